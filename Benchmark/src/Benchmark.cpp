@@ -0,0 +1,164 @@
+#include "mlepch.h"
+#include "Benchmark.h"
+
+#include <iomanip>
+#include <numeric>
+
+namespace benchmark {
+	void BenchmarkSuite::Register(const std::string& name, Function body, Function setup, Function teardown)
+	{
+		entries_.push_back({ name, std::move(body), std::move(setup), std::move(teardown) });
+	}
+
+	const std::vector<BenchmarkResult>& BenchmarkSuite::Run(const BenchmarkOptions& options)
+	{
+		results_.clear();
+		for (const Entry& entry : entries_)
+		{
+			if (!options.filter.empty() && entry.name.find(options.filter) == std::string::npos)
+				continue;
+
+			if (entry.setup)
+				entry.setup();
+			const BenchmarkResult& result = results_.emplace_back(Measure(entry, options));
+			if (entry.teardown)
+				entry.teardown();
+
+			MLE_INFO("[Benchmark] {0}: median {1:.1f} ns, p95 {2:.1f} ns, {3} iterations", result.name, result.median, result.p95, result.iterations);
+		}
+		return results_;
+	}
+
+	BenchmarkResult BenchmarkSuite::Measure(const Entry& entry, const BenchmarkOptions& options)
+	{
+		using clock = std::chrono::steady_clock;
+		auto seconds_since = [](clock::time_point start) {
+			return std::chrono::duration<double>(clock::now() - start).count();
+		};
+
+		BenchmarkResult result{};
+		result.name = entry.name;
+
+		// the first run pays for cold caches and lazy initialization, it isn't kept
+		entry.body();
+
+		// double the batch until a sample is long enough to time
+		uint64_t batch = 1;
+		for (;;)
+		{
+			const clock::time_point start = clock::now();
+			for (uint64_t i = 0; i < batch; ++i)
+				entry.body();
+			if (seconds_since(start) >= options.min_sample_time || batch >= (1ull << 20))
+				break;
+			batch *= 2;
+		}
+
+		std::vector<double> samples;
+		samples.reserve(options.max_samples);
+		const clock::time_point sampling_start = clock::now();
+		while (samples.size() < options.max_samples &&
+			(samples.size() < options.min_samples || seconds_since(sampling_start) < options.min_time))
+		{
+			const clock::time_point start = clock::now();
+			for (uint64_t i = 0; i < batch; ++i)
+				entry.body();
+			samples.push_back(seconds_since(start) * 1e9 / batch);
+		}
+
+		std::sort(samples.begin(), samples.end());
+		// nearest rank, like FrameStats
+		auto percentile = [&samples](double p) {
+			const size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+			return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+		};
+
+		result.samples = static_cast<uint32_t>(samples.size());
+		result.iterations = batch * samples.size();
+		result.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+		result.median = percentile(0.50);
+		result.min = samples.front();
+		result.p95 = percentile(0.95);
+		return result;
+	}
+
+	bool BenchmarkSuite::CompareToBaseline(const std::string& file_path, double threshold)
+	{
+		std::ifstream in(file_path);
+		if (!in.is_open())
+		{
+			MLE_ERROR("[Benchmark] failed to open baseline {0}", file_path);
+			return false;
+		}
+
+		// WriteJSON puts every benchmark on its own line, that is all the parsing needed
+		std::unordered_map<std::string, double> baseline;
+		static constexpr const char NAME_KEY[] = "\"name\": \"";
+		static constexpr const char MEDIAN_KEY[] = "\"median_ns\": ";
+		std::string line;
+		while (std::getline(in, line))
+		{
+			const size_t name_begin = line.find(NAME_KEY);
+			const size_t median_begin = line.find(MEDIAN_KEY);
+			if (name_begin == std::string::npos || median_begin == std::string::npos)
+				continue;
+			const size_t name_offset = name_begin + std::size(NAME_KEY) - 1;
+			const size_t name_end = line.find('"', name_offset);
+			baseline[line.substr(name_offset, name_end - name_offset)] = std::strtod(line.c_str() + median_begin + std::size(MEDIAN_KEY) - 1, nullptr);
+		}
+
+		threshold_ = threshold;
+		for (BenchmarkResult& result : results_)
+		{
+			auto it = baseline.find(result.name);
+			if (it == baseline.end())
+			{
+				MLE_WARN("[Benchmark] {0} isn't in the baseline", result.name);
+				continue;
+			}
+
+			result.baseline_median = it->second;
+			result.is_regression = result.median > result.baseline_median * (1.0 + threshold);
+			const double change = result.baseline_median > 0.0 ? (result.median / result.baseline_median - 1.0) * 100.0 : 0.0;
+			if (result.is_regression)
+				MLE_ERROR("[Benchmark] {0} regressed: {1:.1f} ns -> {2:.1f} ns({3:+.1f}%)", result.name, result.baseline_median, result.median, change);
+			else
+				MLE_INFO("[Benchmark] {0}: {1:.1f} ns -> {2:.1f} ns({3:+.1f}%)", result.name, result.baseline_median, result.median, change);
+		}
+		return true;
+	}
+
+	uint32_t BenchmarkSuite::GetRegressionCount() const
+	{
+		return static_cast<uint32_t>(std::count_if(results_.begin(), results_.end(), [](const BenchmarkResult& result) {
+			return result.is_regression; }));
+	}
+
+	bool BenchmarkSuite::WriteJSON(const std::string& file_path, const std::string& backend) const
+	{
+		std::ofstream out(file_path);
+		if (!out.is_open())
+		{
+			MLE_ERROR("[Benchmark] failed to open {0}", file_path);
+			return false;
+		}
+
+		out << std::fixed << std::setprecision(1);
+		out << "{\n\t\"backend\": \"" << backend << "\",\n\t\"threshold_percent\": " << threshold_ * 100.0
+			<< ",\n\t\"regressions\": " << GetRegressionCount() << ",\n\t\"benchmarks\": [";
+		for (size_t i = 0; i < results_.size(); ++i)
+		{
+			const BenchmarkResult& result = results_[i];
+			out << (i ? "," : "") << "\n\t\t{ \"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+				<< ", \"samples\": " << result.samples << ", \"mean_ns\": " << result.mean << ", \"median_ns\": " << result.median
+				<< ", \"min_ns\": " << result.min << ", \"p95_ns\": " << result.p95;
+			if (result.baseline_median >= 0.0)
+				out << ", \"baseline_median_ns\": " << result.baseline_median << ", \"regression\": " << (result.is_regression ? "true" : "false");
+			out << " }";
+		}
+		out << "\n\t]\n}\n";
+
+		MLE_INFO("[Benchmark] wrote {0} results to {1}", results_.size(), file_path);
+		return true;
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+namespace benchmark {
+	// all times in nanoseconds per iteration
+	struct BenchmarkResult
+	{
+		std::string name;
+		uint64_t iterations = 0;
+		uint32_t samples = 0;
+		double mean = 0.0;
+		double median = 0.0;
+		double min = 0.0;
+		double p95 = 0.0;
+
+		// filled in by CompareToBaseline, a negative baseline means the benchmark is new
+		double baseline_median = -1.0;
+		bool is_regression = false;
+	};
+
+	struct BenchmarkOptions
+	{
+		// only benchmarks whose name contains this run, everything runs if empty
+		std::string filter;
+		// sampling stops after this much time once there are min_samples samples
+		double min_time = 0.5;
+		uint32_t min_samples = 10;
+		uint32_t max_samples = 1000;
+		// iterations are batched until a sample takes at least this long, so the clock isn't what gets measured
+		double min_sample_time = 1e-3;
+	};
+
+	/// <summary>
+	/// A minimal microbenchmark harness. Each benchmark is a setup, a body timed per iteration and a teardown,
+	/// the body has to leave things as it found them so it can run any number of times.
+	/// Results are written as JSON, one benchmark per line, which is also the format read back as a baseline.
+	/// </summary>
+	class BenchmarkSuite
+	{
+	public:
+		using Function = std::function<void()>;
+
+		void Register(const std::string& name, Function body, Function setup = {}, Function teardown = {});
+
+		// Runs every registered benchmark that passes the filter, in registration order
+		const std::vector<BenchmarkResult>& Run(const BenchmarkOptions& options);
+
+		// Medians are compared, a benchmark regressed if it got slower than the baseline by more than threshold(0.1 is 10%)
+		bool CompareToBaseline(const std::string& file_path, double threshold);
+		uint32_t GetRegressionCount() const;
+
+		bool WriteJSON(const std::string& file_path, const std::string& backend) const;
+
+		inline const std::vector<BenchmarkResult>& GetResults() const { return results_; };
+	private:
+		struct Entry
+		{
+			std::string name;
+			Function body;
+			Function setup;
+			Function teardown;
+		};
+
+		static BenchmarkResult Measure(const Entry& entry, const BenchmarkOptions& options);
+
+		std::vector<Entry> entries_;
+		std::vector<BenchmarkResult> results_;
+		double threshold_ = 0.0;
+	};
+}
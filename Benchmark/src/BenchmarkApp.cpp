@@ -0,0 +1,57 @@
+#include "mlepch.h"
+#include <Runtime/Core/Base/Application.h>
+#include <Runtime/Core/Base/EntryPoint.h>
+#include <Runtime/Function/RHI/RHI.h>
+
+#include "BenchmarkLayer.h"
+
+engine::Application* engine::CreateApplication(int argc, char** argv)
+{
+	engine::ApplicationSpecification spec;
+	spec.name = "Benchmark";
+	spec.width = 1280;
+	spec.height = 720;
+	// nothing is shown, the vulkan backend renders offscreen
+	spec.headless = true;
+
+	benchmark::BenchmarkSettings& settings = benchmark::BenchmarkLayer::settings;
+
+	// --rhi null|vulkan --out <file> --baseline <file> --threshold <percent> --filter <substring> --min-time <seconds>
+#ifdef MLE_RHI_STATIC_VULKAN
+	// the build is bound to vulkan, --rhi is ignored
+	settings.backend = "vulkan-static";
+#else
+	rhi::RHI::SetAPI(rhi::RHI::GfxAPI::Null);
+#endif // MLE_RHI_STATIC_VULKAN
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool has_value = i + 1 < argc;
+		if (strcmp(argv[i], "--rhi") == 0 && has_value)
+		{
+#ifdef MLE_RHI_STATIC_VULKAN
+			++i;
+#else
+			settings.backend = argv[++i];
+			// on a machine without a gpu, point the loader at lavapipe(VK_ICD_FILENAMES) to get a software vulkan device
+			if (settings.backend == "vulkan")
+				rhi::RHI::SetAPI(rhi::RHI::GfxAPI::Vulkan);
+			else
+				settings.backend = "null";
+#endif // MLE_RHI_STATIC_VULKAN
+		}
+		else if (strcmp(argv[i], "--out") == 0 && has_value)
+			settings.output_file = argv[++i];
+		else if (strcmp(argv[i], "--baseline") == 0 && has_value)
+			settings.baseline_file = argv[++i];
+		else if (strcmp(argv[i], "--threshold") == 0 && has_value)
+			settings.threshold = std::stod(argv[++i]) / 100.0;
+		else if (strcmp(argv[i], "--filter") == 0 && has_value)
+			settings.options.filter = argv[++i];
+		else if (strcmp(argv[i], "--min-time") == 0 && has_value)
+			settings.options.min_time = std::stod(argv[++i]);
+	}
+
+	engine::Application* app = new engine::Application(spec);
+	app->PushLayer<benchmark::BenchmarkLayer>();
+	return app;
+}
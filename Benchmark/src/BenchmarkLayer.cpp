@@ -0,0 +1,474 @@
+#include "mlepch.h"
+#include "BenchmarkLayer.h"
+#include "Runtime/Core/Base/Application.h"
+#include "Runtime/Function/RHI/RHI.h"
+
+namespace benchmark {
+	BenchmarkSettings BenchmarkLayer::settings{};
+
+	namespace {
+		// the editor's shaders, the null backend never reads them
+		constexpr const char* VERT_SHADER_PATH = "asset/shaders/PostProcess.spv";
+		constexpr const char* FRAG_SHADER_PATH = "asset/shaders/Combine.spv";
+
+		constexpr uint32_t TEXTURE_SIZE = 256;
+	}
+
+	void BenchmarkLayer::OnAttach()
+	{
+		using namespace renderer;
+		rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+
+		//////////////////////////////////////
+		// Shared Resources
+		//////////////////////////////////////
+		{
+			desc_allocator_ = rhi.CreateDescriptorAllocator();
+			layout_cache_ = rhi.CreateDescriptorSetLayoutCache();
+
+			set_layout_ =
+				rhi::DescriptorSetLayoutBuilder::Begin(layout_cache_.get())
+				.AddBinding(0, DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_FRAGMENT_BIT, 1)
+				.AddBinding(1, DESCRIPTOR_TYPE_UNIFORM_BUFFER, SHADER_STAGE_FRAGMENT_BIT, 1)
+				.Build();
+
+			for (uint32_t i = 0; i < DESCRIPTOR_SET_COUNT; ++i)
+			{
+				sets_.emplace_back(rhi.RHICreateDescriptorSet());
+			}
+
+			rhi::RHIBuffer::Descriptor ubo_desc{};
+			ubo_desc.element_stride = 256;
+			ubo_desc.memory_usage = MemoryUsage::MEMORY_USAGE_CPU_TO_GPU;
+			ubo_desc.usage = ResourceTypes::RESOURCE_TYPE_UNIFORM_BUFFER;
+			ubo_desc.mapped_at_creation = true;
+			ubo_ = rhi.RHICreateBuffer(ubo_desc);
+
+			vert_shader_ = rhi.RHICreateShaderModule(VERT_SHADER_PATH);
+			frag_shader_ = rhi.RHICreateShaderModule(FRAG_SHADER_PATH);
+
+			rhi::DescriptorSetLayout* layouts[] = { set_layout_.get() };
+			rhi::PipelineLayout::Descriptor pipeline_layout_desc{};
+			pipeline_layout_desc.set_layout_count = 1;
+			pipeline_layout_desc.layouts = layouts;
+			pipeline_layout_ = rhi.RHICreatePipelineLayout(pipeline_layout_desc);
+
+			pipeline_desc_.vert_shader = vert_shader_;
+			pipeline_desc_.frag_shader = frag_shader_;
+			pipeline_desc_.layout = pipeline_layout_;
+			pipeline_desc_.use_vertex_attribute = false;
+
+			// a single color attachment and subpass, what the graph's passes look like too
+			rhi::RenderPass::Descriptor render_pass_desc{};
+			render_pass_desc.attachments.emplace_back();
+			render_pass_desc.subpasses.push_back({ { 0 }, {}, {}, false });
+			render_pass_ = rhi.RHICreateRenderPass(render_pass_desc);
+
+			command_buffer_ = rhi.RHICreateCommandBuffer();
+			fence_ = rhi.RHICreateFence();
+			frame_.command_buffer = command_buffer_;
+
+			const uint32_t max_passes = *std::max_element(std::begin(GRAPH_SIZES), std::end(GRAPH_SIZES));
+			for (uint32_t i = 0; i < max_passes; ++i)
+			{
+				pass_names_.push_back("Pass " + std::to_string(i));
+				texture_names_.push_back("Texture " + std::to_string(i));
+			}
+		}
+
+		RegisterRenderGraphBenchmarks();
+		RegisterDescriptorBenchmarks();
+		RegisterBufferBenchmarks();
+		RegisterPipelineBenchmarks();
+		RegisterSubmitBenchmarks();
+		RegisterCommandBenchmarks();
+
+		//////////////////////////////////////
+		// Run
+		//////////////////////////////////////
+		{
+			// every compile logs its schedules, that would be most of what gets measured
+			auto& core_logger = engine::Log::GetCoreLogger();
+			const spdlog::level::level_enum core_level = core_logger->level();
+			core_logger->set_level(spdlog::level::warn);
+
+			suite_.Run(settings.options);
+
+			core_logger->set_level(core_level);
+
+			uint32_t regression_count = 0;
+			if (!settings.baseline_file.empty())
+			{
+				if (suite_.CompareToBaseline(settings.baseline_file, settings.threshold))
+				{
+					regression_count = suite_.GetRegressionCount();
+					MLE_INFO("[Benchmark] {0} regressions over {1:.0f}%", regression_count, settings.threshold * 100.0);
+				}
+				else
+				{
+					regression_count = 1;
+				}
+			}
+			suite_.WriteJSON(settings.output_file, settings.backend);
+
+			engine::Application::GetApp().SetExitCode(static_cast<int>(regression_count));
+		}
+
+		// The application still renders a frame before it sees Close(), that frame needs a present pass
+		{
+			RenderGraph& render_graph = Renderer::GetInstance().GetRenderGraph();
+			render_graph.AddPresentPass("Present & UI Pass",
+				[&](RenderGraph& rg, RenderGraph::RenderPassBuilder& builder)
+				{
+				},
+				[=](RenderGraph& rg, rhi::RenderPass& rp, rhi::RenderTarget& rt, FrameResource& current_frame)
+				{
+					ImGui::Render();
+					ImGui_RenderDrawData(current_frame.command_list, ImGui::GetDrawData());
+				});
+			render_graph.Compile();
+		}
+	}
+
+	void BenchmarkLayer::OnDetach()
+	{
+		rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+		renderer::Renderer::GetInstance().GetRenderGraph().Clear();
+
+		if (graph_)
+			graph_->Clear();
+		CleanFrame();
+
+		delete command_buffer_;
+		rhi.RHIDestroyFence(fence_);
+
+		render_pass_.reset();
+		rhi.RHIFreePipelineLayout(*pipeline_layout_);
+		delete pipeline_layout_;
+		rhi.RHIFreeShaderModule(*vert_shader_);
+		delete vert_shader_;
+		rhi.RHIFreeShaderModule(*frag_shader_);
+		delete frag_shader_;
+
+		rhi.RHIFreeBuffer(*ubo_);
+		sets_.clear();
+		set_layout_.reset();
+		desc_allocator_.reset();
+		layout_cache_.reset();
+	}
+
+	void BenchmarkLayer::OnUpdate(float delta_time)
+	{
+		engine::Application::GetApp().Close();
+	}
+
+	void BenchmarkLayer::BuildGraph(renderer::RenderGraph& graph, uint32_t pass_count)
+	{
+		using namespace renderer;
+		using LoadOp = rhi::RenderPass::AttachmentDesc::LoadOp;
+		using StoreOp = rhi::RenderPass::AttachmentDesc::StoreOp;
+
+		std::vector<ResourceHandle> textures(pass_count);
+		for (uint32_t i = 0; i < pass_count; ++i)
+		{
+			textures[i] = graph.AddResource<RenderGraphTexture>(texture_names_[i].c_str(),
+				{ TEXTURE_SIZE, TEXTURE_SIZE, 1, 1, 1, PixelFormat::RGBA8, TextureUsage::COLOR_ATTACHMENT | TextureUsage::SAMPLEABLE });
+		}
+
+		for (uint32_t i = 0; i < pass_count; ++i)
+		{
+			const bool reads_previous = i > 0;
+			const bool reads_skipped = i >= SKIP_DISTANCE && i % SKIP_DISTANCE == 0;
+			graph.AddPass(pass_names_[i].c_str(),
+				[&](RenderGraph& rg, RenderGraph::RenderPassBuilder& builder)
+				{
+					if (reads_previous)
+						builder.Read(textures[i - 1]);
+					if (reads_skipped)
+						builder.Read(textures[i - SKIP_DISTANCE]);
+					builder.Write(textures[i], LoadOp::CLEAR, StoreOp::STORE)
+						.AddSubpass("Draw subpass",
+							[&](RenderGraph& rg, RenderGraph::SubpassBuilder& builder)
+							{
+								if (reads_previous)
+									builder.Read(0, 0, textures[i - 1]);
+								if (reads_skipped)
+									builder.Read(0, 1, textures[i - SKIP_DISTANCE]);
+								builder.Write(textures[i])
+									.SetPipeline(pipeline_desc_);
+							});
+				},
+				[](RenderGraph& rg, rhi::RenderPass& rp, rhi::RenderTarget& rt, FrameResource& current_frame)
+				{
+					BindGfxPipeline(current_frame.command_list, rp.GetPipeline(0).get());
+					SetViewport(current_frame.command_list, 0, 0, static_cast<float>(rt.GetWidth()), static_cast<float>(rt.GetHeight()));
+					SetScissor(current_frame.command_list, 0, 0, rt.GetWidth(), rt.GetHeight());
+					Draw(current_frame.command_list, 3, 1, 0, 0);
+				});
+		}
+
+		// nothing reads the last texture, keep its pass and with it the whole chain
+		graph.GetRenderPass(pass_names_[pass_count - 1].c_str()).DontCull();
+	}
+
+	void BenchmarkLayer::CleanFrame()
+	{
+		rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+		for (auto texture : frame_.texture_dump)
+		{
+			rhi.RHIFreeTexture(*texture);
+		}
+		frame_.texture_dump.clear();
+		for (auto buffer : frame_.buffer_dump)
+		{
+			rhi.RHIFreeBuffer(*buffer);
+		}
+		frame_.buffer_dump.clear();
+		frame_.render_target_dump.clear();
+	}
+
+	void BenchmarkLayer::RegisterRenderGraphBenchmarks()
+	{
+		using namespace renderer;
+		for (uint32_t pass_count : GRAPH_SIZES)
+		{
+			const std::string size = std::to_string(pass_count);
+
+			// declaring, culling, scheduling and instantiating the render passes and pipelines
+			suite_.Register("RenderGraph/BuildCompile/" + size,
+				[this, pass_count]()
+				{
+					RenderGraph graph;
+					BuildGraph(graph, pass_count);
+					graph.Compile();
+					graph.Clear();
+				});
+
+			// recording a frame of the compiled graph, transient textures and the command list translation included
+			suite_.Register("RenderGraph/Run/" + size,
+				[this]()
+				{
+					command_buffer_->Begin();
+					graph_->Run(frame_);
+					frame_.command_list.Translate(*command_buffer_);
+					frame_.command_list.Reset();
+					command_buffer_->End();
+					CleanFrame();
+				},
+				[this, pass_count]()
+				{
+					graph_ = std::make_unique<RenderGraph>();
+					BuildGraph(*graph_, pass_count);
+					graph_->Compile();
+				},
+				[this]()
+				{
+					graph_->Clear();
+					graph_.reset();
+				});
+		}
+	}
+
+	void BenchmarkLayer::RegisterDescriptorBenchmarks()
+	{
+		suite_.Register("Descriptor/Allocate/" + std::to_string(DESCRIPTOR_SET_COUNT),
+			[this]()
+			{
+				for (auto& set : sets_)
+				{
+					desc_allocator_->Allocate(set.get(), set_layout_.get());
+				}
+				desc_allocator_->ResetPools();
+			});
+
+		suite_.Register("Descriptor/Write",
+			[this]()
+			{
+				rhi::DescriptorWriter::Begin(desc_allocator_.get())
+					.WriteBuffer(0, ubo_.get(), DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+					.WriteBuffer(1, ubo_.get(), DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+					.OverWrite(sets_[0].get());
+			},
+			[this]()
+			{
+				desc_allocator_->Allocate(sets_[0].get(), set_layout_.get());
+			},
+			[this]()
+			{
+				desc_allocator_->ResetPools();
+			});
+	}
+
+	void BenchmarkLayer::RegisterBufferBenchmarks()
+	{
+		static constexpr uint32_t BUFFER_SIZES[] = { 256, 64 * 1024 };
+		for (uint32_t buffer_size : BUFFER_SIZES)
+		{
+			auto buffer = std::make_shared<rhi::BufferRef>();
+			auto data = std::make_shared<std::vector<uint8_t>>(buffer_size, uint8_t(0x5A));
+			suite_.Register("Buffer/SetData/" + std::to_string(buffer_size),
+				[buffer, data]()
+				{
+					(*buffer)->SetData(data->data(), data->size());
+				},
+				[buffer, buffer_size]()
+				{
+					rhi::RHIBuffer::Descriptor desc{};
+					desc.element_stride = buffer_size;
+					desc.memory_usage = MemoryUsage::MEMORY_USAGE_CPU_TO_GPU;
+					desc.usage = ResourceTypes::RESOURCE_TYPE_STORAGE_BUFFER;
+					desc.mapped_at_creation = true;
+					*buffer = rhi::RHI::GetRHIInstance().RHICreateBuffer(desc);
+				},
+				[buffer]()
+				{
+					rhi::RHI::GetRHIInstance().RHIFreeBuffer(**buffer);
+					buffer->reset();
+				});
+		}
+	}
+
+	void BenchmarkLayer::RegisterPipelineBenchmarks()
+	{
+		// Cold: the shaders are loaded and the layout created along with the pipeline, like the first time a pass is compiled
+		suite_.Register("Pipeline/Create/Cold",
+			[this]()
+			{
+				rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+				std::unique_ptr<rhi::ShaderModule> vert_shader(rhi.RHICreateShaderModule(VERT_SHADER_PATH));
+				std::unique_ptr<rhi::ShaderModule> frag_shader(rhi.RHICreateShaderModule(FRAG_SHADER_PATH));
+
+				rhi::DescriptorSetLayout* layouts[] = { set_layout_.get() };
+				rhi::PipelineLayout::Descriptor layout_desc{};
+				layout_desc.set_layout_count = 1;
+				layout_desc.layouts = layouts;
+				std::unique_ptr<rhi::PipelineLayout> layout(rhi.RHICreatePipelineLayout(layout_desc));
+
+				rhi::RHIPipeline::Descriptor desc = pipeline_desc_;
+				desc.vert_shader = vert_shader.get();
+				desc.frag_shader = frag_shader.get();
+				desc.layout = layout.get();
+				desc.render_pass = render_pass_.get();
+				desc.subpass = 0;
+				rhi::PipelineRef pipeline = rhi.RHICreatePipeline(desc);
+
+				rhi.RHIFreePipeline(*pipeline);
+				rhi.RHIFreePipelineLayout(*layout);
+				rhi.RHIFreeShaderModule(*vert_shader);
+				rhi.RHIFreeShaderModule(*frag_shader);
+			});
+
+		// Warm: shaders and layout are already there, only the pipeline is created
+		suite_.Register("Pipeline/Create/Warm",
+			[this]()
+			{
+				rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+				rhi::RHIPipeline::Descriptor desc = pipeline_desc_;
+				desc.render_pass = render_pass_.get();
+				desc.subpass = 0;
+				rhi::PipelineRef pipeline = rhi.RHICreatePipeline(desc);
+				rhi.RHIFreePipeline(*pipeline);
+			});
+	}
+
+	void BenchmarkLayer::RegisterSubmitBenchmarks()
+	{
+		// an empty command buffer submitted and waited on, the fixed cost of a submit
+		suite_.Register("Queue/Submit",
+			[this]()
+			{
+				rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+				rhi.RHIWaitForFences(&fence_, 1);
+
+				command_buffer_->Begin();
+				command_buffer_->End();
+
+				rhi::QueueSubmitDesc submit_info{};
+				rhi::RHIEncoderBase* encoders[] = { &command_buffer_->GetGfxEncoder() };
+				submit_info.encoders = encoders;
+				submit_info.cmds_count = 1;
+				submit_info.signal_fence = fence_;
+				rhi.GfxQueueSubmit(submit_info);
+			},
+			{},
+			[]()
+			{
+				rhi::RHI::GetRHIInstance().RHIBlockUntilGPUIdle();
+			});
+	}
+
+	void BenchmarkLayer::RegisterCommandBenchmarks()
+	{
+		struct DrawTarget
+		{
+			rhi::TextureRef texture;
+			std::unique_ptr<rhi::RenderTarget> render_target;
+			rhi::PipelineRef pipeline;
+		};
+		auto target = std::make_shared<DrawTarget>();
+
+		auto create_target = [this, target]()
+		{
+			rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+			target->texture = rhi.RHICreateTexture({ TEXTURE_SIZE, TEXTURE_SIZE, 1, 1, 1, PixelFormat::RGBA8, TextureUsage::COLOR_ATTACHMENT });
+
+			rhi::RenderTarget::Descriptor target_desc{};
+			target_desc.attachments.push_back(target->texture.get());
+			target_desc.width = TEXTURE_SIZE;
+			target_desc.height = TEXTURE_SIZE;
+			target_desc.pass = render_pass_.get();
+			target->render_target = rhi.RHICreateRenderTarget(target_desc);
+
+			rhi::RHIPipeline::Descriptor pipeline_desc = pipeline_desc_;
+			pipeline_desc.render_pass = render_pass_.get();
+			pipeline_desc.subpass = 0;
+			target->pipeline = rhi.RHICreatePipeline(pipeline_desc);
+		};
+		auto free_target = [target]()
+		{
+			rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+			rhi.RHIBlockUntilGPUIdle();
+			rhi.RHIFreePipeline(*target->pipeline);
+			target->pipeline.reset();
+			target->render_target.reset();
+			rhi.RHIFreeTexture(*target->texture);
+			target->texture.reset();
+		};
+
+		// the same draws recorded straight into the command buffer or into a command list that is translated afterwards
+		auto record = [this, target](auto& cmd)
+		{
+			using namespace renderer;
+			BeginRenderPass(cmd, *render_pass_, *target->render_target);
+			BindGfxPipeline(cmd, target->pipeline.get());
+			SetViewport(cmd, 0.0f, 0.0f, static_cast<float>(TEXTURE_SIZE), static_cast<float>(TEXTURE_SIZE));
+			SetScissor(cmd, 0, 0, TEXTURE_SIZE, TEXTURE_SIZE);
+			for (uint32_t i = 0; i < DRAW_COUNT; ++i)
+			{
+				Draw(cmd, 3, 1);
+			}
+			EndRenderPass(cmd);
+		};
+
+		// only recorded, what a pass pays per draw to reach the backend's encoder
+		suite_.Register("Commands/Draw/" + std::to_string(DRAW_COUNT),
+			[this, record]()
+			{
+				command_buffer_->Begin();
+				record(*command_buffer_);
+				command_buffer_->End();
+			},
+			create_target, free_target);
+
+		suite_.Register("Commands/Draw/" + std::to_string(DRAW_COUNT) + "/Deferred",
+			[this, record]()
+			{
+				command_buffer_->Begin();
+				record(frame_.command_list);
+				frame_.command_list.Translate(*command_buffer_);
+				frame_.command_list.Reset();
+				command_buffer_->End();
+			},
+			create_target, free_target);
+	}
+}
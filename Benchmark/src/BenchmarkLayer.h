@@ -0,0 +1,72 @@
+#pragma once
+#include "Runtime/Core/Base/Layer.h"
+#include "Runtime/Function/Renderer/Renderer.h"
+#include "Benchmark.h"
+
+namespace benchmark {
+	struct BenchmarkSettings
+	{
+		BenchmarkOptions options;
+		// results are written here
+		std::string output_file = "MLE-Benchmark.json";
+		// compared against if not empty
+		std::string baseline_file;
+		double threshold = 0.1;
+		std::string backend = "null";
+	};
+
+	/// <summary>
+	/// Runs the render graph and RHI microbenchmarks once everything is initialized, writes the results and closes the application.
+	/// The exit code is the number of regressions against the baseline.
+	/// </summary>
+	class BenchmarkLayer : public engine::Layer
+	{
+	public:
+		static BenchmarkSettings settings;
+
+		virtual void OnAttach() override;
+		virtual void OnDetach() override;
+		virtual void OnUpdate(float delta_time) override;
+	private:
+		void RegisterRenderGraphBenchmarks();
+		void RegisterDescriptorBenchmarks();
+		void RegisterBufferBenchmarks();
+		void RegisterPipelineBenchmarks();
+		void RegisterSubmitBenchmarks();
+		// Draw submission throughput through the renderer:: commands, compare a --rhi=vulkan build against a dynamic one
+		void RegisterCommandBenchmarks();
+
+		// A chain of pass_count passes over transient textures, every SKIP_DISTANCE-th pass also reads a texture from further back
+		void BuildGraph(renderer::RenderGraph& graph, uint32_t pass_count);
+		// Frees what a recorded frame dumped, there is no frame manager to do it
+		void CleanFrame();
+
+		static constexpr uint32_t GRAPH_SIZES[] = { 8, 64, 256 };
+		static constexpr uint32_t SKIP_DISTANCE = 4;
+		static constexpr uint32_t DESCRIPTOR_SET_COUNT = 64;
+		static constexpr uint32_t DRAW_COUNT = 1000;
+
+		BenchmarkSuite suite_;
+
+		// pass and resource names have to outlive the graphs
+		std::vector<std::string> pass_names_;
+		std::vector<std::string> texture_names_;
+		std::unique_ptr<renderer::RenderGraph> graph_;
+
+		rhi::DescriptorAllocatorPtr desc_allocator_;
+		rhi::DescriptorSetLayoutCachePtr layout_cache_;
+		rhi::DescriptorSetLayoutRef set_layout_;
+		std::vector<rhi::DescriptorSetPtr> sets_;
+		rhi::BufferRef ubo_;
+
+		rhi::ShaderModule* vert_shader_ = nullptr;
+		rhi::ShaderModule* frag_shader_ = nullptr;
+		rhi::PipelineLayout* pipeline_layout_ = nullptr;
+		rhi::RHIPipeline::Descriptor pipeline_desc_{};
+		std::unique_ptr<rhi::RenderPass> render_pass_;
+
+		rhi::CommandBuffer* command_buffer_ = nullptr;
+		rhi::Fence* fence_ = nullptr;
+		renderer::FrameResource frame_{};
+	};
+}
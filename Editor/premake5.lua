@@ -34,12 +34,12 @@ project "Editor"
       defines { "MLE_PLATFORM_WINDOWS" }
 
    filter "configurations:Debug"
-      defines { "MLE_DEBUG" }
+      defines { "MLE_DEBUG", "MLE_PROFILE" }
       runtime "Debug"
       symbols "On"
 
    filter "configurations:Release"
-      defines { "MLE_RELEASE" }
+      defines { "MLE_RELEASE", "MLE_PROFILE" }
       runtime "Release"
       optimize "On"
       symbols "On"
@@ -1,6 +1,8 @@
 #include "mlepch.h"
 #include <Runtime/Core/Base/Application.h>
 #include <Runtime/Core/Base/EntryPoint.h>
+#include <Runtime/Function/RHI/RHI.h>
+#include <Runtime/Function/RHI/FrameCapture.h>
 
 #include "EditorLayer.h"
 
@@ -10,8 +12,93 @@ engine::Application* engine::CreateApplication(int argc, char** argv)
 	spec.name = "Editor";
 	spec.width = 1920;
 	spec.height = 1080;
+	spec.frame_stats_file = "MLE-FrameStats";
+
+	// --headless [frame count] --null-rhi --flythrough [camera path file] --flythrough-frames <frame count>
+	// --capture <file> --capture-start <frame> --capture-frames <frame count>
+	// --latency low|throughput --frames-in-flight <1-4> --present-mode fifo|mailbox|immediate --max-fps <rate>
+	// --on-demand|--continuous --max-idle-interval <seconds>
+	bool play_flythrough = false;
+	editor::FlythroughSettings flythrough{};
+	std::string capture_file;
+	uint32_t capture_start = 0;
+	uint32_t capture_frames = 1;
+	bool render_on_demand = true;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--headless") == 0)
+		{
+			spec.headless = true;
+			if (i + 1 < argc && isdigit(argv[i + 1][0]))
+				spec.frame_count = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--null-rhi") == 0)
+			rhi::RHI::SetAPI(rhi::RHI::GfxAPI::Null);
+		else if (strcmp(argv[i], "--flythrough") == 0)
+		{
+			play_flythrough = true;
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				flythrough.path_file = argv[++i];
+		}
+		else if (strcmp(argv[i], "--flythrough-frames") == 0 && i + 1 < argc)
+			flythrough.frame_count = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+			capture_file = argv[++i];
+		else if (strcmp(argv[i], "--capture-start") == 0 && i + 1 < argc)
+			capture_start = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (strcmp(argv[i], "--capture-frames") == 0 && i + 1 < argc)
+			capture_frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc)
+		{
+			// presets, the flags after this one override them
+			if (strcmp(argv[++i], "low") == 0)
+			{
+				spec.frames_in_flight = 1;
+				spec.present_mode = rhi::PresentMode::MAILBOX;
+				spec.low_latency = true;
+			}
+			else
+			{
+				spec.frames_in_flight = renderer::FrameResourceMngr::MAX_FRAMES_IN_FLIGHT;
+				spec.present_mode = rhi::PresentMode::IMMEDIATE;
+				spec.low_latency = false;
+			}
+		}
+		else if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+			spec.frames_in_flight = static_cast<uint8_t>(std::stoul(argv[++i]));
+		else if (strcmp(argv[i], "--present-mode") == 0 && i + 1 < argc)
+		{
+			++i;
+			if (strcmp(argv[i], "fifo") == 0)
+				spec.present_mode = rhi::PresentMode::FIFO;
+			else if (strcmp(argv[i], "immediate") == 0)
+				spec.present_mode = rhi::PresentMode::IMMEDIATE;
+			else
+				spec.present_mode = rhi::PresentMode::MAILBOX;
+		}
+		else if (strcmp(argv[i], "--max-fps") == 0 && i + 1 < argc)
+			spec.max_frame_rate = std::stof(argv[++i]);
+		else if (strcmp(argv[i], "--on-demand") == 0)
+			render_on_demand = true;
+		else if (strcmp(argv[i], "--continuous") == 0)
+			render_on_demand = false;
+		else if (strcmp(argv[i], "--max-idle-interval") == 0 && i + 1 < argc)
+			spec.max_idle_interval = std::max(std::stof(argv[++i]), 0.0f);
+	}
+	// an idle editor only redraws when something changes, benchmarks and captures need every frame
+	spec.render_on_demand = render_on_demand && !play_flythrough && capture_file.empty();
+	// the whole application steps at the flythrough's rate, so every run renders the same frames
+	if (play_flythrough)
+		spec.fixed_time_step = flythrough.time_step;
+
+	// the frames can only be replayed if the capture saw everything they use being created
+	if (!capture_file.empty())
+		rhi::FrameCapture::GetInstance().Start(capture_file, capture_start, capture_frames);
 
 	engine::Application* app = new engine::Application(spec);
-	app->PushLayer<editor::EditorLayer>();
+	auto editor_layer = std::make_shared<editor::EditorLayer>();
+	if (play_flythrough)
+		editor_layer->PlayFlythroughAndExit(flythrough);
+	app->PushLayer(editor_layer);
 	return app;
 }
\ No newline at end of file
@@ -102,6 +102,14 @@ void EditorCamera::OnResize(uint32_t width, uint32_t height)
 	RecalculateProjection();
 }
 
+void EditorCamera::SetView(const glm::vec3& position, const glm::vec3& direction)
+{
+	position_ = position;
+	forward_direction_ = glm::normalize(direction);
+
+	RecalculateView();
+}
+
 float EditorCamera::GetRotationSpeed()
 {
 	return 0.3f;
@@ -11,6 +11,8 @@ namespace editor
 
 		bool OnUpdate(float ts);
 		void OnResize(uint32_t width, uint32_t height);
+		// Places the camera directly, used when it is driven by a path instead of input
+		void SetView(const glm::vec3& position, const glm::vec3& direction);
 
 		const glm::mat4& GetProjection() const { return projection_; }
 		const glm::mat4& GetInverseProjection() const { return inverse_projection_; }
@@ -147,8 +147,9 @@ namespace editor {
 			ResourceHandle color_buffer_handle = render_graph.ImportResource<RenderGraphTexture>("back_buffer", 
 				{ back_buffer_->width, back_buffer_->height, 1, 1, 1,  PixelFormat::RGBA8, TextureUsage::COLOR_ATTACHMENT | TextureUsage::SAMPLEABLE},
 				{ back_buffer_ });
-			ResourceHandle sky_texture_handle = render_graph.AddResource<RenderGraphTexture>("sky_texture",
+			ResourceHandle sky_texture_handle = render_graph.AddHistoryResource<RenderGraphTexture>("sky_texture",
 				{ (back_buffer_->width) / 2, (back_buffer_->height) / 2, 1, 1, 1,  PixelFormat::RGBA8, TextureUsage::COLOR_ATTACHMENT | TextureUsage::SAMPLEABLE });
+			sky_texture_ = sky_texture_handle;
 
 			// Sky Pass
 			{
@@ -161,33 +162,26 @@ namespace editor {
 								{
 									builder.Write(sky_texture_handle)
 										.SetPipeline(sky_pipeline);
+								})
+							// skipped while the cached sky is still up to date
+							.EnableIf([this]() { return render_sky_ && is_sky_dirty_; })
+							.Static([this](RenderGraph& rg, FrameResource& current_frame)
+								{
+									// Update Buffer, UpdateSkyInputs gathered the inputs
+									camera_ubo_[frame_index_]->SetData(&sky_camera_data_, sizeof(sky_camera_data_));
+									param_ubo_[frame_index_]->SetData(&param_, sizeof(param_));
 								});
 					},
 					[=](RenderGraph& rg, rhi::RenderPass& rp, rhi::RenderTarget& rt, FrameResource& current_frame)
 					{
-						// Update Buffer
-						CameraUbo camera_data{};
-						camera_data.position = editor_camera_.GetPosition();
-						camera_data.inverse_view = editor_camera_.GetInverseView();
-						camera_data.inverse_proj = editor_camera_.GetInverseProjection();
-						camera_ubo_[frame_index_]->SetData(&camera_data, sizeof(camera_data));
-
-						param_.sun_light_color = light_entity_.GetComponent<engine::LightComponent>().light_color;
-						param_.sun_light_intensity = light_entity_.GetComponent<engine::LightComponent>().light_intensity;
-
-						glm::mat4 quat_rotation = glm::toMat4(glm::quat(light_entity_.GetComponent<engine::TransformComponent>().rotation));
-
-						param_.sun_light_direction = quat_rotation * glm::vec4(0, 1, 1, 1);
-
-						param_ubo_[frame_index_]->SetData(&param_, sizeof(param_));
-						// ----------------------------
-						BindGfxPipeline(*current_frame.command_buffer, rp.GetPipeline(0).get());
-						SetViewport(*current_frame.command_buffer, 0, 0, (back_buffer_->width) / 2, (back_buffer_->height) / 2);
-						SetScissor(*current_frame.command_buffer, 0, 0, (back_buffer_->width) / 2, (back_buffer_->height) / 2);
+						// recorded once per frame in flight, the buffers are updated by the Static callback
+						BindGfxPipeline(current_frame.command_list, rp.GetPipeline(0).get());
+						SetViewport(current_frame.command_list, 0, 0, (back_buffer_->width) / 2, (back_buffer_->height) / 2);
+						SetScissor(current_frame.command_list, 0, 0, (back_buffer_->width) / 2, (back_buffer_->height) / 2);
 
 						rhi::DescriptorSet* sets[] = { global_set_[frame_index_].get()};
-						BindDescriptorSets(*current_frame.command_buffer, rp.GetPipeline(0)->layout, 0, 1, sets, 0, nullptr);
-						Draw(*current_frame.command_buffer, 3, 1, 0, 0);
+						BindDescriptorSets(current_frame.command_list, rp.GetPipeline(0)->layout, 0, 1, sets, 0, nullptr);
+						Draw(current_frame.command_list, 3, 1, 0, 0);
 					});
 			}
 
@@ -197,6 +191,7 @@ namespace editor {
 					[&](RenderGraph& rg, RenderGraph::RenderPassBuilder& builder)
 					{
 						builder.Read(sky_texture_handle)
+							.ReadPrevious(sky_texture_handle)
 							.Write(color_buffer_handle, rhi::RenderPass::AttachmentDesc::LoadOp::DONT_CARE, rhi::RenderPass::AttachmentDesc::StoreOp::STORE)
 							.AddSubpass("Combine subpass",
 								[&](RenderGraph& rg, RenderGraph::SubpassBuilder& builder)
@@ -204,24 +199,32 @@ namespace editor {
 									builder.Read(0, 0, sky_texture_handle)
 										.Write(color_buffer_handle)
 										.SetPipeline(combine_pipeline);
+								})
+							// the cached sky stays in the history resource, it has nothing to combine without the sky
+							.EnableIf([this]() { return render_sky_; })
+							.Static([this, sky_texture_handle](RenderGraph& rg, FrameResource& current_frame)
+								{
+									// this frame's sky if the sky pass ran, otherwise the one it rendered last
+									auto sky_texture = static_cast<Resource<RenderGraphTexture>*>(rg.GetResource(sky_texture_handle));
+									const rhi::TextureRef& texture = is_sky_dirty_ ? sky_texture->resource_.texture : rg.GetPreviousResource<RenderGraphTexture>(sky_texture_handle).texture;
+									if (texture == texture_set_source_[frame_index_])
+										return;
+									texture_set_source_[frame_index_] = texture;
+
+									rhi::DescriptorWriter::Begin(desc_allocator_.get())
+										.WriteImage(0, texture.get(), DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+										.OverWrite(texture_set_[frame_index_].get());
 								});
 					},
 					[=](RenderGraph& rg, rhi::RenderPass& rp, rhi::RenderTarget& rt, FrameResource& current_frame)
 					{
-						auto sky_texture = rg.GetResource(sky_texture_handle);
-						auto sky_texture_resource = static_cast<Resource<RenderGraphTexture>*>(sky_texture);
-
-						rhi::DescriptorWriter::Begin(desc_allocator_.get())
-							.WriteImage(0, sky_texture_resource->resource_.texture.get(), DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
-							.OverWrite(texture_set_[frame_index_].get());
-						// ----------------------------
-						BindGfxPipeline(*current_frame.command_buffer, rp.GetPipeline(0).get());
-						SetViewport(*current_frame.command_buffer, 0, 0, back_buffer_->width, back_buffer_->height);
-						SetScissor(*current_frame.command_buffer, 0, 0, back_buffer_->width, back_buffer_->height);
+						BindGfxPipeline(current_frame.command_list, rp.GetPipeline(0).get());
+						SetViewport(current_frame.command_list, 0, 0, back_buffer_->width, back_buffer_->height);
+						SetScissor(current_frame.command_list, 0, 0, back_buffer_->width, back_buffer_->height);
 
 						rhi::DescriptorSet* sets[] = { texture_set_[frame_index_].get()};
-						BindDescriptorSets(*current_frame.command_buffer, rp.GetPipeline(0)->layout, 0, 1, sets, 0, nullptr);
-						Draw(*current_frame.command_buffer, 3, 1, 0, 0);
+						BindDescriptorSets(current_frame.command_list, rp.GetPipeline(0)->layout, 0, 1, sets, 0, nullptr);
+						Draw(current_frame.command_list, 3, 1, 0, 0);
 					});
 			}
 		
@@ -240,7 +243,7 @@ namespace editor {
 						const bool main_is_minimized = (main_draw_data->DisplaySize.x <= 0.0f || main_draw_data->DisplaySize.y <= 0.0f);
 						
 						// Record dear imgui primitives into command buffer
-						ImGui_RenderDrawData(*current_frame.command_buffer, main_draw_data);
+						ImGui_RenderDrawData(current_frame.command_list, main_draw_data);
 						
 						ImGuiIO& io = ImGui::GetIO(); (void)io;
 						if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
@@ -258,6 +261,47 @@ namespace editor {
 			rhi.RHIFreeShaderModule(*atmosphere_frag);
 			rhi.RHIFreeShaderModule(*combine_frag);
 		}
+
+		if (exit_after_flythrough_)
+			flythrough_.Start(flythrough_settings_);
+	}
+
+	// FNV-1a over the raw bytes, the sky's input structs are zero initialized so padding can't differ
+	static uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	void EditorLayer::UpdateSkyInputs(bool is_history_lost)
+	{
+		sky_camera_data_ = {};
+		sky_camera_data_.position = editor_camera_.GetPosition();
+		sky_camera_data_.inverse_view = editor_camera_.GetInverseView();
+		sky_camera_data_.inverse_proj = editor_camera_.GetInverseProjection();
+
+		param_.sun_light_color = light_entity_.GetComponent<engine::LightComponent>().light_color;
+		param_.sun_light_intensity = light_entity_.GetComponent<engine::LightComponent>().light_intensity;
+
+		glm::mat4 quat_rotation = glm::toMat4(glm::quat(light_entity_.GetComponent<engine::TransformComponent>().rotation));
+
+		param_.sun_light_direction = quat_rotation * glm::vec4(0, 1, 1, 1);
+
+		const uint64_t hash = HashBytes(&param_, sizeof(param_), HashBytes(&sky_camera_data_, sizeof(sky_camera_data_)));
+		renderer::RenderGraph& render_graph = renderer::Renderer::GetInstance().GetRenderGraph();
+		is_sky_dirty_ = hash != sky_inputs_hash_ || is_history_lost || !render_graph.IsHistoryValid(sky_texture_);
+		sky_inputs_hash_ = hash;
+	}
+
+	void EditorLayer::PlayFlythroughAndExit(const FlythroughSettings& settings)
+	{
+		flythrough_settings_ = settings;
+		exit_after_flythrough_ = true;
 	}
 
 	void EditorLayer::OnDetach() 
@@ -296,11 +340,27 @@ namespace editor {
 		Renderer& renderer = Renderer::GetInstance();
 		frame_index_ = renderer.GetFrameIndex();
 		auto& current_frame = renderer.GetCurrentFrame();
+		engine::Application& app = engine::Application::GetApp();
+
+		// F9 dumps the frame statistics
+		const bool dump_stats_down = engine::InputSystem::IsKeyDown(engine::KeyCode::F9);
+		if (dump_stats_down && !dump_stats_key_down_)
+		{
+			engine::FrameStats& frame_stats = app.GetFrameStats();
+			frame_stats.WriteCSV("MLE-FrameStats.csv");
+			frame_stats.WriteJSON("MLE-FrameStats.json");
+		}
+		dump_stats_key_down_ = dump_stats_down;
 		// Resize
+		bool is_resized = false;
 		if ( viewport_size_.x > 0.0f && viewport_size_.y > 0.0f && // zero sized framebuffer is invalid
 			(back_buffer_->width != viewport_size_.x || back_buffer_->height != viewport_size_.y))
 		{
-			rhi::RHI::GetRHIInstance().ResizeTexture(*back_buffer_, (uint32_t)viewport_size_.x, (uint32_t)viewport_size_.y);
+			is_resized = true;
+			// the frames in flight may still sample the old back buffer
+			rhi::TextureRef old_back_buffer = rhi::RHI::GetRHIInstance().ResizeTexture(*back_buffer_, (uint32_t)viewport_size_.x, (uint32_t)viewport_size_.y);
+			if (old_back_buffer)
+				current_frame.texture_dump.push_back(old_back_buffer);
 
 			RenderGraph& render_graph = renderer.GetRenderGraph();
 			auto& pass = render_graph.GetRenderPass("Sky Pass");
@@ -310,9 +370,32 @@ namespace editor {
 			render_graph.ResizeRenderTarget(&combine_pass, viewport_size_.x, viewport_size_.y);
 
 			editor_camera_.OnResize(viewport_size_.x, viewport_size_.y);
+			app.RequestRedraw();
+		}
+
+		if (flythrough_.IsPlaying())
+		{
+			if (!flythrough_.Update(editor_camera_, light_entity_) && exit_after_flythrough_)
+				app.Close();
+			app.RequestRedraw();
+		}
+		else
+		{
+			// a held key moves the camera without sending new events
+			if (editor_camera_.OnUpdate(delta_time) || path_recorder_.IsRecording())
+				app.RequestRedraw();
+			path_recorder_.Update(delta_time, editor_camera_, light_entity_);
+		}
+
+		if (editor_scene_->GetChangeVersion() != rendered_scene_version_)
+		{
+			rendered_scene_version_ = editor_scene_->GetChangeVersion();
+			app.RequestRedraw();
 		}
 
-		editor_camera_.OnUpdate(delta_time);
+		// once per frame, the sky pass predicate only reads the result. A resize recreates the history when the graph runs,
+		// the cached sky is gone then
+		UpdateSkyInputs(is_resized);
 	}
 
 	void EditorLayer::OnUIRender()
@@ -384,6 +467,37 @@ namespace editor {
 				}
 				ImGui::EndMenu();
 			}
+			if (ImGui::BeginMenu("Profile"))
+			{
+				engine::Instrumentor& instrumentor = engine::Instrumentor::GetInstance();
+				if (ImGui::MenuItem("Start CPU Capture", nullptr, false, !instrumentor.IsCapturing()))
+				{
+					instrumentor.BeginCapture();
+				}
+				// open the trace with chrome://tracing or ui.perfetto.dev
+				if (ImGui::MenuItem("Stop CPU Capture", nullptr, false, instrumentor.IsCapturing()))
+				{
+					instrumentor.EndCapture("MLE-Trace.json");
+				}
+				ImGui::Separator();
+				if (ImGui::MenuItem("Record Camera Path", nullptr, false, !path_recorder_.IsRecording() && !flythrough_.IsPlaying()))
+				{
+					path_recorder_.Start();
+				}
+				if (ImGui::MenuItem("Stop Recording", nullptr, false, path_recorder_.IsRecording()))
+				{
+					path_recorder_.Stop("MLE-CameraPath.txt");
+				}
+				// plays the recorded path if there is one, the report goes to MLE-Flythrough*
+				if (ImGui::MenuItem("Play Flythrough", nullptr, false, !path_recorder_.IsRecording() && !flythrough_.IsPlaying()))
+				{
+					FlythroughSettings settings{};
+					if (std::ifstream("MLE-CameraPath.txt").good())
+						settings.path_file = "MLE-CameraPath.txt";
+					flythrough_.Start(settings);
+				}
+				ImGui::EndMenu();
+			}
 
 			ImGui::EndMenuBar();
 		}
@@ -397,6 +511,9 @@ namespace editor {
 		
 		{
 			ImGui::Begin("Atmosphere Properties");
+			ImGui::Checkbox("Render Sky", &render_sky_);
+			ImGui::SameLine();
+			ImGui::TextDisabled("%s", is_sky_dirty_ ? "(rendered)" : "(cached)");
 			ImGui::DragFloat("Sea Level: ", &param_.sea_level);
 			ImGui::DragFloat3("Planet Center: ", glm::value_ptr(param_.planet_center));
 			ImGui::DragFloat("Planet Radius: ", &param_.planet_radius, 1000.0f, 0.0f);
@@ -427,5 +544,6 @@ namespace editor {
 		ImGui::PopStyleVar();
 
 		scene_panel_.OnUIRender();
+		profiler_panel_.OnUIRender();
 	}
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "MLE.h"
 #include "EditorCamera.h"
 #include "SceneHierachyPanel.h"
+#include "ProfilerPanel.h"
+#include "Flythrough.h"
 struct AtmosphereParameter
 {
 	glm::vec3 sun_light_direction{0.0, 1.0, 1.0};
@@ -37,10 +39,20 @@ namespace editor{
 		virtual void OnDetach() override;
 		virtual void OnUIRender() override;
 		virtual void OnUpdate(float delta_time) override;
+
+		// Plays a flythrough as soon as the layer is attached and closes the application once its report is written
+		void PlayFlythroughAndExit(const FlythroughSettings& settings);
  	private:
+		// Gathers the sky's inputs once per frame, the sky texture is only rendered again if they changed or its history was lost
+		void UpdateSkyInputs(bool is_history_lost);
+
 		rhi::TextureRef back_buffer_;
 
 		EditorCamera editor_camera_;
+		Flythrough flythrough_;
+		FlythroughSettings flythrough_settings_;
+		bool exit_after_flythrough_ = false;
+		CameraPathRecorder path_recorder_;
 		rhi::BufferRef camera_ubo_[renderer::FrameResourceMngr::MAX_FRAMES_IN_FLIGHT];
 
 		std::shared_ptr<engine::Scene> editor_scene_;
@@ -48,6 +60,7 @@ namespace editor{
 		engine::Entity light_entity_;
 
 		SceneHierachyPanel scene_panel_;
+		ProfilerPanel profiler_panel_;
 
 		// TEMP
 		std::unique_ptr<rhi::DescriptorAllocator> desc_allocator_;
@@ -58,6 +71,8 @@ namespace editor{
 
 		rhi::DescriptorSetPtr			texture_set_[renderer::FrameResourceMngr::MAX_FRAMES_IN_FLIGHT];
 		rhi::DescriptorSetLayoutRef		texture_set_layout_;
+		// what each texture set was written with, a write makes the recorded commands of the combine pass invalid
+		rhi::TextureRef					texture_set_source_[renderer::FrameResourceMngr::MAX_FRAMES_IN_FLIGHT];
 
 		// rhi::PipelineLayout* pipeline_layout_;
 		rhi::PipelineLayout* atmosphere_pipeline_layout_;
@@ -68,6 +83,15 @@ namespace editor{
 		glm::vec2 viewport_size_ = { 800.0f, 800.0f };
 
 		AtmosphereParameter param_;
+		CameraUbo sky_camera_data_{};
+		bool render_sky_ = true;
+		// the sky texture is a history resource, the last rendered sky is reused while nothing changes
+		renderer::ResourceHandle sky_texture_ = 0;
+		uint64_t sky_inputs_hash_ = 0;
+		bool is_sky_dirty_ = true;
+		bool dump_stats_key_down_ = false;
+		// the scene's change version that was last rendered, see Application::RequestRedraw
+		uint64_t rendered_scene_version_ = 0;
 		rhi::BufferRef param_ubo_[renderer::FrameResourceMngr::MAX_FRAMES_IN_FLIGHT];
 
 		uint8_t frame_index_;
@@ -0,0 +1,276 @@
+#include "mlepch.h"
+#include "Flythrough.h"
+#include "Runtime/Function/Renderer/Renderer.h"
+
+#include <glm/gtx/spline.hpp>
+#include <iomanip>
+
+namespace editor {
+	void CameraPath::AddKeyframe(const CameraKeyframe& keyframe, bool has_light)
+	{
+		assert((keyframes_.empty() || keyframe.time > keyframes_.back().time) && "keyframes must be added in time order");
+		keyframes_.push_back(keyframe);
+		has_light_ |= has_light;
+	}
+
+	void CameraPath::Clear()
+	{
+		keyframes_.clear();
+		has_light_ = false;
+	}
+
+	CameraKeyframe CameraPath::Evaluate(float time) const
+	{
+		assert(!keyframes_.empty() && "camera path has no keyframes");
+		if (time <= keyframes_.front().time)
+			return keyframes_.front();
+		if (time >= keyframes_.back().time)
+			return keyframes_.back();
+
+		// first keyframe after time
+		const size_t next = std::upper_bound(keyframes_.begin(), keyframes_.end(), time,
+			[](float t, const CameraKeyframe& keyframe) { return t < keyframe.time; }) - keyframes_.begin();
+		const CameraKeyframe& k0 = keyframes_[next >= 2 ? next - 2 : 0];
+		const CameraKeyframe& k1 = keyframes_[next - 1];
+		const CameraKeyframe& k2 = keyframes_[next];
+		const CameraKeyframe& k3 = keyframes_[std::min(next + 1, keyframes_.size() - 1)];
+		const float s = (time - k1.time) / (k2.time - k1.time);
+
+		CameraKeyframe result{};
+		result.time = time;
+		result.position = glm::catmullRom(k0.position, k1.position, k2.position, k3.position, s);
+		result.direction = glm::normalize(glm::catmullRom(k0.direction, k1.direction, k2.direction, k3.direction, s));
+		result.light_rotation = glm::catmullRom(k0.light_rotation, k1.light_rotation, k2.light_rotation, k3.light_rotation, s);
+		return result;
+	}
+
+	bool CameraPath::Load(const std::string& file_path)
+	{
+		std::ifstream in(file_path);
+		if (!in.is_open())
+		{
+			MLE_ERROR("[Flythrough] failed to open camera path {0}", file_path);
+			return false;
+		}
+
+		Clear();
+		std::string line;
+		while (std::getline(in, line))
+		{
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			std::istringstream values(line);
+			CameraKeyframe keyframe{};
+			values >> keyframe.time
+				>> keyframe.position.x >> keyframe.position.y >> keyframe.position.z
+				>> keyframe.direction.x >> keyframe.direction.y >> keyframe.direction.z;
+			if (values.fail())
+			{
+				MLE_ERROR("[Flythrough] malformed keyframe in {0}: {1}", file_path, line);
+				Clear();
+				return false;
+			}
+			values >> keyframe.light_rotation.x >> keyframe.light_rotation.y >> keyframe.light_rotation.z;
+			const bool has_light = !values.fail();
+			if (!keyframes_.empty() && keyframe.time <= keyframes_.back().time)
+			{
+				MLE_ERROR("[Flythrough] keyframes in {0} are not in time order", file_path);
+				Clear();
+				return false;
+			}
+			AddKeyframe(keyframe, has_light);
+		}
+		return !keyframes_.empty();
+	}
+
+	bool CameraPath::Save(const std::string& file_path) const
+	{
+		std::ofstream out(file_path);
+		if (!out.is_open())
+		{
+			MLE_ERROR("[Flythrough] failed to open {0}", file_path);
+			return false;
+		}
+
+		out << std::fixed << std::setprecision(5);
+		out << "# time px py pz dx dy dz" << (has_light_ ? " lx ly lz" : "") << "\n";
+		for (const CameraKeyframe& keyframe : keyframes_)
+		{
+			out << keyframe.time << ' '
+				<< keyframe.position.x << ' ' << keyframe.position.y << ' ' << keyframe.position.z << ' '
+				<< keyframe.direction.x << ' ' << keyframe.direction.y << ' ' << keyframe.direction.z;
+			if (has_light_)
+				out << ' ' << keyframe.light_rotation.x << ' ' << keyframe.light_rotation.y << ' ' << keyframe.light_rotation.z;
+			out << '\n';
+		}
+		MLE_INFO("[Flythrough] wrote {0} keyframes to {1}", keyframes_.size(), file_path);
+		return true;
+	}
+
+	CameraPath CameraPath::CreateOrbit(float radius, float height, float duration)
+	{
+		static constexpr uint32_t KEYFRAME_COUNT = 17;
+		CameraPath path;
+		for (uint32_t i = 0; i < KEYFRAME_COUNT; ++i)
+		{
+			const float t = static_cast<float>(i) / (KEYFRAME_COUNT - 1);
+			const float angle = t * glm::two_pi<float>();
+
+			CameraKeyframe keyframe{};
+			keyframe.time = t * duration;
+			keyframe.position = glm::vec3(std::sin(angle) * radius, height, std::cos(angle) * radius);
+			// look at the origin
+			keyframe.direction = glm::normalize(-keyframe.position);
+			keyframe.light_rotation = glm::vec3(t * glm::pi<float>(), 0.0f, 0.0f);
+			path.AddKeyframe(keyframe, true);
+		}
+		return path;
+	}
+
+	// ------------------------------------------------------------------------------
+
+	void Flythrough::Start(const FlythroughSettings& settings)
+	{
+		settings_ = settings;
+		path_name_ = settings_.path_file.empty() ? "orbit" : settings_.path_file;
+		if (settings_.path_file.empty() || !path_.Load(settings_.path_file))
+		{
+			if (!settings_.path_file.empty())
+				MLE_WARN("[Flythrough] playing the built in orbit instead");
+			path_ = CameraPath::CreateOrbit(6.0f, 1.0f, 20.0f);
+			path_name_ = "orbit";
+		}
+		// it ends up in json
+		std::replace(path_name_.begin(), path_name_.end(), '\\', '/');
+
+		frame_ = 0;
+		gpu_scope_totals_.clear();
+		gpu_frame_count_ = 0;
+		is_playing_ = true;
+		MLE_INFO("[Flythrough] playing {0} for {1} frames after {2} warmup frames", path_name_, settings_.frame_count, settings_.warmup_frames);
+	}
+
+	bool Flythrough::Update(EditorCamera& camera, engine::Entity light)
+	{
+		if (!is_playing_)
+			return false;
+
+		if (frame_ == settings_.warmup_frames + settings_.frame_count)
+		{
+			WriteReport();
+			is_playing_ = false;
+			return false;
+		}
+
+		if (frame_ == settings_.warmup_frames)
+		{
+			engine::Application::GetApp().GetFrameStats().Clear();
+		}
+		else if (frame_ > settings_.warmup_frames)
+		{
+			// the profiler lags a few frames, what it has resolved now is a measured frame too
+			const auto& timings = renderer::Renderer::GetInstance().GetGPUProfiler().GetTimings();
+			if (!timings.empty())
+			{
+				for (const renderer::GPUScopeTiming& timing : timings)
+				{
+					auto it = std::find_if(gpu_scope_totals_.begin(), gpu_scope_totals_.end(), [&timing](const auto& total) {
+						return total.first == timing.name; });
+					if (it == gpu_scope_totals_.end())
+						it = gpu_scope_totals_.insert(gpu_scope_totals_.end(), { timing.name, 0.0 });
+					it->second += timing.last;
+				}
+				gpu_frame_count_++;
+			}
+		}
+
+		const float duration = path_.GetDuration();
+		const float time = duration > 0.0f ? std::fmod(frame_ * settings_.time_step, duration) : 0.0f;
+		const CameraKeyframe keyframe = path_.Evaluate(time);
+		camera.SetView(keyframe.position, keyframe.direction);
+		if (settings_.animate_light && path_.HasLight() && light)
+			light.GetComponent<engine::TransformComponent>().rotation = keyframe.light_rotation;
+
+		frame_++;
+		return true;
+	}
+
+	void Flythrough::WriteReport() const
+	{
+		engine::FrameStats& frame_stats = engine::Application::GetApp().GetFrameStats();
+		frame_stats.WriteCSV(settings_.report_file + ".csv");
+		frame_stats.WriteJSON(settings_.report_file + ".json");
+
+		const std::string summary_file = settings_.report_file + "-Summary.json";
+		std::ofstream out(summary_file);
+		if (!out.is_open())
+		{
+			MLE_ERROR("[Flythrough] failed to open {0}", summary_file);
+			return;
+		}
+
+		static constexpr const char* METRIC_KEYS[] = { "cpu_ms", "gpu_ms", "present_interval_ms" };
+
+		out << std::fixed << std::setprecision(3);
+		out << "{\n\t\"path\": \"" << path_name_ << "\",\n\t\"frames\": " << settings_.frame_count
+			<< ",\n\t\"warmup_frames\": " << settings_.warmup_frames << ",\n\t\"time_step_ms\": " << settings_.time_step * 1000.0f
+			<< ",\n\t\"hitch_factor\": " << frame_stats.GetHitchFactor();
+		for (uint8_t metric = 0; metric < static_cast<uint8_t>(engine::FrameMetric::COUNT); ++metric)
+		{
+			const engine::FrameMetricStats stats = frame_stats.Compute(static_cast<engine::FrameMetric>(metric), settings_.frame_count);
+			out << ",\n\t\"" << METRIC_KEYS[metric] << "\": { \"samples\": " << stats.sample_count
+				<< ", \"avg\": " << stats.average << ", \"p50\": " << stats.p50 << ", \"p90\": " << stats.p90
+				<< ", \"p99\": " << stats.p99 << ", \"max\": " << stats.max << ", \"hitches\": " << stats.hitch_count << " }";
+
+			MLE_INFO("[Flythrough] {0}: avg {1:.3f} ms, p99 {2:.3f} ms, {3} hitches", ToString(static_cast<engine::FrameMetric>(metric)),
+				stats.average, stats.p99, stats.hitch_count);
+		}
+		out << ",\n\t\"gpu_scopes\": [";
+		for (size_t i = 0; i < gpu_scope_totals_.size(); ++i)
+		{
+			out << (i ? "," : "") << "\n\t\t{ \"name\": \"" << gpu_scope_totals_[i].first << "\", \"avg_ms\": "
+				<< gpu_scope_totals_[i].second / std::max(gpu_frame_count_, 1u) << " }";
+		}
+		out << "\n\t]\n}\n";
+
+		MLE_INFO("[Flythrough] wrote the report to {0}", summary_file);
+	}
+
+	// ------------------------------------------------------------------------------
+
+	void CameraPathRecorder::Start()
+	{
+		path_.Clear();
+		time_ = 0.0f;
+		next_sample_ = 0.0f;
+		is_recording_ = true;
+	}
+
+	void CameraPathRecorder::Update(float delta_time, const EditorCamera& camera, engine::Entity light)
+	{
+		if (!is_recording_)
+			return;
+
+		if (time_ >= next_sample_)
+		{
+			CameraKeyframe keyframe{};
+			keyframe.time = time_;
+			keyframe.position = camera.GetPosition();
+			keyframe.direction = camera.GetDirection();
+			if (light)
+				keyframe.light_rotation = light.GetComponent<engine::TransformComponent>().rotation;
+			path_.AddKeyframe(keyframe, static_cast<bool>(light));
+			next_sample_ = time_ + SAMPLE_INTERVAL;
+		}
+		time_ += delta_time;
+	}
+
+	bool CameraPathRecorder::Stop(const std::string& file_path)
+	{
+		is_recording_ = false;
+		if (path_.IsEmpty())
+			return false;
+		return path_.Save(file_path);
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "MLE.h"
+#include "EditorCamera.h"
+
+namespace editor {
+	struct CameraKeyframe
+	{
+		// seconds from the start of the path
+		float time = 0.0f;
+		glm::vec3 position{ 0.0f, 0.0f, 6.0f };
+		glm::vec3 direction{ 0.0f, 0.0f, -1.0f };
+		// euler angles of the light, only applied if the path has light keyframes
+		glm::vec3 light_rotation{ 0.0f };
+	};
+
+	/// <summary>
+	/// Keyframes interpolated with a Catmull-Rom spline. Saved as text, one keyframe per line:
+	/// time px py pz dx dy dz [lx ly lz]
+	/// </summary>
+	class CameraPath
+	{
+	public:
+		void AddKeyframe(const CameraKeyframe& keyframe, bool has_light);
+		void Clear();
+
+		// Clamped to the ends of the path
+		CameraKeyframe Evaluate(float time) const;
+
+		inline bool IsEmpty() const { return keyframes_.empty(); };
+		inline bool HasLight() const { return has_light_; };
+		inline float GetDuration() const { return keyframes_.empty() ? 0.0f : keyframes_.back().time; };
+
+		bool Load(const std::string& file_path);
+		bool Save(const std::string& file_path) const;
+
+		// A circle around the origin with the sun going from sunrise to sunset
+		static CameraPath CreateOrbit(float radius, float height, float duration);
+	private:
+		std::vector<CameraKeyframe> keyframes_;
+		bool has_light_ = false;
+	};
+
+	struct FlythroughSettings
+	{
+		// the built in orbit is played if empty
+		std::string path_file;
+		// measured frames, the warmup frames come on top
+		uint32_t frame_count = 1000;
+		// pipelines, transient resources and the GPU clocks settle in these, they aren't measured
+		uint32_t warmup_frames = 60;
+		float time_step = 1.0f / 60.0f;
+		bool animate_light = true;
+		// <report_file>-Summary.json, .csv and .json are written at the end
+		std::string report_file = "MLE-Flythrough";
+	};
+
+	/// <summary>
+	/// Plays a camera path over a fixed number of frames with a fixed timestep, so two runs render the same frames.
+	/// Per frame CPU and GPU timings come from the application's FrameStats, which are cleared when the measured frames start.
+	/// </summary>
+	class Flythrough
+	{
+	public:
+		void Start(const FlythroughSettings& settings);
+		inline bool IsPlaying() const { return is_playing_; };
+
+		// Moves the camera and the light to the current frame, returns false once the run is over and the report has been written
+		bool Update(EditorCamera& camera, engine::Entity light);
+	private:
+		void WriteReport() const;
+
+		FlythroughSettings settings_;
+		CameraPath path_;
+		std::string path_name_;
+		uint32_t frame_ = 0;
+		bool is_playing_ = false;
+
+		// GPU time of each scope summed over the measured frames, in recording order
+		std::vector<std::pair<std::string, double>> gpu_scope_totals_;
+		uint32_t gpu_frame_count_ = 0;
+	};
+
+	/// <summary>
+	/// Samples the live camera at a fixed interval, the result can be played back by a Flythrough.
+	/// </summary>
+	class CameraPathRecorder
+	{
+	public:
+		static constexpr float SAMPLE_INTERVAL = 0.25f;
+
+		void Start();
+		void Update(float delta_time, const EditorCamera& camera, engine::Entity light);
+		// Writes what has been recorded
+		bool Stop(const std::string& file_path);
+		inline bool IsRecording() const { return is_recording_; };
+	private:
+		CameraPath path_;
+		float time_ = 0.0f;
+		float next_sample_ = 0.0f;
+		bool is_recording_ = false;
+	};
+}
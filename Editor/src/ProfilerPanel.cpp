@@ -0,0 +1,273 @@
+#include "mlepch.h"
+#include "ProfilerPanel.h"
+#include "Runtime/Function/Renderer/Renderer.h"
+#include "Runtime/Function/RHI/RHIStats.h"
+
+#include <imgui.h>
+
+namespace editor {
+	void ProfilerPanel::OnUIRender()
+	{
+		DrawGPUTimings();
+		DrawRHICounters();
+		DrawFrameStats();
+		DrawGPUMemory();
+	}
+
+	void ProfilerPanel::DrawGPUTimings()
+	{
+		renderer::GPUProfiler& profiler = renderer::Renderer::GetInstance().GetGPUProfiler();
+
+		ImGui::Begin("GPU Profiler");
+		if (!profiler.IsSupported())
+		{
+			ImGui::Text("Timestamps are not supported by the graphics queue");
+			ImGui::End();
+			return;
+		}
+
+		bool enabled = profiler.IsEnabled();
+		if (ImGui::Checkbox("Enabled", &enabled))
+			profiler.SetEnabled(enabled);
+
+		const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp;
+		if (ImGui::BeginTable("GPU Timings", 5, flags))
+		{
+			ImGui::TableSetupColumn("Scope");
+			ImGui::TableSetupColumn("Last(ms)");
+			ImGui::TableSetupColumn("Avg(ms)");
+			ImGui::TableSetupColumn("Min(ms)");
+			ImGui::TableSetupColumn("Max(ms)");
+			ImGui::TableHeadersRow();
+
+			for (auto const& timing : profiler.GetTimings())
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(timing.name);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", timing.last);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", timing.average);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", timing.min);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", timing.max);
+			}
+			ImGui::EndTable();
+		}
+
+		ImGui::End();
+	}
+
+	void ProfilerPanel::DrawRHICounters()
+	{
+		rhi::RHIStats& stats = rhi::RHIStats::GetInstance();
+		const auto& passes = stats.GetLastFramePasses();
+		const rhi::RHICounters& frame = stats.GetLastFrame();
+
+		ImGui::Begin("RHI Counters");
+		renderer::RenderGraph& render_graph = renderer::Renderer::GetInstance().GetRenderGraph();
+		int segment_pass_count = static_cast<int>(render_graph.GetSegmentPassCount());
+		if (ImGui::SliderInt("Submit every N passes(0: once)", &segment_pass_count, 0, 8))
+			render_graph.SetSegmentPassCount(static_cast<uint32_t>(segment_pass_count));
+		// one column for the frame, one per executed pass
+		const int column_count = static_cast<int>(passes.size()) + 2;
+		const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollX;
+		if (ImGui::BeginTable("RHI Counters", column_count, flags))
+		{
+			ImGui::TableSetupColumn("Counter");
+			ImGui::TableSetupColumn("Frame");
+			for (auto const& pass : passes)
+			{
+				ImGui::TableSetupColumn(pass.name);
+			}
+			ImGui::TableHeadersRow();
+
+			for (uint8_t i = 0; i < static_cast<uint8_t>(rhi::RHICounter::COUNT); ++i)
+			{
+				const rhi::RHICounter counter = static_cast<rhi::RHICounter>(i);
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(rhi::ToString(counter));
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", static_cast<unsigned long long>(frame[counter]));
+				for (auto const& pass : passes)
+				{
+					ImGui::TableNextColumn();
+					ImGui::Text("%llu", static_cast<unsigned long long>(pass.counters[counter]));
+				}
+			}
+			ImGui::EndTable();
+		}
+		ImGui::End();
+	}
+
+	void ProfilerPanel::DrawFrameStats()
+	{
+		engine::FrameStats& frame_stats = engine::Application::GetApp().GetFrameStats();
+
+		ImGui::Begin("Frame Stats");
+		ImGui::SliderInt("Window(frames)", &stats_window_, 60, static_cast<int>(engine::FrameStats::HISTORY_LENGTH));
+		float hitch_factor = frame_stats.GetHitchFactor();
+		if (ImGui::DragFloat("Hitch Factor(x p50)", &hitch_factor, 0.05f, 1.0f, 10.0f))
+			frame_stats.SetHitchFactor(hitch_factor);
+		DrawLatencySettings();
+
+		const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp;
+		if (ImGui::BeginTable("Frame Stats", 7, flags))
+		{
+			ImGui::TableSetupColumn("Metric(ms)");
+			ImGui::TableSetupColumn("Avg");
+			ImGui::TableSetupColumn("p50");
+			ImGui::TableSetupColumn("p90");
+			ImGui::TableSetupColumn("p99");
+			ImGui::TableSetupColumn("Max");
+			ImGui::TableSetupColumn("Hitches");
+			ImGui::TableHeadersRow();
+
+			for (uint8_t i = 0; i < static_cast<uint8_t>(engine::FrameMetric::COUNT); ++i)
+			{
+				const engine::FrameMetric metric = static_cast<engine::FrameMetric>(i);
+				const engine::FrameMetricStats stats = frame_stats.Compute(metric, static_cast<uint32_t>(stats_window_));
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(engine::ToString(metric));
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", stats.average);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", stats.p50);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", stats.p90);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", stats.p99);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", stats.max);
+				ImGui::TableNextColumn();
+				ImGui::Text("%u", stats.hitch_count);
+			}
+			ImGui::EndTable();
+		}
+
+		// CPU frame times of the window, oldest first
+		const uint32_t sample_count = frame_stats.GetSampleCount();
+		const int plot_count = std::min(stats_window_, static_cast<int>(sample_count));
+		if (plot_count > 0)
+		{
+			const uint32_t offset = sample_count - plot_count;
+			struct PlotData { engine::FrameStats* stats; uint32_t offset; } plot_data{ &frame_stats, offset };
+			ImGui::PlotLines("CPU Time", [](void* data, int index) {
+				auto* plot = static_cast<PlotData*>(data);
+				return std::max(plot->stats->GetSample(plot->offset + index).cpu_time, 0.0f);
+				}, &plot_data, plot_count, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 80));
+		}
+
+		if (ImGui::Button("Export CSV"))
+			frame_stats.WriteCSV("MLE-FrameStats.csv");
+		ImGui::SameLine();
+		if (ImGui::Button("Export JSON"))
+			frame_stats.WriteJSON("MLE-FrameStats.json");
+		ImGui::SameLine();
+		ImGui::TextDisabled("(F9 exports both)");
+
+		ImGui::End();
+	}
+
+	void ProfilerPanel::DrawLatencySettings()
+	{
+		engine::Application& app = engine::Application::GetApp();
+		renderer::Renderer& renderer = renderer::Renderer::GetInstance();
+		rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+
+		int frames_in_flight = renderer.GetFramesInFlight();
+		if (ImGui::SliderInt("Frames In Flight", &frames_in_flight, 1, renderer::FrameResourceMngr::MAX_FRAMES_IN_FLIGHT))
+			renderer.SetFramesInFlight(static_cast<uint8_t>(frames_in_flight));
+
+		constexpr rhi::PresentMode PRESENT_MODES[] = { rhi::PresentMode::FIFO, rhi::PresentMode::MAILBOX, rhi::PresentMode::IMMEDIATE };
+		if (ImGui::BeginCombo("Present Mode", rhi::ToString(rhi.GetPresentMode())))
+		{
+			for (rhi::PresentMode mode : PRESENT_MODES)
+			{
+				if (ImGui::Selectable(rhi::ToString(mode), mode == rhi.GetPresentMode()))
+					rhi.SetPresentMode(mode);
+			}
+			ImGui::EndCombo();
+		}
+
+		float max_frame_rate = app.GetMaxFrameRate();
+		if (ImGui::DragFloat("Max FPS(0: off)", &max_frame_rate, 1.0f, 0.0f, 1000.0f))
+			app.SetMaxFrameRate(max_frame_rate);
+		bool low_latency = app.IsLowLatency();
+		if (ImGui::Checkbox("Low Latency", &low_latency))
+			app.SetLowLatency(low_latency);
+
+		bool render_on_demand = app.IsRenderOnDemand();
+		if (ImGui::Checkbox("On-Demand Rendering", &render_on_demand))
+			app.SetRenderOnDemand(render_on_demand);
+		if (render_on_demand)
+		{
+			float max_idle_interval = app.GetMaxIdleInterval();
+			if (ImGui::DragFloat("Max Idle Interval(s, 0: none)", &max_idle_interval, 0.05f, 0.0f, 10.0f))
+				app.SetMaxIdleInterval(max_idle_interval);
+		}
+	}
+
+	void ProfilerPanel::DrawGPUMemory()
+	{
+		rhi::RHIStats& stats = rhi::RHIStats::GetInstance();
+		constexpr float MIB = 1024.0f * 1024.0f;
+
+		ImGui::Begin("GPU Memory");
+		if (stats.IsNearBudget())
+			ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Close to the memory budget, dead resources are freed every frame");
+
+		const rhi::RHIDefragmentationStats& defragmentation = stats.GetDefragmentation();
+		if (defragmentation.is_running)
+			ImGui::TextUnformatted("Defragmenting...");
+		else if (ImGui::Button("Defragment"))
+			rhi::RHI::GetRHIInstance().RHIDefragment();
+		ImGui::SameLine();
+		ImGui::Text("last run: %u allocations moved, %.1f MiB reclaimed",
+			defragmentation.allocations_moved, defragmentation.bytes_freed / MIB);
+
+		const auto& heaps = stats.GetHeapBudgets();
+		for (size_t heap_index = 0; heap_index < heaps.size(); ++heap_index)
+		{
+			const rhi::RHIHeapBudget& heap = heaps[heap_index];
+			const float usage = static_cast<float>(heap.usage) / MIB;
+			const float budget = static_cast<float>(heap.budget) / MIB;
+			char overlay[64];
+			snprintf(overlay, sizeof(overlay), "%.1f / %.1f MiB", usage, budget);
+
+			ImGui::Text("Heap %zu (%s)", heap_index, heap.device_local ? "device local" : "host");
+			ImGui::ProgressBar(budget > 0.0f ? usage / budget : 0.0f, ImVec2(-1.0f, 0.0f), overlay);
+			ImGui::Text("%u allocations, %.1f MiB in %.1f MiB of blocks",
+				heap.allocation_count, heap.allocation_bytes / MIB, heap.block_bytes / MIB);
+		}
+
+		const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp;
+		if (ImGui::BeginTable("Memory Categories", 3, flags))
+		{
+			ImGui::TableSetupColumn("Category");
+			ImGui::TableSetupColumn("Allocations");
+			ImGui::TableSetupColumn("MiB");
+			ImGui::TableHeadersRow();
+
+			for (size_t i = 0; i < static_cast<size_t>(MemoryCategory::COUNT); ++i)
+			{
+				const MemoryCategory category = static_cast<MemoryCategory>(i);
+				const rhi::RHIMemoryCategoryStats category_stats = stats.GetMemoryCategory(category);
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(rhi::ToString(category));
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", static_cast<unsigned long long>(category_stats.allocation_count));
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", category_stats.bytes / MIB);
+			}
+			ImGui::EndTable();
+		}
+
+		ImGui::End();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+#include "MLE.h"
+
+namespace editor{
+    class ProfilerPanel
+    {
+    public:
+        ProfilerPanel() = default;
+
+        void OnUIRender();
+    private:
+        void DrawGPUTimings();
+        void DrawRHICounters();
+        void DrawFrameStats();
+        // frames in flight, present mode and frame limiter, drawn into the Frame Stats window
+        void DrawLatencySettings();
+        void DrawGPUMemory();
+
+        int stats_window_ = 600;
+    };
+}
@@ -5,10 +5,12 @@
 #include <imgui_internal.h>
 
 namespace editor {
+	// Returns whether the component was edited or removed
 	template<typename T, typename UIFunction>
-	static void DrawComponent(const std::string& name, engine::Entity entity, UIFunction uiFunction)
+	static bool DrawComponent(const std::string& name, engine::Entity entity, UIFunction uiFunction)
 	{
 		const ImGuiTreeNodeFlags treeNodeFlags = ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_Framed | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_AllowItemOverlap | ImGuiTreeNodeFlags_FramePadding;
+		bool changed = false;
 		if (entity.HasComponent<T>())
 		{
 			auto& component = entity.GetComponent<T>();
@@ -37,17 +39,23 @@ namespace editor {
 
 			if (open)
 			{
-				uiFunction(component);
+				changed = uiFunction(component);
 				ImGui::TreePop();
 			}
 
 			if (removeComponent)
+			{
 				entity.RemoveComponent<T>();
+				changed = true;
+			}
 		}
+		return changed;
 	}
 
-	static void DrawVec3Control(const std::string& label, glm::vec3 & values, float resetValue = 0.0f, float columnWidth = 100.0f)
+	// Returns whether any of the values changed
+	static bool DrawVec3Control(const std::string& label, glm::vec3 & values, float resetValue = 0.0f, float columnWidth = 100.0f)
 	{
+		bool changed = false;
 		ImGuiIO& io = ImGui::GetIO();
 		auto boldFont = io.Fonts->Fonts[0];
 
@@ -69,12 +77,15 @@ namespace editor {
 		ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{ 0.8f, 0.1f, 0.15f, 1.0f });
 		ImGui::PushFont(boldFont);
 		if (ImGui::Button("X", buttonSize))
+		{
 			values.x = resetValue;
+			changed = true;
+		}
 		ImGui::PopFont();
 		ImGui::PopStyleColor(3);
 
 		ImGui::SameLine();
-		ImGui::DragFloat("##X", &values.x, 0.1f, 0.0f, 0.0f, "%.2f");
+		changed |= ImGui::DragFloat("##X", &values.x, 0.1f, 0.0f, 0.0f, "%.2f");
 		ImGui::PopItemWidth();
 		ImGui::SameLine();
 
@@ -83,12 +94,15 @@ namespace editor {
 		ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{ 0.2f, 0.7f, 0.2f, 1.0f });
 		ImGui::PushFont(boldFont);
 		if (ImGui::Button("Y", buttonSize))
+		{
 			values.y = resetValue;
+			changed = true;
+		}
 		ImGui::PopFont();
 		ImGui::PopStyleColor(3);
 
 		ImGui::SameLine();
-		ImGui::DragFloat("##Y", &values.y, 0.1f, 0.0f, 0.0f, "%.2f");
+		changed |= ImGui::DragFloat("##Y", &values.y, 0.1f, 0.0f, 0.0f, "%.2f");
 		ImGui::PopItemWidth();
 		ImGui::SameLine();
 
@@ -97,12 +111,15 @@ namespace editor {
 		ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{ 0.1f, 0.25f, 0.8f, 1.0f });
 		ImGui::PushFont(boldFont);
 		if (ImGui::Button("Z", buttonSize))
+		{
 			values.z = resetValue;
+			changed = true;
+		}
 		ImGui::PopFont();
 		ImGui::PopStyleColor(3);
 
 		ImGui::SameLine();
-		ImGui::DragFloat("##Z", &values.z, 0.1f, 0.0f, 0.0f, "%.2f");
+		changed |= ImGui::DragFloat("##Z", &values.z, 0.1f, 0.0f, 0.0f, "%.2f");
 		ImGui::PopItemWidth();
 
 		ImGui::PopStyleVar();
@@ -110,6 +127,7 @@ namespace editor {
 		ImGui::Columns(1);
 
 		ImGui::PopID();
+		return changed;
 	}
 
 	// -------------------------------------
@@ -191,6 +209,7 @@ namespace editor {
 
 		if (selected_entity_)
 		{
+			bool changed = false;
 			if (selected_entity_.HasComponent<engine::TagComponent>())
 			{
 				auto& tag = selected_entity_.GetComponent<engine::TagComponent>().tag;
@@ -201,27 +220,36 @@ namespace editor {
 				if (ImGui::InputText("##Tag", buffer, sizeof(buffer)))
 				{
 					tag = std::string(buffer);
+					changed = true;
 				}
 			}
 
-			DrawComponent<engine::TransformComponent>("Transform", selected_entity_, [](auto& component)
+			changed |= DrawComponent<engine::TransformComponent>("Transform", selected_entity_, [](auto& component)
 				{
-					DrawVec3Control("Translation", component.translation);
+					bool changed = DrawVec3Control("Translation", component.translation);
 					glm::vec3 rotation = glm::degrees(component.rotation);
-					DrawVec3Control("Rotation", rotation);
-					component.rotation = glm::radians(rotation);
-					DrawVec3Control("Scale", component.scale, 1.0f);
+					if (DrawVec3Control("Rotation", rotation))
+					{
+						component.rotation = glm::radians(rotation);
+						changed = true;
+					}
+					changed |= DrawVec3Control("Scale", component.scale, 1.0f);
+					return changed;
 				});
 			
-			DrawComponent<engine::LightComponent>("Light", selected_entity_, [](auto& component)
+			changed |= DrawComponent<engine::LightComponent>("Light", selected_entity_, [](auto& component)
 				{
 					ImGui::PushID("Light");
 					ImGui::Text("Light Intensity: ");
 					ImGui::SameLine();
-					ImGui::DragFloat("##X", &component.light_intensity, 0.1f, 0.0f, 100.0f);
-					DrawVec3Control("Light Color", component.light_color);
+					bool changed = ImGui::DragFloat("##X", &component.light_intensity, 0.1f, 0.0f, 100.0f);
+					changed |= DrawVec3Control("Light Color", component.light_color);
 					ImGui::PopID();
+					return changed;
 				});
+
+			if (changed)
+				current_scene_->MarkChanged();
 		}
 
 		ImGui::End();
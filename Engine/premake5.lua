@@ -55,12 +55,12 @@ project "Runtime"
       defines { "MLE_PLATFORM_WINDOWS" }
 
    filter "configurations:Debug"
-      defines { "MLE_DEBUG" }
+      defines { "MLE_DEBUG", "MLE_PROFILE" }
       runtime "Debug"
       symbols "on"
 
    filter "configurations:Release"
-      defines { "MLE_RELEASE" }
+      defines { "MLE_RELEASE", "MLE_PROFILE" }
       runtime "Release"
       optimize "On"
       symbols "On"
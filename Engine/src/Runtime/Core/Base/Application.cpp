@@ -3,6 +3,8 @@
 #include "Application.h"
 #include "Runtime/Function/RHI/RHI.h"
 
+#include <thread>
+
 // **************************************
 // Adapted from Dear ImGui Vulkan example
 // **************************************
@@ -36,8 +38,11 @@ namespace engine {
 	{
 		//some assert(!app_instance_...) right here
 		app_instance_ = this;
-		app_window_ = std::make_unique<Window>(WindowProps(app_specification_.name, app_specification_.width, app_specification_.height));
-		app_window_->SetEventCallback(std::bind(&Application::OnEvent, this, std::placeholders::_1));
+		if (!app_specification_.headless)
+		{
+			app_window_ = std::make_unique<Window>(WindowProps(app_specification_.name, app_specification_.width, app_specification_.height));
+			app_window_->SetEventCallback(std::bind(&Application::OnEvent, this, std::placeholders::_1));
+		}
 		Init();
 	}
 
@@ -48,6 +53,8 @@ namespace engine {
 
 	void Application::Init()
 	{
+		renderer_.SetFramesInFlight(app_specification_.frames_in_flight);
+		rhi::RHI::GetRHIInstance().SetPresentMode(app_specification_.present_mode);
 		renderer_.Init();
 		for (auto layer : layer_stack_)
 			layer->OnAttach();
@@ -59,6 +66,8 @@ namespace engine {
 #ifdef MLE_DEBUG
 		MLE_CORE_INFO("Dispatching");
 #endif // MLE_DEBUG
+		if (event.GetEventType() == EventType::WindowResize)
+			OnWindowResize(static_cast<WindowResizeEvent&>(event));
 		/*EventBus& bus = EventBus::GetInstance();
 		bus.Post(event);*/
 	}
@@ -70,6 +79,12 @@ namespace engine {
 
 		rhi::RHI::GetRHIInstance().RHIBlockUntilGPUIdle();
 
+		if (!app_specification_.frame_stats_file.empty())
+		{
+			frame_stats_.WriteCSV(app_specification_.frame_stats_file + ".csv");
+			frame_stats_.WriteJSON(app_specification_.frame_stats_file + ".json");
+		}
+
 		for (auto& layer : layer_stack_)
 			layer->OnDetach();
 
@@ -84,43 +99,156 @@ namespace engine {
 	void Application::Run()
 	{
 		is_running_ = true;
-		Application& app = Application::GetApp();
-		GLFWwindow* glfw_window_handle = static_cast<GLFWwindow*>(app.GetWindow().GetNativeWindow());
+		GLFWwindow* glfw_window_handle = app_window_ ? static_cast<GLFWwindow*>(app_window_->GetNativeWindow()) : nullptr;
+		uint32_t frame_index = 0;
 
 		ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 		/*ImGuiIO& io = ImGui::GetIO();*/
+		MLE_PROFILE_THREAD("Main Thread");
 	
 		// Main loop
-		while (!glfwWindowShouldClose(glfw_window_handle) && is_running_)
+		while (is_running_)
 		{
+			if (glfw_window_handle && glfwWindowShouldClose(glfw_window_handle))
+				break;
+			// nothing is rendered while minimized, the loop sleeps until the window comes back
+			if (app_window_ && is_minimized_)
+			{
+				MLE_PROFILE_SCOPE("Window::WaitEvents");
+				app_window_->WaitEvents(app_specification_.max_idle_interval);
+				// the gap would count as one huge present interval, and one huge time step
+				last_present_time_point_ = {};
+				last_tick_time_point_ = std::chrono::steady_clock::now();
+				RequestRedraw();
+				continue;
+			}
+			if (app_window_ && app_specification_.render_on_demand && !WaitForRedraw())
+			{
+				last_present_time_point_ = {};
+				last_tick_time_point_ = std::chrono::steady_clock::now();
+				continue;
+			}
+			if (app_specification_.frame_count > 0 && frame_index++ >= app_specification_.frame_count)
+				break;
+
+			MLE_PROFILE_FRAME("Frame");
+			MLE_PROFILE_SCOPE("Application::Run");
+			// the input is sampled as late as possible, right before the frame is recorded
+			if (app_specification_.low_latency)
+			{
+				LimitFrameRate();
+				if (!is_minimized_)
+					renderer_.WaitForNextFrame();
+			}
 			float delta_time;
+			const std::chrono::steady_clock::time_point frame_start = std::chrono::steady_clock::now();
 			{
 				using namespace std::chrono;
 
-				steady_clock::time_point tick_time_point = steady_clock::now();
+				steady_clock::time_point tick_time_point = frame_start;
 				duration<float> time_span = duration_cast<duration<float>>(tick_time_point - last_tick_time_point_);
-				delta_time = time_span.count();
+				delta_time = app_specification_.fixed_time_step > 0.0f ? app_specification_.fixed_time_step : time_span.count();
 
 				last_tick_time_point_ = tick_time_point;
 			}
-			app_window_.get()->OnUpdate();
+			if (app_window_)
+			{
+				MLE_PROFILE_SCOPE("Window::OnUpdate");
+				app_window_->OnUpdate();
+			}
 
 			if(!is_minimized_)
 			{
-				for (auto& layer : layer_stack_)
-					layer->OnUpdate(delta_time);
+				{
+					MLE_PROFILE_SCOPE("Layer::OnUpdate");
+					for (auto& layer : layer_stack_)
+						layer->OnUpdate(delta_time);
+				}
 
 				renderer_.Begin();
-				for (auto& layer : layer_stack_)
-					layer->OnUIRender();
+				{
+					MLE_PROFILE_SCOPE("Layer::OnUIRender");
+					for (auto& layer : layer_stack_)
+						layer->OnUIRender();
+				}
+
+				// a widget being dragged or typed into keeps changing without new input events
+				if (ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput)
+					RequestRedraw();
 
 				renderer_.Tick(delta_time);
 				renderer_.End();
+
+				using namespace std::chrono;
+				const steady_clock::time_point present_time_point = steady_clock::now();
+
+				FrameSample sample;
+				sample.cpu_time = duration<float, std::milli>(present_time_point - frame_start).count();
+				sample.gpu_time = renderer_.GetGPUProfiler().GetFrameTime();
+				if (last_present_time_point_ != steady_clock::time_point{})
+					sample.present_interval = duration<float, std::milli>(present_time_point - last_present_time_point_).count();
+				last_present_time_point_ = present_time_point;
+				frame_stats_.AddSample(sample);
+
+				last_render_time_point_ = present_time_point;
+				if (redraw_frame_count_ > 0)
+					--redraw_frame_count_;
+
+				// otherwise the frame waits after its input is sampled, before the next one
+				if (!app_specification_.low_latency)
+					LimitFrameRate();
 			}
-			
 		}
 	}
 
+	void Application::LimitFrameRate()
+	{
+		using namespace std::chrono;
+		if (app_specification_.max_frame_rate <= 0.0f)
+		{
+			next_frame_time_point_ = {};
+			return;
+		}
+
+		MLE_PROFILE_FUNCTION();
+		const auto frame_period = duration_cast<steady_clock::duration>(duration<float>(1.0f / app_specification_.max_frame_rate));
+		steady_clock::time_point now = steady_clock::now();
+		// sleeps overshoot by up to a scheduler tick, the last bit is spun
+		constexpr auto SPIN_TIME = milliseconds(1);
+		if (next_frame_time_point_ - now > SPIN_TIME)
+			std::this_thread::sleep_until(next_frame_time_point_ - SPIN_TIME);
+		while ((now = steady_clock::now()) < next_frame_time_point_)
+			std::this_thread::yield();
+
+		// a late frame doesn't make the next ones come faster to catch up
+		next_frame_time_point_ = std::max(next_frame_time_point_ + frame_period, now);
+	}
+
+	bool Application::WaitForRedraw()
+	{
+		using namespace std::chrono;
+		if (app_window_->TakeActivity())
+			RequestRedraw();
+		if (redraw_frame_count_ > 0)
+			return true;
+
+		// idle frames still come every max_idle_interval, e.g. for the GPU timings and the loading assets
+		const float max_idle_interval = app_specification_.max_idle_interval;
+		const steady_clock::time_point deadline = last_render_time_point_ + duration_cast<steady_clock::duration>(duration<float>(max_idle_interval));
+		steady_clock::time_point now = steady_clock::now();
+		if (max_idle_interval > 0.0f && now >= deadline)
+			return true;
+
+		{
+			MLE_PROFILE_SCOPE("Window::WaitEvents");
+			app_window_->WaitEvents(max_idle_interval > 0.0f ? duration<float>(deadline - now).count() : 0.0f);
+		}
+		if (app_window_->TakeActivity())
+			RequestRedraw();
+		now = steady_clock::now();
+		return redraw_frame_count_ > 0 || (max_idle_interval > 0.0f && now >= deadline);
+	}
+
 	void Application::Close()
 	{
 		is_running_ = false;
@@ -135,6 +263,6 @@ namespace engine {
 		}
 
 		is_minimized_ = false;
-		//renderer_->Resize(event.GetWidth(), event.GetHeight());
+		rhi::RHI::GetRHIInstance().OnViewportResize(event.GetWidth(), event.GetHeight());
 	}
 }
@@ -5,6 +5,7 @@
 #include "Runtime/Events/Event.h"
 #include "Runtime/Events/ApplicationEvents.h"
 #include "Runtime/Function/Renderer/Renderer.h"
+#include "Runtime/Core/Debug/FrameStats.h"
 
 #include "imgui.h"
 #include "vulkan/vulkan.h"
@@ -23,6 +24,26 @@ namespace engine {
 		std::string name = "Walnut App";
 		uint32_t width = 1600;
 		uint32_t height = 900;
+		// frame statistics go to <frame_stats_file>.csv and .json at exit, nothing is written if empty
+		std::string frame_stats_file;
+		// no window and no swapchain, the present pass renders into an offscreen image of width x height
+		bool headless = false;
+		// exit after this many frames, 0 runs until Close() or the window is closed
+		uint32_t frame_count = 0;
+		// every frame is stepped by this many seconds instead of the measured time if greater than 0
+		float fixed_time_step = 0.0f;
+
+		// 1 to 4, see FrameResourceMngr::SetFramesInFlight
+		uint8_t frames_in_flight = renderer::FrameResourceMngr::DEFAULT_FRAMES_IN_FLIGHT;
+		rhi::PresentMode present_mode = rhi::PresentMode::MAILBOX;
+		// frames don't start more often than this, 0 doesn't limit
+		float max_frame_rate = 0.0f;
+		// the limiter and the wait for a free frame happen before the input is sampled instead of after it
+		bool low_latency = false;
+		// frames are only rendered after input, a RequestRedraw() or max_idle_interval seconds, ignored when headless
+		bool render_on_demand = false;
+		// 0 keeps an idle window asleep until the next event
+		float max_idle_interval = 1.0f;
 	};
 
 	class Application
@@ -46,21 +67,47 @@ namespace engine {
 		void PushLayer(const std::shared_ptr<Layer>& layer) { layer_stack_.emplace_back(layer); layer->OnAttach(); }
 
 		void Close();
+		// returned from main once the application has been closed
+		void SetExitCode(int exit_code) { exit_code_ = exit_code; }
+		int GetExitCode() const { return exit_code_; }
 
 		static Application& GetApp() { return *app_instance_; }
-		Window& GetWindow() { return*app_window_; }
+		Window& GetWindow() { assert(app_window_ && "headless applications have no window"); return*app_window_; }
+		bool IsHeadless() const { return app_specification_.headless; }
+		FrameStats& GetFrameStats() { return frame_stats_; }
+		const ApplicationSpecification& GetSpecification() const { return app_specification_; }
+
+		void SetMaxFrameRate(float frame_rate) { app_specification_.max_frame_rate = std::max(frame_rate, 0.0f); }
+		float GetMaxFrameRate() const { return app_specification_.max_frame_rate; }
+		void SetLowLatency(bool low_latency) { app_specification_.low_latency = low_latency; }
+		bool IsLowLatency() const { return app_specification_.low_latency; }
+		void SetRenderOnDemand(bool render_on_demand) { app_specification_.render_on_demand = render_on_demand; }
+		bool IsRenderOnDemand() const { return app_specification_.render_on_demand; }
+		void SetMaxIdleInterval(float interval) { app_specification_.max_idle_interval = std::max(interval, 0.0f); }
+		float GetMaxIdleInterval() const { return app_specification_.max_idle_interval; }
+
+		// Renders the next frame_count frames even if nothing else changes, ImGui needs a few to settle
+		void RequestRedraw(uint32_t frame_count = REDRAW_FRAME_COUNT) { redraw_frame_count_ = std::max(redraw_frame_count_, frame_count); }
+		static constexpr uint32_t REDRAW_FRAME_COUNT = 3;
 
 	private:
 		void Init();
 		void Shutdown();
 
 		void OnWindowResize(WindowResizeEvent& event);
+		// Sleeps until the frame limit allows the next frame to start
+		void LimitFrameRate();
+		// Sleeps in the window's event queue while render on demand has nothing to redraw,
+		// returns false if the frame should be skipped
+		bool WaitForRedraw();
 	private:
 		static Application* app_instance_;
 		ApplicationSpecification app_specification_;
 		std::unique_ptr<Window> app_window_;
 		bool is_running_ = false;
 		bool is_minimized_ = false;
+		int exit_code_ = 0;
+		uint32_t redraw_frame_count_ = REDRAW_FRAME_COUNT;
 
 		std::vector<std::shared_ptr<Layer>> layer_stack_;
 		std::function<void()> menu_bar_callback_;
@@ -68,6 +115,11 @@ namespace engine {
 		renderer::Renderer& renderer_;
 
 		std::chrono::steady_clock::time_point last_tick_time_point_{ std::chrono::steady_clock::now() };
+		std::chrono::steady_clock::time_point last_present_time_point_{};
+		std::chrono::steady_clock::time_point next_frame_time_point_{};
+		std::chrono::steady_clock::time_point last_render_time_point_{};
+
+		FrameStats frame_stats_;
 	};
 
 	// Implemented by CLIENT
@@ -10,15 +10,17 @@ namespace engine {
 
 	int Main(int argc, char** argv)
 	{
+		int exit_code = 0;
 		while (g_ApplicationRunning)
 		{
 			engine::Log::Init();
 			MLE_CORE_INFO("Engine running");
 			engine::Application* app = engine::CreateApplication(argc, argv);
 			app->Run();
+			exit_code = app->GetExitCode();
 			delete app;
 		}
-		return 0;
+		return exit_code;
 	}
 
 }
@@ -45,6 +45,7 @@ inline OStream& operator<<(OStream& os, glm::qua<T, Q> quaternion)
 
 // Core log macros
 #define MLE_CORE_TRACE(...)    ::engine::Log::GetCoreLogger()->trace(__VA_ARGS__)
+#define MLE_CORE_DEBUG(...)    ::engine::Log::GetCoreLogger()->debug(__VA_ARGS__)
 #define MLE_CORE_INFO(...)     ::engine::Log::GetCoreLogger()->info(__VA_ARGS__)
 #define MLE_CORE_WARN(...)     ::engine::Log::GetCoreLogger()->warn(__VA_ARGS__)
 #define MLE_CORE_ERROR(...)    ::engine::Log::GetCoreLogger()->error(__VA_ARGS__)
@@ -52,6 +53,7 @@ inline OStream& operator<<(OStream& os, glm::qua<T, Q> quaternion)
 
 // Client log macros
 #define MLE_TRACE(...)         ::engine::Log::GetClientLogger()->trace(__VA_ARGS__)
+#define MLE_DEBUG(...)         ::engine::Log::GetClientLogger()->debug(__VA_ARGS__)
 #define MLE_INFO(...)          ::engine::Log::GetClientLogger()->info(__VA_ARGS__)
 #define MLE_WARN(...)          ::engine::Log::GetClientLogger()->warn(__VA_ARGS__)
 #define MLE_ERROR(...)         ::engine::Log::GetClientLogger()->error(__VA_ARGS__)
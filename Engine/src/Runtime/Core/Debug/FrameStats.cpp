@@ -0,0 +1,158 @@
+#include "mlepch.h"
+#include "FrameStats.h"
+
+#include <iomanip>
+
+namespace engine {
+	const char* ToString(FrameMetric metric)
+	{
+		switch (metric)
+		{
+		case FrameMetric::CPU_TIME:			return "CPU Time";
+		case FrameMetric::GPU_TIME:			return "GPU Time";
+		case FrameMetric::PRESENT_INTERVAL:	return "Present Interval";
+		default:							return "Unknown";
+		}
+	}
+
+	void FrameStats::AddSample(const FrameSample& sample)
+	{
+		samples_[head_] = sample;
+		head_ = (head_ + 1) % HISTORY_LENGTH;
+		count_ = std::min(count_ + 1, HISTORY_LENGTH);
+		frame_count_++;
+	}
+
+	void FrameStats::Clear()
+	{
+		head_ = 0;
+		count_ = 0;
+		frame_count_ = 0;
+	}
+
+	const FrameSample& FrameStats::GetSample(uint32_t index) const
+	{
+		assert(index < count_ && "frame sample out of range");
+		return samples_[(head_ + HISTORY_LENGTH - count_ + index) % HISTORY_LENGTH];
+	}
+
+	FrameMetricStats FrameStats::Compute(FrameMetric metric, uint32_t window_size) const
+	{
+		FrameMetricStats stats{};
+
+		const uint32_t window = std::min(window_size, count_);
+		std::vector<float> values;
+		values.reserve(window);
+		for (uint32_t i = count_ - window; i < count_; ++i)
+		{
+			const float value = GetSample(i).Get(metric);
+			if (value >= 0.0f)
+				values.push_back(value);
+		}
+		if (values.empty())
+			return stats;
+
+		std::sort(values.begin(), values.end());
+		// nearest rank
+		auto percentile = [&values](float p) {
+			const size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+			return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+		};
+
+		stats.sample_count = static_cast<uint32_t>(values.size());
+		stats.p50 = percentile(0.50f);
+		stats.p90 = percentile(0.90f);
+		stats.p99 = percentile(0.99f);
+		stats.max = values.back();
+
+		float sum = 0.0f;
+		const float hitch_threshold = stats.p50 * hitch_factor_;
+		for (float value : values)
+		{
+			sum += value;
+			if (value > hitch_threshold)
+				stats.hitch_count++;
+		}
+		stats.average = sum / values.size();
+
+		return stats;
+	}
+
+	bool FrameStats::WriteCSV(const std::string& file_path) const
+	{
+		std::ofstream out(file_path);
+		if (!out.is_open())
+		{
+			MLE_CORE_ERROR("[FrameStats] failed to open {0}", file_path);
+			return false;
+		}
+
+		out << std::fixed << std::setprecision(3);
+		out << "frame,cpu_ms,gpu_ms,present_interval_ms\n";
+		const uint64_t first_frame = frame_count_ - count_;
+		for (uint32_t i = 0; i < count_; ++i)
+		{
+			const FrameSample& sample = GetSample(i);
+			out << first_frame + i << ',';
+			// leave unavailable values empty
+			for (uint8_t metric = 0; metric < static_cast<uint8_t>(FrameMetric::COUNT); ++metric)
+			{
+				const float value = sample.Get(static_cast<FrameMetric>(metric));
+				if (value >= 0.0f)
+					out << value;
+				out << (metric + 1 < static_cast<uint8_t>(FrameMetric::COUNT) ? ',' : '\n');
+			}
+		}
+
+		MLE_CORE_INFO("[FrameStats] wrote {0} frames to {1}", count_, file_path);
+		return true;
+	}
+
+	bool FrameStats::WriteJSON(const std::string& file_path) const
+	{
+		std::ofstream out(file_path);
+		if (!out.is_open())
+		{
+			MLE_CORE_ERROR("[FrameStats] failed to open {0}", file_path);
+			return false;
+		}
+
+		static constexpr const char* METRIC_KEYS[] = { "cpu_ms", "gpu_ms", "present_interval_ms" };
+		static constexpr uint32_t WINDOWS[] = { 60, 600, HISTORY_LENGTH };
+
+		out << std::fixed << std::setprecision(3);
+		out << "{\n\t\"frame_count\": " << frame_count_ << ",\n\t\"hitch_factor\": " << hitch_factor_ << ",\n\t\"windows\": [";
+		for (size_t w = 0; w < std::size(WINDOWS); ++w)
+		{
+			out << (w ? "," : "") << "\n\t\t{ \"size\": " << WINDOWS[w];
+			for (uint8_t metric = 0; metric < static_cast<uint8_t>(FrameMetric::COUNT); ++metric)
+			{
+				const FrameMetricStats stats = Compute(static_cast<FrameMetric>(metric), WINDOWS[w]);
+				out << ", \"" << METRIC_KEYS[metric] << "\": { \"samples\": " << stats.sample_count
+					<< ", \"avg\": " << stats.average << ", \"p50\": " << stats.p50 << ", \"p90\": " << stats.p90
+					<< ", \"p99\": " << stats.p99 << ", \"max\": " << stats.max << ", \"hitches\": " << stats.hitch_count << " }";
+			}
+			out << " }";
+		}
+		out << "\n\t],\n\t\"frames\": [";
+		for (uint32_t i = 0; i < count_; ++i)
+		{
+			const FrameSample& sample = GetSample(i);
+			out << (i ? "," : "") << "\n\t\t[";
+			for (uint8_t metric = 0; metric < static_cast<uint8_t>(FrameMetric::COUNT); ++metric)
+			{
+				const float value = sample.Get(static_cast<FrameMetric>(metric));
+				out << (metric ? ", " : "");
+				if (value >= 0.0f)
+					out << value;
+				else
+					out << "null";
+			}
+			out << "]";
+		}
+		out << "\n\t]\n}\n";
+
+		MLE_CORE_INFO("[FrameStats] wrote {0} frames to {1}", count_, file_path);
+		return true;
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+namespace engine {
+	enum class FrameMetric : uint8_t
+	{
+		// time the main thread spent on the frame, fence waits included
+		CPU_TIME = 0,
+		// timestamps around the frame's command buffer, lags a few frames behind
+		GPU_TIME = 1,
+		// time between two presents, what the user actually sees
+		PRESENT_INTERVAL = 2,
+		COUNT
+	};
+
+	const char* ToString(FrameMetric metric);
+
+	// all times in milliseconds, a negative value means not available
+	struct FrameSample
+	{
+		float cpu_time = -1.0f;
+		float gpu_time = -1.0f;
+		float present_interval = -1.0f;
+
+		inline float Get(FrameMetric metric) const
+		{
+			switch (metric)
+			{
+			case FrameMetric::CPU_TIME:			return cpu_time;
+			case FrameMetric::GPU_TIME:			return gpu_time;
+			case FrameMetric::PRESENT_INTERVAL:	return present_interval;
+			default:							return -1.0f;
+			}
+		};
+	};
+
+	struct FrameMetricStats
+	{
+		uint32_t sample_count = 0;
+		float average = 0.0f;
+		float p50 = 0.0f;
+		float p90 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+		// frames longer than hitch factor times the median of the window
+		uint32_t hitch_count = 0;
+	};
+
+	/// <summary>
+	/// Keeps the last HISTORY_LENGTH frames and reports percentiles and hitches over the most recent ones.
+	/// </summary>
+	class FrameStats
+	{
+	public:
+		static constexpr uint32_t HISTORY_LENGTH = 4096;
+
+		void AddSample(const FrameSample& sample);
+		// Drops every sample, e.g. to measure from the start of a benchmark run
+		void Clear();
+
+		// Over the last window_size frames(clamped to what has been recorded), samples without the metric are skipped
+		FrameMetricStats Compute(FrameMetric metric, uint32_t window_size) const;
+
+		inline uint32_t GetSampleCount() const { return count_; };
+		// index 0 is the oldest sample still kept
+		const FrameSample& GetSample(uint32_t index) const;
+		inline uint64_t GetFrameCount() const { return frame_count_; };
+
+		inline void SetHitchFactor(float factor) { hitch_factor_ = factor; };
+		inline float GetHitchFactor() const { return hitch_factor_; };
+
+		// Every kept frame, one row per frame
+		bool WriteCSV(const std::string& file_path) const;
+		// Statistics of a few windows, followed by every kept frame
+		bool WriteJSON(const std::string& file_path) const;
+	private:
+		std::vector<FrameSample> samples_ = std::vector<FrameSample>(HISTORY_LENGTH);
+		uint32_t head_ = 0;
+		uint32_t count_ = 0;
+		uint64_t frame_count_ = 0;
+
+		float hitch_factor_ = 2.0f;
+	};
+}
@@ -0,0 +1,160 @@
+#include "mlepch.h"
+#include "Instrumentor.h"
+
+#include <iomanip>
+
+namespace engine {
+	Instrumentor::Instrumentor()
+		:epoch_(std::chrono::steady_clock::now())
+	{
+	}
+
+	void Instrumentor::BeginCapture()
+	{
+		// threads notice the new index and clear their own buffers on their next event
+		capture_index_.fetch_add(1, std::memory_order_relaxed);
+		is_capturing_.store(true, std::memory_order_release);
+		MLE_CORE_INFO("[Instrumentor] capture started");
+	}
+
+	static void WriteJsonString(std::ofstream& out, const char* str)
+	{
+		out << '"';
+		for (const char* c = str; c && *c; ++c)
+		{
+			if (*c == '"' || *c == '\\')
+				out << '\\';
+			out << *c;
+		}
+		out << '"';
+	}
+
+	void Instrumentor::EndCapture(const std::string& file_path)
+	{
+		is_capturing_.store(false, std::memory_order_release);
+
+		std::ofstream out(file_path);
+		if (!out.is_open())
+		{
+			MLE_CORE_ERROR("[Instrumentor] failed to open {0}", file_path);
+			return;
+		}
+
+		const uint32_t capture_index = capture_index_.load(std::memory_order_relaxed);
+		size_t event_count = 0;
+		uint32_t dropped_count = 0;
+		bool first = true;
+		auto separator = [&out, &first]() {
+			if (!first)
+				out << ",\n";
+			first = false;
+		};
+
+		out << std::fixed << std::setprecision(3);
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		std::lock_guard<std::mutex> lock(buffers_mutex_);
+		for (auto const& buffer : buffers_)
+		{
+			if (buffer->thread_name)
+			{
+				separator();
+				out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->thread_id << ",\"args\":{\"name\":";
+				WriteJsonString(out, buffer->thread_name);
+				out << "}}";
+			}
+			if (buffer->capture_index.load(std::memory_order_relaxed) != capture_index)
+				continue;
+
+			const uint32_t count = buffer->count.load(std::memory_order_acquire);
+			dropped_count += buffer->dropped.load(std::memory_order_relaxed);
+			event_count += count;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const TraceEvent& event = buffer->events[i];
+				separator();
+				out << "{\"name\":";
+				WriteJsonString(out, event.name);
+				// chrome trace timestamps are in microseconds
+				out << ",\"pid\":0,\"tid\":" << buffer->thread_id << ",\"ts\":" << event.start / 1000.0;
+				switch (event.type)
+				{
+				case TraceEventType::SCOPE:
+					out << ",\"ph\":\"X\",\"cat\":\"cpu\",\"dur\":" << event.duration / 1000.0 << "}";
+					break;
+				case TraceEventType::FRAME_MARKER:
+					out << ",\"ph\":\"i\",\"s\":\"g\",\"cat\":\"frame\"}";
+					break;
+				case TraceEventType::COUNTER:
+					out << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+					break;
+				}
+			}
+		}
+		out << "\n]}\n";
+
+		MLE_CORE_INFO("[Instrumentor] wrote {0} events to {1}", event_count, file_path);
+		if (dropped_count)
+			MLE_CORE_WARN("[Instrumentor] {0} events were dropped, buffers hold {1} events per thread", dropped_count, MAX_EVENTS_PER_THREAD);
+	}
+
+	void Instrumentor::SetThreadName(const char* name)
+	{
+		GetThreadBuffer().thread_name = name;
+	}
+
+	void Instrumentor::WriteScope(const char* name, uint64_t start, uint64_t end)
+	{
+		Write({ name, start, end - start, 0.0, TraceEventType::SCOPE });
+	}
+
+	void Instrumentor::WriteFrameMarker(const char* name)
+	{
+		if (IsCapturing())
+			Write({ name, Now(), 0, 0.0, TraceEventType::FRAME_MARKER });
+	}
+
+	void Instrumentor::WriteCounter(const char* name, double value)
+	{
+		if (IsCapturing())
+			Write({ name, Now(), 0, value, TraceEventType::COUNTER });
+	}
+
+	Instrumentor::ThreadBuffer& Instrumentor::GetThreadBuffer()
+	{
+		static thread_local ThreadBuffer* t_buffer = nullptr;
+		if (t_buffer)
+			return *t_buffer;
+
+		// first event of this thread, the only time the mutex is taken
+		std::lock_guard<std::mutex> lock(buffers_mutex_);
+		auto& buffer = buffers_.emplace_back(std::make_unique<ThreadBuffer>());
+		buffer->events = std::make_unique<TraceEvent[]>(MAX_EVENTS_PER_THREAD);
+		buffer->thread_id = static_cast<uint32_t>(buffers_.size());
+		buffer->capture_index.store(capture_index_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		t_buffer = buffer.get();
+		return *t_buffer;
+	}
+
+	void Instrumentor::Write(const TraceEvent& event)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+
+		const uint32_t capture_index = capture_index_.load(std::memory_order_relaxed);
+		if (buffer.capture_index.load(std::memory_order_relaxed) != capture_index)
+		{
+			buffer.capture_index.store(capture_index, std::memory_order_relaxed);
+			buffer.count.store(0, std::memory_order_relaxed);
+			buffer.dropped.store(0, std::memory_order_relaxed);
+		}
+
+		const uint32_t index = buffer.count.load(std::memory_order_relaxed);
+		if (index >= MAX_EVENTS_PER_THREAD)
+		{
+			buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		buffer.events[index] = event;
+		// publish the event to the exporter
+		buffer.count.store(index + 1, std::memory_order_release);
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include "Runtime/Core/Base/Singleton.h"
+
+namespace engine {
+	enum class TraceEventType : uint8_t
+	{
+		SCOPE = 0,
+		FRAME_MARKER = 1,
+		COUNTER = 2
+	};
+
+	// Names are not copied, they must outlive the capture(literals, __FUNCTION__, pass names)
+	struct TraceEvent
+	{
+		const char* name;
+		// nanoseconds since the instrumentor was created
+		uint64_t start;
+		uint64_t duration;
+		double value;
+		TraceEventType type;
+	};
+
+	/// <summary>
+	/// Collects CPU scopes, frame markers and counters while a capture is running and exports them
+	/// as Chrome trace JSON, which chrome://tracing and Perfetto both open.
+	/// Every thread appends to its own buffer, recording an event never takes a lock.
+	/// </summary>
+	class Instrumentor : public Singleton<Instrumentor>
+	{
+		friend class Singleton<Instrumentor>;
+	public:
+		// events per thread and capture, later ones are dropped
+		static constexpr uint32_t MAX_EVENTS_PER_THREAD = 1 << 16;
+
+		void BeginCapture();
+		// Stops recording and writes everything captured so far to file_path
+		void EndCapture(const std::string& file_path);
+		inline bool IsCapturing() const { return is_capturing_.load(std::memory_order_relaxed); };
+
+		void SetThreadName(const char* name);
+
+		inline uint64_t Now() const
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch_).count();
+		};
+
+		void WriteScope(const char* name, uint64_t start, uint64_t end);
+		void WriteFrameMarker(const char* name);
+		void WriteCounter(const char* name, double value);
+	private:
+		Instrumentor();
+
+		struct ThreadBuffer
+		{
+			std::unique_ptr<TraceEvent[]> events;
+			// only the owning thread writes these, the exporter reads them after the capture stopped
+			std::atomic<uint32_t> count{ 0 };
+			std::atomic<uint32_t> dropped{ 0 };
+			std::atomic<uint32_t> capture_index{ 0 };
+			uint32_t thread_id = 0;
+			const char* thread_name = nullptr;
+		};
+		ThreadBuffer& GetThreadBuffer();
+		void Write(const TraceEvent& event);
+
+		std::chrono::steady_clock::time_point epoch_;
+		std::atomic<bool> is_capturing_{ false };
+		// bumped by BeginCapture, a thread clears its own buffer when it sees a new one
+		std::atomic<uint32_t> capture_index_{ 0 };
+
+		// registration only, once per thread
+		std::mutex buffers_mutex_;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+	};
+
+	class ProfileScope
+	{
+	public:
+		ProfileScope(const char* name)
+			:name_(name)
+		{
+			if (Instrumentor::GetInstance().IsCapturing())
+				start_ = Instrumentor::GetInstance().Now();
+		}
+		~ProfileScope()
+		{
+			if (start_ != NOT_STARTED)
+				Instrumentor::GetInstance().WriteScope(name_, start_, Instrumentor::GetInstance().Now());
+		}
+
+		ProfileScope(ProfileScope const&) = delete;
+		ProfileScope& operator=(ProfileScope const&) = delete;
+	private:
+		static constexpr uint64_t NOT_STARTED = std::numeric_limits<uint64_t>::max();
+		const char* name_;
+		uint64_t start_ = NOT_STARTED;
+	};
+}
+
+#define MLE_PROFILE_CONCAT_INTERNAL(a, b) a##b
+#define MLE_PROFILE_CONCAT(a, b) MLE_PROFILE_CONCAT_INTERNAL(a, b)
+
+// Compiled out unless MLE_PROFILE is defined
+#ifdef MLE_PROFILE
+	#define MLE_PROFILE_SCOPE(name)				::engine::ProfileScope MLE_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+	#define MLE_PROFILE_FUNCTION()				MLE_PROFILE_SCOPE(__FUNCTION__)
+	#define MLE_PROFILE_FRAME(name)				::engine::Instrumentor::GetInstance().WriteFrameMarker(name)
+	#define MLE_PROFILE_COUNTER(name, value)	::engine::Instrumentor::GetInstance().WriteCounter(name, static_cast<double>(value))
+	#define MLE_PROFILE_THREAD(name)			::engine::Instrumentor::GetInstance().SetThreadName(name)
+#else
+	#define MLE_PROFILE_SCOPE(name)
+	#define MLE_PROFILE_FUNCTION()
+	#define MLE_PROFILE_FRAME(name)
+	#define MLE_PROFILE_COUNTER(name, value)
+	#define MLE_PROFILE_THREAD(name)
+#endif
@@ -37,6 +37,7 @@ namespace engine {
 				WindowProps& data = *(WindowProps*)glfwGetWindowUserPointer(window);
 				data.width = width;
 				data.height = height;
+				data.has_activity = true;
 
 				WindowResizeEvent event(width, height);
 				data.EventCallback(event);
@@ -45,6 +46,7 @@ namespace engine {
 		glfwSetKeyCallback(glfw_window_, [](GLFWwindow* window, int key, int scancode, int action, int mods)
 			{
 				WindowProps& data = *(WindowProps*)glfwGetWindowUserPointer(window);
+				data.has_activity = true;
 
 				switch (action)
 				{
@@ -75,6 +77,7 @@ namespace engine {
 		glfwSetMouseButtonCallback(glfw_window_, [](GLFWwindow* window, int button, int action, int mods)
 			{
 				WindowProps& data = *(WindowProps*)glfwGetWindowUserPointer(window);
+				data.has_activity = true;
 
 				switch (action)
 				{
@@ -94,6 +97,37 @@ namespace engine {
 				}
 				}
 			});
+
+		// the rest only wakes up on-demand rendering, ImGui's backend chains to these
+		glfwSetCursorPosCallback(glfw_window_, [](GLFWwindow* window, double x, double y)
+			{
+				((WindowProps*)glfwGetWindowUserPointer(window))->has_activity = true;
+			});
+
+		glfwSetScrollCallback(glfw_window_, [](GLFWwindow* window, double x_offset, double y_offset)
+			{
+				((WindowProps*)glfwGetWindowUserPointer(window))->has_activity = true;
+			});
+
+		glfwSetCharCallback(glfw_window_, [](GLFWwindow* window, unsigned int codepoint)
+			{
+				((WindowProps*)glfwGetWindowUserPointer(window))->has_activity = true;
+			});
+
+		glfwSetCursorEnterCallback(glfw_window_, [](GLFWwindow* window, int entered)
+			{
+				((WindowProps*)glfwGetWindowUserPointer(window))->has_activity = true;
+			});
+
+		glfwSetWindowFocusCallback(glfw_window_, [](GLFWwindow* window, int focused)
+			{
+				((WindowProps*)glfwGetWindowUserPointer(window))->has_activity = true;
+			});
+
+		glfwSetWindowRefreshCallback(glfw_window_, [](GLFWwindow* window)
+			{
+				((WindowProps*)glfwGetWindowUserPointer(window))->has_activity = true;
+			});
 	}
 
 	void Window::OnUpdate()
@@ -101,6 +135,21 @@ namespace engine {
 		glfwPollEvents();
 	}
 
+	void Window::WaitEvents(float timeout)
+	{
+		if (timeout > 0.0f)
+			glfwWaitEventsTimeout(timeout);
+		else
+			glfwWaitEvents();
+	}
+
+	bool Window::TakeActivity()
+	{
+		const bool has_activity = window_properties_.has_activity;
+		window_properties_.has_activity = false;
+		return has_activity;
+	}
+
 	Window::~Window()
 	{
 		Shutdown();
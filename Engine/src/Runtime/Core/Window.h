@@ -10,6 +10,8 @@ namespace engine {
 		uint32_t width;
 		uint32_t height;
 		std::function<void(Event&)> EventCallback;
+		// set by every input and window callback, cleared by Window::TakeActivity()
+		bool has_activity = false;
 
 		WindowProps(const std::string& title = "My Little Engine",
 			uint32_t width = 1600,
@@ -27,6 +29,10 @@ namespace engine {
 		virtual ~Window();
 
 		void OnUpdate();
+		// Blocks until an event arrives or timeout seconds have passed, waits for an event only if timeout is 0
+		void WaitEvents(float timeout);
+		// Whether there was any input or window event since the last call
+		bool TakeActivity();
 
 		uint32_t		GetWidth()			const	{ return window_properties_.width; };
 		uint32_t		GetHeight()			const	{ return window_properties_.height; };
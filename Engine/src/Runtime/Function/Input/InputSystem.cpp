@@ -6,6 +6,8 @@
 namespace engine {
 	bool InputSystem::IsKeyDown(KeyCode keycode)
 	{
+		if (Application::GetApp().IsHeadless())
+			return false;
 		GLFWwindow* windowHandle = (GLFWwindow*)Application::GetApp().GetWindow().GetNativeWindow();
 		int state = glfwGetKey(windowHandle, (int)keycode);
 		return state == GLFW_PRESS || state == GLFW_REPEAT;
@@ -13,6 +15,8 @@ namespace engine {
 
 	bool InputSystem::IsMouseButtonDown(MouseButton button)
 	{
+		if (Application::GetApp().IsHeadless())
+			return false;
 		GLFWwindow* windowHandle = (GLFWwindow*)Application::GetApp().GetWindow().GetNativeWindow();
 		int state = glfwGetMouseButton(windowHandle, (int)button);
 		return state == GLFW_PRESS;
@@ -20,6 +24,8 @@ namespace engine {
 
 	glm::vec2 InputSystem::GetMousePosition()
 	{
+		if (Application::GetApp().IsHeadless())
+			return { 0.0f, 0.0f };
 		GLFWwindow* windowHandle = (GLFWwindow*)Application::GetApp().GetWindow().GetNativeWindow();
 
 		double x, y;
@@ -29,6 +35,8 @@ namespace engine {
 
 	void InputSystem::SetCursorMode(CursorMode mode)
 	{
+		if (Application::GetApp().IsHeadless())
+			return;
 		GLFWwindow* windowHandle = (GLFWwindow*)Application::GetApp().GetWindow().GetNativeWindow();
 		glfwSetInputMode(windowHandle, GLFW_CURSOR, GLFW_CURSOR_NORMAL + (int)mode);
 	}
@@ -1,12 +1,14 @@
 #pragma once
 #include "Descriptor.h"
 #include "RHIResource.h"
+#include "RHIStats.h"
 struct ImDrawData;
 
 namespace rhi {
     class RenderTarget;
     class RenderPass;
-
+    struct QueryPool;
+    class SecondaryCommandBuffer;
 
     struct CopyBufferToBufferDesc
     {
@@ -16,6 +18,24 @@ namespace rhi {
         uint64_t dst_offset;
         uint64_t size;
     };
+    struct BufferBarrierDesc
+    {
+        RHIBuffer* buffer;
+        // how the buffer was accessed before the barrier
+        BufferUsage src_usage;
+        bool src_write;
+        // how the buffer will be accessed after the barrier
+        BufferUsage dst_usage;
+        bool dst_write;
+    };
+    enum class SubpassContents : uint8_t
+    {
+        // the commands are recorded into the command buffer that began the render pass
+        INLINE = 0,
+        // the subpass only executes secondary command buffers
+        SECONDARY_COMMAND_BUFFERS
+    };
+
     class RHIEncoderBase
     {
     public:
@@ -32,7 +52,7 @@ namespace rhi {
         virtual ~RHIGraphicsEncoder() = default;
 
         
-        virtual void BeginRenderPass(RenderPass& pass, RenderTarget& render_target) = 0;
+        virtual void BeginRenderPass(RenderPass& pass, RenderTarget& render_target, SubpassContents contents) = 0;
         virtual void BindGfxPipeline(RHIPipeline* pipeline) = 0;
         virtual void BindVertexBuffers(uint32_t first_binding, uint32_t binding_count, RHIBuffer** buffer, uint64_t* offsets) = 0;
         virtual void BindIndexBuffer(RHIBuffer* index_buffer, uint64_t offset) = 0;
@@ -46,6 +66,23 @@ namespace rhi {
 
         virtual void NextSubpass() {};
 
+        // The subpass must have been begun with SubpassContents::SECONDARY_COMMAND_BUFFERS, the bound state is undefined afterwards
+        virtual void ExecuteSecondary(SecondaryCommandBuffer& secondary) = 0;
+
+        // Must be recorded outside of a render pass
+        virtual void BufferBarrier(const BufferBarrierDesc& desc) = 0;
+        // Backends that can, record all of them as one barrier
+        virtual void BufferBarriers(const BufferBarrierDesc* descs, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                BufferBarrier(descs[i]);
+        };
+
+        // Must be recorded outside of a render pass
+        virtual void ResetQueryPool(QueryPool* pool, uint32_t first_query, uint32_t query_count) = 0;
+        // Written once all previously submitted commands reach the bottom of the pipe
+        virtual void WriteTimestamp(QueryPool* pool, uint32_t query) = 0;
+
         virtual void EndRenderPass() = 0;
 
         virtual void ImGui_RenderDrawData(ImDrawData* draw_data) = 0;
@@ -85,4 +122,26 @@ namespace rhi {
         virtual RHITransferEncoder& GetTransferEncoder()    = 0;
         virtual void* GetNativeTransferHandle()             = 0;
     };
+
+    /// <summary>
+    /// Graphics commands for one subpass, recorded once and executed by the command buffers of later frames
+    /// without being encoded again. They stay tied to the render pass they were recorded for,
+    /// and the backend can't execute them anymore once a descriptor set they bind has been written.
+    /// The GPU may still execute them until the frames that did are done
+    /// </summary>
+    class SecondaryCommandBuffer
+    {
+    public:
+        virtual ~SecondaryCommandBuffer() = default;
+
+        // Drops what was recorded, the commands for the subpass of the pass are recorded through the encoder until End
+        virtual void Begin(RenderPass& pass, uint32_t subpass) = 0;
+        virtual void End() = 0;
+        virtual RHIGraphicsEncoder& GetGfxEncoder() = 0;
+        // False once the recorded commands can't be executed anymore and have to be recorded again
+        virtual bool IsValid() = 0;
+
+        // what recording the commands counted, every execution counts it again
+        RHICounters recorded_counters;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,390 @@
+#include "mlepch.h"
+#include "CommandList.h"
+#include "RHIBackend.h"
+#include "RHIStats.h"
+#include "FrameCapture.h"
+
+namespace rhi {
+	namespace {
+		template<typename Command>
+		inline const Command& As(const CommandHeader* header)
+		{
+			return *reinterpret_cast<const Command*>(header);
+		}
+
+		template<typename T>
+		inline bool ArrayEquals(const T* a, const T* b, uint32_t count)
+		{
+			return a == b || (a && b && std::equal(a, a + count, b));
+		}
+
+		// What the encoder has bound, binds of the same state again are skipped
+		struct BoundState
+		{
+			const command::BindGfxPipeline* pipeline = nullptr;
+			const command::BindVertexBuffers* vertex_buffers = nullptr;
+			const command::BindIndexBuffer* index_buffer = nullptr;
+			const command::BindDescriptorSets* descriptor_sets = nullptr;
+			const command::SetViewport* viewport = nullptr;
+			const command::SetScissor* scissor = nullptr;
+
+			bool IsBound(const command::BindGfxPipeline& cmd) const
+			{
+				return pipeline && pipeline->pipeline == cmd.pipeline;
+			}
+			bool IsBound(const command::BindVertexBuffers& cmd) const
+			{
+				return vertex_buffers && vertex_buffers->first_binding == cmd.first_binding && vertex_buffers->binding_count == cmd.binding_count &&
+					ArrayEquals(vertex_buffers->buffers, cmd.buffers, cmd.binding_count) && ArrayEquals(vertex_buffers->offsets, cmd.offsets, cmd.binding_count);
+			}
+			bool IsBound(const command::BindIndexBuffer& cmd) const
+			{
+				return index_buffer && index_buffer->buffer == cmd.buffer && index_buffer->offset == cmd.offset;
+			}
+			bool IsBound(const command::BindDescriptorSets& cmd) const
+			{
+				return descriptor_sets && descriptor_sets->layout == cmd.layout && descriptor_sets->first_set == cmd.first_set &&
+					descriptor_sets->sets_count == cmd.sets_count && ArrayEquals(descriptor_sets->sets, cmd.sets, cmd.sets_count) &&
+					descriptor_sets->dynamic_offset_count == cmd.dynamic_offset_count &&
+					ArrayEquals(descriptor_sets->dynamic_offsets, cmd.dynamic_offsets, cmd.dynamic_offset_count);
+			}
+			bool IsBound(const command::SetViewport& cmd) const
+			{
+				return viewport && viewport->x == cmd.x && viewport->y == cmd.y && viewport->width == cmd.width && viewport->height == cmd.height &&
+					viewport->min_depth == cmd.min_depth && viewport->max_depth == cmd.max_depth;
+			}
+			bool IsBound(const command::SetScissor& cmd) const
+			{
+				return scissor && scissor->offset_x == cmd.offset_x && scissor->offset_y == cmd.offset_y && scissor->width == cmd.width && scissor->height == cmd.height;
+			}
+		};
+	}
+
+	void CommandList::Translate(CommandBuffer& cmd_buffer)
+	{
+		MLE_PROFILE_FUNCTION();
+		FrameCapture::OnTranslate(*this);
+		TranslateInto(ToBackend(cmd_buffer).GetGfxEncoder());
+	}
+
+	void CommandList::Translate(SecondaryCommandBuffer& secondary, RenderPass& pass, uint32_t subpass)
+	{
+		MLE_PROFILE_FUNCTION();
+		RHIStats& stats = RHIStats::GetInstance();
+		const RHICounters start = stats.GetTotal();
+		secondary.Begin(pass, subpass);
+		TranslateInto(ToBackend(secondary).GetGfxEncoder());
+		secondary.End();
+		secondary.recorded_counters = stats.GetTotal() - start;
+	}
+
+	template<typename Encoder>
+	void CommandList::TranslateInto(Encoder& encoder)
+	{
+		// pipelines are tied to a render pass and subpass, and ImGui binds its own state, so nothing is assumed across those
+		BoundState bound{};
+		uint64_t filtered_count = 0;
+
+		auto flush_barriers = [&]() {
+			if (pending_barriers_.empty())
+				return;
+			encoder.BufferBarriers(pending_barriers_.data(), static_cast<uint32_t>(pending_barriers_.size()));
+			pending_barriers_.clear();
+		};
+
+		for (const CommandHeader *header = head_, *next = nullptr; header || !return_to_.empty(); header = next)
+		{
+			if (!header)
+			{
+				next = return_to_.back();
+				return_to_.pop_back();
+				continue;
+			}
+			next = header->next;
+
+			if (header->type == CommandType::BUFFER_BARRIER)
+			{
+				pending_barriers_.push_back(As<command::BufferBarrier>(header).desc);
+				continue;
+			}
+			flush_barriers();
+
+			switch (header->type)
+			{
+			case CommandType::BEGIN_RENDER_PASS:
+			{
+				auto& cmd = As<command::BeginRenderPass>(header);
+				encoder.BeginRenderPass(*cmd.pass, *cmd.render_target, cmd.contents);
+				bound = {};
+				break;
+			}
+			case CommandType::END_RENDER_PASS:
+				encoder.EndRenderPass();
+				break;
+			case CommandType::NEXT_SUBPASS:
+				encoder.NextSubpass();
+				bound = {};
+				break;
+			case CommandType::BIND_GFX_PIPELINE:
+			{
+				auto& cmd = As<command::BindGfxPipeline>(header);
+				if (bound.IsBound(cmd))
+				{
+					filtered_count++;
+					break;
+				}
+				encoder.BindGfxPipeline(cmd.pipeline);
+				bound.pipeline = &cmd;
+				break;
+			}
+			case CommandType::BIND_VERTEX_BUFFERS:
+			{
+				auto& cmd = As<command::BindVertexBuffers>(header);
+				if (bound.IsBound(cmd))
+				{
+					filtered_count++;
+					break;
+				}
+				encoder.BindVertexBuffers(cmd.first_binding, cmd.binding_count, cmd.buffers, cmd.offsets);
+				bound.vertex_buffers = &cmd;
+				break;
+			}
+			case CommandType::BIND_INDEX_BUFFER:
+			{
+				auto& cmd = As<command::BindIndexBuffer>(header);
+				if (bound.IsBound(cmd))
+				{
+					filtered_count++;
+					break;
+				}
+				encoder.BindIndexBuffer(cmd.buffer, cmd.offset);
+				bound.index_buffer = &cmd;
+				break;
+			}
+			case CommandType::BIND_DESCRIPTOR_SETS:
+			{
+				auto& cmd = As<command::BindDescriptorSets>(header);
+				if (bound.IsBound(cmd))
+				{
+					filtered_count++;
+					break;
+				}
+				encoder.BindDescriptorSets(cmd.layout, cmd.first_set, cmd.sets_count, cmd.sets, cmd.dynamic_offset_count, cmd.dynamic_offsets);
+				bound.descriptor_sets = &cmd;
+				break;
+			}
+			case CommandType::SET_VIEWPORT:
+			{
+				auto& cmd = As<command::SetViewport>(header);
+				if (bound.IsBound(cmd))
+				{
+					filtered_count++;
+					break;
+				}
+				encoder.SetViewport(cmd.x, cmd.y, cmd.width, cmd.height, cmd.min_depth, cmd.max_depth);
+				bound.viewport = &cmd;
+				break;
+			}
+			case CommandType::SET_SCISSOR:
+			{
+				auto& cmd = As<command::SetScissor>(header);
+				if (bound.IsBound(cmd))
+				{
+					filtered_count++;
+					break;
+				}
+				encoder.SetScissor(cmd.offset_x, cmd.offset_y, cmd.width, cmd.height);
+				bound.scissor = &cmd;
+				break;
+			}
+			case CommandType::DRAW:
+			{
+				auto& cmd = As<command::Draw>(header);
+				encoder.Draw(cmd.vertex_count, cmd.instance_count, cmd.first_vertex, cmd.first_instance);
+				break;
+			}
+			case CommandType::DRAW_INDEXED:
+			{
+				auto& cmd = As<command::DrawIndexed>(header);
+				encoder.DrawIndexed(cmd.index_count, cmd.instance_count, cmd.first_index, cmd.offset, cmd.first_instance);
+				break;
+			}
+			case CommandType::RESET_QUERY_POOL:
+			{
+				auto& cmd = As<command::ResetQueryPool>(header);
+				encoder.ResetQueryPool(cmd.pool, cmd.first_query, cmd.query_count);
+				break;
+			}
+			case CommandType::WRITE_TIMESTAMP:
+			{
+				auto& cmd = As<command::WriteTimestamp>(header);
+				encoder.WriteTimestamp(cmd.pool, cmd.query);
+				break;
+			}
+			case CommandType::IMGUI_RENDER_DRAW_DATA:
+				encoder.ImGui_RenderDrawData(As<command::ImGuiRenderDrawData>(header).draw_data);
+				bound = {};
+				break;
+			case CommandType::BEGIN_MARKER:
+				RHIStats::GetInstance().BeginPass(As<command::BeginMarker>(header).name);
+				break;
+			case CommandType::END_MARKER:
+				RHIStats::GetInstance().EndPass();
+				break;
+			case CommandType::EXECUTE_LIST:
+			{
+				// the bound state carries over, the nested commands are filtered against the ones around them
+				const CommandList& list = *As<command::ExecuteList>(header).list;
+				assert(&list != this && "a command list can't execute itself");
+				return_to_.push_back(next);
+				next = list.head_;
+				break;
+			}
+			case CommandType::EXECUTE_SECONDARY:
+			{
+				auto& cmd = As<command::ExecuteSecondary>(header);
+				if (cmd.record || !cmd.secondary->IsValid())
+					cmd.list->Translate(*cmd.secondary, *cmd.pass, cmd.subpass);
+				else
+					RHIStats::Count(cmd.secondary->recorded_counters);
+				encoder.ExecuteSecondary(*cmd.secondary);
+				bound = {};
+				break;
+			}
+			default:
+				assert(false && "unknown command");
+				break;
+			}
+		}
+		flush_barriers();
+
+		RHIStats::Count(RHICounter::FILTERED_COMMANDS, filtered_count);
+	}
+
+	void CommandList::AppendCopy(const CommandHeader* first)
+	{
+		for (const CommandHeader* header = first; header; header = header->next)
+		{
+			switch (header->type)
+			{
+			case CommandType::BEGIN_RENDER_PASS:
+			{
+				auto& cmd = As<command::BeginRenderPass>(header);
+				BeginRenderPass(*cmd.pass, *cmd.render_target, cmd.contents);
+				break;
+			}
+			case CommandType::END_RENDER_PASS:
+				EndRenderPass();
+				break;
+			case CommandType::NEXT_SUBPASS:
+				NextSubpass();
+				break;
+			case CommandType::BIND_GFX_PIPELINE:
+				BindGfxPipeline(As<command::BindGfxPipeline>(header).pipeline);
+				break;
+			case CommandType::BIND_VERTEX_BUFFERS:
+			{
+				auto& cmd = As<command::BindVertexBuffers>(header);
+				BindVertexBuffers(cmd.first_binding, cmd.binding_count, cmd.buffers, cmd.offsets);
+				break;
+			}
+			case CommandType::BIND_INDEX_BUFFER:
+			{
+				auto& cmd = As<command::BindIndexBuffer>(header);
+				BindIndexBuffer(cmd.buffer, cmd.offset);
+				break;
+			}
+			case CommandType::BIND_DESCRIPTOR_SETS:
+			{
+				auto& cmd = As<command::BindDescriptorSets>(header);
+				BindDescriptorSets(cmd.layout, cmd.first_set, cmd.sets_count, cmd.sets, cmd.dynamic_offset_count, cmd.dynamic_offsets);
+				break;
+			}
+			case CommandType::SET_VIEWPORT:
+			{
+				auto& cmd = As<command::SetViewport>(header);
+				SetViewport(cmd.x, cmd.y, cmd.width, cmd.height, cmd.min_depth, cmd.max_depth);
+				break;
+			}
+			case CommandType::SET_SCISSOR:
+			{
+				auto& cmd = As<command::SetScissor>(header);
+				SetScissor(cmd.offset_x, cmd.offset_y, cmd.width, cmd.height);
+				break;
+			}
+			case CommandType::DRAW:
+			{
+				auto& cmd = As<command::Draw>(header);
+				Draw(cmd.vertex_count, cmd.instance_count, cmd.first_vertex, cmd.first_instance);
+				break;
+			}
+			case CommandType::DRAW_INDEXED:
+			{
+				auto& cmd = As<command::DrawIndexed>(header);
+				DrawIndexed(cmd.index_count, cmd.instance_count, cmd.first_index, cmd.offset, cmd.first_instance);
+				break;
+			}
+			case CommandType::BUFFER_BARRIER:
+				BufferBarrier(As<command::BufferBarrier>(header).desc);
+				break;
+			case CommandType::RESET_QUERY_POOL:
+			{
+				auto& cmd = As<command::ResetQueryPool>(header);
+				ResetQueryPool(cmd.pool, cmd.first_query, cmd.query_count);
+				break;
+			}
+			case CommandType::WRITE_TIMESTAMP:
+			{
+				auto& cmd = As<command::WriteTimestamp>(header);
+				WriteTimestamp(cmd.pool, cmd.query);
+				break;
+			}
+			case CommandType::IMGUI_RENDER_DRAW_DATA:
+				ImGui_RenderDrawData(As<command::ImGuiRenderDrawData>(header).draw_data);
+				break;
+			case CommandType::BEGIN_MARKER:
+				BeginMarker(As<command::BeginMarker>(header).name);
+				break;
+			case CommandType::END_MARKER:
+				EndMarker();
+				break;
+			case CommandType::EXECUTE_LIST:
+				ExecuteList(*As<command::ExecuteList>(header).list);
+				break;
+			case CommandType::EXECUTE_SECONDARY:
+			{
+				auto& cmd = As<command::ExecuteSecondary>(header);
+				ExecuteSecondary(*cmd.secondary, *cmd.list, *cmd.pass, cmd.subpass, cmd.record);
+				break;
+			}
+			default:
+				assert(false && "unknown command");
+				break;
+			}
+		}
+	}
+
+	void CommandList::Reset()
+	{
+		arena_.Reset();
+		head_ = nullptr;
+		tail_ = nullptr;
+		command_count_ = 0;
+	}
+
+	void CommandList::Truncate(const CommandHeader* last)
+	{
+		for (const CommandHeader* header = last ? last->next : head_; header; header = header->next)
+		{
+			command_count_--;
+		}
+		if (!last)
+		{
+			head_ = nullptr;
+			tail_ = nullptr;
+			return;
+		}
+		tail_ = const_cast<CommandHeader*>(last);
+		tail_->next = nullptr;
+	}
+}
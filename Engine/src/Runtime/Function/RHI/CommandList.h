@@ -0,0 +1,276 @@
+#pragma once
+#include "CommandBuffer.h"
+#include "Runtime/Platform/Memory/Memory.h"
+
+namespace rhi {
+	enum class CommandType : uint8_t
+	{
+		BEGIN_RENDER_PASS = 0,
+		END_RENDER_PASS,
+		NEXT_SUBPASS,
+		BIND_GFX_PIPELINE,
+		BIND_VERTEX_BUFFERS,
+		BIND_INDEX_BUFFER,
+		BIND_DESCRIPTOR_SETS,
+		SET_VIEWPORT,
+		SET_SCISSOR,
+		DRAW,
+		DRAW_INDEXED,
+		BUFFER_BARRIER,
+		RESET_QUERY_POOL,
+		WRITE_TIMESTAMP,
+		IMGUI_RENDER_DRAW_DATA,
+		// brackets the commands of a render graph pass for the RHIStats
+		BEGIN_MARKER,
+		END_MARKER,
+		// the commands of another list, in place
+		EXECUTE_LIST,
+		// the commands of another list, recorded into a secondary command buffer
+		EXECUTE_SECONDARY
+	};
+
+	class CommandList;
+
+	// Commands are plain structs placed back to back in the list's arena, each one starts with its header
+	struct CommandHeader
+	{
+		CommandType type;
+		CommandHeader* next = nullptr;
+	};
+
+	namespace command {
+		struct BeginRenderPass		{ static constexpr CommandType TYPE = CommandType::BEGIN_RENDER_PASS; CommandHeader header; RenderPass* pass; RenderTarget* render_target; SubpassContents contents; };
+		struct EndRenderPass		{ static constexpr CommandType TYPE = CommandType::END_RENDER_PASS; CommandHeader header; };
+		struct NextSubpass			{ static constexpr CommandType TYPE = CommandType::NEXT_SUBPASS; CommandHeader header; };
+		struct BindGfxPipeline		{ static constexpr CommandType TYPE = CommandType::BIND_GFX_PIPELINE; CommandHeader header; RHIPipeline* pipeline; };
+		struct BindVertexBuffers
+		{
+			static constexpr CommandType TYPE = CommandType::BIND_VERTEX_BUFFERS;
+			CommandHeader header;
+			uint32_t first_binding;
+			uint32_t binding_count;
+			RHIBuffer** buffers;
+			uint64_t* offsets;
+		};
+		struct BindIndexBuffer		{ static constexpr CommandType TYPE = CommandType::BIND_INDEX_BUFFER; CommandHeader header; RHIBuffer* buffer; uint64_t offset; };
+		struct BindDescriptorSets
+		{
+			static constexpr CommandType TYPE = CommandType::BIND_DESCRIPTOR_SETS;
+			CommandHeader header;
+			PipelineLayout* layout;
+			uint32_t first_set;
+			uint32_t sets_count;
+			DescriptorSet** sets;
+			uint32_t dynamic_offset_count;
+			uint32_t* dynamic_offsets;
+		};
+		struct SetViewport			{ static constexpr CommandType TYPE = CommandType::SET_VIEWPORT; CommandHeader header; float x, y, width, height, min_depth, max_depth; };
+		struct SetScissor			{ static constexpr CommandType TYPE = CommandType::SET_SCISSOR; CommandHeader header; int32_t offset_x, offset_y; uint32_t width, height; };
+		struct Draw					{ static constexpr CommandType TYPE = CommandType::DRAW; CommandHeader header; uint32_t vertex_count, instance_count, first_vertex, first_instance; };
+		struct DrawIndexed			{ static constexpr CommandType TYPE = CommandType::DRAW_INDEXED; CommandHeader header; uint32_t index_count, instance_count, first_index; int32_t offset; uint32_t first_instance; };
+		struct BufferBarrier		{ static constexpr CommandType TYPE = CommandType::BUFFER_BARRIER; CommandHeader header; BufferBarrierDesc desc; };
+		struct ResetQueryPool		{ static constexpr CommandType TYPE = CommandType::RESET_QUERY_POOL; CommandHeader header; QueryPool* pool; uint32_t first_query, query_count; };
+		struct WriteTimestamp		{ static constexpr CommandType TYPE = CommandType::WRITE_TIMESTAMP; CommandHeader header; QueryPool* pool; uint32_t query; };
+		struct ImGuiRenderDrawData	{ static constexpr CommandType TYPE = CommandType::IMGUI_RENDER_DRAW_DATA; CommandHeader header; ImDrawData* draw_data; };
+		struct BeginMarker			{ static constexpr CommandType TYPE = CommandType::BEGIN_MARKER; CommandHeader header; const char* name; };
+		struct EndMarker			{ static constexpr CommandType TYPE = CommandType::END_MARKER; CommandHeader header; };
+		struct ExecuteList			{ static constexpr CommandType TYPE = CommandType::EXECUTE_LIST; CommandHeader header; const CommandList* list; };
+		struct ExecuteSecondary
+		{
+			static constexpr CommandType TYPE = CommandType::EXECUTE_SECONDARY;
+			CommandHeader header;
+			SecondaryCommandBuffer* secondary;
+			CommandList* list;
+			RenderPass* pass;
+			uint32_t subpass;
+			bool record;
+		};
+	}
+
+	/// <summary>
+	/// Graphics commands recorded into an arena instead of a native command buffer. Recording is a bump allocation and a few stores,
+	/// it needs no backend object, so any thread can record its own list. Translate() replays the list into a command buffer,
+	/// skipping binds of state that is already bound and merging consecutive barriers into one.
+	/// Pointers and arrays are copied, what they point at has to live until the list is translated.
+	/// A list has one writer at a time and is reset by the owner once it has been translated.
+	/// </summary>
+	class CommandList
+	{
+	public:
+		static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+		explicit CommandList(size_t block_size = DEFAULT_BLOCK_SIZE)
+			:arena_(block_size) {};
+
+		CommandList(CommandList const&) = delete;
+		CommandList& operator=(CommandList const&) = delete;
+
+		inline void BeginRenderPass(RenderPass& pass, RenderTarget& render_target, SubpassContents contents = SubpassContents::INLINE)
+		{
+			auto* cmd = Push<command::BeginRenderPass>();
+			cmd->pass = &pass;
+			cmd->render_target = &render_target;
+			cmd->contents = contents;
+		};
+		inline void EndRenderPass() { Push<command::EndRenderPass>(); };
+		inline void NextSubpass() { Push<command::NextSubpass>(); };
+
+		inline void BindGfxPipeline(RHIPipeline* pipeline) { Push<command::BindGfxPipeline>()->pipeline = pipeline; };
+		inline void BindVertexBuffers(uint32_t first_binding, uint32_t binding_count, RHIBuffer** buffers, uint64_t* offsets)
+		{
+			auto* cmd = Push<command::BindVertexBuffers>();
+			cmd->first_binding = first_binding;
+			cmd->binding_count = binding_count;
+			cmd->buffers = Copy(buffers, binding_count);
+			cmd->offsets = offsets ? Copy(offsets, binding_count) : nullptr;
+		};
+		inline void BindIndexBuffer(RHIBuffer* index_buffer, uint64_t offset)
+		{
+			auto* cmd = Push<command::BindIndexBuffer>();
+			cmd->buffer = index_buffer;
+			cmd->offset = offset;
+		};
+		inline void BindDescriptorSets(PipelineLayout* layout, uint32_t first_set, uint32_t sets_count, DescriptorSet** sets, uint32_t dynamic_offset_count, const uint32_t* dynamic_offsets)
+		{
+			auto* cmd = Push<command::BindDescriptorSets>();
+			cmd->layout = layout;
+			cmd->first_set = first_set;
+			cmd->sets_count = sets_count;
+			cmd->sets = Copy(sets, sets_count);
+			cmd->dynamic_offset_count = dynamic_offset_count;
+			cmd->dynamic_offsets = dynamic_offset_count ? Copy(dynamic_offsets, dynamic_offset_count) : nullptr;
+		};
+
+		inline void SetViewport(float x, float y, float width, float height, float min_depth, float max_depth)
+		{
+			auto* cmd = Push<command::SetViewport>();
+			cmd->x = x;
+			cmd->y = y;
+			cmd->width = width;
+			cmd->height = height;
+			cmd->min_depth = min_depth;
+			cmd->max_depth = max_depth;
+		};
+		inline void SetScissor(int32_t offset_x, int32_t offset_y, uint32_t width, uint32_t height)
+		{
+			auto* cmd = Push<command::SetScissor>();
+			cmd->offset_x = offset_x;
+			cmd->offset_y = offset_y;
+			cmd->width = width;
+			cmd->height = height;
+		};
+
+		inline void Draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance)
+		{
+			auto* cmd = Push<command::Draw>();
+			cmd->vertex_count = vertex_count;
+			cmd->instance_count = instance_count;
+			cmd->first_vertex = first_vertex;
+			cmd->first_instance = first_instance;
+		};
+		inline void DrawIndexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t offset, uint32_t first_instance)
+		{
+			auto* cmd = Push<command::DrawIndexed>();
+			cmd->index_count = index_count;
+			cmd->instance_count = instance_count;
+			cmd->first_index = first_index;
+			cmd->offset = offset;
+			cmd->first_instance = first_instance;
+		};
+
+		// Must be recorded outside of a render pass
+		inline void BufferBarrier(const BufferBarrierDesc& desc) { Push<command::BufferBarrier>()->desc = desc; };
+
+		// Must be recorded outside of a render pass
+		inline void ResetQueryPool(QueryPool* pool, uint32_t first_query, uint32_t query_count)
+		{
+			auto* cmd = Push<command::ResetQueryPool>();
+			cmd->pool = pool;
+			cmd->first_query = first_query;
+			cmd->query_count = query_count;
+		};
+		inline void WriteTimestamp(QueryPool* pool, uint32_t query)
+		{
+			auto* cmd = Push<command::WriteTimestamp>();
+			cmd->pool = pool;
+			cmd->query = query;
+		};
+
+		// The draw data belongs to ImGui, the list has to be translated before the next ImGui frame
+		inline void ImGui_RenderDrawData(ImDrawData* draw_data) { Push<command::ImGuiRenderDrawData>()->draw_data = draw_data; };
+
+		// The name has to outlive the translation
+		inline void BeginMarker(const char* name) { Push<command::BeginMarker>()->name = name; };
+		inline void EndMarker() { Push<command::EndMarker>(); };
+
+		// The other list is translated as if its commands were recorded here, it has to live until this one is translated
+		inline void ExecuteList(const CommandList& list) { Push<command::ExecuteList>()->list = &list; };
+		// The only command of a subpass begun with SubpassContents::SECONDARY_COMMAND_BUFFERS. With record, or once the secondary
+		// can't be executed anymore, the translation records the commands of list into it first, otherwise it executes
+		// what it was recorded with last. The list has to live until this one is translated
+		inline void ExecuteSecondary(SecondaryCommandBuffer& secondary, CommandList& list, RenderPass& pass, uint32_t subpass, bool record)
+		{
+			assert(&list != this && "a command list can't be recorded into a secondary command buffer it executes");
+			auto* cmd = Push<command::ExecuteSecondary>();
+			cmd->secondary = &secondary;
+			cmd->list = &list;
+			cmd->pass = &pass;
+			cmd->subpass = subpass;
+			cmd->record = record;
+		};
+		// Records copies of the commands from first to the end of their list, e.g. to keep a part of a frame's list for later frames.
+		// The arrays are copied too, the objects they point at are not
+		void AppendCopy(const CommandHeader* first);
+
+		// Replays everything recorded into the graphics encoder of the command buffer, which must be recording
+		void Translate(CommandBuffer& cmd_buffer);
+		// Everything recorded so far is dropped, the memory is kept
+		void Reset();
+		// The commands recorded after last are dropped, all of them if last is null. Their memory is only reused after Reset
+		void Truncate(const CommandHeader* last);
+
+		inline bool IsEmpty() const { return head_ == nullptr; };
+		// Commands are walked through CommandHeader::next, the type tells which command::X a header starts
+		inline const CommandHeader* GetFirstCommand() const { return head_; };
+		inline const CommandHeader* GetLastCommand() const { return tail_; };
+		inline uint32_t GetCommandCount() const { return command_count_; };
+		inline size_t GetUsedBytes() const { return arena_.GetUsedBytes(); };
+	private:
+		template<typename Encoder>
+		void TranslateInto(Encoder& encoder);
+		// Records everything into the secondary command buffer for the subpass of the pass, and keeps what it counted
+		void Translate(SecondaryCommandBuffer& secondary, RenderPass& pass, uint32_t subpass);
+
+		template<typename Command>
+		Command* Push()
+		{
+			Command* cmd = arena_.New<Command>();
+			cmd->header.type = Command::TYPE;
+			if (tail_)
+				tail_->next = &cmd->header;
+			else
+				head_ = &cmd->header;
+			tail_ = &cmd->header;
+			command_count_++;
+			return cmd;
+		}
+
+		template<typename T>
+		T* Copy(const T* data, uint32_t count)
+		{
+			T* copy = static_cast<T*>(arena_.Allocate(sizeof(T) * count, alignof(T)));
+			std::copy(data, data + count, copy);
+			return copy;
+		}
+
+		engine::LinearArena arena_;
+		CommandHeader* head_ = nullptr;
+		CommandHeader* tail_ = nullptr;
+		uint32_t command_count_ = 0;
+
+		// consecutive barriers are gathered here and recorded together
+		std::vector<BufferBarrierDesc> pending_barriers_;
+		// where the translation goes on once the list of an EXECUTE_LIST is done
+		std::vector<const CommandHeader*> return_to_;
+	};
+}
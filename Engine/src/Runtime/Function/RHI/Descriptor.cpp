@@ -2,7 +2,9 @@
 #include "Descriptor.h"
 
 #include "RHI.h"
+#include "FrameCapture.h"
 #include "Runtime/Platform/Vulkan/VulkanDescriptor.h"
+#include "Runtime/Platform/Null/NullDescriptor.h"
 
 namespace rhi {
 	bool DescriptorLayoutDesc::operator==(const DescriptorLayoutDesc& other) const 
@@ -74,26 +76,39 @@ namespace rhi {
 
 	DescriptorSetLayoutRef DescriptorSetLayoutBuilder::Build()
 	{
-		return cache_->CreateDescriptorLayout(current_desc_);
+		return BuildFromDesc(current_desc_);
 	}
 
 	DescriptorSetLayoutRef DescriptorSetLayoutBuilder::BuildFromDesc(const DescriptorLayoutDesc& in_desc)
 	{
-		return cache_->CreateDescriptorLayout(in_desc);
+		DescriptorSetLayoutRef layout = cache_->CreateDescriptorLayout(in_desc);
+		if (layout)
+			FrameCapture::OnCreateDescriptorSetLayout(*layout, in_desc);
+		return layout;
 	}
 	// -----------------------------------------------------------------------------
 
 	DescriptorWriter& DescriptorWriter::Begin(DescriptorAllocator* allocator)
 	{
+		FrameCapture::OnBeginDescriptorWrites();
 		switch (RHI::GetAPI())
 		{
 		case RHI::GfxAPI::None:
 			assert(false && "Need to select a RendererAPI!"); break;
 		case RHI::GfxAPI::Vulkan:
+		{
 			VulkanDescriptorAllocator* vk_allocator = static_cast<VulkanDescriptorAllocator*>(allocator);
 			static VulkanDescriptorWriter builder(vk_allocator);
 			builder.writes_.clear();
 			return builder;
 		}
+		case RHI::GfxAPI::Null:
+		{
+			static NullDescriptorWriter null_builder(nullptr);
+			null_builder.alloc_ = static_cast<NullDescriptorAllocator*>(allocator);
+			null_builder.writes_.clear();
+			return null_builder;
+		}
+		}
 	};
 }
\ No newline at end of file
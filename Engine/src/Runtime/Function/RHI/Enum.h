@@ -31,6 +31,18 @@ enum class TextureUsage : uint8_t
 };
 ENUM_CLASS_FLAGS(TextureUsage)
 
+// How a pass accesses a buffer
+enum class BufferUsage : uint8_t
+{
+    NONE = 0x0,
+    UNIFORM = 0x1,
+    STORAGE = 0x2,
+    INDIRECT = 0x4,
+    VERTEX = 0x8,
+    INDEX = 0x10,
+};
+ENUM_CLASS_FLAGS(BufferUsage)
+
 
 enum DescriptorType {
     DESCRIPTOR_TYPE_SAMPLER = 0,
@@ -63,6 +75,18 @@ enum class MemoryUsage : uint8_t
 #endif
 };
 
+// What an allocation is used for, only drives memory statistics
+enum class MemoryCategory : uint8_t
+{
+    BUFFER = 0,
+    STAGING = 1,
+    IMPORTED_TEXTURE = 2,
+    RENDER_GRAPH_TRANSIENT = 3,
+    // both instances of the render graph's history resources, they live across frames
+    RENDER_GRAPH_HISTORY = 4,
+    COUNT
+};
+
 enum class ResourceTypes : uint32_t
 {
     RESOURCE_TYPE_NONE = 0,
@@ -80,8 +104,9 @@ enum class ResourceTypes : uint32_t
     RESOURCE_TYPE_STORAGE_BUFFER_DYNAMIC = 0x00000060,
 #ifdef USE_VULKAN
     RESOURCE_TYPE_COMBINED_IMAGE_SAMPLER = 0x00000070,
-    RESOURCE_TYPE_INPUT_ATTACHMENT = 0x0000080
+    RESOURCE_TYPE_INPUT_ATTACHMENT = 0x0000080,
 #endif
+    RESOURCE_TYPE_INDIRECT_BUFFER = 0x00000100
 };
 ENUM_CLASS_FLAGS(ResourceTypes)
 
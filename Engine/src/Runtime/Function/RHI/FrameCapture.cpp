@@ -0,0 +1,495 @@
+#include "mlepch.h"
+#include "FrameCapture.h"
+#include "CommandList.h"
+#include <fstream>
+
+namespace rhi {
+	namespace {
+		template<typename Command>
+		inline const Command& As(const CommandHeader* header)
+		{
+			return *reinterpret_cast<const Command*>(header);
+		}
+	}
+
+	void FrameCapture::Start(const std::string& file_path, uint32_t first_frame, uint32_t frame_count)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		assert(!is_capturing_ && "a capture is already running");
+		file_path_ = file_path;
+		first_frame_ = first_frame;
+		frame_count_ = std::max(frame_count, 1u);
+		frame_index_ = 0;
+		captured_frame_count_ = 0;
+		is_frame_captured_ = false;
+		header_ = {};
+		ids_.clear();
+		next_id_ = INVALID_CAPTURE_ID + 1;
+		stream_.Clear();
+		pending_writes_.clear();
+		is_capturing_ = true;
+		MLE_CORE_INFO("[Capture] capturing frames {0} to {1} into {2}", first_frame_, first_frame_ + frame_count_ - 1, file_path_);
+	}
+
+	void FrameCapture::Stop()
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		if (!is_capturing_)
+			return;
+		if (captured_frame_count_ < frame_count_)
+			MLE_CORE_WARN("[Capture] stopped after {0} of {1} frames", captured_frame_count_, frame_count_);
+		Finish();
+	}
+
+	void FrameCapture::BeginFrame()
+	{
+		if (!IsCapturing())
+			return;
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		is_frame_captured_ = frame_index_ >= first_frame_;
+		if (!is_frame_captured_)
+			return;
+		chunk_.Clear();
+		Commit(CaptureChunk::BEGIN_FRAME);
+	}
+
+	void FrameCapture::EndFrame(uint32_t viewport_width, uint32_t viewport_height)
+	{
+		if (!IsCapturing())
+			return;
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		++frame_index_;
+		if (!is_frame_captured_)
+			return;
+		is_frame_captured_ = false;
+
+		if (captured_frame_count_ == 0)
+		{
+			header_.viewport_width = viewport_width;
+			header_.viewport_height = viewport_height;
+		}
+		chunk_.Clear();
+		Commit(CaptureChunk::END_FRAME);
+		if (++captured_frame_count_ == frame_count_)
+			Finish();
+	}
+
+	void FrameCapture::RecordCreateBuffer(const RHIBuffer& buffer, const RHIBuffer::Descriptor& desc)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(AssignId(&buffer));
+		chunk_.Write(desc);
+		Commit(CaptureChunk::CREATE_BUFFER);
+	}
+
+	void FrameCapture::RecordBufferData(const RHIBuffer& buffer, const void* data, uint64_t size, uint64_t offset)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(GetId(&buffer));
+		chunk_.Write(offset);
+		chunk_.Write(size);
+		chunk_.WriteBytes(data, size);
+		Commit(CaptureChunk::BUFFER_DATA);
+	}
+
+	void FrameCapture::RecordCreateTexture(const RHITexture& texture, const RHITexture::Descriptor& desc)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(AssignId(&texture));
+		chunk_.Write(desc);
+		Commit(CaptureChunk::CREATE_TEXTURE);
+	}
+
+	void FrameCapture::RecordResizeTexture(const RHITexture& texture, uint32_t width, uint32_t height)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(GetId(&texture));
+		chunk_.Write(width);
+		chunk_.Write(height);
+		Commit(CaptureChunk::RESIZE_TEXTURE);
+	}
+
+	void FrameCapture::RecordCreateShaderModule(const ShaderModule& shader, const char* path)
+	{
+		std::ifstream file(path, std::ios::ate | std::ios::binary);
+		if (!file.is_open())
+		{
+			// the null backend replays it all the same
+			MLE_CORE_WARN("[Capture] can't read {0}, the shader is captured without code", path);
+			RecordCreateShaderModule(shader, nullptr, 0);
+			return;
+		}
+		std::vector<char> code(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(code.data(), code.size());
+		RecordCreateShaderModule(shader, code.data(), code.size());
+	}
+
+	void FrameCapture::RecordCreateShaderModule(const ShaderModule& shader, const void* code, size_t size)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(AssignId(&shader));
+		chunk_.Write(static_cast<uint64_t>(size));
+		chunk_.WriteBytes(code, size);
+		Commit(CaptureChunk::CREATE_SHADER_MODULE);
+	}
+
+	void FrameCapture::RecordCreatePipelineLayout(const PipelineLayout& layout, const PipelineLayout::Descriptor& desc)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(AssignId(&layout));
+		chunk_.Write(desc.set_layout_count);
+		for (uint32_t i = 0; i < desc.set_layout_count; ++i)
+		{
+			chunk_.Write(GetId(desc.layouts[i]));
+		}
+		chunk_.Write(desc.push_constant_count);
+		Commit(CaptureChunk::CREATE_PIPELINE_LAYOUT);
+	}
+
+	void FrameCapture::RecordCreatePipeline(const RHIPipeline& pipeline, const RHIPipeline::Descriptor& desc)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(AssignId(&pipeline));
+		chunk_.Write(desc.topology);
+		chunk_.Write(GetId(desc.render_pass));
+		chunk_.Write(GetId(desc.layout));
+		chunk_.Write(GetId(desc.vert_shader));
+		chunk_.Write(GetId(desc.frag_shader));
+		chunk_.Write(desc.use_vertex_attribute);
+		chunk_.Write(desc.subpass);
+		Commit(CaptureChunk::CREATE_PIPELINE);
+	}
+
+	void FrameCapture::RecordCreateRenderPass(const RenderPass& pass, const RenderPass::Descriptor& desc)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(AssignId(&pass));
+		chunk_.Write(desc.is_for_present);
+		chunk_.Write(static_cast<uint32_t>(desc.attachments.size()));
+		for (auto const& attachment : desc.attachments)
+		{
+			chunk_.Write(attachment);
+		}
+		chunk_.Write(static_cast<uint32_t>(desc.subpasses.size()));
+		for (auto const& subpass : desc.subpasses)
+		{
+			chunk_.Write(static_cast<uint32_t>(subpass.color_attachments.size()));
+			chunk_.WriteBytes(subpass.color_attachments.data(), subpass.color_attachments.size() * sizeof(uint32_t));
+			chunk_.Write(static_cast<uint32_t>(subpass.input_attachments.size()));
+			chunk_.WriteBytes(subpass.input_attachments.data(), subpass.input_attachments.size() * sizeof(uint32_t));
+			chunk_.Write(static_cast<uint32_t>(subpass.dependencies.size()));
+			for (size_t dependency : subpass.dependencies)
+			{
+				chunk_.Write(static_cast<uint64_t>(dependency));
+			}
+			chunk_.Write(subpass.use_depth_stencil);
+		}
+		Commit(CaptureChunk::CREATE_RENDER_PASS);
+	}
+
+	void FrameCapture::RecordCreateRenderTarget(const RenderTarget& render_target, const RenderTarget::Descriptor& desc)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(AssignId(&render_target));
+		chunk_.Write(GetId(desc.pass));
+		chunk_.Write(desc.width);
+		chunk_.Write(desc.height);
+		chunk_.Write(desc.clear_value);
+		chunk_.Write(static_cast<uint32_t>(desc.attachments.size()));
+		for (RHITexture* attachment : desc.attachments)
+		{
+			chunk_.Write(GetId(attachment));
+		}
+		Commit(CaptureChunk::CREATE_RENDER_TARGET);
+	}
+
+	void FrameCapture::RecordCreateDescriptorSetLayout(const DescriptorSetLayout& layout, const DescriptorLayoutDesc& desc)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		// the cache hands out the same layout for the same bindings, once is enough
+		if (GetId(&layout) != INVALID_CAPTURE_ID)
+			return;
+		chunk_.Clear();
+		chunk_.Write(AssignId(&layout));
+		chunk_.Write(static_cast<uint32_t>(desc.bindings.size()));
+		for (auto const& binding : desc.bindings)
+		{
+			chunk_.Write(binding);
+		}
+		Commit(CaptureChunk::CREATE_DESCRIPTOR_SET_LAYOUT);
+	}
+
+	void FrameCapture::RecordCreateDescriptorSet(const DescriptorSet& set)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(AssignId(&set));
+		Commit(CaptureChunk::CREATE_DESCRIPTOR_SET);
+	}
+
+	void FrameCapture::RecordAllocateDescriptorSet(const DescriptorSet& set, const DescriptorSetLayout& layout)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(GetId(&set));
+		chunk_.Write(GetId(&layout));
+		Commit(CaptureChunk::ALLOCATE_DESCRIPTOR_SET);
+	}
+
+	void FrameCapture::RecordBeginDescriptorWrites()
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		pending_writes_.clear();
+	}
+
+	void FrameCapture::RecordDescriptorWrite(uint32_t binding, DescriptorType type, const RHIBuffer* buffer, const RHITexture* image)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		pending_writes_.push_back({ binding, type, GetId(buffer), GetId(image) });
+	}
+
+	void FrameCapture::RecordWriteDescriptorSet(const DescriptorSet& set)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(GetId(&set));
+		chunk_.Write(static_cast<uint32_t>(pending_writes_.size()));
+		for (auto const& write : pending_writes_)
+		{
+			chunk_.Write(write);
+		}
+		Commit(CaptureChunk::WRITE_DESCRIPTOR_SET);
+	}
+
+	void FrameCapture::RecordCopyBufferToBuffer(const CopyBufferToBufferDesc& desc)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(GetId(desc.src));
+		chunk_.Write(desc.src_offset);
+		chunk_.Write(GetId(desc.dst));
+		chunk_.Write(desc.dst_offset);
+		chunk_.Write(desc.size);
+		Commit(CaptureChunk::COPY_BUFFER_TO_BUFFER);
+	}
+
+	void FrameCapture::RecordCopyBufferToImage(const RHIBuffer& buffer, const RHITexture& image, uint32_t width, uint32_t height, uint32_t layer_count)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		chunk_.Clear();
+		chunk_.Write(GetId(&buffer));
+		chunk_.Write(GetId(&image));
+		chunk_.Write(width);
+		chunk_.Write(height);
+		chunk_.Write(layer_count);
+		Commit(CaptureChunk::COPY_BUFFER_TO_IMAGE);
+	}
+
+	void FrameCapture::RecordCommands(const CommandList& command_list)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		if (!is_frame_captured_)
+			return;
+
+		// the command types are kept, pointers become ids and arrays are written inline
+		chunk_.Clear();
+		uint32_t command_count = 0;
+		chunk_.Write(command_count);
+		WriteCommands(command_list.GetFirstCommand(), command_count);
+		chunk_.WriteAt(0, command_count);
+		Commit(CaptureChunk::COMMANDS);
+	}
+
+	void FrameCapture::WriteCommands(const CommandHeader* first, uint32_t& command_count)
+	{
+		for (const CommandHeader* header = first; header; header = header->next)
+		{
+			switch (header->type)
+			{
+			case CommandType::RESET_QUERY_POOL:
+			case CommandType::WRITE_TIMESTAMP:
+			case CommandType::IMGUI_RENDER_DRAW_DATA:
+				continue;
+			case CommandType::EXECUTE_LIST:
+				// written flat, the replay doesn't know which commands were cached
+				WriteCommands(As<command::ExecuteList>(header).list->GetFirstCommand(), command_count);
+				continue;
+			case CommandType::EXECUTE_SECONDARY:
+				// the subpass is begun with inline contents by the replay
+				WriteCommands(As<command::ExecuteSecondary>(header).list->GetFirstCommand(), command_count);
+				continue;
+			default:
+				break;
+			}
+
+			chunk_.Write(header->type);
+			++command_count;
+			switch (header->type)
+			{
+			case CommandType::BEGIN_RENDER_PASS:
+			{
+				auto& cmd = As<command::BeginRenderPass>(header);
+				chunk_.Write(GetId(cmd.pass));
+				chunk_.Write(GetId(cmd.render_target));
+				break;
+			}
+			case CommandType::BIND_GFX_PIPELINE:
+				chunk_.Write(GetId(As<command::BindGfxPipeline>(header).pipeline));
+				break;
+			case CommandType::BIND_VERTEX_BUFFERS:
+			{
+				auto& cmd = As<command::BindVertexBuffers>(header);
+				chunk_.Write(cmd.first_binding);
+				chunk_.Write(cmd.binding_count);
+				for (uint32_t i = 0; i < cmd.binding_count; ++i)
+				{
+					chunk_.Write(GetId(cmd.buffers[i]));
+					chunk_.Write(cmd.offsets ? cmd.offsets[i] : uint64_t(0));
+				}
+				break;
+			}
+			case CommandType::BIND_INDEX_BUFFER:
+			{
+				auto& cmd = As<command::BindIndexBuffer>(header);
+				chunk_.Write(GetId(cmd.buffer));
+				chunk_.Write(cmd.offset);
+				break;
+			}
+			case CommandType::BIND_DESCRIPTOR_SETS:
+			{
+				auto& cmd = As<command::BindDescriptorSets>(header);
+				chunk_.Write(GetId(cmd.layout));
+				chunk_.Write(cmd.first_set);
+				chunk_.Write(cmd.sets_count);
+				for (uint32_t i = 0; i < cmd.sets_count; ++i)
+				{
+					chunk_.Write(GetId(cmd.sets[i]));
+				}
+				chunk_.Write(cmd.dynamic_offset_count);
+				chunk_.WriteBytes(cmd.dynamic_offsets, cmd.dynamic_offset_count * sizeof(uint32_t));
+				break;
+			}
+			case CommandType::SET_VIEWPORT:
+			{
+				auto& cmd = As<command::SetViewport>(header);
+				const float viewport[] = { cmd.x, cmd.y, cmd.width, cmd.height, cmd.min_depth, cmd.max_depth };
+				chunk_.Write(viewport);
+				break;
+			}
+			case CommandType::SET_SCISSOR:
+			{
+				auto& cmd = As<command::SetScissor>(header);
+				chunk_.Write(cmd.offset_x);
+				chunk_.Write(cmd.offset_y);
+				chunk_.Write(cmd.width);
+				chunk_.Write(cmd.height);
+				break;
+			}
+			case CommandType::DRAW:
+			{
+				auto& cmd = As<command::Draw>(header);
+				chunk_.Write(cmd.vertex_count);
+				chunk_.Write(cmd.instance_count);
+				chunk_.Write(cmd.first_vertex);
+				chunk_.Write(cmd.first_instance);
+				break;
+			}
+			case CommandType::DRAW_INDEXED:
+			{
+				auto& cmd = As<command::DrawIndexed>(header);
+				chunk_.Write(cmd.index_count);
+				chunk_.Write(cmd.instance_count);
+				chunk_.Write(cmd.first_index);
+				chunk_.Write(cmd.offset);
+				chunk_.Write(cmd.first_instance);
+				break;
+			}
+			case CommandType::BUFFER_BARRIER:
+			{
+				auto& desc = As<command::BufferBarrier>(header).desc;
+				chunk_.Write(GetId(desc.buffer));
+				chunk_.Write(desc.src_usage);
+				chunk_.Write(desc.src_write);
+				chunk_.Write(desc.dst_usage);
+				chunk_.Write(desc.dst_write);
+				break;
+			}
+			case CommandType::BEGIN_MARKER:
+				chunk_.WriteString(As<command::BeginMarker>(header).name);
+				break;
+			case CommandType::END_RENDER_PASS:
+			case CommandType::NEXT_SUBPASS:
+			case CommandType::END_MARKER:
+			default:
+				break;
+			}
+		}
+	}
+
+	void FrameCapture::RecordFree(CaptureChunk chunk, const void* object)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		auto it = ids_.find(object);
+		if (it == ids_.end())
+			return;
+		chunk_.Clear();
+		chunk_.Write(it->second);
+		ids_.erase(it);
+		Commit(chunk);
+	}
+
+	CaptureId FrameCapture::AssignId(const void* object)
+	{
+		const CaptureId id = next_id_++;
+		ids_[object] = id;
+		return id;
+	}
+
+	CaptureId FrameCapture::GetId(const void* object) const
+	{
+		if (!object)
+			return INVALID_CAPTURE_ID;
+		auto it = ids_.find(object);
+		return it == ids_.end() ? INVALID_CAPTURE_ID : it->second;
+	}
+
+	void FrameCapture::Commit(CaptureChunk type)
+	{
+		stream_.Write(type);
+		stream_.Write(static_cast<uint32_t>(chunk_.GetSize()));
+		stream_.WriteBytes(chunk_.GetData().data(), chunk_.GetSize());
+	}
+
+	void FrameCapture::Finish()
+	{
+		is_capturing_ = false;
+		header_.frame_count = captured_frame_count_;
+
+		std::ofstream file(file_path_, std::ios::binary | std::ios::trunc);
+		if (file.is_open())
+		{
+			file.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+			file.write(reinterpret_cast<const char*>(stream_.GetData().data()), stream_.GetSize());
+			MLE_CORE_INFO("[Capture] {0} frames, {1} bytes written to {2}", captured_frame_count_, sizeof(header_) + stream_.GetSize(), file_path_);
+		}
+		else
+		{
+			MLE_CORE_ERROR("[Capture] can't write {0}", file_path_);
+		}
+
+		ids_.clear();
+		stream_.Clear();
+		chunk_.Clear();
+		pending_writes_.clear();
+	}
+}
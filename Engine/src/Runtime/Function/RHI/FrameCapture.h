@@ -0,0 +1,327 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include "Runtime/Core/Base/Singleton.h"
+#include "RHIResource.h"
+#include "Descriptor.h"
+#include "RenderPass.h"
+
+namespace rhi {
+	class CommandList;
+	struct CommandHeader;
+	struct CopyBufferToBufferDesc;
+
+	// After the header a capture file is a list of chunks: the type, the payload size in bytes and the payload
+	enum class CaptureChunk : uint8_t
+	{
+		CREATE_BUFFER = 0,
+		BUFFER_DATA,
+		FREE_BUFFER,
+		CREATE_TEXTURE,
+		RESIZE_TEXTURE,
+		FREE_TEXTURE,
+		// the spir-v is embedded, replaying doesn't need the asset folder
+		CREATE_SHADER_MODULE,
+		CREATE_DESCRIPTOR_SET_LAYOUT,
+		CREATE_PIPELINE_LAYOUT,
+		CREATE_PIPELINE,
+		FREE_PIPELINE,
+		CREATE_RENDER_PASS,
+		CREATE_RENDER_TARGET,
+		CREATE_DESCRIPTOR_SET,
+		ALLOCATE_DESCRIPTOR_SET,
+		WRITE_DESCRIPTOR_SET,
+		COPY_BUFFER_TO_BUFFER,
+		COPY_BUFFER_TO_IMAGE,
+		// everything before the first one sets the captured frames up
+		BEGIN_FRAME,
+		// the graphics commands of a frame in recording order, see FrameCapture::RecordCommands
+		COMMANDS,
+		END_FRAME
+	};
+
+	struct CaptureHeader
+	{
+		// "MLEC"
+		static constexpr uint32_t MAGIC = 0x43454C4D;
+		static constexpr uint32_t VERSION = 1;
+
+		uint32_t magic = MAGIC;
+		uint32_t version = VERSION;
+		// of the frames when they were captured, the replay renders at the same size
+		uint32_t viewport_width = 0;
+		uint32_t viewport_height = 0;
+		uint32_t frame_count = 0;
+	};
+
+	// Objects are numbered in the order the capture sees them created, ids are never reused
+	using CaptureId = uint32_t;
+	constexpr CaptureId INVALID_CAPTURE_ID = 0;
+
+	// Appends plain values to a byte stream, in the byte order of the machine
+	class CaptureWriter
+	{
+	public:
+		template<typename T>
+		void Write(const T& value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "only plain values can be written");
+			WriteBytes(&value, sizeof(T));
+		}
+		inline void WriteBytes(const void* data, size_t size)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			data_.insert(data_.end(), bytes, bytes + size);
+		}
+		// Written with its terminator, so the reader can hand out pointers into the stream
+		inline void WriteString(const char* string)
+		{
+			WriteBytes(string, strlen(string) + 1);
+		}
+
+		// Overwrites a value written before, for counts that are only known at the end
+		template<typename T>
+		void WriteAt(size_t offset, const T& value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "only plain values can be written");
+			assert(offset + sizeof(T) <= data_.size() && "writing past the end");
+			memcpy(data_.data() + offset, &value, sizeof(T));
+		}
+
+		inline const std::vector<uint8_t>& GetData() const { return data_; };
+		inline size_t GetSize() const { return data_.size(); };
+		inline void Clear() { data_.clear(); };
+	private:
+		std::vector<uint8_t> data_;
+	};
+
+	// Reads what a CaptureWriter wrote. Reading past the end yields zeros and marks the reader as failed
+	class CaptureReader
+	{
+	public:
+		CaptureReader() = default;
+		CaptureReader(const uint8_t* data, size_t size)
+			:data_(data), size_(size) {};
+
+		template<typename T>
+		T Read()
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "only plain values can be read");
+			T value{};
+			if (const uint8_t* bytes = ReadBytes(sizeof(T)))
+				memcpy(&value, bytes, sizeof(T));
+			return value;
+		}
+		// Points into the stream, nullptr if there aren't enough bytes left
+		inline const uint8_t* ReadBytes(size_t size)
+		{
+			if (size > size_ - offset_)
+			{
+				has_failed_ = true;
+				offset_ = size_;
+				return nullptr;
+			}
+			const uint8_t* bytes = data_ + offset_;
+			offset_ += size;
+			return bytes;
+		}
+		// Points into the stream, an empty string if it isn't terminated
+		inline const char* ReadString()
+		{
+			const uint8_t* end = static_cast<const uint8_t*>(memchr(data_ + offset_, '\0', size_ - offset_));
+			if (!end)
+			{
+				has_failed_ = true;
+				offset_ = size_;
+				return "";
+			}
+			return reinterpret_cast<const char*>(ReadBytes(end - (data_ + offset_) + 1));
+		}
+
+		inline bool IsAtEnd() const { return offset_ >= size_; };
+		inline bool HasFailed() const { return has_failed_; };
+		inline size_t GetOffset() const { return offset_; };
+		inline void Seek(size_t offset) { offset_ = std::min(offset, size_); };
+	private:
+		const uint8_t* data_ = nullptr;
+		size_t size_ = 0;
+		size_t offset_ = 0;
+		bool has_failed_ = false;
+	};
+
+	/// <summary>
+	/// Records what the engine asks of the RHI into a file the Replay tool executes again: resource creation, buffer contents,
+	/// descriptor writes, uploads and the graphics commands of a range of frames.
+	/// The backends call the On* hooks next to their RHIStats counters, the hooks return right away unless a capture is running.
+	/// Every object the frames use has to be seen being created, so a capture is started before the renderer is initialized.
+	/// Resources are recorded from then on, commands only for the frames [first_frame, first_frame + frame_count).
+	/// The file is written once the last of them has ended, or when the renderer shuts down.
+	/// ImGui draws and the GPU profiler's queries aren't recorded, they belong to the tools and not to the workload.
+	/// </summary>
+	class FrameCapture : public engine::Singleton<FrameCapture>
+	{
+		friend class engine::Singleton<FrameCapture>;
+	public:
+		void Start(const std::string& file_path, uint32_t first_frame, uint32_t frame_count);
+		// Writes what has been captured so far
+		void Stop();
+
+		static inline bool IsCapturing() { return GetInstance().is_capturing_.load(std::memory_order_relaxed); };
+
+		// Called by the renderer around every frame
+		void BeginFrame();
+		void EndFrame(uint32_t viewport_width, uint32_t viewport_height);
+
+		static inline void OnCreateBuffer(const RHIBuffer& buffer, const RHIBuffer::Descriptor& desc)
+		{
+			if (IsCapturing()) GetInstance().RecordCreateBuffer(buffer, desc);
+		};
+		static inline void OnBufferData(const RHIBuffer& buffer, const void* data, uint64_t size, uint64_t offset)
+		{
+			if (IsCapturing()) GetInstance().RecordBufferData(buffer, data, size, offset);
+		};
+		static inline void OnFreeBuffer(const RHIBuffer& buffer)
+		{
+			if (IsCapturing()) GetInstance().RecordFree(CaptureChunk::FREE_BUFFER, &buffer);
+		};
+		static inline void OnCreateTexture(const RHITexture& texture, const RHITexture::Descriptor& desc)
+		{
+			if (IsCapturing()) GetInstance().RecordCreateTexture(texture, desc);
+		};
+		static inline void OnResizeTexture(const RHITexture& texture, uint32_t width, uint32_t height)
+		{
+			if (IsCapturing()) GetInstance().RecordResizeTexture(texture, width, height);
+		};
+		static inline void OnFreeTexture(const RHITexture& texture)
+		{
+			if (IsCapturing()) GetInstance().RecordFree(CaptureChunk::FREE_TEXTURE, &texture);
+		};
+		// For backends that don't read the file themselves
+		static inline void OnCreateShaderModule(const ShaderModule& shader, const char* path)
+		{
+			if (IsCapturing()) GetInstance().RecordCreateShaderModule(shader, path);
+		};
+		static inline void OnCreateShaderModule(const ShaderModule& shader, const void* code, size_t size)
+		{
+			if (IsCapturing()) GetInstance().RecordCreateShaderModule(shader, code, size);
+		};
+		static inline void OnCreatePipelineLayout(const PipelineLayout& layout, const PipelineLayout::Descriptor& desc)
+		{
+			if (IsCapturing()) GetInstance().RecordCreatePipelineLayout(layout, desc);
+		};
+		static inline void OnCreatePipeline(const RHIPipeline& pipeline, const RHIPipeline::Descriptor& desc)
+		{
+			if (IsCapturing()) GetInstance().RecordCreatePipeline(pipeline, desc);
+		};
+		static inline void OnFreePipeline(const RHIPipeline& pipeline)
+		{
+			if (IsCapturing()) GetInstance().RecordFree(CaptureChunk::FREE_PIPELINE, &pipeline);
+		};
+		static inline void OnCreateRenderPass(const RenderPass& pass, const RenderPass::Descriptor& desc)
+		{
+			if (IsCapturing()) GetInstance().RecordCreateRenderPass(pass, desc);
+		};
+		static inline void OnCreateRenderTarget(const RenderTarget& render_target, const RenderTarget::Descriptor& desc)
+		{
+			if (IsCapturing()) GetInstance().RecordCreateRenderTarget(render_target, desc);
+		};
+		static inline void OnCreateDescriptorSetLayout(const DescriptorSetLayout& layout, const DescriptorLayoutDesc& desc)
+		{
+			if (IsCapturing()) GetInstance().RecordCreateDescriptorSetLayout(layout, desc);
+		};
+		static inline void OnCreateDescriptorSet(const DescriptorSet& set)
+		{
+			if (IsCapturing()) GetInstance().RecordCreateDescriptorSet(set);
+		};
+		static inline void OnAllocateDescriptorSet(const DescriptorSet& set, const DescriptorSetLayout& layout)
+		{
+			if (IsCapturing()) GetInstance().RecordAllocateDescriptorSet(set, layout);
+		};
+		// Writes are gathered until the writer writes the set
+		static inline void OnBeginDescriptorWrites()
+		{
+			if (IsCapturing()) GetInstance().RecordBeginDescriptorWrites();
+		};
+		static inline void OnDescriptorWrite(uint32_t binding, DescriptorType type, const RHIBuffer* buffer, const RHITexture* image)
+		{
+			if (IsCapturing()) GetInstance().RecordDescriptorWrite(binding, type, buffer, image);
+		};
+		static inline void OnWriteDescriptorSet(const DescriptorSet& set)
+		{
+			if (IsCapturing()) GetInstance().RecordWriteDescriptorSet(set);
+		};
+		static inline void OnCopyBufferToBuffer(const CopyBufferToBufferDesc& desc)
+		{
+			if (IsCapturing()) GetInstance().RecordCopyBufferToBuffer(desc);
+		};
+		static inline void OnCopyBufferToImage(const RHIBuffer& buffer, const RHITexture& image, uint32_t width, uint32_t height, uint32_t layer_count)
+		{
+			if (IsCapturing()) GetInstance().RecordCopyBufferToImage(buffer, image, width, height, layer_count);
+		};
+		static inline void OnTranslate(const CommandList& command_list)
+		{
+			if (IsCapturing()) GetInstance().RecordCommands(command_list);
+		};
+	private:
+		FrameCapture() = default;
+
+		void RecordCreateBuffer(const RHIBuffer& buffer, const RHIBuffer::Descriptor& desc);
+		void RecordBufferData(const RHIBuffer& buffer, const void* data, uint64_t size, uint64_t offset);
+		void RecordCreateTexture(const RHITexture& texture, const RHITexture::Descriptor& desc);
+		void RecordResizeTexture(const RHITexture& texture, uint32_t width, uint32_t height);
+		void RecordCreateShaderModule(const ShaderModule& shader, const char* path);
+		void RecordCreateShaderModule(const ShaderModule& shader, const void* code, size_t size);
+		void RecordCreatePipelineLayout(const PipelineLayout& layout, const PipelineLayout::Descriptor& desc);
+		void RecordCreatePipeline(const RHIPipeline& pipeline, const RHIPipeline::Descriptor& desc);
+		void RecordCreateRenderPass(const RenderPass& pass, const RenderPass::Descriptor& desc);
+		void RecordCreateRenderTarget(const RenderTarget& render_target, const RenderTarget::Descriptor& desc);
+		void RecordCreateDescriptorSetLayout(const DescriptorSetLayout& layout, const DescriptorLayoutDesc& desc);
+		void RecordCreateDescriptorSet(const DescriptorSet& set);
+		void RecordAllocateDescriptorSet(const DescriptorSet& set, const DescriptorSetLayout& layout);
+		void RecordBeginDescriptorWrites();
+		void RecordDescriptorWrite(uint32_t binding, DescriptorType type, const RHIBuffer* buffer, const RHITexture* image);
+		void RecordWriteDescriptorSet(const DescriptorSet& set);
+		void RecordCopyBufferToBuffer(const CopyBufferToBufferDesc& desc);
+		void RecordCopyBufferToImage(const RHIBuffer& buffer, const RHITexture& image, uint32_t width, uint32_t height, uint32_t layer_count);
+		void RecordCommands(const CommandList& command_list);
+		// Appends the commands from first on to chunk_, the ones of nested lists included
+		void WriteCommands(const CommandHeader* first, uint32_t& command_count);
+		void RecordFree(CaptureChunk chunk, const void* object);
+
+		// A new id for an object that has just been created, pool slots and heap addresses get reused
+		CaptureId AssignId(const void* object);
+		// INVALID_CAPTURE_ID for objects created before the capture started
+		CaptureId GetId(const void* object) const;
+
+		// Appends chunk_ to the stream as one chunk of the given type
+		void Commit(CaptureChunk type);
+		void Finish();
+
+		std::atomic<bool> is_capturing_{ false };
+		// resources may be created on other threads
+		std::recursive_mutex mutex_;
+
+		std::string file_path_;
+		uint32_t first_frame_ = 0;
+		uint32_t frame_count_ = 0;
+		uint32_t frame_index_ = 0;
+		uint32_t captured_frame_count_ = 0;
+		bool is_frame_captured_ = false;
+		CaptureHeader header_{};
+
+		std::unordered_map<const void*, CaptureId> ids_;
+		CaptureId next_id_ = INVALID_CAPTURE_ID + 1;
+
+		CaptureWriter stream_;
+		CaptureWriter chunk_;
+
+		struct DescriptorWrite
+		{
+			uint32_t binding;
+			DescriptorType type;
+			CaptureId buffer;
+			CaptureId image;
+		};
+		std::vector<DescriptorWrite> pending_writes_;
+	};
+}
@@ -1,7 +1,9 @@
 #include "mlepch.h"
 #include "RHI.h"
+#include "RHIBackend.h"
 
 #include "Runtime/Platform/Vulkan/VulkanRHI.h"
+#include "Runtime/Platform/Null/NullRHI.h"
 
 namespace rhi{
 
@@ -10,12 +12,17 @@ namespace rhi{
 
     RHI& RHI::GetRHIInstance()
     {
+#ifdef MLE_RHI_STATIC_VULKAN
+        return GetBackendRHI();
+#else
         switch (api_)
         {
         case RHI::GfxAPI::None:     assert(false && "Need to select a RendererAPI!"); break;
         case RHI::GfxAPI::Vulkan:   static VulkanRHI rhi;return rhi;
+        case RHI::GfxAPI::Null:     static NullRHI null_rhi;return null_rhi;
         }
 
         assert(false && "Unknown RendererAPI!");
+#endif // MLE_RHI_STATIC_VULKAN
     }
 }
\ No newline at end of file
@@ -11,6 +11,29 @@ namespace rhi{
 
     struct Fence {};
 
+    struct QueryPool {};
+
+    // How presented images are queued, FIFO waits for the vertical blank and is always supported
+    enum class PresentMode : uint8_t
+    {
+        FIFO = 0,
+        // the newest image replaces the queued one, no tearing and the least latency with vsync
+        MAILBOX,
+        // no waiting and no queue, the most throughput but may tear
+        IMMEDIATE
+    };
+
+    inline const char* ToString(PresentMode mode)
+    {
+        switch (mode)
+        {
+        case PresentMode::FIFO:         return "fifo";
+        case PresentMode::MAILBOX:      return "mailbox";
+        case PresentMode::IMMEDIATE:    return "immediate";
+        default:                        return "unknown";
+        }
+    }
+
     struct QueueSubmitDesc
     {
         RHIEncoderBase** encoders;
@@ -27,7 +50,8 @@ namespace rhi{
     public:
         enum class GfxAPI
         {
-            None = 0, Vulkan = 1
+            // Null talks to no driver, for measuring the engine's own CPU cost
+            None = 0, Vulkan = 1, Null = 2
         };
     public:
         virtual ~RHI() = default;
@@ -37,6 +61,8 @@ namespace rhi{
 
         virtual void RHITick(float delta_time) = 0;
         virtual void RHIBlockUntilGPUIdle() = 0;
+        // Starts compacting GPU memory, the moves are spread over the following RHITicks
+        virtual void RHIDefragment() = 0;
 
         virtual void* GetNativeInstance() = 0;
         virtual void* GetNativeDevice() = 0;
@@ -49,6 +75,11 @@ namespace rhi{
         virtual void* GetNativeSwapchainImageView() = 0;
         virtual uint32_t GetViewportWidth() = 0;
         virtual uint32_t GetViewportHeight() = 0;
+        // The window has been resized, the swapchain follows before the next image is acquired
+        virtual void OnViewportResize(uint32_t width, uint32_t height) {};
+        // Takes effect when the swapchain is created next, modes the surface doesn't support fall back to FIFO
+        virtual void SetPresentMode(PresentMode mode) { present_mode_ = mode; };
+        inline PresentMode GetPresentMode() const { return present_mode_; };
 
         virtual uint32_t GetGfxQueueFamily() = 0;
         
@@ -63,10 +94,13 @@ namespace rhi{
         [[nodiscard]] virtual DescriptorAllocatorPtr CreateDescriptorAllocator() = 0;
 
         virtual CommandBuffer* RHICreateCommandBuffer() = 0;
+        [[nodiscard]] virtual std::unique_ptr<SecondaryCommandBuffer> RHICreateSecondaryCommandBuffer() = 0;
         virtual std::unique_ptr<RenderPass> RHICreateRenderPass(const RenderPass::Descriptor& desc) = 0;
         virtual std::unique_ptr<RenderTarget> RHICreateRenderTarget(const RenderTarget::Descriptor& desc) = 0;
         
         [[nodiscard]] virtual ShaderModule* RHICreateShaderModule(const char* path) = 0;
+        // From spir-v in memory, the replay of a capture has no files to read
+        [[nodiscard]] virtual ShaderModule* RHICreateShaderModuleFromCode(const void* code, size_t size) = 0;
         virtual void RHIFreeShaderModule(ShaderModule& shader) = 0;
         [[nodiscard]] virtual PipelineLayout* RHICreatePipelineLayout(const PipelineLayout::Descriptor& desc) = 0;
         virtual void RHIFreePipelineLayout(PipelineLayout& layout) = 0;
@@ -75,7 +109,8 @@ namespace rhi{
         [[nodiscard]] virtual BufferRef RHICreateBuffer(const RHIBuffer::Descriptor& desc) = 0;
         virtual void RHIFreeBuffer(RHIBuffer& buffer) = 0;
         [[nodiscard]] virtual TextureRef RHICreateTexture(const RHITexture::Descriptor& desc) = 0;
-        virtual void ResizeTexture(RHITexture& texture, uint32_t width, uint32_t height) = 0;
+        // The texture keeps its slot, its old memory comes back as a texture of its own for the frame dumps, null if nothing was resized
+        [[nodiscard]] virtual TextureRef ResizeTexture(RHITexture& texture, uint32_t width, uint32_t height) = 0;
         virtual void RHIFreeTexture(RHITexture& texture) = 0;
 
         virtual Semaphore* RHICreateSemaphore() = 0;
@@ -86,8 +121,25 @@ namespace rhi{
         virtual void RHIWaitForFences(Fence** fence, uint32_t fence_count) = 0;
         virtual bool RHIIsFenceReady(Fence* fence) = 0;
 
+        [[nodiscard]] virtual QueryPool* RHICreateTimestampQueryPool(uint32_t query_count) = 0;
+        virtual void RHIDestroyQueryPool(QueryPool* pool) = 0;
+        // Never blocks, returns false if any of the queries isn't available yet
+        virtual bool RHIGetQueryResults(QueryPool* pool, uint32_t first_query, uint32_t query_count, uint64_t* results) = 0;
+        // Nanoseconds per timestamp tick, 0 if the graphics queue doesn't support timestamps
+        virtual float GetTimestampPeriod() = 0;
+
         static GfxAPI GetAPI() { return api_; }
+        // Must be called before the first GetRHIInstance
+        static void SetAPI(GfxAPI api)
+        {
+#ifdef MLE_RHI_STATIC_VULKAN
+            assert(api == GfxAPI::Vulkan && "This build is bound to the vulkan backend(MLE_RHI_STATIC_VULKAN)");
+#endif // MLE_RHI_STATIC_VULKAN
+            api_ = api;
+        }
         static RHI& GetRHIInstance();
+    protected:
+        PresentMode present_mode_ = PresentMode::MAILBOX;
     private:
         static GfxAPI api_;
     };
@@ -0,0 +1,47 @@
+#pragma once
+#include "RHI.h"
+#include "CommandBuffer.h"
+
+// Build with MLE_RHI_STATIC_VULKAN(premake5 --rhi=vulkan) to bind the renderer to the vulkan backend at compile time.
+// Encoder and resource calls on the hot path then go straight to the final vulkan classes and can be inlined,
+// instead of going through the RHI and CommandBuffer vtables. The default build keeps the virtual path,
+// the api is picked at runtime and the NullRHI is available.
+#ifdef MLE_RHI_STATIC_VULKAN
+#include "Runtime/Platform/Vulkan/VulkanRHI.h"
+#include "Runtime/Platform/Vulkan/VulkanCommandBuffer.h"
+
+namespace rhi {
+	using BackendRHI = VulkanRHI;
+	using BackendCommandBuffer = VulkanCommandBuffer;
+	using BackendSecondaryCommandBuffer = VulkanSecondaryCommandBuffer;
+
+	inline BackendRHI& GetBackendRHI()
+	{
+		static VulkanRHI rhi;
+		return rhi;
+	}
+}
+#else
+namespace rhi {
+	using BackendRHI = RHI;
+	using BackendCommandBuffer = CommandBuffer;
+	using BackendSecondaryCommandBuffer = SecondaryCommandBuffer;
+
+	inline BackendRHI& GetBackendRHI()
+	{
+		return RHI::GetRHIInstance();
+	}
+}
+#endif // MLE_RHI_STATIC_VULKAN
+
+namespace rhi {
+	// Every command buffer is created by the backend, so this is only a change of static type
+	inline BackendCommandBuffer& ToBackend(CommandBuffer& cmd_buffer)
+	{
+		return static_cast<BackendCommandBuffer&>(cmd_buffer);
+	}
+	inline BackendSecondaryCommandBuffer& ToBackend(SecondaryCommandBuffer& secondary)
+	{
+		return static_cast<BackendSecondaryCommandBuffer&>(secondary);
+	}
+}
@@ -1,5 +1,5 @@
 #include "mlepch.h"
 #include "RHICommands.h"
 namespace rhi {
-	RHI& RHICommands::rhi_ = RHI::GetRHIInstance();
+	BackendRHI* RHICommands::rhi_ = nullptr;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "Enum.h"
+#include "ResourcePool.h"
 
 namespace rhi {
 	struct DescriptorSetLayout;
@@ -18,6 +19,8 @@ namespace rhi {
 
 			PixelFormat format = PixelFormat::RGBA8;
 			TextureUsage usage;
+
+			MemoryCategory category = MemoryCategory::IMPORTED_TEXTURE;
 		};
 		uint32_t width = 0;
 		uint32_t height = 0;
@@ -28,12 +31,15 @@ namespace rhi {
 
 		TextureUsage	usage;
 		PixelFormat		format;
+		MemoryCategory	category = MemoryCategory::IMPORTED_TEXTURE;
+
+		PoolHandle handle;
 
 		//For use of ImGui
 		void* texture_id = nullptr;
 		virtual void RegisterForImGui() {};
 	};
-	typedef std::shared_ptr<RHITexture> TextureRef;
+	typedef ResourceRef<RHITexture> TextureRef;
 
 	struct RHISampler
 	{
@@ -61,15 +67,20 @@ namespace rhi {
 			bool prefer_device = false;
 			bool prefer_host = false;
 			bool mapped_at_creation = false;
+
+			MemoryCategory category = MemoryCategory::BUFFER;
 		};
 		uint64_t size = 0;
 		uint32_t alignment = 0;
 		// Vertex, Index, Uniform etc.
 		ResourceTypes usage;
+		MemoryCategory category = MemoryCategory::BUFFER;
+
+		PoolHandle handle;
 
 		virtual void SetData(const void* data, uint64_t size, uint64_t offset = 0) = 0;
 	};
-	typedef std::shared_ptr<RHIBuffer> BufferRef;
+	typedef ResourceRef<RHIBuffer> BufferRef;
 
 	// ---------------------------------------------------------------------------
 
@@ -108,6 +119,8 @@ namespace rhi {
 			uint32_t subpass;
 		};
 		PipelineLayout* layout;
+
+		PoolHandle handle;
 	};
-	typedef std::shared_ptr<RHIPipeline> PipelineRef;
+	typedef ResourceRef<RHIPipeline> PipelineRef;
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "mlepch.h"
+#include "RHIStats.h"
+
+namespace rhi {
+    const char* ToString(RHICounter counter)
+    {
+        switch (counter)
+        {
+        case RHICounter::DRAW_CALLS:            return "Draw Calls";
+        case RHICounter::DRAWN_VERTICES:        return "Vertices";
+        case RHICounter::PIPELINE_BINDS:        return "Pipeline Binds";
+        case RHICounter::DESCRIPTOR_SET_BINDS:  return "Descriptor Set Binds";
+        case RHICounter::VERTEX_BUFFER_BINDS:   return "Vertex Buffer Binds";
+        case RHICounter::INDEX_BUFFER_BINDS:    return "Index Buffer Binds";
+        case RHICounter::BARRIERS:              return "Barriers";
+        case RHICounter::RENDER_PASS_BEGINS:    return "Render Pass Begins";
+        case RHICounter::BUFFER_CREATIONS:      return "Buffer Creations";
+        case RHICounter::BUFFER_FREES:          return "Buffer Frees";
+        case RHICounter::TEXTURE_CREATIONS:     return "Texture Creations";
+        case RHICounter::TEXTURE_RESIZES:       return "Texture Resizes";
+        case RHICounter::TEXTURE_FREES:         return "Texture Frees";
+        case RHICounter::PIPELINE_CREATIONS:    return "Pipeline Creations";
+        case RHICounter::DESCRIPTOR_WRITES:     return "Descriptor Writes";
+        case RHICounter::QUEUE_SUBMITS:         return "Queue Submits";
+        case RHICounter::FILTERED_COMMANDS:     return "Filtered Commands";
+        default:                                return "Unknown";
+        }
+    }
+
+    const char* ToString(MemoryCategory category)
+    {
+        switch (category)
+        {
+        case MemoryCategory::BUFFER:                    return "Buffer";
+        case MemoryCategory::STAGING:                   return "Staging";
+        case MemoryCategory::IMPORTED_TEXTURE:          return "Imported Texture";
+        case MemoryCategory::RENDER_GRAPH_TRANSIENT:    return "Render Graph Transient";
+        case MemoryCategory::RENDER_GRAPH_HISTORY:      return "Render Graph History";
+        default:                                        return "Unknown";
+        }
+    }
+
+    RHICounters RHICounters::operator-(const RHICounters& other) const
+    {
+        RHICounters result;
+        for (size_t i = 0; i < static_cast<size_t>(RHICounter::COUNT); ++i)
+        {
+            result.values[i] = values[i] - other.values[i];
+        }
+        return result;
+    }
+
+    void RHIStats::BeginFrame()
+    {
+        const RHICounters total = GetTotal();
+        last_frame_ = total - frame_start_;
+        frame_start_ = total;
+
+        last_frame_passes_.swap(current_frame_passes_);
+        current_frame_passes_.clear();
+    }
+
+    void RHIStats::BeginPass(const char* name)
+    {
+        assert(current_pass_ == nullptr && "passes don't nest");
+        current_pass_ = name;
+        pass_start_ = GetTotal();
+    }
+
+    void RHIStats::EndPass()
+    {
+        current_frame_passes_.push_back({ current_pass_, GetTotal() - pass_start_ });
+        current_pass_ = nullptr;
+    }
+
+    void RHIStats::Count(const RHICounters& counters)
+    {
+        for (size_t i = 0; i < static_cast<size_t>(RHICounter::COUNT); ++i)
+        {
+            if (counters.values[i])
+                Count(static_cast<RHICounter>(i), counters.values[i]);
+        }
+    }
+
+    RHICounters RHIStats::GetTotal() const
+    {
+        RHICounters total;
+        for (size_t i = 0; i < static_cast<size_t>(RHICounter::COUNT); ++i)
+        {
+            total.values[i] = counters_[i].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    RHIMemoryCategoryStats RHIStats::GetMemoryCategory(MemoryCategory category) const
+    {
+        const auto& category_stats = memory_[static_cast<size_t>(category)];
+        return { category_stats.bytes.load(std::memory_order_relaxed), category_stats.allocation_count.load(std::memory_order_relaxed) };
+    }
+
+    bool RHIStats::IsNearBudget() const
+    {
+        for (auto const& heap : heaps_)
+        {
+            if (heap.budget > 0 && heap.usage >= static_cast<uint64_t>(heap.budget * BUDGET_WARNING_RATIO))
+                return true;
+        }
+        return false;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+#include <atomic>
+#include "Runtime/Core/Base/Singleton.h"
+#include "Enum.h"
+
+namespace rhi {
+    enum class RHICounter : uint8_t
+    {
+        DRAW_CALLS = 0,
+        DRAWN_VERTICES,
+        PIPELINE_BINDS,
+        DESCRIPTOR_SET_BINDS,
+        VERTEX_BUFFER_BINDS,
+        INDEX_BUFFER_BINDS,
+        BARRIERS,
+        RENDER_PASS_BEGINS,
+        BUFFER_CREATIONS,
+        BUFFER_FREES,
+        TEXTURE_CREATIONS,
+        TEXTURE_RESIZES,
+        TEXTURE_FREES,
+        PIPELINE_CREATIONS,
+        DESCRIPTOR_WRITES,
+        QUEUE_SUBMITS,
+        // binds the command list translator skipped because the state was already bound
+        FILTERED_COMMANDS,
+        COUNT
+    };
+
+    const char* ToString(RHICounter counter);
+    const char* ToString(MemoryCategory category);
+
+    struct RHICounters
+    {
+        uint64_t values[static_cast<size_t>(RHICounter::COUNT)]{};
+
+        inline uint64_t operator[](RHICounter counter) const { return values[static_cast<size_t>(counter)]; };
+        RHICounters operator-(const RHICounters& other) const;
+    };
+
+    struct RHIPassCounters
+    {
+        const char* name = nullptr;
+        RHICounters counters;
+    };
+
+    struct RHIMemoryCategoryStats
+    {
+        uint64_t bytes = 0;
+        uint64_t allocation_count = 0;
+    };
+
+    // One memory heap of the device, filled in by the backend every RHITick
+    struct RHIHeapBudget
+    {
+        // what the driver says this process has resident in the heap
+        uint64_t usage = 0;
+        // how much this process may allocate before the OS starts evicting or allocations fail
+        uint64_t budget = 0;
+        // memory blocks the allocator holds and the live allocations placed in them
+        uint64_t block_bytes = 0;
+        uint64_t allocation_bytes = 0;
+        uint32_t allocation_count = 0;
+        bool device_local = false;
+    };
+
+    struct RHIDefragmentationStats
+    {
+        bool is_running = false;
+        // totals of the last finished defragmentation
+        uint64_t bytes_moved = 0;
+        uint64_t bytes_freed = 0;
+        uint32_t allocations_moved = 0;
+        uint32_t blocks_freed = 0;
+    };
+
+    /// <summary>
+    /// Counts what the backend records and creates. Counters are bumped with relaxed atomics,
+    /// so resource creation on other threads is counted as well.
+    /// A frame runs from one BeginFrame to the next, passes are bracketed by BeginPass/EndPass.
+    /// </summary>
+    class RHIStats : public engine::Singleton<RHIStats>
+    {
+        friend class engine::Singleton<RHIStats>;
+    public:
+        static inline void Count(RHICounter counter, uint64_t amount = 1)
+        {
+            GetInstance().counters_[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+        }
+        // Counts all of them again, e.g. when commands recorded in an earlier frame are executed
+        static void Count(const RHICounters& counters);
+
+        void BeginFrame();
+
+        void BeginPass(const char* name);
+        void EndPass();
+
+        // Everything counted since start up
+        RHICounters GetTotal() const;
+        // The last complete frame
+        inline const RHICounters& GetLastFrame() const { return last_frame_; };
+        inline const std::vector<RHIPassCounters>& GetLastFramePasses() const { return last_frame_passes_; };
+        // Counted so far in the current frame
+        inline RHICounters GetCurrentFrame() const { return GetTotal() - frame_start_; };
+
+        // Budgets are considered exhausted once usage reaches this fraction of them
+        static constexpr float BUDGET_WARNING_RATIO = 0.9f;
+
+        static inline void TrackAllocation(MemoryCategory category, uint64_t bytes)
+        {
+            auto& category_stats = GetInstance().memory_[static_cast<size_t>(category)];
+            category_stats.bytes.fetch_add(bytes, std::memory_order_relaxed);
+            category_stats.allocation_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        static inline void TrackFree(MemoryCategory category, uint64_t bytes)
+        {
+            auto& category_stats = GetInstance().memory_[static_cast<size_t>(category)];
+            category_stats.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+            category_stats.allocation_count.fetch_sub(1, std::memory_order_relaxed);
+        }
+        RHIMemoryCategoryStats GetMemoryCategory(MemoryCategory category) const;
+
+        inline void SetHeapBudgets(std::vector<RHIHeapBudget>&& heaps) { heaps_ = std::move(heaps); };
+        inline const std::vector<RHIHeapBudget>& GetHeapBudgets() const { return heaps_; };
+        // Whether any heap is past BUDGET_WARNING_RATIO of its budget
+        bool IsNearBudget() const;
+
+        inline void SetDefragmentation(const RHIDefragmentationStats& defragmentation) { defragmentation_ = defragmentation; };
+        inline const RHIDefragmentationStats& GetDefragmentation() const { return defragmentation_; };
+    private:
+        RHIStats() = default;
+
+        std::atomic<uint64_t> counters_[static_cast<size_t>(RHICounter::COUNT)]{};
+
+        RHICounters frame_start_;
+        RHICounters pass_start_;
+        const char* current_pass_ = nullptr;
+
+        RHICounters last_frame_;
+        std::vector<RHIPassCounters> last_frame_passes_;
+        std::vector<RHIPassCounters> current_frame_passes_;
+
+        struct CategoryCounters
+        {
+            std::atomic<uint64_t> bytes{ 0 };
+            std::atomic<uint64_t> allocation_count{ 0 };
+        };
+        CategoryCounters memory_[static_cast<size_t>(MemoryCategory::COUNT)];
+        std::vector<RHIHeapBudget> heaps_;
+        RHIDefragmentationStats defragmentation_;
+    };
+}
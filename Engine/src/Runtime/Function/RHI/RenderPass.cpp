@@ -8,6 +8,11 @@
 namespace rhi {
 	RenderPass::~RenderPass()
 	{
+		// pipelines aren't reference counted, the pass owns the ones it created.
+		// A pass the frames in flight may still use is kept in FrameResource::render_pass_dump until they are done
+		RHI& rhi = RHI::GetRHIInstance();
+		for (PipelineRef& pipeline : pipelines_)
+			rhi.RHIFreePipeline(*pipeline);
 		pipelines_.clear();
 	}
 
@@ -13,8 +13,6 @@ namespace rhi {
 	struct PipelineDesc;
 	class CommandBuffer;
 	class RenderPass;
-	struct RHIPipeline;
-	typedef std::shared_ptr<RHIPipeline> PipelineRef;
 	
 	enum class ImageLayout
 	{
@@ -98,6 +96,10 @@ namespace rhi {
 			
 			ImageLayout initial_layout = ImageLayout::IMAGE_LAYOUT_UNDEFINED;
 			ImageLayout final_layout = ImageLayout::IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+			// frames still in flight may sample it, e.g. the other instance of a history resource,
+			// so writing it has to wait for their fragment shaders
+			bool is_read_by_earlier_frames = false;
 		};
 
 		struct Descriptor
@@ -119,6 +121,7 @@ namespace rhi {
 
 		PipelineRef CreatePipeline(const RHIPipeline::Descriptor& desc);
 		PipelineRef GetPipeline(uint32_t index) { return pipelines_[index]; };
+		inline const std::vector<PipelineRef>& GetPipelines() const { return pipelines_; };
 
 		static std::unique_ptr<RenderPass> Create(const Descriptor& desc);
 
@@ -0,0 +1,130 @@
+#pragma once
+
+namespace rhi {
+	/// <summary>
+	/// Slot of a resource in its backend pool. The generation is bumped every time the slot is freed,
+	/// so a handle kept past RHIFree* no longer matches and is reported as stale instead of aliasing the next resource.
+	/// </summary>
+	struct PoolHandle
+	{
+		static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+		uint32_t index = INVALID_INDEX;
+		uint32_t generation = 0;
+
+		inline bool IsValid() const { return index != INVALID_INDEX; };
+		inline bool operator==(const PoolHandle& other) const { return index == other.index && generation == other.generation; };
+		inline bool operator!=(const PoolHandle& other) const { return !(*this == other); };
+	};
+
+	/// <summary>
+	/// Bookkeeping shared by every pool, kept apart from the objects so liveness checks only touch a dense array of generations.
+	/// </summary>
+	class ResourcePoolBase
+	{
+	public:
+		inline bool IsAlive(PoolHandle handle) const
+		{
+			return handle.index < generations_.size() && generations_[handle.index] == handle.generation && is_used_[handle.index];
+		};
+		inline uint32_t GetLiveCount() const { return live_count_; };
+		inline uint32_t GetCapacity() const { return static_cast<uint32_t>(generations_.size()); };
+	protected:
+		std::vector<uint32_t>	generations_;
+		std::vector<bool>		is_used_;
+		std::vector<uint32_t>	free_list_;
+		uint32_t				live_count_ = 0;
+	};
+
+	/// <summary>
+	/// Dense storage of one backend resource type, allocated in fixed chunks so objects never move:
+	/// descriptor writes, render targets and the defragmenter keep raw pointers into it.
+	/// Only the RHI thread allocates and frees, there is no locking.
+	/// </summary>
+	template<typename T>
+	class ResourcePool : public ResourcePoolBase
+	{
+	public:
+		static constexpr uint32_t CHUNK_SIZE = 256;
+
+		// The returned object is default constructed and knows its own handle
+		T* Allocate()
+		{
+			uint32_t index;
+			if (!free_list_.empty())
+			{
+				index = free_list_.back();
+				free_list_.pop_back();
+			}
+			else
+			{
+				index = static_cast<uint32_t>(generations_.size());
+				generations_.push_back(0);
+				is_used_.push_back(false);
+				if (index % CHUNK_SIZE == 0)
+					chunks_.emplace_back(std::make_unique<T[]>(CHUNK_SIZE));
+			}
+
+			T& object = chunks_[index / CHUNK_SIZE][index % CHUNK_SIZE];
+			object = T{};
+			object.handle = { index, generations_[index] };
+			is_used_[index] = true;
+			++live_count_;
+			return &object;
+		}
+
+		// False if the object has already been released
+		bool Release(const T& object)
+		{
+			if (!IsAlive(object.handle))
+				return false;
+			const uint32_t index = object.handle.index;
+			++generations_[index];
+			is_used_[index] = false;
+			free_list_.push_back(index);
+			--live_count_;
+			return true;
+		}
+	private:
+		std::vector<std::unique_ptr<T[]>> chunks_;
+	};
+
+	/// <summary>
+	/// Non owning reference to a pooled resource, a pointer plus the handle it was created with.
+	/// Copies are plain copies, no reference count is touched; the resource lives until it is given back with RHIFree*,
+	/// usually through the frame dumps once the GPU is done with it.
+	/// </summary>
+	template<typename T>
+	class ResourceRef
+	{
+	public:
+		ResourceRef() = default;
+		ResourceRef(std::nullptr_t) {};
+		ResourceRef(T* resource, const ResourcePoolBase* pool)
+			:resource_(resource), pool_(pool), handle_(resource ? resource->handle : PoolHandle{}) {};
+
+		inline T* get() const
+		{
+			assert((!resource_ || pool_->IsAlive(handle_)) && "stale resource handle, the resource has been freed");
+			return resource_;
+		};
+		inline T* operator->() const { return get(); };
+		inline T& operator*() const { return *get(); };
+		inline explicit operator bool() const { return resource_ != nullptr; };
+
+		inline void reset() { *this = ResourceRef(); };
+
+		// False once the resource has been freed, even if its slot holds another resource by now
+		inline bool IsAlive() const { return resource_ && pool_->IsAlive(handle_); };
+		inline PoolHandle GetHandle() const { return handle_; };
+
+		inline bool operator==(const ResourceRef& other) const { return resource_ == other.resource_ && handle_ == other.handle_; };
+		inline bool operator!=(const ResourceRef& other) const { return !(*this == other); };
+		inline bool operator==(std::nullptr_t) const { return resource_ == nullptr; };
+		inline bool operator!=(std::nullptr_t) const { return resource_ != nullptr; };
+	private:
+		T* resource_ = nullptr;
+		const ResourcePoolBase* pool_ = nullptr;
+		PoolHandle handle_;
+	};
+}
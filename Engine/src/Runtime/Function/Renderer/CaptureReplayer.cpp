@@ -0,0 +1,729 @@
+#include "mlepch.h"
+#include "CaptureReplayer.h"
+#include "Renderer.h"
+#include "RenderCommands.h"
+#include "Runtime/Function/RHI/RHI.h"
+#include "Runtime/Function/RHI/RHICommands.h"
+
+#include <fstream>
+
+namespace renderer {
+	namespace {
+		template<typename T>
+		inline T* ToPointer(T* object) { return object; }
+		template<typename T>
+		inline T* ToPointer(const rhi::ResourceRef<T>& ref) { return ref.get(); }
+		template<typename T>
+		inline T* ToPointer(const std::shared_ptr<T>& ptr) { return ptr.get(); }
+
+		bool IsValid(const rhi::CaptureHeader& header, const std::string& file_path)
+		{
+			if (header.magic != rhi::CaptureHeader::MAGIC)
+			{
+				MLE_CORE_ERROR("[Replay] {0} isn't a capture", file_path);
+				return false;
+			}
+			if (header.version != rhi::CaptureHeader::VERSION)
+			{
+				MLE_CORE_ERROR("[Replay] {0} is a version {1} capture, version {2} is supported", file_path, header.version, rhi::CaptureHeader::VERSION);
+				return false;
+			}
+			return true;
+		}
+	}
+
+	CaptureReplayer::~CaptureReplayer()
+	{
+		Release();
+	}
+
+	bool CaptureReplayer::ReadHeader(const std::string& file_path, rhi::CaptureHeader& header)
+	{
+		std::ifstream file(file_path, std::ios::binary);
+		if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		{
+			MLE_CORE_ERROR("[Replay] can't read {0}", file_path);
+			return false;
+		}
+		return IsValid(header, file_path);
+	}
+
+	bool CaptureReplayer::Load(const std::string& file_path)
+	{
+		std::ifstream file(file_path, std::ios::ate | std::ios::binary);
+		if (!file.is_open())
+		{
+			MLE_CORE_ERROR("[Replay] can't read {0}", file_path);
+			return false;
+		}
+		data_.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(data_.data()), data_.size());
+		if (data_.size() < sizeof(header_))
+		{
+			MLE_CORE_ERROR("[Replay] {0} is too short to be a capture", file_path);
+			return false;
+		}
+		memcpy(&header_, data_.data(), sizeof(header_));
+		if (!IsValid(header_, file_path))
+			return false;
+
+		reader_ = rhi::CaptureReader(data_.data() + sizeof(header_), data_.size() - sizeof(header_));
+		MLE_CORE_INFO("[Replay] {0}: {1} frames at {2}x{3}", file_path, header_.frame_count, header_.viewport_width, header_.viewport_height);
+		return true;
+	}
+
+	bool CaptureReplayer::Setup()
+	{
+		rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+		upload_cmd_buffer_ = rhi.RHICreateCommandBuffer();
+		desc_allocator_ = rhi.CreateDescriptorAllocator();
+		layout_cache_ = rhi.CreateDescriptorSetLayoutCache();
+
+		while (!reader_.IsAtEnd())
+		{
+			const size_t offset = reader_.GetOffset();
+			const auto type = reader_.Read<rhi::CaptureChunk>();
+			if (type == rhi::CaptureChunk::BEGIN_FRAME)
+			{
+				first_frame_offset_ = offset;
+				reader_.Seek(offset);
+				return true;
+			}
+			const uint32_t size = reader_.Read<uint32_t>();
+			const uint8_t* payload = reader_.ReadBytes(size);
+			if (reader_.HasFailed())
+				break;
+			rhi::CaptureReader chunk(payload, size);
+			if (!RunChunk(type, chunk))
+				return false;
+		}
+		MLE_CORE_ERROR("[Replay] the capture has no frames");
+		return false;
+	}
+
+	bool CaptureReplayer::ReplayFrame(FrameResource& frame)
+	{
+		MLE_PROFILE_FUNCTION();
+		if (replayed_frame_count_ >= header_.frame_count)
+			return false;
+
+		frame_ = &frame;
+		const bool is_replayed = RunChunks(rhi::CaptureChunk::END_FRAME);
+		frame_ = nullptr;
+
+		// a broken frame can leave markers open
+		GPUProfiler& profiler = Renderer::GetInstance().GetGPUProfiler();
+		for (auto it = open_scopes_.rbegin(); it != open_scopes_.rend(); ++it)
+		{
+			profiler.EndScope(frame, *it);
+			frame.command_list.EndMarker();
+		}
+		open_scopes_.clear();
+
+		if (is_replayed)
+			++replayed_frame_count_;
+		return is_replayed;
+	}
+
+	void CaptureReplayer::Rewind()
+	{
+		reader_.Seek(first_frame_offset_);
+		replayed_frame_count_ = 0;
+	}
+
+	void CaptureReplayer::Release()
+	{
+		if (!upload_cmd_buffer_)
+			return;
+		rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+		rhi.RHIBlockUntilGPUIdle();
+
+		for (auto& [id, pipeline] : pipelines_)
+		{
+			rhi.RHIFreePipeline(*pipeline);
+		}
+		pipelines_.clear();
+		// the framebuffers go before their attachments
+		render_targets_.clear();
+		render_passes_.clear();
+		retired_passes_.clear();
+		for (auto& [id, texture] : textures_)
+		{
+			rhi.RHIFreeTexture(*texture);
+		}
+		textures_.clear();
+		for (auto& [id, buffer] : buffers_)
+		{
+			rhi.RHIFreeBuffer(*buffer);
+		}
+		buffers_.clear();
+
+		descriptor_sets_.clear();
+		retired_sets_.clear();
+		for (auto& [id, layout] : pipeline_layouts_)
+		{
+			retired_pipeline_layouts_.push_back(layout);
+		}
+		pipeline_layouts_.clear();
+		for (rhi::PipelineLayout* layout : retired_pipeline_layouts_)
+		{
+			rhi.RHIFreePipelineLayout(*layout);
+			delete layout;
+		}
+		retired_pipeline_layouts_.clear();
+		for (auto& [id, shader] : shaders_)
+		{
+			retired_shaders_.push_back(shader);
+		}
+		shaders_.clear();
+		for (rhi::ShaderModule* shader : retired_shaders_)
+		{
+			rhi.RHIFreeShaderModule(*shader);
+			delete shader;
+		}
+		retired_shaders_.clear();
+		set_layouts_.clear();
+
+		desc_allocator_.reset();
+		layout_cache_.reset();
+		delete upload_cmd_buffer_;
+		upload_cmd_buffer_ = nullptr;
+	}
+
+	bool CaptureReplayer::RunChunks(rhi::CaptureChunk last_chunk)
+	{
+		while (!reader_.IsAtEnd())
+		{
+			const auto type = reader_.Read<rhi::CaptureChunk>();
+			const uint32_t size = reader_.Read<uint32_t>();
+			const uint8_t* payload = reader_.ReadBytes(size);
+			if (reader_.HasFailed())
+				break;
+			rhi::CaptureReader chunk(payload, size);
+			if (!RunChunk(type, chunk))
+				return false;
+			if (type == last_chunk)
+				return true;
+		}
+		MLE_CORE_ERROR("[Replay] the capture ends in the middle of a frame");
+		return false;
+	}
+
+	template<typename Table>
+	auto CaptureReplayer::Find(const Table& table, rhi::CaptureId id)
+	{
+		auto it = table.find(id);
+		if (it != table.end())
+			return ToPointer(it->second);
+		if (!has_reported_missing_)
+		{
+			MLE_CORE_WARN("[Replay] object {0} wasn't captured, what uses it is skipped. Was the capture started before the renderer?", id);
+			has_reported_missing_ = true;
+		}
+		return decltype(ToPointer(it->second))(nullptr);
+	}
+
+	bool CaptureReplayer::RunChunk(rhi::CaptureChunk type, rhi::CaptureReader& reader)
+	{
+		using rhi::CaptureChunk;
+		using rhi::CaptureId;
+		rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+
+		// replaced resources may still be used by frames in flight
+		auto retire_buffer = [&](rhi::BufferRef& buffer) {
+			if (frame_)
+				frame_->buffer_dump.push_back(buffer);
+			else
+				rhi.RHIFreeBuffer(*buffer);
+		};
+		auto retire_texture = [&](rhi::TextureRef& texture) {
+			if (frame_)
+				frame_->texture_dump.push_back(texture);
+			else
+				rhi.RHIFreeTexture(*texture);
+		};
+
+		switch (type)
+		{
+		case CaptureChunk::CREATE_BUFFER:
+		{
+			const CaptureId id = reader.Read<CaptureId>();
+			const auto desc = reader.Read<rhi::RHIBuffer::Descriptor>();
+			auto it = buffers_.find(id);
+			if (it != buffers_.end())
+				retire_buffer(it->second);
+			buffers_[id] = rhi.RHICreateBuffer(desc);
+			break;
+		}
+		case CaptureChunk::BUFFER_DATA:
+		{
+			rhi::RHIBuffer* buffer = Find(buffers_, reader.Read<CaptureId>());
+			const uint64_t offset = reader.Read<uint64_t>();
+			const uint64_t size = reader.Read<uint64_t>();
+			const uint8_t* data = reader.ReadBytes(size);
+			if (buffer && data)
+				buffer->SetData(data, size, offset);
+			break;
+		}
+		case CaptureChunk::FREE_BUFFER:
+		{
+			auto it = buffers_.find(reader.Read<CaptureId>());
+			if (it != buffers_.end())
+			{
+				retire_buffer(it->second);
+				buffers_.erase(it);
+			}
+			break;
+		}
+		case CaptureChunk::CREATE_TEXTURE:
+		{
+			const CaptureId id = reader.Read<CaptureId>();
+			const auto desc = reader.Read<rhi::RHITexture::Descriptor>();
+			auto it = textures_.find(id);
+			if (it != textures_.end())
+				retire_texture(it->second);
+			textures_[id] = rhi.RHICreateTexture(desc);
+			break;
+		}
+		case CaptureChunk::RESIZE_TEXTURE:
+		{
+			rhi::RHITexture* texture = Find(textures_, reader.Read<CaptureId>());
+			const uint32_t width = reader.Read<uint32_t>();
+			const uint32_t height = reader.Read<uint32_t>();
+			if (texture)
+			{
+				rhi::TextureRef old_memory = rhi.ResizeTexture(*texture, width, height);
+				if (old_memory)
+					retire_texture(old_memory);
+			}
+			break;
+		}
+		case CaptureChunk::FREE_TEXTURE:
+		{
+			auto it = textures_.find(reader.Read<CaptureId>());
+			if (it != textures_.end())
+			{
+				retire_texture(it->second);
+				textures_.erase(it);
+			}
+			break;
+		}
+		case CaptureChunk::CREATE_SHADER_MODULE:
+		{
+			const CaptureId id = reader.Read<CaptureId>();
+			const uint64_t size = reader.Read<uint64_t>();
+			const uint8_t* code = reader.ReadBytes(size);
+			auto it = shaders_.find(id);
+			if (it != shaders_.end())
+				retired_shaders_.push_back(it->second);
+			shaders_[id] = rhi.RHICreateShaderModuleFromCode(code, size);
+			break;
+		}
+		case CaptureChunk::CREATE_DESCRIPTOR_SET_LAYOUT:
+		{
+			const CaptureId id = reader.Read<CaptureId>();
+			rhi::DescriptorLayoutDesc desc{};
+			desc.bindings.resize(reader.Read<uint32_t>());
+			for (auto& binding : desc.bindings)
+			{
+				binding = reader.Read<rhi::DescriptorBinding>();
+			}
+			set_layouts_[id] = rhi::DescriptorSetLayoutBuilder::Begin(layout_cache_.get()).BuildFromDesc(desc);
+			break;
+		}
+		case CaptureChunk::CREATE_PIPELINE_LAYOUT:
+		{
+			const CaptureId id = reader.Read<CaptureId>();
+			std::vector<rhi::DescriptorSetLayout*> layouts(reader.Read<uint32_t>());
+			bool is_complete = true;
+			for (auto& layout : layouts)
+			{
+				layout = Find(set_layouts_, reader.Read<CaptureId>());
+				is_complete &= layout != nullptr;
+			}
+			rhi::PipelineLayout::Descriptor desc{};
+			desc.set_layout_count = static_cast<uint32_t>(layouts.size());
+			desc.layouts = layouts.data();
+			desc.push_constant_count = reader.Read<uint32_t>();
+			if (!is_complete)
+				break;
+
+			auto it = pipeline_layouts_.find(id);
+			if (it != pipeline_layouts_.end())
+				retired_pipeline_layouts_.push_back(it->second);
+			pipeline_layouts_[id] = rhi.RHICreatePipelineLayout(desc);
+			break;
+		}
+		case CaptureChunk::CREATE_PIPELINE:
+		{
+			const CaptureId id = reader.Read<CaptureId>();
+			rhi::RHIPipeline::Descriptor desc{};
+			desc.topology = reader.Read<PrimitiveTopology>();
+			desc.render_pass = Find(render_passes_, reader.Read<CaptureId>());
+			desc.layout = Find(pipeline_layouts_, reader.Read<CaptureId>());
+			desc.vert_shader = Find(shaders_, reader.Read<CaptureId>());
+			desc.frag_shader = Find(shaders_, reader.Read<CaptureId>());
+			desc.use_vertex_attribute = reader.Read<bool>();
+			desc.subpass = reader.Read<uint32_t>();
+			if (!desc.render_pass || !desc.layout || !desc.vert_shader || !desc.frag_shader)
+				break;
+
+			auto it = pipelines_.find(id);
+			if (it != pipelines_.end())
+			{
+				rhi.RHIBlockUntilGPUIdle();
+				rhi.RHIFreePipeline(*it->second);
+			}
+			pipelines_[id] = rhi.RHICreatePipeline(desc);
+			break;
+		}
+		case CaptureChunk::FREE_PIPELINE:
+		{
+			auto it = pipelines_.find(reader.Read<CaptureId>());
+			if (it != pipelines_.end())
+			{
+				rhi.RHIBlockUntilGPUIdle();
+				rhi.RHIFreePipeline(*it->second);
+				pipelines_.erase(it);
+			}
+			break;
+		}
+		case CaptureChunk::CREATE_RENDER_PASS:
+		{
+			const CaptureId id = reader.Read<CaptureId>();
+			rhi::RenderPass::Descriptor desc{};
+			desc.is_for_present = reader.Read<bool>();
+			desc.attachments.resize(reader.Read<uint32_t>());
+			for (auto& attachment : desc.attachments)
+			{
+				attachment = reader.Read<rhi::RenderPass::AttachmentDesc>();
+			}
+			desc.subpasses.resize(reader.Read<uint32_t>());
+			for (auto& subpass : desc.subpasses)
+			{
+				subpass.color_attachments.resize(reader.Read<uint32_t>());
+				for (uint32_t& attachment : subpass.color_attachments)
+				{
+					attachment = reader.Read<uint32_t>();
+				}
+				subpass.input_attachments.resize(reader.Read<uint32_t>());
+				for (uint32_t& attachment : subpass.input_attachments)
+				{
+					attachment = reader.Read<uint32_t>();
+				}
+				subpass.dependencies.resize(reader.Read<uint32_t>());
+				for (size_t& dependency : subpass.dependencies)
+				{
+					dependency = static_cast<size_t>(reader.Read<uint64_t>());
+				}
+				subpass.use_depth_stencil = reader.Read<bool>();
+			}
+
+			auto it = render_passes_.find(id);
+			if (it != render_passes_.end())
+				retired_passes_.push_back(it->second);
+			render_passes_[id] = rhi.RHICreateRenderPass(desc);
+			break;
+		}
+		case CaptureChunk::CREATE_RENDER_TARGET:
+		{
+			const CaptureId id = reader.Read<CaptureId>();
+			rhi::RenderTarget::Descriptor desc{};
+			desc.pass = Find(render_passes_, reader.Read<CaptureId>());
+			desc.width = reader.Read<uint32_t>();
+			desc.height = reader.Read<uint32_t>();
+			desc.clear_value = reader.Read<glm::fvec4>();
+			desc.attachments.resize(reader.Read<uint32_t>());
+			bool is_complete = desc.pass != nullptr;
+			for (auto& attachment : desc.attachments)
+			{
+				attachment = Find(textures_, reader.Read<CaptureId>());
+				is_complete &= attachment != nullptr;
+			}
+			if (!is_complete)
+				break;
+
+			auto it = render_targets_.find(id);
+			if (it != render_targets_.end() && frame_)
+				frame_->render_target_dump.push_back(it->second);
+			render_targets_[id] = rhi.RHICreateRenderTarget(desc);
+			break;
+		}
+		case CaptureChunk::CREATE_DESCRIPTOR_SET:
+		{
+			const CaptureId id = reader.Read<CaptureId>();
+			auto it = descriptor_sets_.find(id);
+			if (it != descriptor_sets_.end())
+				retired_sets_.push_back(it->second);
+			descriptor_sets_[id] = rhi.RHICreateDescriptorSet();
+			break;
+		}
+		case CaptureChunk::ALLOCATE_DESCRIPTOR_SET:
+		{
+			rhi::DescriptorSet* set = Find(descriptor_sets_, reader.Read<CaptureId>());
+			rhi::DescriptorSetLayout* layout = Find(set_layouts_, reader.Read<CaptureId>());
+			if (set && layout && !desc_allocator_->Allocate(set, layout))
+				MLE_CORE_ERROR("[Replay] failed to allocate a descriptor set");
+			break;
+		}
+		case CaptureChunk::WRITE_DESCRIPTOR_SET:
+		{
+			rhi::DescriptorSet* set = Find(descriptor_sets_, reader.Read<CaptureId>());
+			const uint32_t write_count = reader.Read<uint32_t>();
+			rhi::DescriptorWriter& writer = rhi::DescriptorWriter::Begin(desc_allocator_.get());
+			for (uint32_t i = 0; i < write_count; ++i)
+			{
+				const uint32_t binding = reader.Read<uint32_t>();
+				const auto descriptor_type = reader.Read<DescriptorType>();
+				const CaptureId buffer_id = reader.Read<CaptureId>();
+				const CaptureId image_id = reader.Read<CaptureId>();
+				if (buffer_id != rhi::INVALID_CAPTURE_ID)
+				{
+					if (rhi::RHIBuffer* buffer = Find(buffers_, buffer_id))
+						writer.WriteBuffer(binding, buffer, descriptor_type);
+				}
+				else if (rhi::RHITexture* image = Find(textures_, image_id))
+				{
+					writer.WriteImage(binding, image, descriptor_type);
+				}
+			}
+			if (set)
+				writer.OverWrite(set);
+			break;
+		}
+		case CaptureChunk::COPY_BUFFER_TO_BUFFER:
+		{
+			rhi::CopyBufferToBufferDesc desc{};
+			desc.src = Find(buffers_, reader.Read<CaptureId>());
+			desc.src_offset = reader.Read<uint64_t>();
+			desc.dst = Find(buffers_, reader.Read<CaptureId>());
+			desc.dst_offset = reader.Read<uint64_t>();
+			desc.size = reader.Read<uint64_t>();
+			if (desc.src && desc.dst)
+				SubmitCopy([&desc](rhi::RHITransferEncoder& encoder) { encoder.CopyBufferToBuffer(desc); });
+			break;
+		}
+		case CaptureChunk::COPY_BUFFER_TO_IMAGE:
+		{
+			rhi::RHIBuffer* buffer = Find(buffers_, reader.Read<CaptureId>());
+			rhi::RHITexture* image = Find(textures_, reader.Read<CaptureId>());
+			const uint32_t width = reader.Read<uint32_t>();
+			const uint32_t height = reader.Read<uint32_t>();
+			const uint32_t layer_count = reader.Read<uint32_t>();
+			if (buffer && image)
+				SubmitCopy([=](rhi::RHITransferEncoder& encoder) { encoder.CopyBufferToImage(buffer, image, width, height, layer_count); });
+			break;
+		}
+		case CaptureChunk::COMMANDS:
+			RecordCommands(reader);
+			break;
+		case CaptureChunk::BEGIN_FRAME:
+		case CaptureChunk::END_FRAME:
+			break;
+		default:
+			// the size is known, so newer chunks can be skipped
+			MLE_CORE_WARN("[Replay] unknown chunk {0} skipped", static_cast<uint32_t>(type));
+			break;
+		}
+
+		if (reader.HasFailed())
+		{
+			MLE_CORE_ERROR("[Replay] chunk {0} is shorter than its contents, the capture is broken", static_cast<uint32_t>(type));
+			return false;
+		}
+		return true;
+	}
+
+	void CaptureReplayer::RecordCommands(rhi::CaptureReader& reader)
+	{
+		using rhi::CommandType;
+		using rhi::CaptureId;
+		if (!frame_)
+		{
+			MLE_CORE_ERROR("[Replay] commands outside of a frame");
+			return;
+		}
+		rhi::CommandList& cmd_list = frame_->command_list;
+		GPUProfiler& profiler = Renderer::GetInstance().GetGPUProfiler();
+
+		// everything up to the end of a render pass that can't begin is skipped
+		bool is_skipping_pass = false;
+		std::vector<rhi::RHIBuffer*> buffers;
+		std::vector<uint64_t> offsets;
+		std::vector<rhi::DescriptorSet*> sets;
+		std::vector<uint32_t> dynamic_offsets;
+
+		const uint32_t command_count = reader.Read<uint32_t>();
+		for (uint32_t i = 0; i < command_count && !reader.HasFailed(); ++i)
+		{
+			const auto type = reader.Read<CommandType>();
+			switch (type)
+			{
+			case CommandType::BEGIN_RENDER_PASS:
+			{
+				rhi::RenderPass* pass = Find(render_passes_, reader.Read<CaptureId>());
+				rhi::RenderTarget* render_target = Find(render_targets_, reader.Read<CaptureId>());
+				is_skipping_pass = !pass || !render_target;
+				if (!is_skipping_pass)
+					BeginRenderPass(cmd_list, *pass, *render_target);
+				break;
+			}
+			case CommandType::END_RENDER_PASS:
+				if (!is_skipping_pass)
+					EndRenderPass(cmd_list);
+				is_skipping_pass = false;
+				break;
+			case CommandType::NEXT_SUBPASS:
+				if (!is_skipping_pass)
+					NextSubpass(cmd_list);
+				break;
+			case CommandType::BIND_GFX_PIPELINE:
+			{
+				rhi::RHIPipeline* pipeline = Find(pipelines_, reader.Read<CaptureId>());
+				if (pipeline && !is_skipping_pass)
+					BindGfxPipeline(cmd_list, pipeline);
+				break;
+			}
+			case CommandType::BIND_VERTEX_BUFFERS:
+			{
+				const uint32_t first_binding = reader.Read<uint32_t>();
+				const uint32_t binding_count = reader.Read<uint32_t>();
+				buffers.resize(binding_count);
+				offsets.resize(binding_count);
+				bool is_complete = true;
+				for (uint32_t binding = 0; binding < binding_count; ++binding)
+				{
+					buffers[binding] = Find(buffers_, reader.Read<CaptureId>());
+					offsets[binding] = reader.Read<uint64_t>();
+					is_complete &= buffers[binding] != nullptr;
+				}
+				if (is_complete && !is_skipping_pass)
+					BindVertexBuffers(cmd_list, first_binding, binding_count, buffers.data(), offsets.data());
+				break;
+			}
+			case CommandType::BIND_INDEX_BUFFER:
+			{
+				rhi::RHIBuffer* buffer = Find(buffers_, reader.Read<CaptureId>());
+				const uint64_t offset = reader.Read<uint64_t>();
+				if (buffer && !is_skipping_pass)
+					BindIndexBuffer(cmd_list, buffer, offset);
+				break;
+			}
+			case CommandType::BIND_DESCRIPTOR_SETS:
+			{
+				rhi::PipelineLayout* layout = Find(pipeline_layouts_, reader.Read<CaptureId>());
+				const uint32_t first_set = reader.Read<uint32_t>();
+				sets.resize(reader.Read<uint32_t>());
+				bool is_complete = layout != nullptr;
+				for (auto& set : sets)
+				{
+					set = Find(descriptor_sets_, reader.Read<CaptureId>());
+					is_complete &= set != nullptr;
+				}
+				dynamic_offsets.resize(reader.Read<uint32_t>());
+				for (uint32_t& offset : dynamic_offsets)
+				{
+					offset = reader.Read<uint32_t>();
+				}
+				if (is_complete && !is_skipping_pass)
+					BindDescriptorSets(cmd_list, layout, first_set, static_cast<uint32_t>(sets.size()), sets.data(),
+						static_cast<uint32_t>(dynamic_offsets.size()), dynamic_offsets.data());
+				break;
+			}
+			case CommandType::SET_VIEWPORT:
+			{
+				float viewport[6];
+				for (float& value : viewport)
+				{
+					value = reader.Read<float>();
+				}
+				if (!is_skipping_pass)
+					SetViewport(cmd_list, viewport[0], viewport[1], viewport[2], viewport[3], viewport[4], viewport[5]);
+				break;
+			}
+			case CommandType::SET_SCISSOR:
+			{
+				const int32_t offset_x = reader.Read<int32_t>();
+				const int32_t offset_y = reader.Read<int32_t>();
+				const uint32_t width = reader.Read<uint32_t>();
+				const uint32_t height = reader.Read<uint32_t>();
+				if (!is_skipping_pass)
+					SetScissor(cmd_list, offset_x, offset_y, width, height);
+				break;
+			}
+			case CommandType::DRAW:
+			{
+				uint32_t args[4];
+				for (uint32_t& arg : args)
+				{
+					arg = reader.Read<uint32_t>();
+				}
+				if (!is_skipping_pass)
+					Draw(cmd_list, args[0], args[1], args[2], args[3]);
+				break;
+			}
+			case CommandType::DRAW_INDEXED:
+			{
+				const uint32_t index_count = reader.Read<uint32_t>();
+				const uint32_t instance_count = reader.Read<uint32_t>();
+				const uint32_t first_index = reader.Read<uint32_t>();
+				const int32_t offset = reader.Read<int32_t>();
+				const uint32_t first_instance = reader.Read<uint32_t>();
+				if (!is_skipping_pass)
+					DrawIndexed(cmd_list, index_count, instance_count, first_index, offset, first_instance);
+				break;
+			}
+			case CommandType::BUFFER_BARRIER:
+			{
+				rhi::BufferBarrierDesc desc{};
+				desc.buffer = Find(buffers_, reader.Read<CaptureId>());
+				desc.src_usage = reader.Read<BufferUsage>();
+				desc.src_write = reader.Read<bool>();
+				desc.dst_usage = reader.Read<BufferUsage>();
+				desc.dst_write = reader.Read<bool>();
+				if (desc.buffer)
+					BufferBarrier(cmd_list, desc);
+				break;
+			}
+			case CommandType::BEGIN_MARKER:
+			{
+				// points into the loaded file, it outlives the translation
+				const char* name = reader.ReadString();
+				cmd_list.BeginMarker(name);
+				open_scopes_.push_back(profiler.BeginScope(*frame_, name));
+				break;
+			}
+			case CommandType::END_MARKER:
+				if (open_scopes_.empty())
+					break;
+				profiler.EndScope(*frame_, open_scopes_.back());
+				open_scopes_.pop_back();
+				cmd_list.EndMarker();
+				break;
+			default:
+				// the payload size of an unknown command isn't known, nothing after it can be read
+				MLE_CORE_ERROR("[Replay] unknown command {0}, the rest of the frame is dropped", static_cast<uint32_t>(type));
+				return;
+			}
+		}
+		if (is_skipping_pass)
+			MLE_CORE_WARN("[Replay] a render pass of the frame isn't closed");
+	}
+
+	void CaptureReplayer::SubmitCopy(const std::function<void(rhi::RHITransferEncoder&)>& record)
+	{
+		// uploads are rare, they are submitted on their own and waited for like Renderer::LoadModel does
+		rhi::RHITransferEncoder& encoder = upload_cmd_buffer_->GetTransferEncoder();
+		encoder.Begin();
+		record(encoder);
+		encoder.End();
+
+		rhi::QueueSubmitDesc submit_info{};
+		rhi::RHIEncoderBase* encoders[] = { &encoder };
+		submit_info.encoders = encoders;
+		submit_info.cmds_count = 1;
+		rhi::RHICommands::TransferQueueSubmit(submit_info);
+		rhi::RHI::GetRHIInstance().RHIBlockUntilGPUIdle();
+	}
+}
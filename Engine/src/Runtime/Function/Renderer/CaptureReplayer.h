@@ -0,0 +1,84 @@
+#pragma once
+#include "FrameResource.h"
+#include "Runtime/Function/RHI/FrameCapture.h"
+
+namespace renderer {
+	/// <summary>
+	/// Executes a file written by rhi::FrameCapture on the current RHI, without the scene, the editor or the assets.
+	/// Setup() creates what the captured frames use, each ReplayFrame() records one captured frame into the
+	/// frame's command list, the renderer submits and presents it as usual. The render graph's pass markers
+	/// become GPUProfiler scopes again, so the per-pass timings are comparable with the ones of the live run.
+	/// Commands that refer to objects created before the capture started are dropped, with a single warning.
+	/// </summary>
+	class CaptureReplayer
+	{
+	public:
+		CaptureReplayer() = default;
+		~CaptureReplayer();
+
+		CaptureReplayer(CaptureReplayer const&) = delete;
+		CaptureReplayer& operator=(CaptureReplayer const&) = delete;
+
+		// Reads only the header, e.g. to size the window before the renderer is initialized
+		static bool ReadHeader(const std::string& file_path, rhi::CaptureHeader& header);
+
+		bool Load(const std::string& file_path);
+		// Runs everything recorded before the first frame
+		bool Setup();
+		// Returns false once there is no frame left, or the file is broken
+		bool ReplayFrame(FrameResource& frame);
+		// Starts over with the first frame, the resources of the setup are kept
+		void Rewind();
+		// Waits for the GPU and frees everything the replay created
+		void Release();
+
+		inline const rhi::CaptureHeader& GetHeader() const { return header_; };
+		inline uint32_t GetFrameCount() const { return header_.frame_count; };
+		inline uint32_t GetReplayedFrameCount() const { return replayed_frame_count_; };
+	private:
+		// Runs chunks until the reader is past a chunk of the given type
+		bool RunChunks(rhi::CaptureChunk last_chunk);
+		bool RunChunk(rhi::CaptureChunk type, rhi::CaptureReader& reader);
+		void RecordCommands(rhi::CaptureReader& reader);
+		void SubmitCopy(const std::function<void(rhi::RHITransferEncoder&)>& record);
+
+		// The object of an id in one of the tables, nullptr if it is unknown.
+		// Unknown ids come from objects the capture didn't see, reported once
+		template<typename Table>
+		auto Find(const Table& table, rhi::CaptureId id);
+
+		rhi::CaptureHeader header_{};
+		std::vector<uint8_t> data_;
+		rhi::CaptureReader reader_;
+		// where the chunks of the first frame start
+		size_t first_frame_offset_ = 0;
+		uint32_t replayed_frame_count_ = 0;
+		bool has_reported_missing_ = false;
+
+		// frees wait for the frame's fence, nullptr during the setup
+		FrameResource* frame_ = nullptr;
+		rhi::CommandBuffer* upload_cmd_buffer_ = nullptr;
+
+		rhi::DescriptorAllocatorPtr desc_allocator_;
+		rhi::DescriptorSetLayoutCachePtr layout_cache_;
+
+		std::unordered_map<rhi::CaptureId, rhi::BufferRef> buffers_;
+		std::unordered_map<rhi::CaptureId, rhi::TextureRef> textures_;
+		std::unordered_map<rhi::CaptureId, rhi::ShaderModule*> shaders_;
+		std::unordered_map<rhi::CaptureId, rhi::DescriptorSetLayoutRef> set_layouts_;
+		std::unordered_map<rhi::CaptureId, rhi::PipelineLayout*> pipeline_layouts_;
+		std::unordered_map<rhi::CaptureId, rhi::PipelineRef> pipelines_;
+		std::unordered_map<rhi::CaptureId, std::shared_ptr<rhi::RenderPass>> render_passes_;
+		std::unordered_map<rhi::CaptureId, std::shared_ptr<rhi::RenderTarget>> render_targets_;
+		std::unordered_map<rhi::CaptureId, std::shared_ptr<rhi::DescriptorSet>> descriptor_sets_;
+
+		// replaced while frames in flight may still use them, freed by Release()
+		std::vector<std::shared_ptr<rhi::RenderPass>> retired_passes_;
+		std::vector<std::shared_ptr<rhi::DescriptorSet>> retired_sets_;
+		std::vector<rhi::ShaderModule*> retired_shaders_;
+		std::vector<rhi::PipelineLayout*> retired_pipeline_layouts_;
+
+		// GPUProfiler scopes of the markers that are open
+		std::vector<uint32_t> open_scopes_;
+	};
+}
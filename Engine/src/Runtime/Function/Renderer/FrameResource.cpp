@@ -1,80 +1,157 @@
 #include "mlepch.h"
 #include "FrameResource.h"
-#include "Runtime/Function/RHI/RHI.h"
+#include "Runtime/Function/RHI/RHIBackend.h"
+#include "Runtime/Function/RHI/RHICommands.h"
 #include "Runtime/Resource/Vertex.h"
 
 namespace renderer {
 	void FrameResourceMngr::CreateFrames()
 	{
-		rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+		rhi::BackendRHI& rhi = rhi::GetBackendRHI();
 		for (uint8_t index = 0; index < MAX_FRAMES_IN_FLIGHT; index++)
 		{
 			frame_[index].command_buffer = rhi.RHICreateCommandBuffer();
 			frame_[index].in_flight_fence = rhi.RHICreateFence();
 			frame_[index].image_acquired_semaphore = rhi.RHICreateSemaphore();
 			frame_[index].render_finished_semaphore = rhi.RHICreateSemaphore();
+			frame_[index].timestamp_pool = rhi.RHICreateTimestampQueryPool(MAX_TIMESTAMPS);
 		}
 	}
 
 	void FrameResourceMngr::DestroyFrames()
 	{
-		rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+		rhi::BackendRHI& rhi = rhi::GetBackendRHI();
 		for (uint8_t index = 0; index < MAX_FRAMES_IN_FLIGHT; index++)
 		{
 			if (frame_[index].command_buffer)
 				delete frame_[index].command_buffer;
+			for (auto cmd_buffer : frame_[index].segment_command_buffers)
+			{
+				delete cmd_buffer;
+			}
+			frame_[index].segment_command_buffers.clear();
 
 			rhi.RHIDestroyFence(frame_[index].in_flight_fence);
 			rhi.RHIDestroySemaphore(frame_[index].image_acquired_semaphore);
 			rhi.RHIDestroySemaphore(frame_[index].render_finished_semaphore);
+			rhi.RHIDestroyQueryPool(frame_[index].timestamp_pool);
+			frame_[index].timestamp_scopes.clear();
 
-			for (auto texture : frame_[index].texture_dump)
-			{
-				rhi.RHIFreeTexture(*texture);
-			}
-			frame_[index].texture_dump.clear();
-			frame_[index].render_target_dump.clear();
+			ReleaseDumps(frame_[index]);
 		}
 	}
 
 	FrameResource& FrameResourceMngr::BeginFrame()
 	{
-		rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
-		// TEMP: will come up with a better gc strategy
-		for (auto& frame : frame_)
+		rhi::BackendRHI& rhi = rhi::GetBackendRHI();
+		Clean();
+		if (pending_frames_in_flight_ != frames_in_flight_)
 		{
-			if (rhi.RHIIsFenceReady(frame.in_flight_fence))
+			// the frames past the new count may still be in flight
+			rhi.RHIBlockUntilGPUIdle();
+			frames_in_flight_ = pending_frames_in_flight_;
+			for (auto& frame : frame_)
 			{
-				for (auto texture : frame.texture_dump)
-				{
-					rhi.RHIFreeTexture(*texture);
-				}
-				frame.texture_dump.clear();
-				frame.render_target_dump.clear();
+				ReleaseDumps(frame);
 			}
 		}
-		current_frame = (current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
-		rhi::Fence* fences[1] = { frame_[current_frame].in_flight_fence };
-		rhi.RHIWaitForFences(fences, 1);
+		if (is_next_frame_ready_)
+		{
+			// its fence has been waited for and reset already, so it has to be the next one even if the count changed since
+			current_frame = ready_frame_;
+			is_next_frame_ready_ = false;
+		}
+		else
+		{
+			current_frame = (current_frame + 1) % frames_in_flight_;
+			rhi::Fence* fences[1] = { frame_[current_frame].in_flight_fence };
+			rhi.RHIWaitForFences(fences, 1);
+		}
+		// waiting reset the fence, Clean wouldn't see it signaled until this frame comes around again
+		ReleaseDumps(frame_[current_frame]);
 
 		rhi.AcquireNextImage(frame_[current_frame].image_acquired_semaphore);
 
 		frame_[current_frame].command_buffer->Begin();
+		// the fence covers every submission of the frame, so its segment buffers are free again
+		frame_[current_frame].submitted_segment_count = 0;
 
 		return frame_[current_frame];
 	}
 
 	FrameResource& FrameResourceMngr::EndFrame()
 	{
-		frame_[current_frame].command_buffer->End();
+		FrameResource& frame = frame_[current_frame];
+		frame.command_list.Translate(*frame.command_buffer);
+		frame.command_list.Reset();
+		frame.command_buffer->End();
 		return frame_[current_frame];
 	}
 
+	void FrameResourceMngr::SetFramesInFlight(uint8_t count)
+	{
+		pending_frames_in_flight_ = std::clamp<uint8_t>(count, 1, MAX_FRAMES_IN_FLIGHT);
+	}
+
+	void FrameResourceMngr::WaitForNextFrame()
+	{
+		MLE_PROFILE_FUNCTION();
+		if (is_next_frame_ready_)
+			return;
+		ready_frame_ = (current_frame + 1) % frames_in_flight_;
+		rhi::Fence* fences[1] = { frame_[ready_frame_].in_flight_fence };
+		rhi::GetBackendRHI().RHIWaitForFences(fences, 1);
+		is_next_frame_ready_ = true;
+	}
+
+	void FrameResourceMngr::SubmitSegment()
+	{
+		MLE_PROFILE_FUNCTION();
+		FrameResource& frame = frame_[current_frame];
+		if (frame.command_list.IsEmpty())
+			return;
+
+		if (frame.submitted_segment_count == frame.segment_command_buffers.size())
+			frame.segment_command_buffers.push_back(rhi::GetBackendRHI().RHICreateCommandBuffer());
+		rhi::CommandBuffer* cmd_buffer = frame.segment_command_buffers[frame.submitted_segment_count++];
+
+		cmd_buffer->Begin();
+		frame.command_list.Translate(*cmd_buffer);
+		frame.command_list.Reset();
+		cmd_buffer->End();
+
+		// no semaphore, only the last submission writes the swapchain image
+		rhi::QueueSubmitDesc submit_info{};
+		rhi::RHIEncoderBase* encoders[] = { &cmd_buffer->GetGfxEncoder() };
+		submit_info.encoders = encoders;
+		submit_info.cmds_count = 1;
+		rhi::RHICommands::GfxQueueSubmit(submit_info);
+	}
+
 	void FrameResourceMngr::Clean()
 	{
+		rhi::BackendRHI& rhi = rhi::GetBackendRHI();
 		for (auto& frame : frame_)
 		{
-			
+			if (rhi.RHIIsFenceReady(frame.in_flight_fence))
+				ReleaseDumps(frame);
+		}
+	}
+
+	void FrameResourceMngr::ReleaseDumps(FrameResource& frame)
+	{
+		rhi::BackendRHI& rhi = rhi::GetBackendRHI();
+		for (auto texture : frame.texture_dump)
+		{
+			rhi.RHIFreeTexture(*texture);
+		}
+		frame.texture_dump.clear();
+		for (auto buffer : frame.buffer_dump)
+		{
+			rhi.RHIFreeBuffer(*buffer);
 		}
+		frame.buffer_dump.clear();
+		frame.render_target_dump.clear();
+		frame.render_pass_dump.clear();
 	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "Runtime/Function/RHI/RenderPass.h"
 #include "Runtime/Function/RHI/CommandBuffer.h"
+#include "Runtime/Function/RHI/CommandList.h"
 #include "Runtime/Function/RHI/RHIResource.h"
 #include "Runtime/Function/RHI/Descriptor.h"
 
@@ -8,6 +9,7 @@ namespace rhi {
 	class RHI;
 	struct Semaphore;
 	struct Fence;
+	struct QueryPool;
 }
 namespace renderer {
 	/// <summary>
@@ -17,20 +19,35 @@ namespace renderer {
 	{
 		// graphics, compute and transfer 
 		rhi::CommandBuffer* command_buffer = nullptr;
+		// graphics commands of the frame, translated into command_buffer when the frame ends
+		rhi::CommandList command_list;
+		// one per segment the render graph submitted before the end of the frame, created on first use
+		std::vector<rhi::CommandBuffer*> segment_command_buffers;
+		uint32_t submitted_segment_count = 0;
 
 		//Sync Objects
 		rhi::Fence* in_flight_fence = nullptr;
 		rhi::Semaphore* render_finished_semaphore = nullptr;
 		rhi::Semaphore* image_acquired_semaphore = nullptr;
 
+		// GPU timestamps, two per scope, read back by the GPUProfiler once in_flight_fence is signaled
+		rhi::QueryPool* timestamp_pool = nullptr;
+		std::vector<std::string> timestamp_scopes;
+
 		std::vector<rhi::TextureRef> texture_dump;
+		std::vector<rhi::BufferRef> buffer_dump;
 		std::vector<std::shared_ptr<rhi::RenderTarget>> render_target_dump;
+		// destroyed with the pipelines they created
+		std::vector<std::unique_ptr<rhi::RenderPass>> render_pass_dump;
 	};
 
 	class FrameResourceMngr
 	{
 	public:
-		static constexpr uint8_t MAX_FRAMES_IN_FLIGHT = 3;
+		// frames are created for the most frames in flight, per frame arrays can be sized with it
+		static constexpr uint8_t MAX_FRAMES_IN_FLIGHT = 4;
+		static constexpr uint8_t DEFAULT_FRAMES_IN_FLIGHT = 3;
+		static constexpr uint32_t MAX_TIMESTAMPS = 128;
 		virtual ~FrameResourceMngr() = default;
 
 		void CreateFrames();
@@ -39,12 +56,41 @@ namespace renderer {
 		inline FrameResource& GetCurrentFrame() { return frame_[current_frame]; };
 		inline uint8_t GetFrameIndex() { return current_frame; };
 
+		/// <summary>
+		/// 1 to MAX_FRAMES_IN_FLIGHT frames may be recorded while the GPU works on the previous ones.
+		/// Fewer frames lower the latency between the input and the image, more keep the GPU busier.
+		/// Takes effect at the next BeginFrame, which waits for the GPU to go idle first
+		/// </summary>
+		void SetFramesInFlight(uint8_t count);
+		inline uint8_t GetFramesInFlight() const { return pending_frames_in_flight_; };
+
+		// Waits for the GPU to be done with the frame BeginFrame starts next, so whatever happens
+		// in between, e.g. sampling the input, isn't delayed by that wait. BeginFrame doesn't wait again
+		void WaitForNextFrame();
+
 		FrameResource& EndFrame();
 
+		/// <summary>
+		/// Translates what the current frame has recorded so far into a command buffer of its own and submits it,
+		/// so the GPU starts on it while the rest of the frame is recorded. Submissions to the graphics queue run in order,
+		/// the frame's fence and semaphores stay on the last submission, made by Renderer::End.
+		/// Must be called outside of a render pass
+		/// </summary>
+		void SubmitSegment();
+
+		// Frees what the frames whose fences have signaled have dumped, never waits for the GPU
 		void Clean();
 	private:
+		// The GPU must be done with the frame
+		void ReleaseDumps(FrameResource& frame);
+
 		FrameResource frame_[MAX_FRAMES_IN_FLIGHT];
 		uint8_t current_frame = 0;
+		uint8_t frames_in_flight_ = DEFAULT_FRAMES_IN_FLIGHT;
+		uint8_t pending_frames_in_flight_ = DEFAULT_FRAMES_IN_FLIGHT;
+		// set by WaitForNextFrame
+		uint8_t ready_frame_ = 0;
+		bool is_next_frame_ready_ = false;
 
 	};	
 }
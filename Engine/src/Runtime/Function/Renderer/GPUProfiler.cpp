@@ -0,0 +1,125 @@
+#include "mlepch.h"
+#include "GPUProfiler.h"
+#include "Renderer.h"
+#include "RenderCommands.h"
+#include "Runtime/Function/RHI/RHI.h"
+
+namespace renderer {
+	void GPUProfiler::Init()
+	{
+		timestamp_period_ = rhi::GetBackendRHI().GetTimestampPeriod();
+		if (!IsSupported())
+			MLE_CORE_WARN("[GPUProfiler] the graphics queue doesn't support timestamps, GPU profiling is disabled");
+	}
+
+	void GPUProfiler::BeginFrame(FrameResource& frame)
+	{
+		frame_scope_ = INVALID_SCOPE;
+		is_recording_ = false;
+		if (!IsSupported())
+			return;
+
+		// the fence of this frame has been waited on, whatever it recorded last time is available
+		Resolve(frame);
+		frame.timestamp_scopes.clear();
+
+		if (!is_enabled_)
+			return;
+
+		// queries must be reset before they are written, and outside of any render pass
+		ResetQueryPool(frame.command_list, frame.timestamp_pool, 0, FrameResourceMngr::MAX_TIMESTAMPS);
+		is_recording_ = true;
+		frame_scope_ = BeginScope(frame, "Frame");
+	}
+
+	void GPUProfiler::EndFrame(FrameResource& frame)
+	{
+		EndScope(frame, frame_scope_);
+		frame_scope_ = INVALID_SCOPE;
+		is_recording_ = false;
+	}
+
+	uint32_t GPUProfiler::BeginScope(FrameResource& frame, const char* name)
+	{
+		if (!is_recording_ || (frame.timestamp_scopes.size() + 1) * 2 > FrameResourceMngr::MAX_TIMESTAMPS)
+			return INVALID_SCOPE;
+
+		const uint32_t scope = static_cast<uint32_t>(frame.timestamp_scopes.size());
+		frame.timestamp_scopes.emplace_back(name);
+		WriteTimestamp(frame.command_list, frame.timestamp_pool, scope * 2);
+		return scope;
+	}
+
+	void GPUProfiler::EndScope(FrameResource& frame, uint32_t scope)
+	{
+		if (scope == INVALID_SCOPE)
+			return;
+
+		WriteTimestamp(frame.command_list, frame.timestamp_pool, scope * 2 + 1);
+	}
+
+	const GPUScopeTiming* GPUProfiler::GetTiming(const char* name) const
+	{
+		auto it = std::find_if(timings_.begin(), timings_.end(), [name](GPUScopeTiming const& timing) {
+			return std::strcmp(timing.name, name) == 0; });
+		return it == timings_.end() ? nullptr : &(*it);
+	}
+
+	float GPUProfiler::GetFrameTime() const
+	{
+		const GPUScopeTiming* timing = GetTiming("Frame");
+		return timing ? timing->last : -1.0f;
+	}
+
+	void GPUProfiler::Resolve(FrameResource& frame)
+	{
+		const uint32_t query_count = static_cast<uint32_t>(frame.timestamp_scopes.size()) * 2;
+		if (query_count == 0)
+			return;
+
+		query_results_.resize(query_count);
+		// Fails if a scope was never closed, keep the last timings then
+		if (!rhi::GetBackendRHI().RHIGetQueryResults(frame.timestamp_pool, 0, query_count, query_results_.data()))
+			return;
+
+		timings_.clear();
+		for (uint32_t scope = 0; scope < frame.timestamp_scopes.size(); ++scope)
+		{
+			const uint64_t begin = query_results_[scope * 2];
+			const uint64_t end = query_results_[scope * 2 + 1];
+			const float elapsed = end > begin ? static_cast<float>(end - begin) * timestamp_period_ * 1e-6f : 0.0f;
+
+			auto [it, inserted] = histories_.try_emplace(frame.timestamp_scopes[scope]);
+			ScopeHistory& history = it->second;
+			history.samples[history.head] = elapsed;
+			history.head = (history.head + 1) % HISTORY_LENGTH;
+			history.count = std::min(history.count + 1, HISTORY_LENGTH);
+
+			GPUScopeTiming& timing = timings_.emplace_back();
+			timing.name = it->first.c_str();
+			timing.last = elapsed;
+			timing.min = std::numeric_limits<float>::max();
+			timing.max = 0.0f;
+			float sum = 0.0f;
+			for (uint32_t i = 0; i < history.count; ++i)
+			{
+				sum += history.samples[i];
+				timing.min = std::min(timing.min, history.samples[i]);
+				timing.max = std::max(timing.max, history.samples[i]);
+			}
+			timing.average = sum / history.count;
+		}
+	}
+
+	// --------------------------------------------------------------
+	GPUProfileScope::GPUProfileScope(FrameResource& frame, const char* name)
+		:frame_(frame)
+	{
+		scope_ = Renderer::GetInstance().GetGPUProfiler().BeginScope(frame_, name);
+	}
+
+	GPUProfileScope::~GPUProfileScope()
+	{
+		Renderer::GetInstance().GetGPUProfiler().EndScope(frame_, scope_);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "FrameResource.h"
+
+namespace renderer {
+	struct GPUScopeTiming
+	{
+		const char* name = nullptr;
+		// in milliseconds, the last value is from the most recently resolved frame
+		float last = 0.0f;
+		float average = 0.0f;
+		float min = 0.0f;
+		float max = 0.0f;
+	};
+
+	/// <summary>
+	/// Times render graph passes and user scopes on the GPU with timestamp queries.
+	/// Every frame in flight writes into its own query pool, which is read back the next time
+	/// the frame comes around, right after its fence has been waited on, so it never stalls.
+	/// </summary>
+	class GPUProfiler
+	{
+	public:
+		static constexpr uint32_t INVALID_SCOPE = std::numeric_limits<uint32_t>::max();
+		// samples kept per scope for the rolling statistics
+		static constexpr uint32_t HISTORY_LENGTH = 120;
+
+		void Init();
+
+		// Must be called after the frame's fence has been waited on and its command buffer has begun
+		void BeginFrame(FrameResource& frame);
+		void EndFrame(FrameResource& frame);
+
+		// Scopes may nest, each one takes two queries of the frame's pool
+		uint32_t BeginScope(FrameResource& frame, const char* name);
+		void EndScope(FrameResource& frame, uint32_t scope);
+
+		// Scopes of the most recently resolved frame, in recording order. The frame itself comes first
+		inline const std::vector<GPUScopeTiming>& GetTimings() const { return timings_; };
+		const GPUScopeTiming* GetTiming(const char* name) const;
+		// Whole frame of the most recently resolved frame in milliseconds, negative if there is none
+		float GetFrameTime() const;
+
+		inline bool IsSupported() const { return timestamp_period_ > 0.0f; };
+		inline bool IsEnabled() const { return is_enabled_ && IsSupported(); };
+		inline void SetEnabled(bool enabled) { is_enabled_ = enabled; };
+	private:
+		void Resolve(FrameResource& frame);
+
+		struct ScopeHistory
+		{
+			float samples[HISTORY_LENGTH]{};
+			uint32_t count = 0;
+			uint32_t head = 0;
+		};
+		// keyed by name, names are usually pass names and literals, so compare the strings
+		std::unordered_map<std::string, ScopeHistory> histories_;
+		std::vector<GPUScopeTiming> timings_;
+		std::vector<uint64_t> query_results_;
+
+		float timestamp_period_ = 0.0f;
+		bool is_enabled_ = true;
+		// queries of the current frame have been reset, scopes can be written
+		bool is_recording_ = false;
+		uint32_t frame_scope_ = INVALID_SCOPE;
+	};
+
+	// Times everything recorded into the frame's command buffer during its lifetime,
+	// e.g. a part of an Execute lambda
+	class GPUProfileScope
+	{
+	public:
+		GPUProfileScope(FrameResource& frame, const char* name);
+		~GPUProfileScope();
+
+		GPUProfileScope(GPUProfileScope const&) = delete;
+		GPUProfileScope& operator=(GPUProfileScope const&) = delete;
+	private:
+		FrameResource& frame_;
+		uint32_t scope_;
+	};
+}
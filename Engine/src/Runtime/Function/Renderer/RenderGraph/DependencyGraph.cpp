@@ -10,6 +10,12 @@ namespace renderer {
 
 	void DependencyGraph::Cull()
 	{
+		// Cull runs again on every compile, only targets start with a reader
+		for (Node* const node : nodes_)
+		{
+			node->out_degree_ = node->is_target_ ? 1 : 0;
+		}
+
 		// update in degree for each node
 		for (Edge* const edge : edges_) {
 			Node* node = nodes_[edge->from];
@@ -43,6 +49,17 @@ namespace renderer {
 		}
 	}
 
+	std::vector<DependencyGraph::Edge*> DependencyGraph::Unlink(Node const* node)
+	{
+		uint32_t const id = node->GetId();
+		auto it = std::stable_partition(edges_.begin(), edges_.end(),
+			[id](auto edge) { return edge->from != id && edge->to != id; });
+
+		std::vector<Edge*> result(it, edges_.end());
+		edges_.erase(it, edges_.end());
+		return result;
+	}
+
 	void DependencyGraph::Clear()
 	{
 		nodes_.clear();
@@ -41,11 +41,14 @@ namespace renderer {
 			inline uint8_t GetOutDegree() const noexcept { return out_degree_; };
 
 			bool IsCulled() const noexcept { return out_degree_ == 0; };
+			// has side effects, kept even if nothing reads from it
+			bool IsTarget() const noexcept { return is_target_; };
 
-			void DontCull() { out_degree_++; };
+			void DontCull() { out_degree_++; is_target_ = true; };
 
 		private:
 			uint8_t out_degree_ = 0;
+			bool is_target_ = false;
 
 			uint32_t id_;
 		};
@@ -57,6 +60,9 @@ namespace renderer {
 
 		void Cull();
 
+		// Takes the edges from and to the node out of the graph and returns them, nothing keeps the node then
+		std::vector<Edge*> Unlink(Node const* node);
+
 		void Clear();
 
 	private:
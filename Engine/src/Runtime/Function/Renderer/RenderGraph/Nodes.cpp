@@ -20,6 +20,62 @@ namespace renderer {
 			dependencies_.push_back(std::numeric_limits<uint32_t>::max());
 	}
 
+	void PassNode::ResetCompileState()
+	{
+		dependencies_.clear();
+		// RegisterBuffer places them again in the new order
+		buffer_barriers_.clear();
+	}
+
+	void PassNode::AddBufferAccess(ResourceHandle handle, BufferUsage usage, bool is_write)
+	{
+		for (auto& access : buffer_accesses_)
+		{
+			if (access.handle == handle && access.is_write == is_write)
+			{
+				access.usage |= usage;
+				return;
+			}
+		}
+		buffer_accesses_.push_back({ handle, usage, is_write });
+	}
+
+	void PassNode::RegisterBuffer(ResourceNode* resource_node, bool is_write)
+	{
+		auto handle = resource_node->resource_index_;
+		VirtualResource* resource = rg_.GetResource(handle);
+		assert(resource->type_ == VirtualResourceType::BUFFER && "resource is not a buffer");
+		Resource<RenderGraphBuffer>* buffer = static_cast<Resource<RenderGraphBuffer>*>(resource);
+		auto& rg_buffer = buffer->resource_;
+		resource->NeedByPass(this);
+
+		auto it = std::find_if(buffer_accesses_.begin(), buffer_accesses_.end(), [=](const BufferAccess& access) {
+			return access.handle == handle && access.is_write == is_write; });
+		assert(it != buffer_accesses_.end() && "buffer access is not declared");
+		const BufferUsage usage = it->usage;
+
+		if (EnumHasFlag(usage, BufferUsage::UNIFORM))
+			rg_buffer.desc_.usage |= ResourceTypes::RESOURCE_TYPE_UNIFORM_BUFFER;
+		if (EnumHasFlag(usage, BufferUsage::STORAGE))
+			rg_buffer.desc_.usage |= ResourceTypes::RESOURCE_TYPE_STORAGE_BUFFER;
+		if (EnumHasFlag(usage, BufferUsage::INDIRECT))
+			rg_buffer.desc_.usage |= ResourceTypes::RESOURCE_TYPE_INDIRECT_BUFFER;
+		if (EnumHasFlag(usage, BufferUsage::VERTEX))
+			rg_buffer.desc_.usage |= ResourceTypes::RESOURCE_TYPE_VERTEX_BUFFER;
+		if (EnumHasFlag(usage, BufferUsage::INDEX))
+			rg_buffer.desc_.usage |= ResourceTypes::RESOURCE_TYPE_INDEX_BUFFER;
+
+		// Passes are registered in execution order, so the last access is the one to wait for.
+		// Read after read needs nothing.
+		if (rg_buffer.last_pass && rg_buffer.last_pass != this && (rg_buffer.last_write || is_write))
+		{
+			buffer_barriers_.push_back({ resource, rg_buffer.last_usage, rg_buffer.last_write, usage, is_write });
+		}
+		rg_buffer.last_usage = usage;
+		rg_buffer.last_write = is_write;
+		rg_buffer.last_pass = this;
+	}
+
 	std::unique_ptr<rhi::DescriptorSetPtr[]> PassNode::GetSets()
 	{
 		auto sets = std::make_unique<rhi::DescriptorSetPtr[]>(100);
@@ -30,12 +86,14 @@ namespace renderer {
 	RenderPassNode::RenderPassNode(const char* name, RenderGraph& rg, RenderGraphPassBase* base)
 		:PassNode(name, rg), pass_base_(base)
 	{
-		subpass_graph_ = new RenderGraph();
+		// subpasses share the arena of the render graph
+		subpass_graph_ = rg.GetArena().New<RenderGraph>(rg.GetArena());
 	}
 	RenderPassNode::~RenderPassNode()
 	{
 		subpass_graph_->Clear();
-		delete subpass_graph_;
+		engine::LinearArena::Delete(subpass_graph_);
+		engine::LinearArena::Delete(pass_base_);
 	}
 	void RenderPassNode::Resolve()
 	{
@@ -70,6 +128,7 @@ namespace renderer {
 	void RenderPassNode::AddAttachment(ResourceHandle handle, LoadOp load_operation, StoreOp store_operation)
 	{
 		VirtualResource* resource = rg_.GetResource(handle);
+		assert(resource->type_ == VirtualResourceType::TEXTURE && "only textures can be attachments");
 		Resource<RenderGraphTexture>* texture = static_cast<Resource<RenderGraphTexture>*>(resource);
 
 		auto& rp_desc = pass_base_->desc_;
@@ -84,6 +143,8 @@ namespace renderer {
 		attachment.load_op = load_operation;
 		attachment.store_op = store_operation;
 
+		attachment.is_read_by_earlier_frames = dynamic_cast<HistoryResourceBase*>(resource) != nullptr;
+
 		auto& rt_desc = render_target_.desc_;
 		// Set up the attachments for framebuffer
 		rt_desc.attachments.emplace_back(&texture->resource_);
@@ -125,6 +186,8 @@ namespace renderer {
 
 	void RenderPassNode::Instantiate()
 	{
+		if (pass_base_->actual_rp_)
+			rg_.DumpRenderPass(std::move(pass_base_->actual_rp_));
 		pass_base_->Instantiate();
 
 		for (auto& desc : pipelines_)
@@ -145,6 +208,13 @@ namespace renderer {
 		render_target_.Destroy(resource);
 	}
 
+	void RenderPassNode::ResetCompileState()
+	{
+		PassNode::ResetCompileState();
+		// the subpass graph appends them again when this pass is resolved
+		pass_base_->desc_.subpasses.clear();
+	}
+
 	void RenderPassNode::AssembleRenderTarget()
 	{
 		
@@ -168,6 +238,12 @@ namespace renderer {
 		parent_->pass_base_->desc_.subpasses.emplace_back(subpass_desc_);
 	}
 
+	void SubpassNode::ResetCompileState()
+	{
+		PassNode::ResetCompileState();
+		subpass_desc_ = {};
+	}
+
 	void SubpassNode::RegisterResource(ResourceNode* resource_node, Usage usage)
 	{
 		auto handle = resource_node->resource_index_;
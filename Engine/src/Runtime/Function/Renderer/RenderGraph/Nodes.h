@@ -27,11 +27,16 @@ namespace renderer {
 		virtual char const* GetName() const noexcept override { return pass_name_; };
 
 		virtual void RegisterResource(ResourceNode* resource_node, Usage usage) = 0;
+		// buffers are accessed through descriptors or bindings, never as attachments
+		void RegisterBuffer(ResourceNode* resource_node, bool is_write);
+		void AddBufferAccess(ResourceHandle handle, BufferUsage usage, bool is_write);
 
 		virtual void Instantiate() {};
 		virtual void Execute(FrameResource& resource) {};
 		virtual void Resolve() {};
 		virtual void UpdateAttachmentLayout(ResourceHandle handle) {};
+		// Forgets what the last compile derived, called at the start of every compile
+		virtual void ResetCompileState();
 
 		std::unique_ptr<rhi::DescriptorSetPtr[]> GetSets();
 
@@ -43,14 +48,34 @@ namespace renderer {
 		std::vector<size_t> dependencies_;
 
 		bool is_subpass_ = false;
+
+		// Evaluated every frame, the pass is skipped when it returns false
+		std::function<bool()> enable_predicate_;
+
+		// what has been recorded is submitted once this pass is done
+		bool submit_after_ = false;
 	protected:
 		RenderGraph& rg_;
 		const char* pass_name_ = nullptr;
 
-		// resources that this pass needs to devirtualize
-		std::unordered_set<VirtualResource*> devirtualize_;
-		// resources that this pass needs to destroy
-		std::unordered_set<VirtualResource*> destroy_;
+		struct BufferAccess
+		{
+			ResourceHandle handle;
+			BufferUsage usage;
+			bool is_write;
+		};
+		std::vector<BufferAccess> buffer_accesses_;
+
+		struct BufferBarrier
+		{
+			VirtualResource* resource;
+			BufferUsage src_usage;
+			bool src_write;
+			BufferUsage dst_usage;
+			bool dst_write;
+		};
+		// recorded before the pass begins
+		std::vector<BufferBarrier> buffer_barriers_;
 	};
 
 	class SubpassNode : public PassNode
@@ -63,6 +88,7 @@ namespace renderer {
 
 		virtual void RegisterResource(ResourceNode* resource_node, Usage usage) override;
 		virtual void Resolve() override;
+		virtual void ResetCompileState() override;
 
 		RenderPassNode*	parent_ = nullptr;
 
@@ -92,6 +118,7 @@ namespace renderer {
 		virtual void Execute(FrameResource& resource) override;
 		virtual void Resolve() override;
 		virtual void UpdateAttachmentLayout(ResourceHandle handle) override;
+		virtual void ResetCompileState() override;
 
 		virtual void AssembleRenderTarget();
 
@@ -100,7 +127,8 @@ namespace renderer {
 
 		std::unordered_map<ResourceHandle, size_t> declared_resources_;
 	protected:
-		std::unique_ptr<RenderGraphPassBase>		pass_base_;
+		// allocated from the render graph's arena
+		RenderGraphPassBase*	pass_base_;
 		RenderGraphRenderTarget	render_target_;
 
 		std::vector<rhi::RHIPipeline::Descriptor> pipelines_;
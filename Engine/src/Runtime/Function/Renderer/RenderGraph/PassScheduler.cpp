@@ -0,0 +1,300 @@
+#include "mlepch.h"
+#include "PassScheduler.h"
+#include "Nodes.h"
+#include "VirtualResource.h"
+
+namespace renderer {
+	const char* ToString(ScheduleHeuristic heuristic)
+	{
+		switch (heuristic)
+		{
+		case ScheduleHeuristic::DECLARATION_ORDER:		return "Declaration Order";
+		case ScheduleHeuristic::MIN_PEAK_MEMORY:		return "Min Peak Memory";
+		case ScheduleHeuristic::MAX_BARRIER_DISTANCE:	return "Max Barrier Distance";
+		default:										return "Unknown";
+		}
+	}
+
+	PassScheduler::PassScheduler(DependencyGraph& graph, const std::vector<PassNode*>& passes, const std::vector<ResourceNode*>& resource_nodes)
+		:passes_(passes)
+	{
+		const size_t pass_count = passes_.size();
+		predecessors_.resize(pass_count);
+		successors_.resize(pass_count);
+		producers_.resize(pass_count);
+		pass_resources_.resize(pass_count);
+
+		// writer and readers of every resource node(one version of a resource)
+		struct Version
+		{
+			uint32_t writer = INVALID_INDEX;
+			std::vector<uint32_t> readers;
+		};
+		std::unordered_map<uint32_t, Version> versions;
+		for (uint32_t i = 0; i < pass_count; ++i)
+		{
+			for (auto const& edge : graph.GetIncomingEdges(passes_[i]))
+			{
+				versions[edge->from].readers.push_back(i);
+			}
+			for (auto const& edge : graph.GetOutgoingEdges(passes_[i]))
+			{
+				versions[edge->to].writer = i;
+			}
+		}
+
+		// resource nodes are created in write order, so the previous node with the same handle is the previous version
+		std::unordered_map<ResourceHandle, Version*> last_versions;
+		std::unordered_map<ResourceHandle, uint32_t> transient_indices;
+		for (ResourceNode* resource_node : resource_nodes)
+		{
+			auto it = versions.find(resource_node->GetId());
+			if (it == versions.end())
+				continue;
+
+			Version& version = it->second;
+			const ResourceHandle handle = resource_node->resource_index_;
+
+			// read after write
+			if (version.writer != INVALID_INDEX)
+			{
+				for (uint32_t reader : version.readers)
+				{
+					AddDependency(version.writer, reader, true);
+				}
+			}
+
+			// write after write, write after read
+			auto last = last_versions.find(handle);
+			if (last != last_versions.end() && version.writer != INVALID_INDEX)
+			{
+				Version* previous = last->second;
+				if (previous->writer != INVALID_INDEX)
+					AddDependency(previous->writer, version.writer, false);
+				for (uint32_t reader : previous->readers)
+				{
+					AddDependency(reader, version.writer, false);
+				}
+			}
+			last_versions[handle] = &version;
+
+			VirtualResource* resource = resource_node->GetResource();
+			const uint64_t size = resource->GetMemorySize();
+			if (!resource->IsTransient() || size == 0)
+				continue;
+
+			auto transient = transient_indices.find(handle);
+			if (transient == transient_indices.end())
+			{
+				transient = transient_indices.emplace(handle, static_cast<uint32_t>(transient_resources_.size())).first;
+				transient_resources_.emplace_back().size = size;
+			}
+			auto& users = transient_resources_[transient->second].users;
+			if (version.writer != INVALID_INDEX)
+				users.push_back(version.writer);
+			users.insert(users.end(), version.readers.begin(), version.readers.end());
+		}
+
+		for (uint32_t index = 0; index < transient_resources_.size(); ++index)
+		{
+			auto& users = transient_resources_[index].users;
+			std::sort(users.begin(), users.end());
+			users.erase(std::unique(users.begin(), users.end()), users.end());
+			for (uint32_t user : users)
+			{
+				pass_resources_[user].push_back(index);
+			}
+		}
+
+		// Present pass goes last no matter what
+		for (uint32_t i = 0; i < pass_count; ++i)
+		{
+			if (dynamic_cast<PresentPassNode*>(passes_[i]) == nullptr)
+				continue;
+			for (uint32_t j = 0; j < pass_count; ++j)
+			{
+				if (j != i)
+					AddDependency(j, i, false);
+			}
+		}
+	}
+
+	void PassScheduler::AddDependency(uint32_t from, uint32_t to, bool need_barrier)
+	{
+		if (from == to)
+			return;
+
+		predecessors_[to].push_back(from);
+		successors_[from].push_back(to);
+		if (need_barrier)
+			producers_[to].push_back(from);
+	}
+
+	std::vector<PassNode*> PassScheduler::Schedule(ScheduleHeuristic heuristic) const
+	{
+		std::vector<PassNode*> result;
+		result.reserve(passes_.size());
+		for (uint32_t index : ScheduleIndices(heuristic))
+		{
+			result.push_back(passes_[index]);
+		}
+		return result;
+	}
+
+	ScheduleEstimate PassScheduler::Estimate(const std::vector<PassNode*>& order) const
+	{
+		std::vector<uint32_t> indices;
+		indices.reserve(order.size());
+		for (PassNode* pass : order)
+		{
+			auto it = std::find(passes_.begin(), passes_.end(), pass);
+			assert(it != passes_.end() && "pass is not part of this schedule");
+			indices.push_back(static_cast<uint32_t>(it - passes_.begin()));
+		}
+		return EstimateIndices(indices);
+	}
+
+	std::vector<uint32_t> PassScheduler::ScheduleIndices(ScheduleHeuristic heuristic) const
+	{
+		const uint32_t pass_count = static_cast<uint32_t>(passes_.size());
+
+		std::vector<uint32_t> declaration_order(pass_count);
+		for (uint32_t i = 0; i < pass_count; ++i)
+		{
+			declaration_order[i] = i;
+		}
+		if (heuristic == ScheduleHeuristic::DECLARATION_ORDER)
+			return declaration_order;
+
+		// List scheduling: pick the best ready pass each step, ties go to the one declared first
+		std::vector<uint32_t> order;
+		order.reserve(pass_count);
+		std::vector<uint32_t> position(pass_count, INVALID_INDEX);
+		std::vector<size_t> unscheduled_predecessors(pass_count);
+		std::vector<uint32_t> ready;
+		for (uint32_t i = 0; i < pass_count; ++i)
+		{
+			unscheduled_predecessors[i] = predecessors_[i].size();
+			if (unscheduled_predecessors[i] == 0)
+				ready.push_back(i);
+		}
+
+		std::vector<size_t> pending_users(transient_resources_.size());
+		std::vector<bool> alive(transient_resources_.size(), false);
+		for (size_t i = 0; i < transient_resources_.size(); ++i)
+		{
+			pending_users[i] = transient_resources_[i].users.size();
+		}
+
+		while (!ready.empty())
+		{
+			auto best = ready.begin();
+			int64_t best_score = std::numeric_limits<int64_t>::max();
+			for (auto it = ready.begin(); it != ready.end(); ++it)
+			{
+				const uint32_t candidate = *it;
+				int64_t score = 0;
+				if (heuristic == ScheduleHeuristic::MIN_PEAK_MEMORY)
+				{
+					// memory this pass brings in minus memory it lets go
+					for (uint32_t resource : pass_resources_[candidate])
+					{
+						const int64_t size = static_cast<int64_t>(transient_resources_[resource].size);
+						if (!alive[resource])
+							score += size;
+						if (pending_users[resource] == 1)
+							score -= size;
+					}
+				}
+				else
+				{
+					// the closest producer decides how long the barrier has to wait
+					int64_t distance = std::numeric_limits<int32_t>::max();
+					for (uint32_t producer : producers_[candidate])
+					{
+						distance = std::min<int64_t>(distance, static_cast<int64_t>(order.size()) - position[producer]);
+					}
+					score = -distance;
+				}
+
+				if (score < best_score || (score == best_score && candidate < *best))
+				{
+					best = it;
+					best_score = score;
+				}
+			}
+
+			const uint32_t pass = *best;
+			ready.erase(best);
+
+			position[pass] = static_cast<uint32_t>(order.size());
+			order.push_back(pass);
+
+			for (uint32_t resource : pass_resources_[pass])
+			{
+				alive[resource] = --pending_users[resource] != 0;
+			}
+			for (uint32_t successor : successors_[pass])
+			{
+				if (--unscheduled_predecessors[successor] == 0)
+					ready.push_back(successor);
+			}
+		}
+
+		if (order.size() != pass_count)
+		{
+			MLE_CORE_ERROR("[RenderGraph] cyclic pass dependencies, falling back to declaration order");
+			return declaration_order;
+		}
+		return order;
+	}
+
+	ScheduleEstimate PassScheduler::EstimateIndices(const std::vector<uint32_t>& order) const
+	{
+		ScheduleEstimate estimate{};
+
+		std::vector<uint32_t> position(passes_.size(), INVALID_INDEX);
+		for (uint32_t i = 0; i < order.size(); ++i)
+		{
+			position[order[i]] = i;
+		}
+
+		// sweep over the schedule, a resource lives from its first user to its last user
+		std::vector<uint64_t> allocated(order.size() + 1, 0);
+		std::vector<uint64_t> released(order.size() + 1, 0);
+		for (auto const& resource : transient_resources_)
+		{
+			if (resource.users.empty())
+				continue;
+			uint32_t first = INVALID_INDEX;
+			uint32_t last = 0;
+			for (uint32_t user : resource.users)
+			{
+				first = std::min(first, position[user]);
+				last = std::max(last, position[user]);
+			}
+			allocated[first] += resource.size;
+			released[last] += resource.size;
+		}
+
+		uint64_t alive = 0;
+		for (size_t step = 0; step < order.size(); ++step)
+		{
+			alive += allocated[step];
+			estimate.peak_memory = std::max(estimate.peak_memory, alive);
+			alive -= released[step];
+		}
+
+		// every order has the same producer -> consumer hazards, only how close they end up differs
+		for (uint32_t pass = 0; pass < producers_.size(); ++pass)
+		{
+			for (uint32_t producer : producers_[pass])
+			{
+				if (position[pass] - position[producer] == 1)
+					estimate.stalling_barrier_count++;
+			}
+		}
+
+		return estimate;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "DependencyGraph.h"
+
+namespace renderer {
+	class PassNode;
+	class ResourceNode;
+
+	enum class ScheduleHeuristic : uint8_t
+	{
+		// keep the order in which the passes were added
+		DECLARATION_ORDER = 0,
+		// keep as few transient resources alive at the same time as possible
+		MIN_PEAK_MEMORY = 1,
+		// move consumers away from their producers, so barriers have other work to hide behind
+		MAX_BARRIER_DISTANCE = 2,
+		COUNT
+	};
+
+	const char* ToString(ScheduleHeuristic heuristic);
+
+	struct ScheduleEstimate
+	{
+		ScheduleHeuristic heuristic = ScheduleHeuristic::DECLARATION_ORDER;
+		// bytes of non-imported resources that are alive at the same time
+		uint64_t peak_memory = 0;
+		// barriers whose producer runs right before the consumer, nothing can overlap them
+		uint32_t stalling_barrier_count = 0;
+	};
+
+	/// <summary>
+	/// Reorders the non-culled passes of a render graph.
+	/// Every candidate is a topological order of the read/write dependencies
+	/// (read after write, write after read and write after write), the present pass always goes last.
+	/// </summary>
+	class PassScheduler
+	{
+	public:
+		PassScheduler(DependencyGraph& graph, const std::vector<PassNode*>& passes, const std::vector<ResourceNode*>& resource_nodes);
+
+		std::vector<PassNode*> Schedule(ScheduleHeuristic heuristic) const;
+
+		ScheduleEstimate Estimate(const std::vector<PassNode*>& order) const;
+	private:
+		static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+		void AddDependency(uint32_t from, uint32_t to, bool need_barrier);
+
+		std::vector<uint32_t> ScheduleIndices(ScheduleHeuristic heuristic) const;
+		ScheduleEstimate EstimateIndices(const std::vector<uint32_t>& order) const;
+
+		struct TransientResource
+		{
+			uint64_t size = 0;
+			std::vector<uint32_t> users;
+		};
+
+		std::vector<PassNode*> passes_;
+		// passes that must run before, indexed by pass
+		std::vector<std::vector<uint32_t>> predecessors_;
+		std::vector<std::vector<uint32_t>> successors_;
+		// passes that wrote something this pass reads, indexed by pass
+		std::vector<std::vector<uint32_t>> producers_;
+
+		std::vector<TransientResource> transient_resources_;
+		// transient resources used by each pass
+		std::vector<std::vector<uint32_t>> pass_resources_;
+	};
+}
@@ -56,13 +56,82 @@ namespace renderer {
 		return *this;
 	}
 
+	RenderGraph::RenderPassBuilder& RenderGraph::RenderPassBuilder::ReadPrevious(ResourceHandle resource)
+	{
+		rg_.ReadPrevious(node_, resource);
+
+		return *this;
+	}
+	RenderGraph::RenderPassBuilder& RenderGraph::RenderPassBuilder::ReadBuffer(ResourceHandle resource, BufferUsage usage)
+	{
+		rg_.ReadBuffer(node_, resource, usage);
+
+		return *this;
+	}
+	RenderGraph::RenderPassBuilder& RenderGraph::RenderPassBuilder::WriteBuffer(ResourceHandle resource, BufferUsage usage)
+	{
+		rg_.WriteBuffer(node_, resource, usage);
+
+		return *this;
+	}
+
 	RenderGraph::RenderPassBuilder& RenderGraph::RenderPassBuilder::SetPipeline(const rhi::RHIPipeline::Descriptor& desc)
 	{
 		rg_.SetPipelineInternal(node_, desc);
 		return *this;
 	}
 
+	RenderGraph::RenderPassBuilder& RenderGraph::RenderPassBuilder::EnableIf(std::function<bool()> predicate)
+	{
+		rg_.SetPassPredicate(node_, std::move(predicate));
+		return *this;
+	}
+
+	RenderGraph::RenderPassBuilder& RenderGraph::RenderPassBuilder::Static(std::function<void(RenderGraph&, FrameResource&)> update)
+	{
+		rg_.MakeStaticInternal(node_, std::move(update));
+		return *this;
+	}
+
+	RenderGraph::RenderPassBuilder& RenderGraph::RenderPassBuilder::SubmitAfter()
+	{
+		node_->submit_after_ = true;
+		return *this;
+	}
+
 	//-----------------------------------------------------------------
+	void RenderGraph::DumpRenderPass(std::unique_ptr<rhi::RenderPass> render_pass)
+	{
+		if (renderer_)
+		{
+			renderer_->frames_manager_.GetCurrentFrame().render_pass_dump.push_back(std::move(render_pass));
+			return;
+		}
+		// no frames to dump into
+		rhi::GetBackendRHI().RHIBlockUntilGPUIdle();
+	}
+
+	void RenderGraph::DumpHistoryResources()
+	{
+		if (history_resources_.empty())
+			return;
+		if (renderer_)
+		{
+			FrameResource& frame = renderer_->frames_manager_.GetCurrentFrame();
+			for (auto& [handle, history] : history_resources_)
+			{
+				history->Dump(frame);
+			}
+			return;
+		}
+		// no frames to dump into
+		rhi::GetBackendRHI().RHIBlockUntilGPUIdle();
+		for (auto& [handle, history] : history_resources_)
+		{
+			history->Release();
+		}
+	}
+
 	void RenderGraph::SetRenderer(Renderer* in_renderer)
 	{
 		renderer_ = in_renderer;
@@ -70,7 +139,7 @@ namespace renderer {
 
 	RenderGraph::RenderPassBuilder RenderGraph::AddRenderPassInternal(const char* name, RenderGraphPassBase* base)
 	{
-		RenderPassNode* node = new RenderPassNode(name, *this, base);
+		RenderPassNode* node = arena_.New<RenderPassNode>(name, *this, base);
 		base->SetNode(node);
 		pass_nodes_.push_back(node);
 
@@ -79,7 +148,7 @@ namespace renderer {
 
 	RenderGraph::SubpassBuilder RenderGraph::AddSubPassInternal(const char* name, RenderPassNode* parent)
 	{
-		SubpassNode* node = new SubpassNode(name, *parent->subpass_graph_, parent, static_cast<uint32_t>(pass_nodes_.size()));
+		SubpassNode* node = arena_.New<SubpassNode>(name, *parent->subpass_graph_, parent, static_cast<uint32_t>(pass_nodes_.size()));
 		pass_nodes_.push_back(node);
 		node->DontCull();
 
@@ -99,46 +168,132 @@ namespace renderer {
 
 	void RenderGraph::RemoveRenderPass(const char* render_pass_name)
 	{
-		pass_nodes_.erase(std::remove_if(pass_nodes_.begin(), pass_nodes_.end(), [render_pass_name](auto* rp) {
-			return rp->pass_name_ == render_pass_name;
-			}));
+		auto it = std::stable_partition(pass_nodes_.begin(), pass_nodes_.end(), [render_pass_name](auto* rp) {
+			return rp->pass_name_ != render_pass_name;
+			});
+		// Resources it wrote are left without a writer, a compile must not order or cull by a pass that is gone
+		for (auto removed = it; removed != pass_nodes_.end(); ++removed)
+		{
+			for (DependencyGraph::Edge* edge : graph_.Unlink(*removed))
+			{
+				if (edge->from == (*removed)->GetId())
+				{
+					static_cast<ResourceNode*>(graph_.GetNode(edge->to))->SetIncomingEdge(nullptr);
+				}
+				else
+				{
+					auto& reads = static_cast<ResourceNode*>(graph_.GetNode(edge->from))->outgoing_edges_;
+					reads.erase(std::remove(reads.begin(), reads.end(), edge), reads.end());
+				}
+			}
+		}
+		removed_passes_.insert(removed_passes_.end(), it, pass_nodes_.end());
+		pass_nodes_.erase(it, pass_nodes_.end());
 
 		is_compiled_ = false;
 		render_pass_path_.clear();
+		toggleable_passes_.clear();
+		path_variants_.clear();
+	}
+
+	void RenderGraph::SetPassPredicate(const char* render_pass_name, std::function<bool()> predicate)
+	{
+		auto it = std::find_if(pass_nodes_.begin(), pass_nodes_.end(), [render_pass_name](auto* rp) {
+			return rp->pass_name_ == render_pass_name;
+			});
+		if (it == pass_nodes_.end())
+		{
+			MLE_CORE_WARN("[RenderGraph] no pass named {0}", render_pass_name);
+			return;
+		}
+		SetPassPredicate(*it, std::move(predicate));
+	}
+
+	void RenderGraph::SetPassPredicate(PassNode* pass_node, std::function<bool()> predicate)
+	{
+		assert(dynamic_cast<PresentPassNode*>(pass_node) == nullptr && "present pass can't be disabled");
+		pass_node->enable_predicate_ = std::move(predicate);
+
+		// Cheap, variants don't touch the RHI
+		if (is_compiled_)
+			CollectToggleablePasses();
 	}
 
 	void RenderGraph::Clear()
 	{
+		DumpHistoryResources();
 		graph_.Clear();
+		// Only run the destructors, the memory goes back with the arena. Edges are trivially destructible
 		for (auto rp : pass_nodes_)
 		{
-			delete rp;
+			engine::LinearArena::Delete(rp);
+		}
+		for (auto rp : removed_passes_)
+		{
+			engine::LinearArena::Delete(rp);
 		}
 		for (auto resource_node : resource_nodes_)
 		{
-			delete resource_node;
+			engine::LinearArena::Delete(resource_node);
 		}
 		for (auto resource : resources_)
 		{
-			delete resource;
+			engine::LinearArena::Delete(resource);
 		}
 		pass_nodes_.clear();
+		removed_passes_.clear();
 		render_pass_path_.clear();
+		toggleable_passes_.clear();
+		path_variants_.clear();
 		resources_.clear();
+		history_resources_.clear();
 		resource_nodes_.clear();
+
+		// A subpass graph lives in its parent's arena, the parent resets it
+		if (&arena_ == &own_arena_)
+			arena_.Reset();
+	}
+
+	void RenderGraph::MakeStaticInternal(RenderPassNode* pass_node, std::function<void(RenderGraph&, FrameResource&)> update)
+	{
+		pass_node->pass_base_->MakeStatic(std::move(update));
+	}
+
+	void RenderGraph::InvalidateStaticPass(const char* render_pass_name)
+	{
+		auto it = std::find_if(pass_nodes_.begin(), pass_nodes_.end(), [render_pass_name](auto* rp) {
+			return rp->pass_name_ == render_pass_name;
+			});
+		if (it == pass_nodes_.end() || (*it)->is_subpass_)
+		{
+			MLE_CORE_WARN("[RenderGraph] no render pass named {0}", render_pass_name);
+			return;
+		}
+		static_cast<RenderPassNode*>(*it)->pass_base_->InvalidateStaticCommands();
 	}
 
 	void RenderGraph::Compile()
 	{
+		MLE_PROFILE_FUNCTION();
 		render_pass_path_.clear();
+		// A graph is compiled again after RemoveRenderPass or SetScheduleHeuristic, nothing of the last compile may add up
+		for (PassNode* pass : pass_nodes_)
+		{
+			pass->ResetCompileState();
+		}
+		for (VirtualResource* resource : resources_)
+		{
+			resource->ResetCompileState();
+		}
+
 		// Cull unused nodes first
 		graph_.Cull();
 
 		// copy the used pass nodes to render pass path
-		auto it = std::stable_partition(pass_nodes_.begin(), pass_nodes_.end(), [](auto const& pass_node) {
+		std::copy_if(pass_nodes_.begin(), pass_nodes_.end(), std::back_inserter(render_pass_path_), [](auto const& pass_node) {
 			return !pass_node->IsCulled(); });
-		render_pass_path_.resize(it - pass_nodes_.begin());
-		std::copy(std::begin(pass_nodes_), it, render_pass_path_.begin());
+
+		Schedule();
 
 		size_t index = 0;
 		for (auto pass : render_pass_path_)
@@ -148,15 +303,25 @@ namespace renderer {
 			for (auto const& edge : reads)
 			{
 				auto resource_node = static_cast<ResourceNode*>(graph_.GetNode(edge->from));
-				pass->RegisterResource(resource_node, DEFAULT_R_USAGE);
-				pass->SetDependencies(resource_node->GetWriterPass());
+				if (resource_node->GetResource()->type_ == VirtualResourceType::BUFFER)
+					pass->RegisterBuffer(resource_node, false);
+				else
+					pass->RegisterResource(resource_node, DEFAULT_R_USAGE);
+
+				PassNode* writer = resource_node->GetWriterPass();
+				assert(std::find(removed_passes_.begin(), removed_passes_.end(), writer) == removed_passes_.end() &&
+					"a removed pass is still linked to the graph");
+				pass->SetDependencies(writer);
 			}
 
 			auto const& writes = graph_.GetOutgoingEdges(pass);
 			for (auto const& edge : writes)
 			{
 				auto resource_node = static_cast<ResourceNode*>(graph_.GetNode(edge->to));
-				pass->RegisterResource(resource_node, DEFAULT_W_USAGE);
+				if (resource_node->GetResource()->type_ == VirtualResourceType::BUFFER)
+					pass->RegisterBuffer(resource_node, true);
+				else
+					pass->RegisterResource(resource_node, DEFAULT_W_USAGE);
 			}
 
 			pass->Resolve();
@@ -165,14 +330,7 @@ namespace renderer {
 		std::for_each(resources_.begin(), resources_.end(), [](VirtualResource* resource) {
 			if (resource->ref_count_)
 			{
-				PassNode* first = resource->first_;
-				PassNode* last = resource->last_;
-				if (first && last)
-				{
-					first->devirtualize_.insert(resource);
-					last->destroy_.insert(resource);
-				}
-				if (resource->ref_count_ == 1)
+				if (resource->ref_count_ == 1 && resource->type_ == VirtualResourceType::TEXTURE && resource->IsTransient())
 				{
 					Resource<RenderGraphTexture>* texture = static_cast<Resource<RenderGraphTexture>*>(resource);
 					texture->resource_.desc_.usage |= TextureUsage::TRANSIENT_ATTACHMENT;
@@ -184,7 +342,7 @@ namespace renderer {
 		for (auto node : resource_nodes_)
 		{
 			PassNode* pass = node->GetWriterPass();
-			if (pass && !node->IsCulled())
+			if (pass && !node->IsCulled() && node->GetResource()->type_ == VirtualResourceType::TEXTURE)
 			{
 				pass->UpdateAttachmentLayout(node->resource_index_);
 			}
@@ -195,27 +353,282 @@ namespace renderer {
 			});
 
 		is_compiled_ = true;
+
+		CollectToggleablePasses();
+	}
+
+	void RenderGraph::CollectToggleablePasses()
+	{
+		toggleable_passes_.clear();
+		path_variants_.clear();
+		std::copy_if(render_pass_path_.begin(), render_pass_path_.end(), std::back_inserter(toggleable_passes_), [](PassNode* pass) {
+			return static_cast<bool>(pass->enable_predicate_); });
+		assert(toggleable_passes_.size() <= 64 && "too many toggleable passes");
+
+		// the compiled path itself is variant 0
+		path_variants_.emplace(0, BuildVariant(0));
+		if (toggleable_passes_.size() <= MAX_PRECOMPILED_TOGGLES)
+		{
+			const uint64_t variant_count = 1ull << toggleable_passes_.size();
+			for (uint64_t mask = 1; mask < variant_count; ++mask)
+			{
+				path_variants_.emplace(mask, BuildVariant(mask));
+			}
+		}
+		has_reported_late_variant_ = false;
+	}
+
+	const RenderGraph::PathVariant& RenderGraph::GetVariant(uint64_t disabled_mask)
+	{
+		auto it = path_variants_.find(disabled_mask);
+		if (it == path_variants_.end())
+		{
+			MLE_PROFILE_SCOPE("RenderGraph::BuildVariant");
+			if (!has_reported_late_variant_)
+				MLE_CORE_WARN("[RenderGraph] building a path variant mid-frame, {0} toggleable passes are more than the {1} whose variants are precompiled",
+					toggleable_passes_.size(), MAX_PRECOMPILED_TOGGLES);
+			has_reported_late_variant_ = true;
+			it = path_variants_.emplace(disabled_mask, BuildVariant(disabled_mask)).first;
+		}
+		return it->second;
+	}
+
+	RenderGraph::PathVariant RenderGraph::BuildVariant(uint64_t disabled_mask)
+	{
+		PathVariant variant{};
+
+		std::unordered_set<PassNode*> disabled;
+		for (size_t i = 0; i < toggleable_passes_.size(); ++i)
+		{
+			if (disabled_mask & (1ull << i))
+				disabled.insert(toggleable_passes_[i]);
+		}
+
+		auto is_history = [this](ResourceNode* node) {
+			return history_resources_.find(node->resource_index_) != history_resources_.end(); };
+
+		// Consumers of transient resources written by a disabled pass go as well,
+		// imported and history resources just keep what they had
+		for (PassNode* pass : render_pass_path_)
+		{
+			if (disabled.count(pass))
+				continue;
+			for (auto const& edge : graph_.GetIncomingEdges(pass))
+			{
+				auto resource_node = static_cast<ResourceNode*>(graph_.GetNode(edge->from));
+				PassNode* writer = resource_node->GetWriterPass();
+				if (writer && disabled.count(writer) && resource_node->GetResource()->IsTransient())
+				{
+					disabled.insert(pass);
+					break;
+				}
+			}
+		}
+
+		// Producers that nothing enabled reads from anymore are culled, walking backwards
+		std::unordered_set<PassNode*> needed;
+		for (auto it = render_pass_path_.rbegin(); it != render_pass_path_.rend(); ++it)
+		{
+			PassNode* pass = *it;
+			if (disabled.count(pass))
+				continue;
+
+			bool is_needed = pass->IsTarget();
+			for (auto const& edge : graph_.GetOutgoingEdges(pass))
+			{
+				if (is_needed)
+					break;
+				auto resource_node = static_cast<ResourceNode*>(graph_.GetNode(edge->to));
+				if (resource_node->IsTarget() || !resource_node->GetResource()->IsTransient())
+				{
+					is_needed = true;
+					break;
+				}
+				for (auto const* read : resource_node->outgoing_edges_)
+				{
+					if (needed.count(static_cast<PassNode*>(graph_.GetNode(read->to))))
+					{
+						is_needed = true;
+						break;
+					}
+				}
+			}
+			if (is_needed)
+				needed.insert(pass);
+		}
+
+		// Lifetimes over the remaining passes
+		std::unordered_map<VirtualResource*, std::pair<size_t, size_t>> lifetimes;
+		for (PassNode* pass : render_pass_path_)
+		{
+			if (!needed.count(pass))
+				continue;
+
+			const size_t index = variant.passes.size();
+			variant.passes.push_back(pass);
+
+			auto touch = [&](ResourceNode* resource_node) {
+				auto [lifetime, inserted] = lifetimes.try_emplace(resource_node->GetResource(), index, index);
+				lifetime->second.second = index;
+			};
+			for (auto const& edge : graph_.GetIncomingEdges(pass))
+			{
+				touch(static_cast<ResourceNode*>(graph_.GetNode(edge->from)));
+			}
+			for (auto const& edge : graph_.GetOutgoingEdges(pass))
+			{
+				auto resource_node = static_cast<ResourceNode*>(graph_.GetNode(edge->to));
+				touch(resource_node);
+				if (is_history(resource_node))
+				{
+					HistoryResourceBase* history = history_resources_.at(resource_node->resource_index_);
+					if (std::find(variant.written_history.begin(), variant.written_history.end(), history) == variant.written_history.end())
+						variant.written_history.push_back(history);
+				}
+			}
+		}
+
+		// Bucket the resources by pass into flat arrays
+		const size_t pass_count = variant.passes.size();
+		variant.devirtualize_offsets.assign(pass_count + 1, 0);
+		variant.destroy_offsets.assign(pass_count + 1, 0);
+		for (auto const& [resource, lifetime] : lifetimes)
+		{
+			variant.devirtualize_offsets[lifetime.first + 1]++;
+			variant.destroy_offsets[lifetime.second + 1]++;
+		}
+		for (size_t i = 0; i < pass_count; ++i)
+		{
+			variant.devirtualize_offsets[i + 1] += variant.devirtualize_offsets[i];
+			variant.destroy_offsets[i + 1] += variant.destroy_offsets[i];
+		}
+		variant.devirtualize.resize(lifetimes.size());
+		variant.destroy.resize(lifetimes.size());
+		std::vector<uint32_t> devirtualize_cursor(variant.devirtualize_offsets.begin(), variant.devirtualize_offsets.end() - 1);
+		std::vector<uint32_t> destroy_cursor(variant.destroy_offsets.begin(), variant.destroy_offsets.end() - 1);
+		for (auto const& [resource, lifetime] : lifetimes)
+		{
+			variant.devirtualize[devirtualize_cursor[lifetime.first]++] = resource;
+			variant.destroy[destroy_cursor[lifetime.second]++] = resource;
+		}
+
+		return variant;
+	}
+
+	void RenderGraph::SetScheduleHeuristic(ScheduleHeuristic heuristic)
+	{
+		if (schedule_heuristic_ == heuristic)
+			return;
+		schedule_heuristic_ = heuristic;
+		is_compiled_ = false;
+	}
+
+	void RenderGraph::Schedule()
+	{
+		schedule_estimates_.clear();
+		// Subpasses must keep their order, the subpass index is baked at declaration
+		if (render_pass_path_.empty() || render_pass_path_.front()->is_subpass_)
+			return;
+
+		PassScheduler scheduler(graph_, render_pass_path_, resource_nodes_);
+
+		std::vector<PassNode*> selected;
+		for (uint8_t i = 0; i < static_cast<uint8_t>(ScheduleHeuristic::COUNT); ++i)
+		{
+			const ScheduleHeuristic heuristic = static_cast<ScheduleHeuristic>(i);
+			std::vector<PassNode*> candidate = scheduler.Schedule(heuristic);
+
+			ScheduleEstimate& estimate = schedule_estimates_.emplace_back(scheduler.Estimate(candidate));
+			estimate.heuristic = heuristic;
+			MLE_CORE_DEBUG("[RenderGraph] {0} schedule: peak transient memory {1} KB, {2} back to back barriers{3}",
+				ToString(heuristic), estimate.peak_memory / 1024, estimate.stalling_barrier_count,
+				heuristic == schedule_heuristic_ ? " <- selected" : "");
+
+			if (heuristic == schedule_heuristic_)
+				selected = std::move(candidate);
+		}
+
+		render_pass_path_ = std::move(selected);
 	}
 
 	void RenderGraph::Run(FrameResource& resource)
 	{
+		MLE_PROFILE_FUNCTION();
 		if (!is_compiled_)
 			Compile();
 
-		for (auto pass : render_pass_path_)
+		for (auto& [handle, history] : history_resources_)
 		{
-			for (VirtualResource* virtual_resource : pass->devirtualize_)
+			history->Prepare(resource);
+		}
+
+		uint64_t disabled_mask = 0;
+		for (size_t i = 0; i < toggleable_passes_.size(); ++i)
+		{
+			if (!toggleable_passes_[i]->enable_predicate_())
+				disabled_mask |= 1ull << i;
+		}
+
+		// passes record into the frame's command list, it is translated into the command buffer when the frame ends
+		auto execute = [&resource](PassNode* pass) {
+			// the stats of the pass are counted once the list is translated
+			resource.command_list.BeginMarker(pass->GetName());
+
+			// Barriers of a skipped producer stay, an extra barrier is harmless
+			for (auto const& barrier : pass->buffer_barriers_)
 			{
-				virtual_resource->Instantiate();
+				auto buffer = static_cast<Resource<RenderGraphBuffer>*>(barrier.resource);
+				BufferBarrier(resource.command_list, { buffer->resource_.buffer.get(),
+					barrier.src_usage, barrier.src_write, barrier.dst_usage, barrier.dst_write });
 			}
 
-			pass->Execute(resource);
+			MLE_PROFILE_SCOPE(pass->GetName());
+			{
+				GPUProfileScope gpu_scope(resource, pass->GetName());
+				pass->Execute(resource);
+			}
+
+			resource.command_list.EndMarker();
+		};
+
+		const PathVariant& variant = GetVariant(disabled_mask);
+		uint32_t segment_passes = 0;
+		for (size_t i = 0; i < variant.passes.size(); ++i)
+		{
+			for (uint32_t j = variant.devirtualize_offsets[i]; j < variant.devirtualize_offsets[i + 1]; ++j)
+			{
+				variant.devirtualize[j]->Instantiate();
+			}
 
-			for (VirtualResource* virtual_resource : pass->destroy_)
+			execute(variant.passes[i]);
+
+			for (uint32_t j = variant.destroy_offsets[i]; j < variant.destroy_offsets[i + 1]; ++j)
+			{
+				variant.destroy[j]->Destroy(resource);
+			}
+
+			// the last segment is submitted by the renderer, with the frame's sync objects
+			PassNode* pass = variant.passes[i];
+			if (!renderer_ || pass->is_subpass_ || i + 1 == variant.passes.size())
+				continue;
+			++segment_passes;
+			if (pass->submit_after_ || (segment_pass_count_ > 0 && segment_passes >= segment_pass_count_))
 			{
-				virtual_resource->Destroy(resource);
+				renderer_->frames_manager_.SubmitSegment();
+				segment_passes = 0;
 			}
 		}
+
+		for (HistoryResourceBase* history : variant.written_history)
+		{
+			history->Swap();
+		}
+	}
+
+	bool RenderGraph::IsHistoryValid(ResourceHandle handle) const
+	{
+		auto it = history_resources_.find(handle);
+		return it != history_resources_.end() && it->second->IsHistoryValid();
 	}
 
 	// Since the function doesn't specify set and binding, it must has subpass
@@ -228,9 +641,9 @@ namespace renderer {
 				ResourceNode* resource_node = (*it);
 
 				// create a identical resource node from the render pass graph for its subpass
-				pass_node->subpass_graph_->resource_nodes_.push_back(new ResourceNode(*pass_node->subpass_graph_, handle));
+				pass_node->subpass_graph_->resource_nodes_.push_back(arena_.New<ResourceNode>(*pass_node->subpass_graph_, handle));
 
-				DependencyGraph::Edge* edge = new DependencyGraph::Edge(graph_, (DependencyGraph::Node*)resource_node, (DependencyGraph::Node*)pass_node);
+				DependencyGraph::Edge* edge = arena_.New<DependencyGraph::Edge>(graph_, (DependencyGraph::Node*)resource_node, (DependencyGraph::Node*)pass_node);
 				resource_node->SetOutgoingEdge(edge);
 
 				/*VirtualResource* const resource = resources_[handle];
@@ -251,7 +664,7 @@ namespace renderer {
 				resource_node->set_ = set;
 				resource_node->binding_ = binding;
 
-				DependencyGraph::Edge* edge = new DependencyGraph::Edge(graph_, (DependencyGraph::Node*)resource_node, (DependencyGraph::Node*)pass_node);
+				DependencyGraph::Edge* edge = arena_.New<DependencyGraph::Edge>(graph_, (DependencyGraph::Node*)resource_node, (DependencyGraph::Node*)pass_node);
 				resource_node->SetOutgoingEdge(edge);
 
 				/*VirtualResource* const resource = resources_[handle];
@@ -263,11 +676,15 @@ namespace renderer {
 
 	void RenderGraph::Write(PassNode* node, ResourceHandle handle)
 	{
-		ResourceNode* resource_node = new ResourceNode(*this, handle);
+		ResourceNode* resource_node = arena_.New<ResourceNode>(*this, handle);
 
 		resource_nodes_.push_back(resource_node);
 
-		DependencyGraph::Edge* edge = new DependencyGraph::Edge(graph_, (DependencyGraph::Node*)node, (DependencyGraph::Node*)resource_node);
+		// history is consumed by the next frame, nothing in this frame may need it
+		if (history_resources_.find(handle) != history_resources_.end())
+			resource_node->DontCull();
+
+		DependencyGraph::Edge* edge = arena_.New<DependencyGraph::Edge>(graph_, (DependencyGraph::Node*)node, (DependencyGraph::Node*)resource_node);
 		resource_node->SetIncomingEdge(edge);
 
 		/*VirtualResource* const resource = resources_[handle];
@@ -275,6 +692,70 @@ namespace renderer {
 		resource->Connect(graph_, node, resource_node);*/
 	}
 
+	// The previous instance was written by last frame's graph, the edge goes to the node of this frame's writer,
+	// so culling keeps the writer as long as something reads what it leaves for the next frame
+	void RenderGraph::ReadPrevious(PassNode* pass_node, ResourceHandle handle)
+	{
+		assert(history_resources_.find(handle) != history_resources_.end() && "ReadPrevious needs a history resource");
+
+		ResourceNode* resource_node = nullptr;
+		for (auto it = resource_nodes_.rbegin(); it != resource_nodes_.rend(); ++it)
+		{
+			if ((*it)->resource_index_ == handle)
+			{
+				resource_node = (*it);
+				break;
+			}
+		}
+		// the writer is declared later, or this pass writes it after reading the previous instance
+		if (!resource_node)
+		{
+			resource_node = arena_.New<ResourceNode>(*this, handle);
+			resource_nodes_.push_back(resource_node);
+		}
+
+		DependencyGraph::Edge* edge = arena_.New<DependencyGraph::Edge>(graph_, (DependencyGraph::Node*)resource_node, (DependencyGraph::Node*)pass_node);
+		resource_node->SetOutgoingEdge(edge);
+
+		VirtualResource* resource = resources_[handle];
+		if (resource->type_ == VirtualResourceType::TEXTURE)
+		{
+			auto texture = static_cast<Resource<RenderGraphTexture>*>(resource);
+			texture->resource_.desc_.usage |= TextureUsage::SAMPLEABLE;
+		}
+	}
+
+	void RenderGraph::ReadBuffer(PassNode* pass_node, ResourceHandle handle, BufferUsage usage)
+	{
+		ResourceNode* resource_node = nullptr;
+		for (auto it = resource_nodes_.rbegin(); it != resource_nodes_.rend(); ++it)
+		{
+			if ((*it)->resource_index_ == handle)
+			{
+				resource_node = (*it);
+				break;
+			}
+		}
+		// Buffers are often imported and only read(e.g. vertex or index buffers), give them a version without writer
+		if (!resource_node)
+		{
+			resource_node = arena_.New<ResourceNode>(*this, handle);
+			resource_nodes_.push_back(resource_node);
+		}
+
+		DependencyGraph::Edge* edge = arena_.New<DependencyGraph::Edge>(graph_, (DependencyGraph::Node*)resource_node, (DependencyGraph::Node*)pass_node);
+		resource_node->SetOutgoingEdge(edge);
+
+		pass_node->AddBufferAccess(handle, usage, false);
+	}
+
+	void RenderGraph::WriteBuffer(PassNode* pass_node, ResourceHandle handle, BufferUsage usage)
+	{
+		Write(pass_node, handle);
+
+		pass_node->AddBufferAccess(handle, usage, true);
+	}
+
 	void RenderGraph::SetPipelineInternal(PassNode* node, rhi::RHIPipeline::Descriptor desc)
 	{
 		RenderPassNode* pass_node = static_cast<RenderPassNode*>(node);
@@ -4,6 +4,7 @@
 #include "Nodes.h"
 #include "RenderGraphPass.h"
 #include "VirtualResource.h"
+#include "PassScheduler.h"
 
 namespace renderer{
 	class Renderer;
@@ -48,8 +49,24 @@ namespace renderer{
 			RenderPassBuilder& ReadWrite(uint32_t set, uint32_t binding, ResourceHandle resource, LoadOp load_operation, StoreOp store_operation);
 			RenderPassBuilder& Write(ResourceHandle resource, LoadOp load_operation, StoreOp store_operation);
 
+			// Read last frame's content of a history resource
+			RenderPassBuilder& ReadPrevious(ResourceHandle resource);
+
+			RenderPassBuilder& ReadBuffer(ResourceHandle resource, BufferUsage usage);
+			RenderPassBuilder& WriteBuffer(ResourceHandle resource, BufferUsage usage);
+
 			RenderPassBuilder& SetPipeline(const rhi::RHIPipeline::Descriptor& desc);
 
+			// Skip this pass for the frames where the predicate returns false
+			RenderPassBuilder& EnableIf(std::function<bool()> predicate);
+
+			// Record the commands of the execute lambda into secondary command buffers once and execute those every frame.
+			// See RenderGraphPassBase::MakeStatic
+			RenderPassBuilder& Static(std::function<void(RenderGraph&, FrameResource&)> update = {});
+
+			// Submit the frame's commands up to this pass, e.g. after an expensive pass, so the GPU starts on them early
+			RenderPassBuilder& SubmitAfter();
+
 			template<typename Setup>
 			RenderPassBuilder& AddSubpass(const char* pass_name, Setup setup)
 			{
@@ -66,6 +83,10 @@ namespace renderer{
 		};
 		// --------------------------------------------------
 
+		RenderGraph() = default;
+		// Used by subpass graphs, everything is allocated from the parent's arena
+		explicit RenderGraph(engine::LinearArena& arena)
+			:arena_(arena) {};
 		virtual ~RenderGraph() = default;
 
 		void SetRenderer(Renderer* in_renderer);
@@ -83,7 +104,7 @@ namespace renderer{
 		template<typename Setup, typename Execute>
 		void AddPass(const char* pass_name, Setup setup, Execute execute)
 		{
-			auto* const pass = RenderGraphPassBase::Create<Execute>(execute);
+			auto* const pass = RenderGraphPassBase::Create<Execute>(arena_, execute);
 
 			RenderPassBuilder builder(AddRenderPassInternal(pass_name, pass));
 			setup(*this, builder);
@@ -95,9 +116,9 @@ namespace renderer{
 		void AddPresentPass(const char* pass_name, Setup setup, Execute execute)
 		{
 
-			auto* const pass = RenderGraphPassBase::Create<Execute>(execute);
+			auto* const pass = RenderGraphPassBase::Create<Execute>(arena_, execute);
 
-			RenderPassNode* node = new PresentPassNode(pass_name, *this, pass);
+			RenderPassNode* node = arena_.New<PresentPassNode>(pass_name, *this, pass);
 			pass->SetNode(node);
 			pass_nodes_.push_back(node);
 			node->DontCull();
@@ -113,18 +134,43 @@ namespace renderer{
 
 		void RemoveRenderPass(const char* render_pass_name);
 
+		/// <summary>
+		/// Predicates are evaluated every frame in Run. Disabling a pass also skips the passes that consume
+		/// its transient outputs, and the passes that only fed it. None of that needs a recompile.
+		/// Present passes can't be disabled.
+		/// </summary>
+		void SetPassPredicate(const char* render_pass_name, std::function<bool()> predicate);
+		void SetPassPredicate(PassNode* pass_node, std::function<bool()> predicate);
+
+		// A static pass records its commands again the next time each frame in flight runs it
+		void InvalidateStaticPass(const char* render_pass_name);
+
 		void Clear();
 
 		void Run(FrameResource& resource);
 
 		void Compile();
 
+		// Takes effect on the next compile
+		void SetScheduleHeuristic(ScheduleHeuristic heuristic);
+		inline ScheduleHeuristic GetScheduleHeuristic() const { return schedule_heuristic_; };
+		// Estimates of every candidate schedule from the last compile
+		inline const std::vector<ScheduleEstimate>& GetScheduleEstimates() const { return schedule_estimates_; };
+
+		/// <summary>
+		/// Besides after the passes marked with SubmitAfter, the recorded commands are submitted every pass_count passes,
+		/// one command buffer per segment, in order on the graphics queue. 0 leaves the frame in one submission.
+		/// Needs the graph to belong to a Renderer, standalone graphs always submit once
+		/// </summary>
+		inline void SetSegmentPassCount(uint32_t pass_count) { segment_pass_count_ = pass_count; };
+		inline uint32_t GetSegmentPassCount() const { return segment_pass_count_; };
+
 		template<typename RESOURCE>
 		ResourceHandle ImportResource(const char* name, 
 			typename RESOURCE::Descriptor const& desc,						  
 			typename RESOURCE const& resource)
 		{
-			Resource<RESOURCE>* imported_resource = new Resource<RESOURCE>(name, desc, resource);
+			Resource<RESOURCE>* imported_resource = arena_.New<Resource<RESOURCE>>(name, desc, resource);
 			resources_.push_back(imported_resource);
 			return resources_.size() - 1;
 		}
@@ -132,16 +178,43 @@ namespace renderer{
 		template<typename RESOURCE>
 		ResourceHandle AddResource(const char* name, typename RESOURCE::Descriptor const& descriptor)
 		{
-			Resource<RESOURCE>* virtual_resource = new Resource<RESOURCE>(name, descriptor);
+			Resource<RESOURCE>* virtual_resource = arena_.New<Resource<RESOURCE>>(name, descriptor);
 			resources_.push_back(virtual_resource);
 			return resources_.size() - 1;
 		}
 
+		/// <summary>
+		/// Add a resource that lives across frames, written every frame and read back the next one with ReadPrevious
+		/// </summary>
+		template<typename RESOURCE>
+		ResourceHandle AddHistoryResource(const char* name, typename RESOURCE::Descriptor const& descriptor)
+		{
+			HistoryResource<RESOURCE>* history_resource = arena_.New<HistoryResource<RESOURCE>>(name, descriptor);
+			resources_.push_back(history_resource);
+			history_resources_.emplace(resources_.size() - 1, history_resource);
+			return resources_.size() - 1;
+		}
+
+		// Last frame's instance of a history resource
+		template<typename RESOURCE>
+		RESOURCE& GetPreviousResource(ResourceHandle handle)
+		{
+			assert(history_resources_.find(handle) != history_resources_.end() && "not a history resource");
+			return static_cast<HistoryResource<RESOURCE>*>(resources_[handle])->previous_;
+		}
+
+		// False on first use and after the resource was recreated, the previous instance holds garbage then
+		bool IsHistoryValid(ResourceHandle handle) const;
+
 		void Read(RenderPassNode* pass_node, ResourceHandle handle);
 		void Read(uint32_t set, uint32_t binding, PassNode* pass_node, ResourceHandle handle);
 		void Write(PassNode* pass_node, ResourceHandle handle);
+		void ReadPrevious(PassNode* pass_node, ResourceHandle handle);
+		void ReadBuffer(PassNode* pass_node, ResourceHandle handle, BufferUsage usage);
+		void WriteBuffer(PassNode* pass_node, ResourceHandle handle, BufferUsage usage);
 		void SetPipelineInternal(PassNode* node, rhi::RHIPipeline::Descriptor desc);
 		void SetPipelineInternal(SubpassNode* pass_node, const rhi::RHIPipeline::Descriptor& desc);
+		void MakeStaticInternal(RenderPassNode* pass_node, std::function<void(RenderGraph&, FrameResource&)> update);
 
 		VirtualResource* GetResource(ResourceHandle handle)
 		{
@@ -161,18 +234,66 @@ namespace renderer{
 		}
 
 		inline DependencyGraph& GetGraph() { return graph_; };
+		inline engine::LinearArena& GetArena() { return arena_; };
+
+		// A render pass replaced by a compile may still be used by the frames in flight, it goes with the current frame's dumps
+		void DumpRenderPass(std::unique_ptr<rhi::RenderPass> render_pass);
+		// Same for both instances of every history resource, before the graph deletes them
+		void DumpHistoryResources();
 
 		Renderer* renderer_ = nullptr;
 	private:
+		// topologically reorder render_pass_path_ with the selected heuristic
+		void Schedule();
+
+		// render pass path, the compiled one or one with some toggleable passes disabled
+		struct PathVariant
+		{
+			std::vector<PassNode*> passes;
+			// passes[i] devirtualizes devirtualize[devirtualize_offsets[i], devirtualize_offsets[i + 1])
+			std::vector<VirtualResource*> devirtualize;
+			std::vector<uint32_t> devirtualize_offsets;
+			// passes[i] destroys destroy[destroy_offsets[i], destroy_offsets[i + 1])
+			std::vector<VirtualResource*> destroy;
+			std::vector<uint32_t> destroy_offsets;
+			// only these get swapped at the end of the frame
+			std::vector<HistoryResourceBase*> written_history;
+		};
+		// bit i of the mask is toggleable_passes_[i], 0 is the compiled path
+		PathVariant BuildVariant(uint64_t disabled_mask);
+		const PathVariant& GetVariant(uint64_t disabled_mask);
+		void CollectToggleablePasses();
+
+		// with this many toggleable passes or less, every variant is built at compile time(256 at most),
+		// beyond that a combination is built in Run the first time it comes up
+		static constexpr size_t MAX_PRECOMPILED_TOGGLES = 8;
+
 		std::vector<PassNode*> pass_nodes_{};
 		std::vector<PassNode*> render_pass_path_{};
 		std::vector<ResourceNode*> resource_nodes_{};
+		// removed passes are still referenced by the dependency graph, they are freed at Clear
+		std::vector<PassNode*> removed_passes_{};
+
+		std::vector<PassNode*> toggleable_passes_{};
+		std::unordered_map<uint64_t, PathVariant> path_variants_{};
+		// a variant was built in Run since the last compile, it is reported once
+		bool has_reported_late_variant_ = false;
 
 		std::vector<VirtualResource*> resources_{};
+		std::unordered_map<ResourceHandle, HistoryResourceBase*> history_resources_{};
 
 		DependencyGraph graph_;
 
+		ScheduleHeuristic schedule_heuristic_ = ScheduleHeuristic::DECLARATION_ORDER;
+		std::vector<ScheduleEstimate> schedule_estimates_{};
+
 		bool is_compiled_ = false;
+
+		uint32_t segment_pass_count_ = 0;
+
+		// Nodes, edges, resources and subpass graphs live here, reset at Clear
+		engine::LinearArena own_arena_;
+		engine::LinearArena& arena_ = own_arena_;
 	};
 
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #pragma once
+#include "Runtime/Function/RHI/RHI.h"
 #include "Runtime/Function/RHI/RenderPass.h"
 #include "Runtime/Function/RHI/CommandBuffer.h"
+#include "Runtime/Function/RHI/CommandList.h"
 #include "Runtime/Function/Renderer/RenderCommands.h"
 #include "Runtime/Function/Renderer/FrameResource.h"
+#include "Runtime/Platform/Memory/Memory.h"
 
 namespace renderer {
 	class PassNode;
@@ -14,31 +17,113 @@ namespace renderer {
 		RenderGraphPassBase() = default;
 		virtual ~RenderGraphPassBase() = default;
 		template<typename Execute>
-		static RenderGraphPassBase* Create(const Execute& exec)
+		static RenderGraphPassBase* Create(engine::LinearArena& arena, const Execute& exec)
 		{
-			RenderGraphPass<Execute>* pass = new RenderGraphPass<Execute>(exec);
+			RenderGraphPass<Execute>* pass = arena.New<RenderGraphPass<Execute>>(exec);
 			return pass;
 		};
 
-		static RenderGraphPassBase* Create()
+		static RenderGraphPassBase* Create(engine::LinearArena& arena)
 		{
-			return new RenderGraphPassBase();
+			return arena.New<RenderGraphPassBase>();
 		}
 
 		virtual void Instantiate()
 		{
 			actual_rp_ = rhi::RenderPass::Create(desc_);
+			// the commands were recorded for the old render pass and its pipelines
+			InvalidateStaticCommands();
 		}
 
 		virtual void Exec(RenderGraph& rg, rhi::RenderTarget& rt, FrameResource& frame) {};
 		void SetNode(PassNode* node) { node_ = node; };
 
+		/// <summary>
+		/// A static pass records the commands of its execute lambda into a secondary command buffer, one per frame in flight,
+		/// and begins its render pass with secondary contents so the later frames only execute it, nothing is encoded again.
+		/// The execute lambda only runs again after the render pass or its pipelines were recreated, the render target was resized
+		/// or InvalidateStaticCommands(), and the backend records the commands again once a descriptor set they bind was written.
+		/// Whatever changes every frame goes into update, which runs before the render pass.
+		/// A static pass has a single subpass, and its execute lambda can't open GPU profile scopes, their queries change every frame
+		/// </summary>
+		void MakeStatic(std::function<void(RenderGraph&, FrameResource&)> update)
+		{
+			is_static_ = true;
+			static_update_ = std::move(update);
+			InvalidateStaticCommands();
+		}
+		inline bool IsStatic() const { return is_static_; };
+		// The secondary command buffers may still be executed by the frames in flight, each one is recorded again when its frame comes around
+		void InvalidateStaticCommands() { ++static_version_; };
+
 		using Descriptor = rhi::RenderPass::Descriptor;
 		Descriptor desc_;
 
 		std::unique_ptr<rhi::RenderPass> actual_rp_;
 	protected:
+		// Records the commands of the execute lambda into frame.command_list
+		virtual void Record(RenderGraph& rg, rhi::RenderTarget& rt, FrameResource& frame) {};
+
+		// Records the render pass executing the secondary command buffer of this frame in flight, with the commands of the execute lambda
+		// if they are out of date
+		void RecordStatic(RenderGraph& rg, rhi::RenderTarget& rt, FrameResource& frame)
+		{
+			assert(desc_.subpasses.size() <= 1 && "a static pass is recorded into one secondary command buffer, it can't have more than one subpass");
+			auto it = std::find_if(static_commands_.begin(), static_commands_.end(), [&frame](const StaticCommands& commands) {
+				return commands.frame == &frame;
+				});
+			if (it == static_commands_.end())
+			{
+				static_commands_.push_back({ &frame });
+				it = std::prev(static_commands_.end());
+				it->commands = std::make_unique<rhi::CommandList>(STATIC_BLOCK_SIZE);
+				it->secondary = rhi::RHI::GetRHIInstance().RHICreateSecondaryCommandBuffer();
+				it->version = static_version_ - 1;
+			}
+
+			const bool record = it->version != static_version_ || it->render_pass != actual_rp_->GetHandle() ||
+				it->pipelines != actual_rp_->GetPipelines() || it->width != rt.GetWidth() || it->height != rt.GetHeight();
+			if (record)
+			{
+				// recorded into the frame's list as usual, then moved to the pass, the translation records them into the secondary command buffer
+				const rhi::CommandHeader* last = frame.command_list.GetLastCommand();
+				Record(rg, rt, frame);
+				it->commands->Reset();
+				it->commands->AppendCopy(last ? last->next : frame.command_list.GetFirstCommand());
+				frame.command_list.Truncate(last);
+
+				it->version = static_version_;
+				it->render_pass = actual_rp_->GetHandle();
+				it->pipelines = actual_rp_->GetPipelines();
+				it->width = rt.GetWidth();
+				it->height = rt.GetHeight();
+			}
+
+			BeginRenderPass(frame.command_list, *actual_rp_, rt, rhi::SubpassContents::SECONDARY_COMMAND_BUFFERS);
+			frame.command_list.ExecuteSecondary(*it->secondary, *it->commands, *actual_rp_, 0, record);
+			EndRenderPass(frame.command_list);
+		}
+
 		PassNode* node_ = nullptr;
+
+		static constexpr size_t STATIC_BLOCK_SIZE = 4 * 1024;
+		struct StaticCommands
+		{
+			const FrameResource* frame;
+			// what the commands were recorded with
+			uint32_t version = 0;
+			void* render_pass = nullptr;
+			std::vector<rhi::PipelineRef> pipelines;
+			uint32_t width = 0;
+			uint32_t height = 0;
+			// kept for the backend to record again and for the frame captures, which replay the commands inline
+			std::unique_ptr<rhi::CommandList> commands;
+			std::unique_ptr<rhi::SecondaryCommandBuffer> secondary;
+		};
+		bool is_static_ = false;
+		std::function<void(RenderGraph&, FrameResource&)> static_update_;
+		uint32_t static_version_ = 0;
+		std::vector<StaticCommands> static_commands_;
 	};
 
 	template<typename Execute>
@@ -53,12 +138,22 @@ namespace renderer {
 		virtual void Exec(RenderGraph& rg, rhi::RenderTarget& rt, FrameResource& frame) override
 		{
 			assert(actual_rp_!=nullptr&&"render pass is a null");
+			if (is_static_)
+			{
+				if (static_update_)
+					static_update_(rg, frame);
+				RecordStatic(rg, rt, frame);
+				return;
+			}
 			
-			BeginRenderPass(*frame.command_buffer, *actual_rp_, rt);
-
+			BeginRenderPass(frame.command_list, *actual_rp_, rt);
+			exec_func_(rg, *actual_rp_, rt, frame);
+			EndRenderPass(frame.command_list);
+		}
+	protected:
+		virtual void Record(RenderGraph& rg, rhi::RenderTarget& rt, FrameResource& frame) override
+		{
 			exec_func_(rg, *actual_rp_, rt, frame);
-
-			EndRenderPass(*frame.command_buffer);
 		}
 	private:
 		Execute exec_func_;
@@ -28,6 +28,13 @@ namespace renderer {
 		resource->SetIncomingEdge(edge);
 	}
 
+	void VirtualResource::ResetCompileState()
+	{
+		ref_count_ = 0;
+		first_ = nullptr;
+		last_ = nullptr;
+	}
+
 	void VirtualResource::NeedByPass(PassNode* node)
 	{
 		ref_count_++;
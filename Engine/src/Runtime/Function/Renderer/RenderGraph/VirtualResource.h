@@ -1,7 +1,7 @@
 #pragma once
 #include "Runtime/Function/RHI/RHIResource.h"
 #include "Runtime/Function/RHI/RenderPass.h"
-#include "Runtime/Function/RHI/RHI.h"
+#include "Runtime/Function/RHI/RHIBackend.h"
 #include "Runtime/Function/Renderer/FrameResource.h"
 
 namespace renderer {
@@ -9,19 +9,32 @@ namespace renderer {
 	class ResourceNode;
 	class DependencyGraph;
 
+	enum class VirtualResourceType : uint8_t
+	{
+		TEXTURE,
+		BUFFER
+	};
+
 	class VirtualResource {
 	public:
-		VirtualResource(const char* name, bool imported = false)
-			:name_(name), is_imported_(imported) {};
+		VirtualResource(const char* name, VirtualResourceType type, bool imported = false)
+			:name_(name), type_(type), is_imported_(imported) {};
 		virtual ~VirtualResource() = default;
 
 		virtual void Instantiate() = 0;
 		virtual void Destroy(FrameResource& frame) = 0;
 
+		// estimated bytes of the actual resource, used by the pass scheduler
+		virtual uint64_t GetMemorySize() const { return 0; };
+		// created and destroyed within a frame
+		virtual bool IsTransient() const { return !is_imported_; };
+
 		virtual void Connect(DependencyGraph& dg, ResourceNode* resource, PassNode* pass);
 		virtual void Connect(DependencyGraph& dg, PassNode* pass, ResourceNode* resource);
 		
 		void NeedByPass(PassNode* node);
+		// Forgets the passes and layouts of the last compile
+		virtual void ResetCompileState();
 
 		const char* const name_;
 
@@ -32,6 +45,7 @@ namespace renderer {
 		// last pass that needs this resource, so it has the resonsibility to destroy the resource
 		PassNode* last_ = nullptr;
 
+		const VirtualResourceType type_;
 		const bool is_imported_;
 	};
 
@@ -42,12 +56,12 @@ namespace renderer {
 		using Descriptor = typename T::Descriptor;
 
 		Resource(const char* name, Descriptor const& desc)
-			:VirtualResource(name)
+			:VirtualResource(name, T::TYPE)
 		{
 			resource_.desc_ = desc;
 		}
 		Resource(const char* name, Descriptor const& desc, const T& in_resource)
-			:VirtualResource(name, true), resource_(in_resource)
+			:VirtualResource(name, T::TYPE, true), resource_(in_resource)
 		{
 			resource_.desc_ = desc;
 		}
@@ -67,25 +81,228 @@ namespace renderer {
 				resource_.Destroy(frame);
 			}
 		}
+
+		virtual uint64_t GetMemorySize() const override
+		{
+			return resource_.GetMemorySize();
+		}
+
+		virtual void ResetCompileState() override
+		{
+			VirtualResource::ResetCompileState();
+			resource_.ResetCompileState();
+		}
 		T resource_{};
 	};
 
+	class HistoryResourceBase
+	{
+	public:
+		virtual ~HistoryResourceBase() = default;
+
+		// (Re)create both instances on first use or when the descriptor changed, e.g. after a resize
+		virtual void Prepare(FrameResource& frame) = 0;
+		// What was written this frame becomes the previous instance
+		virtual void Swap() = 0;
+
+		// Hands both instances to the frame's dumps, the render graph does so before deleting the resource
+		virtual void Dump(FrameResource& frame) = 0;
+		// Frees both instances right away, the GPU must be idle
+		virtual void Release() = 0;
+
+		// False until the previous instance holds a frame rendered with the current descriptor
+		inline bool IsHistoryValid() const { return is_history_valid_; };
+	protected:
+		bool is_history_valid_ = false;
+	};
+
+	/// <summary>
+	/// Kept alive across frames, passes write the current instance and ReadPrevious the other one
+	/// </summary>
+	template<typename T>
+	class HistoryResource : public Resource<T>, public HistoryResourceBase
+	{
+	public:
+		using Descriptor = typename T::Descriptor;
+
+		HistoryResource(const char* name, Descriptor const& desc)
+			:Resource<T>(name, desc) {};
+		~HistoryResource() override
+		{
+			assert(!is_created_ && "the GPU may still use the instances, dump them first");
+		}
+
+		// Both instances are managed by Prepare and Swap
+		virtual void Instantiate() override {};
+		virtual void Destroy(FrameResource& frame) override {};
+
+		virtual uint64_t GetMemorySize() const override
+		{
+			return 2 * this->resource_.GetMemorySize();
+		}
+		virtual bool IsTransient() const override { return false; };
+
+		virtual void Prepare(FrameResource& frame) override
+		{
+			if (is_created_ && this->resource_.IsCompatible(created_desc_))
+				return;
+
+			if (is_created_)
+			{
+				this->resource_.Destroy(frame);
+				previous_.Destroy(frame);
+			}
+			this->resource_.Create(MemoryCategory::RENDER_GRAPH_HISTORY);
+			previous_.desc_ = this->resource_.desc_;
+			previous_.Create(MemoryCategory::RENDER_GRAPH_HISTORY);
+
+			created_desc_ = this->resource_.desc_;
+			is_created_ = true;
+			is_history_valid_ = false;
+		}
+
+		virtual void Dump(FrameResource& frame) override
+		{
+			if (!is_created_)
+				return;
+			this->resource_.Destroy(frame);
+			previous_.Destroy(frame);
+			is_created_ = false;
+			is_history_valid_ = false;
+		}
+
+		virtual void Release() override
+		{
+			if (!is_created_)
+				return;
+			this->resource_.Release();
+			previous_.Release();
+			is_created_ = false;
+			is_history_valid_ = false;
+		}
+
+		virtual void Swap() override
+		{
+			if (!is_created_)
+				return;
+			this->resource_.Swap(previous_);
+			is_history_valid_ = true;
+		}
+
+		T previous_{};
+	private:
+		Descriptor created_desc_{};
+		bool is_created_ = false;
+	};
+
 	struct RenderGraphTexture
 	{
+		static constexpr VirtualResourceType TYPE = VirtualResourceType::TEXTURE;
+
 		rhi::TextureRef texture;
 		using Descriptor = rhi::RHITexture::Descriptor;
 		Descriptor desc_{};
 
 		rhi::ImageLayout last_layout = rhi::ImageLayout::IMAGE_LAYOUT_UNDEFINED;
 
-		void Create() 
+		void Create(MemoryCategory category = MemoryCategory::RENDER_GRAPH_TRANSIENT) 
 		{
-			texture = rhi::RHI::GetRHIInstance().RHICreateTexture(desc_);
+			Descriptor desc = desc_;
+			desc.category = category;
+			texture = rhi::GetBackendRHI().RHICreateTexture(desc);
 		};
 		void Destroy(FrameResource& frame) 
 		{
 			frame.texture_dump.push_back(texture);
 		};
+		void Release()
+		{
+			if (texture)
+				rhi::GetBackendRHI().RHIFreeTexture(*texture);
+			texture.reset();
+		};
+		void Swap(RenderGraphTexture& other)
+		{
+			std::swap(texture, other.texture);
+		};
+		// the compile walks the layouts from the start again and decides whether it is still transient
+		void ResetCompileState()
+		{
+			last_layout = rhi::ImageLayout::IMAGE_LAYOUT_UNDEFINED;
+			desc_.usage &= ~TextureUsage::TRANSIENT_ATTACHMENT;
+		};
+		bool IsCompatible(const Descriptor& desc) const
+		{
+			return desc_.width == desc.width && desc_.height == desc.height && desc_.depth == desc.depth &&
+				desc_.format == desc.format && desc_.array_layers == desc.array_layers && desc_.miplevels == desc.miplevels;
+		};
+		uint64_t GetMemorySize() const
+		{
+			uint64_t pixel_size = 0;
+			switch (desc_.format)
+			{
+			case PixelFormat::RGBA8:	pixel_size = 4; break;
+			case PixelFormat::RGBA32F:	pixel_size = 16; break;
+			case PixelFormat::DEPTH:	pixel_size = 4; break;
+			default: break;
+			}
+			uint64_t size = pixel_size * desc_.width * desc_.height * std::max(desc_.depth, 1u) * std::max(desc_.array_layers, 1u);
+			// a full mip chain adds about a third
+			if (desc_.miplevels > 1)
+				size += size / 3;
+			return size;
+		};
+	};
+
+	struct RenderGraphBuffer
+	{
+		static constexpr VirtualResourceType TYPE = VirtualResourceType::BUFFER;
+
+		rhi::BufferRef buffer;
+		using Descriptor = rhi::RHIBuffer::Descriptor;
+		Descriptor desc_{};
+
+		// last access in the render pass path, set during compile to place barriers
+		BufferUsage last_usage = BufferUsage::NONE;
+		bool last_write = false;
+		PassNode* last_pass = nullptr;
+
+		void Create(MemoryCategory category = MemoryCategory::RENDER_GRAPH_TRANSIENT)
+		{
+			Descriptor desc = desc_;
+			desc.category = category;
+			buffer = rhi::GetBackendRHI().RHICreateBuffer(desc);
+		};
+		void Destroy(FrameResource& frame)
+		{
+			frame.buffer_dump.push_back(buffer);
+		};
+		void Release()
+		{
+			if (buffer)
+				rhi::GetBackendRHI().RHIFreeBuffer(*buffer);
+			buffer.reset();
+		};
+		void Swap(RenderGraphBuffer& other)
+		{
+			std::swap(buffer, other.buffer);
+		};
+		// the barriers are placed from the first access again
+		void ResetCompileState()
+		{
+			last_usage = BufferUsage::NONE;
+			last_write = false;
+			last_pass = nullptr;
+		};
+		bool IsCompatible(const Descriptor& desc) const
+		{
+			return desc_.element_count == desc.element_count && desc_.element_stride == desc.element_stride &&
+				desc_.memory_usage == desc.memory_usage;
+		};
+		uint64_t GetMemorySize() const
+		{
+			return static_cast<uint64_t>(desc_.element_count) * desc_.element_stride;
+		};
 	};
 
 	struct RenderGraphRenderTarget
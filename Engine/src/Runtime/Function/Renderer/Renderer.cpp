@@ -4,8 +4,11 @@
 #include "Runtime/Function/RHI/RHI.h"
 #include "Runtime/Function/RHI/RHIResource.h"
 #include "Runtime/Function/RHI/RHICommands.h"
+#include "Runtime/Function/RHI/RHIStats.h"
+#include "Runtime/Function/RHI/FrameCapture.h"
 #include "Runtime/Function/Renderer/RenderCommands.h"
 #include "Runtime/Resource/Vertex.h"
+#include "Runtime/Core/Base/Application.h"
 #include "RenderGraph/RenderGraph.h"
 
 #include <glm/glm.hpp>
@@ -29,27 +32,47 @@ namespace renderer
     {
         rhi::RHICommands::Init();
         frames_manager_.CreateFrames();
+        gpu_profiler_.Init();
         render_graph_.SetRenderer(this);
     }
 
     void Renderer::Shutdown()
     {
+        // a capture that hasn't got all its frames keeps the ones it has
+        rhi::FrameCapture::GetInstance().Stop();
         frames_manager_.DestroyFrames();
         rhi::RHICommands::Shutdown();
     }
 
     void Renderer::Begin()
     {
-        frames_manager_.BeginFrame();
+        MLE_PROFILE_FUNCTION();
+        rhi::FrameCapture::GetInstance().BeginFrame();
+        rhi::RHIStats::GetInstance().BeginFrame();
+        FrameResource& frame = frames_manager_.BeginFrame();
+        gpu_profiler_.BeginFrame(frame);
 
         // Start the Dear ImGui frame
-        ImGui_ImplGlfw_NewFrame();
+        if (engine::Application::GetApp().IsHeadless())
+        {
+            // no platform backend, so fill in what it would
+            ImGuiIO& io = ImGui::GetIO();
+            rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+            io.DisplaySize = ImVec2(static_cast<float>(rhi.GetViewportWidth()), static_cast<float>(rhi.GetViewportHeight()));
+            io.DeltaTime = HEADLESS_UI_TIME_STEP;
+        }
+        else
+        {
+            ImGui_ImplGlfw_NewFrame();
+        }
         ImGui::NewFrame();
         ImGuizmo::BeginFrame();
     }
 
     void Renderer::Tick(float time_step)
     {
+        MLE_PROFILE_FUNCTION();
+        rhi::RHI::GetRHIInstance().RHITick(time_step);
         auto& current_frame = frames_manager_.GetCurrentFrame();
 
         render_graph_.Run(current_frame);
@@ -57,7 +80,9 @@ namespace renderer
 
     void Renderer::End()
     {
+        MLE_PROFILE_FUNCTION();
         auto& current_frame = frames_manager_.GetCurrentFrame();
+        gpu_profiler_.EndFrame(current_frame);
         frames_manager_.EndFrame();
 
         rhi::QueueSubmitDesc gfx_submit_info{};
@@ -77,6 +102,9 @@ namespace renderer
         rhi::RHICommands::GfxQueueSubmit(gfx_submit_info);
         rhi::Semaphore* present_semaphores[] = { current_frame.render_finished_semaphore };
         rhi::RHICommands::Present(present_semaphores, 1);
+
+        rhi::RHI& rhi = rhi::RHI::GetRHIInstance();
+        rhi::FrameCapture::GetInstance().EndFrame(rhi.GetViewportWidth(), rhi.GetViewportHeight());
     }
 
     rhi::BufferRef Renderer::LoadModel(const std::vector<resource::Vertex>& in_vertices)
@@ -98,6 +126,7 @@ namespace renderer
         sb_desc.memory_usage = MemoryUsage::MEMORY_USAGE_CPU_TO_GPU;
         sb_desc.prefer_host = true;
         sb_desc.mapped_at_creation = true;
+        sb_desc.category = MemoryCategory::STAGING;
         auto staging_buffer = rhi.RHICreateBuffer(sb_desc);
         staging_buffer->SetData(in_vertices.data(), size);
 
@@ -137,6 +166,7 @@ namespace renderer
         sb_desc.memory_usage = MemoryUsage::MEMORY_USAGE_CPU_TO_GPU;
         sb_desc.prefer_host = true;
         sb_desc.mapped_at_creation = true;
+        sb_desc.category = MemoryCategory::STAGING;
         auto staging_buffer = rhi.RHICreateBuffer(sb_desc);
         staging_buffer->SetData(in_indecies.data(), size);
 
@@ -2,6 +2,7 @@
 #include "Runtime/Core/Base/Singleton.h"
 #include "Runtime/Function/RHI/RHICommands.h"
 #include "FrameResource.h"
+#include "GPUProfiler.h"
 #include "RenderGraph/RenderGraph.h"
 
 namespace resource {
@@ -28,6 +29,7 @@ namespace renderer {
 		void Shutdown();
 
 		RenderGraph& GetRenderGraph() { return render_graph_; };
+		GPUProfiler& GetGPUProfiler() { return gpu_profiler_; };
 
 		// TEMP Functions
 		rhi::BufferRef LoadModel(const std::vector<resource::Vertex>& in_vertices);
@@ -50,11 +52,21 @@ namespace renderer {
 		{
 			return frames_manager_.GetFrameIndex();
 		}
+
+		// See FrameResourceMngr::SetFramesInFlight
+		inline void SetFramesInFlight(uint8_t count) { frames_manager_.SetFramesInFlight(count); };
+		inline uint8_t GetFramesInFlight() const { return frames_manager_.GetFramesInFlight(); };
+		// Called before the input is sampled, so the GPU wait of Begin doesn't add to the input latency
+		inline void WaitForNextFrame() { frames_manager_.WaitForNextFrame(); };
 		rhi::DescriptorAllocator* desc_allocator_;
 		rhi::DescriptorSetLayout* global_layout_;
 	private:
+		// headless runs step the UI at a fixed rate so their output doesn't depend on timing
+		static constexpr float HEADLESS_UI_TIME_STEP = 1.0f / 60.0f;
+
 		RenderGraph render_graph_;
 		FrameResourceMngr frames_manager_;
+		GPUProfiler gpu_profiler_;
 		bool is_frame_started_{ false };
 	};
 }
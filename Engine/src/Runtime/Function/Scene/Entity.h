@@ -18,6 +18,7 @@ namespace engine {
 		{
 			assert(!HasComponent<COMPONENT>() && "Entity already has component");
 			COMPONENT& component = belonged_scene_->registry_.emplace<COMPONENT>(entity_handle_, std::forward<Args>(args)...);
+			belonged_scene_->MarkChanged();
 
 			return component;
 		}
@@ -40,6 +41,7 @@ namespace engine {
 		{
 			assert(HasComponent<COMPONENT>() && "Entity dose not have component");
 			belonged_scene_->registry_.remove<COMPONENT>(entity_handle_);
+			belonged_scene_->MarkChanged();
 		}
 
 		operator bool() const { return entity_handle_ != entt::null; }
@@ -15,5 +15,6 @@ namespace engine {
 	void Scene::DestroyEntity(Entity entity)
 	{
 		registry_.destroy(entity);
+		MarkChanged();
 	}
 }
\ No newline at end of file
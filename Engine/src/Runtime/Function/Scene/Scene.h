@@ -18,6 +18,10 @@ namespace engine {
 		Entity CreateEntity(const char* name = nullptr);
 		void DestroyEntity(Entity entity);
 
+		// Bumped whenever an entity or a component is added or removed, edits of a component in place call MarkChanged()
+		void MarkChanged() { ++change_version_; }
+		uint64_t GetChangeVersion() const { return change_version_; }
+
 		template<typename... Components>
 		auto GetAllEntitiesWith()
 		{
@@ -32,5 +36,6 @@ namespace engine {
 		}
 	private:
 		entt::registry registry_;
+		uint64_t change_version_ = 0;
 	};
 }
\ No newline at end of file
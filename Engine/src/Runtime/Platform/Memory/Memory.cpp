@@ -0,0 +1,70 @@
+#include "mlepch.h"
+#include "Memory.h"
+
+namespace engine {
+	LinearArena::LinearArena(size_t block_size)
+		:block_size_(block_size)
+	{
+	}
+
+	LinearArena::~LinearArena()
+	{
+		for (auto& block : blocks_)
+		{
+			::operator delete(block.data);
+		}
+	}
+
+	void* LinearArena::Allocate(size_t size, size_t alignment)
+	{
+		assert((alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+		assert(alignment <= alignof(std::max_align_t) && "over-aligned types are not supported");
+
+		while (current_block_ < blocks_.size())
+		{
+			Block& block = blocks_[current_block_];
+			const size_t aligned_offset = (offset_ + alignment - 1) & ~(alignment - 1);
+			if (aligned_offset + size <= block.size)
+			{
+				offset_ = aligned_offset + size;
+				used_bytes_ += size;
+				return block.data + aligned_offset;
+			}
+			// leave the tail of this block, try the next one
+			current_block_++;
+			offset_ = 0;
+		}
+
+		AddBlock(size + alignment);
+		return Allocate(size, alignment);
+	}
+
+	void LinearArena::Reset()
+	{
+		// Fold the blocks into one big enough for the last round, so the next one allocates once
+		if (blocks_.size() > 1)
+		{
+			size_t total_size = 0;
+			for (auto& block : blocks_)
+			{
+				total_size += block.size;
+				::operator delete(block.data);
+			}
+			blocks_.clear();
+			AddBlock(total_size);
+		}
+		current_block_ = 0;
+		offset_ = 0;
+		used_bytes_ = 0;
+	}
+
+	void LinearArena::AddBlock(size_t min_size)
+	{
+		Block& block = blocks_.emplace_back();
+		block.size = std::max(min_size, block_size_);
+		// operator new is aligned to max_align_t, which covers everything the render graph allocates
+		block.data = static_cast<uint8_t*>(::operator new(block.size));
+		current_block_ = blocks_.size() - 1;
+		offset_ = 0;
+	}
+}
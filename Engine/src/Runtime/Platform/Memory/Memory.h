@@ -0,0 +1,56 @@
+#pragma once
+
+namespace engine {
+	/// <summary>
+	/// Bump allocator over a few big blocks. Objects are never freed one by one,
+	/// Reset() rewinds everything at once and keeps the memory for the next round.
+	/// Destructors are not tracked, call LinearArena::Delete on objects that need them before Reset().
+	/// </summary>
+	class LinearArena
+	{
+	public:
+		static constexpr size_t DEFAULT_BLOCK_SIZE = 16 * 1024;
+
+		explicit LinearArena(size_t block_size = DEFAULT_BLOCK_SIZE);
+		~LinearArena();
+
+		LinearArena(LinearArena const&) = delete;
+		LinearArena& operator=(LinearArena const&) = delete;
+
+		void* Allocate(size_t size, size_t alignment);
+
+		template<typename T, typename... Args>
+		T* New(Args&&... args)
+		{
+			void* memory = Allocate(sizeof(T), alignof(T));
+			return new (memory) T(std::forward<Args>(args)...);
+		}
+
+		template<typename T>
+		static void Delete(T* object)
+		{
+			if (object)
+				object->~T();
+		}
+
+		// Everything allocated so far becomes invalid
+		void Reset();
+
+		inline size_t GetUsedBytes() const { return used_bytes_; };
+		inline size_t GetBlockCount() const { return blocks_.size(); };
+	private:
+		void AddBlock(size_t min_size);
+
+		struct Block
+		{
+			uint8_t* data = nullptr;
+			size_t size = 0;
+		};
+		std::vector<Block> blocks_;
+		size_t current_block_ = 0;
+		size_t offset_ = 0;
+		size_t used_bytes_ = 0;
+
+		const size_t block_size_;
+	};
+}
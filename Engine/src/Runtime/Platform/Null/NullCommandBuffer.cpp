@@ -0,0 +1,291 @@
+#include "mlepch.h"
+#include "NullCommandBuffer.h"
+#include "NullRHI.h"
+#include "NullRenderPass.h"
+#include "NullDescriptor.h"
+#include "Runtime/Function/RHI/RHIStats.h"
+#include "Runtime/Function/RHI/FrameCapture.h"
+
+namespace rhi {
+	void NullEncoderBase::InternalBegin()
+	{
+		rhi_->Validate(!is_recording_, "Begin on an encoder that is already recording");
+		is_recording_ = true;
+		command_count_ = 0;
+	}
+
+	void NullEncoderBase::InternalEnd()
+	{
+		rhi_->Validate(is_recording_, "End on an encoder that isn't recording");
+		is_recording_ = false;
+	}
+
+	bool NullEncoderBase::ValidateRecording(const char* command)
+	{
+		++command_count_;
+		return rhi_->Validate(is_recording_, "command recorded outside of Begin/End", command);
+	}
+
+	//------------------------------------Gfx Encoder------------------------------------
+	void NullGraphicsEncoder::BeginRenderPass(RenderPass& pass, RenderTarget& render_target, SubpassContents contents)
+	{
+		ValidateRecording("BeginRenderPass");
+		rhi_->Validate(current_pass_ == nullptr, "BeginRenderPass inside of a render pass");
+		current_pass_ = static_cast<NullRenderPass*>(&pass);
+		current_subpass_ = 0;
+		current_contents_ = contents;
+		RHIStats::Count(RHICounter::RENDER_PASS_BEGINS);
+	}
+
+	void NullGraphicsEncoder::BindGfxPipeline(RHIPipeline* pipeline)
+	{
+		ValidateRecording("BindGfxPipeline");
+		NullPipeline* null_pipeline = static_cast<NullPipeline*>(pipeline);
+		if (rhi_->Validate(null_pipeline != nullptr, "BindGfxPipeline with a null pipeline") && current_pass_)
+		{
+			rhi_->Validate(null_pipeline->render_pass == current_pass_, "pipeline bound in a render pass it wasn't created for");
+			rhi_->Validate(null_pipeline->subpass == current_subpass_, "pipeline bound in a subpass it wasn't created for");
+		}
+		current_pipeline_ = null_pipeline;
+		RHIStats::Count(RHICounter::PIPELINE_BINDS);
+	}
+
+	void NullGraphicsEncoder::BindVertexBuffers(uint32_t first_binding, uint32_t binding_count, RHIBuffer** buffer, uint64_t* offsets)
+	{
+		ValidateRecording("BindVertexBuffers");
+		if (rhi_->IsValidating())
+		{
+			NullBuffer** vb = (NullBuffer**)buffer;
+			for (uint32_t i = 0; i < binding_count; ++i)
+			{
+				rhi_->Validate(vb[i] && vb[i]->is_alive, "vertex buffer is null or has been freed");
+				if (vb[i] && offsets)
+					rhi_->Validate(offsets[i] < vb[i]->size, "vertex buffer offset is out of range");
+			}
+		}
+		RHIStats::Count(RHICounter::VERTEX_BUFFER_BINDS, binding_count);
+	}
+
+	void NullGraphicsEncoder::BindIndexBuffer(RHIBuffer* index_buffer, uint64_t offset)
+	{
+		ValidateRecording("BindIndexBuffer");
+		NullBuffer* null_buffer = static_cast<NullBuffer*>(index_buffer);
+		if (rhi_->Validate(null_buffer && null_buffer->is_alive, "index buffer is null or has been freed"))
+			rhi_->Validate(offset < null_buffer->size, "index buffer offset is out of range");
+		current_index_buffer_ = null_buffer;
+		RHIStats::Count(RHICounter::INDEX_BUFFER_BINDS);
+	}
+
+	void NullGraphicsEncoder::BindDescriptorSets(PipelineLayout* layout, uint32_t first_set, uint32_t sets_count, DescriptorSet** sets, uint32_t dynameic_offset_count, const uint32_t* dynamic_offsets)
+	{
+		ValidateRecording("BindDescriptorSets");
+		if (rhi_->IsValidating())
+		{
+			NullPipelineLayout* null_layout = static_cast<NullPipelineLayout*>(layout);
+			rhi_->Validate(null_layout != nullptr, "BindDescriptorSets with a null pipeline layout");
+			if (null_layout)
+				rhi_->Validate(first_set + sets_count <= null_layout->set_layout_count, "more descriptor sets bound than the pipeline layout has");
+			NullDescriptorSet** null_sets = (NullDescriptorSet**)sets;
+			for (uint32_t i = 0; i < sets_count; ++i)
+			{
+				rhi_->Validate(null_sets[i] && null_sets[i]->IsAllocated(), "descriptor set is null, unallocated or its pool has been reset");
+			}
+		}
+		RHIStats::Count(RHICounter::DESCRIPTOR_SET_BINDS, sets_count);
+	}
+
+	void NullGraphicsEncoder::SetViewport(float x, float y, float width, float height, float min_depth, float max_depth)
+	{
+		ValidateRecording("SetViewport");
+		rhi_->Validate(width > 0.0f, "viewport width must be greater than 0");
+	}
+
+	void NullGraphicsEncoder::SetScissor(int32_t offset_x, int32_t offset_y, uint32_t width, uint32_t height)
+	{
+		ValidateRecording("SetScissor");
+		rhi_->Validate(offset_x >= 0 && offset_y >= 0, "scissor offset must not be negative");
+	}
+
+	void NullGraphicsEncoder::Draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance)
+	{
+		ValidateRecording("Draw");
+		rhi_->Validate(current_pass_ != nullptr, "Draw outside of a render pass");
+		rhi_->Validate(current_pipeline_ != nullptr, "Draw without a bound pipeline");
+		RHIStats::Count(RHICounter::DRAW_CALLS);
+		RHIStats::Count(RHICounter::DRAWN_VERTICES, static_cast<uint64_t>(vertex_count) * instance_count);
+	}
+
+	void NullGraphicsEncoder::DrawIndexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t offset, uint32_t first_instance)
+	{
+		ValidateRecording("DrawIndexed");
+		rhi_->Validate(current_pass_ != nullptr, "DrawIndexed outside of a render pass");
+		rhi_->Validate(current_pipeline_ != nullptr, "DrawIndexed without a bound pipeline");
+		// indices are uint16
+		if (rhi_->Validate(current_index_buffer_ != nullptr, "DrawIndexed without a bound index buffer"))
+			rhi_->Validate((static_cast<uint64_t>(first_index) + index_count) * sizeof(uint16_t) <= current_index_buffer_->size, "DrawIndexed reads past the end of the index buffer");
+		RHIStats::Count(RHICounter::DRAW_CALLS);
+		RHIStats::Count(RHICounter::DRAWN_VERTICES, static_cast<uint64_t>(index_count) * instance_count);
+	}
+
+	void NullGraphicsEncoder::NextSubpass()
+	{
+		ValidateRecording("NextSubpass");
+		if (rhi_->Validate(current_pass_ != nullptr, "NextSubpass outside of a render pass"))
+			rhi_->Validate(current_subpass_ + 1 < current_pass_->GetSubpassCount(), "NextSubpass past the last subpass");
+		++current_subpass_;
+		current_pipeline_ = nullptr;
+		// vulkan begins the next subpass with inline contents
+		current_contents_ = SubpassContents::INLINE;
+	}
+
+	void NullGraphicsEncoder::ExecuteSecondary(SecondaryCommandBuffer& secondary)
+	{
+		ValidateRecording("ExecuteSecondary");
+		NullSecondaryCommandBuffer& null_secondary = static_cast<NullSecondaryCommandBuffer&>(secondary);
+		if (rhi_->Validate(current_pass_ != nullptr, "ExecuteSecondary outside of a render pass"))
+		{
+			rhi_->Validate(current_contents_ == SubpassContents::SECONDARY_COMMAND_BUFFERS, "ExecuteSecondary in a subpass with inline contents");
+			rhi_->Validate(null_secondary.pass_ == current_pass_ && null_secondary.subpass_ == current_subpass_,
+				"secondary command buffer executed in a subpass it wasn't recorded for");
+		}
+		rhi_->Validate(!null_secondary.gfx_encoder_.is_recording_, "ExecuteSecondary on a secondary command buffer that is still recording");
+		current_pipeline_ = nullptr;
+		current_index_buffer_ = nullptr;
+	}
+
+	void NullGraphicsEncoder::BufferBarrier(const BufferBarrierDesc& desc)
+	{
+		BufferBarriers(&desc, 1);
+	}
+
+	void NullGraphicsEncoder::BufferBarriers(const BufferBarrierDesc* descs, uint32_t count)
+	{
+		ValidateRecording("BufferBarrier");
+		rhi_->Validate(current_pass_ == nullptr, "BufferBarrier inside of a render pass");
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			NullBuffer* null_buffer = static_cast<NullBuffer*>(descs[i].buffer);
+			rhi_->Validate(null_buffer && null_buffer->is_alive, "barrier on a buffer that is null or has been freed");
+		}
+		// counted like the vulkan backend, one per batch
+		RHIStats::Count(RHICounter::BARRIERS);
+	}
+
+	void NullGraphicsEncoder::ResetQueryPool(QueryPool* pool, uint32_t first_query, uint32_t query_count)
+	{
+		ValidateRecording("ResetQueryPool");
+		rhi_->Validate(current_pass_ == nullptr, "ResetQueryPool inside of a render pass");
+		NullQueryPool* null_pool = static_cast<NullQueryPool*>(pool);
+		if (!rhi_->Validate(first_query + query_count <= null_pool->is_written.size(), "ResetQueryPool is out of range"))
+			return;
+		std::fill_n(null_pool->is_written.begin() + first_query, query_count, false);
+	}
+
+	void NullGraphicsEncoder::WriteTimestamp(QueryPool* pool, uint32_t query)
+	{
+		ValidateRecording("WriteTimestamp");
+		NullQueryPool* null_pool = static_cast<NullQueryPool*>(pool);
+		if (!rhi_->Validate(query < null_pool->is_written.size(), "WriteTimestamp is out of range"))
+			return;
+		rhi_->Validate(!null_pool->is_written[query], "WriteTimestamp on a query that hasn't been reset");
+		null_pool->is_written[query] = true;
+	}
+
+	void NullGraphicsEncoder::EndRenderPass()
+	{
+		ValidateRecording("EndRenderPass");
+		if (rhi_->Validate(current_pass_ != nullptr, "EndRenderPass outside of a render pass"))
+			rhi_->Validate(current_subpass_ + 1 == current_pass_->GetSubpassCount(), "EndRenderPass before the last subpass");
+		current_pass_ = nullptr;
+		current_pipeline_ = nullptr;
+	}
+
+	void NullGraphicsEncoder::ImGui_RenderDrawData(ImDrawData* draw_data)
+	{
+		ValidateRecording("ImGui_RenderDrawData");
+		rhi_->Validate(current_pass_ != nullptr && current_pass_->is_for_present_, "ImGui has to be drawn in the present pass");
+	}
+
+	void NullGraphicsEncoder::End()
+	{
+		rhi_->Validate(current_pass_ == nullptr, "End inside of a render pass");
+		current_pass_ = nullptr;
+		current_pipeline_ = nullptr;
+		current_index_buffer_ = nullptr;
+		InternalEnd();
+	}
+
+	//------------------------------------Transfer Encoder------------------------------------
+
+	void NullTransferEncoder::CopyBufferToBuffer(const CopyBufferToBufferDesc& desc)
+	{
+		assert(desc.dst != nullptr && "fatal:destination buffer is NULL");
+		assert(desc.src != nullptr && "fatal:source buffer is NULL");
+		ValidateRecording("CopyBufferToBuffer");
+
+		NullBuffer* src = static_cast<NullBuffer*>(desc.src);
+		NullBuffer* dst = static_cast<NullBuffer*>(desc.dst);
+		rhi_->Validate(src->is_alive && dst->is_alive, "copy between buffers that have been freed");
+		rhi_->Validate(desc.src_offset + desc.size <= src->size, "copy reads past the end of the source buffer");
+		rhi_->Validate(desc.dst_offset + desc.size <= dst->size, "copy writes past the end of the destination buffer");
+		FrameCapture::OnCopyBufferToBuffer(desc);
+	}
+
+	void NullTransferEncoder::CopyBufferToImage(RHIBuffer* buffer,
+												RHITexture* image,
+												uint32_t              width,
+												uint32_t              height,
+												uint32_t              layer_count)
+	{
+		assert(buffer != nullptr && "fatal:buffer is NULL");
+		assert(image != nullptr && "fatal:image is NULL");
+		ValidateRecording("CopyBufferToImage");
+
+		NullBuffer* null_buffer = static_cast<NullBuffer*>(buffer);
+		NullTexture* null_texture = static_cast<NullTexture*>(image);
+		rhi_->Validate(null_buffer->is_alive && null_texture->is_alive, "copy between resources that have been freed");
+		rhi_->Validate(width <= null_texture->width && height <= null_texture->height, "copy is larger than the image");
+		rhi_->Validate(EnumHasFlag(null_texture->usage, TextureUsage::UPLOADABLE), "copy into an image that isn't UPLOADABLE");
+		FrameCapture::OnCopyBufferToImage(*buffer, *image, width, height, layer_count);
+	}
+
+	//------------------------------------Cmd Buffer----------------------------------------
+	NullCommandBuffer::NullCommandBuffer(NullRHI* in_rhi)
+	{
+		gfx_encoder_.rhi_ = in_rhi;
+		transfer_encoder_.rhi_ = in_rhi;
+	}
+
+	NullSecondaryCommandBuffer::NullSecondaryCommandBuffer(NullRHI* in_rhi)
+	{
+		gfx_encoder_.rhi_ = in_rhi;
+	}
+
+	void NullSecondaryCommandBuffer::Begin(RenderPass& pass, uint32_t subpass)
+	{
+		pass_ = static_cast<NullRenderPass*>(&pass);
+		subpass_ = subpass;
+		gfx_encoder_.Begin();
+		// the commands continue the subpass, so they are validated as if they were recorded inside of it
+		gfx_encoder_.current_pass_ = pass_;
+		gfx_encoder_.current_subpass_ = subpass;
+	}
+
+	void NullSecondaryCommandBuffer::End()
+	{
+		gfx_encoder_.current_pass_ = nullptr;
+		gfx_encoder_.End();
+	}
+
+	void NullCommandBuffer::Begin()
+	{
+		gfx_encoder_.Begin();
+		transfer_encoder_.Begin();
+	}
+
+	void NullCommandBuffer::End()
+	{
+		gfx_encoder_.End();
+		transfer_encoder_.End();
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "Runtime/Function/RHI/CommandBuffer.h"
+#include "NullResource.h"
+
+namespace rhi {
+	class NullRHI;
+	class NullRenderPass;
+
+	// The handle of a null encoder is the encoder itself, that is what a submit gets back
+	class NullEncoderBase
+	{
+		friend class NullRHI;
+	public:
+		virtual ~NullEncoderBase() = default;
+		void InternalBegin();
+		void InternalEnd();
+	protected:
+		// false if the command is recorded while the encoder isn't
+		bool ValidateRecording(const char* command);
+
+		NullRHI* rhi_ = nullptr;
+		bool is_recording_ = false;
+		// commands recorded since the last Begin
+		uint64_t command_count_ = 0;
+	};
+
+	class NullGraphicsEncoder : public RHIGraphicsEncoder, public NullEncoderBase
+	{
+		friend class NullCommandBuffer;
+		friend class NullSecondaryCommandBuffer;
+	public:
+		virtual ~NullGraphicsEncoder() = default;
+
+		virtual void Begin() override { InternalBegin(); }
+		virtual void BeginRenderPass(RenderPass& pass, RenderTarget& render_target, SubpassContents contents) override;
+		virtual void BindGfxPipeline(RHIPipeline* pipeline) override;
+		virtual void BindVertexBuffers(uint32_t first_binding, uint32_t binding_count, RHIBuffer** buffer, uint64_t* offsets) override;
+		virtual void BindIndexBuffer(RHIBuffer* index_buffer, uint64_t offset) override;
+		virtual void BindDescriptorSets(PipelineLayout* layout, uint32_t first_set, uint32_t sets_count, DescriptorSet** sets, uint32_t dynameic_offset_count, const uint32_t* dynamic_offsets) override;
+
+		virtual void SetViewport(float x, float y, float width, float height, float min_depth, float max_depth) override;
+		virtual void SetScissor(int32_t offset_x, int32_t offset_y, uint32_t width, uint32_t height) override;
+
+		virtual void Draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance) override;
+		virtual void DrawIndexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t offset, uint32_t first_instance) override;
+
+		virtual void NextSubpass() override;
+
+		virtual void ExecuteSecondary(SecondaryCommandBuffer& secondary) override;
+
+		virtual void BufferBarrier(const BufferBarrierDesc& desc) override;
+		virtual void BufferBarriers(const BufferBarrierDesc* descs, uint32_t count) override;
+
+		virtual void ResetQueryPool(QueryPool* pool, uint32_t first_query, uint32_t query_count) override;
+		virtual void WriteTimestamp(QueryPool* pool, uint32_t query) override;
+
+		virtual void EndRenderPass() override;
+
+		virtual void ImGui_RenderDrawData(ImDrawData* draw_data) override;
+
+		virtual void End() override;
+
+		virtual void* GetHandle() override { return static_cast<NullEncoderBase*>(this); };
+	private:
+		NullRenderPass* current_pass_ = nullptr;
+		uint32_t current_subpass_ = 0;
+		SubpassContents current_contents_ = SubpassContents::INLINE;
+		NullPipeline* current_pipeline_ = nullptr;
+		NullBuffer* current_index_buffer_ = nullptr;
+	};
+
+	class NullTransferEncoder :public RHITransferEncoder, public NullEncoderBase
+	{
+		friend class NullCommandBuffer;
+	public:
+		virtual ~NullTransferEncoder() = default;
+		virtual void Begin() override { InternalBegin(); };
+		virtual void CopyBufferToBuffer(const CopyBufferToBufferDesc& desc)	override;
+		virtual void CopyBufferToImage(RHIBuffer* buffer,
+									   RHITexture* image,
+									   uint32_t              width,
+									   uint32_t              height,
+									   uint32_t              layer_count)	override;
+		virtual void End() override { InternalEnd(); };
+
+		virtual void* GetHandle() override { return static_cast<NullEncoderBase*>(this); };
+	};
+
+	class NullCommandBuffer : public CommandBuffer
+	{
+	public:
+		NullCommandBuffer(NullRHI* in_rhi);
+		virtual ~NullCommandBuffer() = default;
+		virtual void Begin() override;
+		virtual void End() override;
+		inline virtual RHIGraphicsEncoder& GetGfxEncoder()	override { return gfx_encoder_; };
+		inline virtual void* GetNativeGfxHandle()			override { return gfx_encoder_.GetHandle(); };
+		virtual RHITransferEncoder& GetTransferEncoder()	override { return transfer_encoder_; };
+		virtual void* GetNativeTransferHandle()				override { return transfer_encoder_.GetHandle(); };
+	private:
+		NullGraphicsEncoder gfx_encoder_;
+		NullTransferEncoder transfer_encoder_;
+	};
+
+	class NullSecondaryCommandBuffer : public SecondaryCommandBuffer
+	{
+		friend class NullGraphicsEncoder;
+	public:
+		NullSecondaryCommandBuffer(NullRHI* in_rhi);
+		virtual ~NullSecondaryCommandBuffer() = default;
+		virtual void Begin(RenderPass& pass, uint32_t subpass) override;
+		virtual void End() override;
+		inline virtual RHIGraphicsEncoder& GetGfxEncoder() override { return gfx_encoder_; };
+		// null descriptor sets can be written while they are bound
+		virtual bool IsValid() override { return !gfx_encoder_.is_recording_; };
+	private:
+		NullGraphicsEncoder gfx_encoder_;
+		NullRenderPass* pass_ = nullptr;
+		uint32_t subpass_ = 0;
+	};
+}
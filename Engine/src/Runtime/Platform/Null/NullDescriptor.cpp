@@ -0,0 +1,98 @@
+#include "mlepch.h"
+#include "NullDescriptor.h"
+#include "NullRHI.h"
+#include "NullResource.h"
+#include "Runtime/Function/RHI/RHIStats.h"
+#include "Runtime/Function/RHI/FrameCapture.h"
+
+namespace rhi {
+	void NullDescriptorAllocator::ResetPools()
+	{
+		// every set allocated so far becomes invalid
+		++(*pool_generation_);
+	}
+
+	bool NullDescriptorAllocator::Allocate(DescriptorSet* set, DescriptorSetLayout* layout)
+	{
+		if (!rhi_->Validate(set != nullptr && layout != nullptr, "descriptor set allocated with a null set or layout"))
+			return false;
+		NullDescriptorSet* null_set = static_cast<NullDescriptorSet*>(set);
+		null_set->layout = static_cast<NullDescriptorSetLayout*>(layout);
+		null_set->pool_generation = pool_generation_;
+		null_set->generation = *pool_generation_;
+		FrameCapture::OnAllocateDescriptorSet(*set, *layout);
+		return true;
+	}
+
+	// -------------------------------------------------------
+
+	DescriptorSetLayoutRef NullDescriptorSetLayoutCache::CreateDescriptorLayout(const DescriptorLayoutDesc& desc)
+	{
+		// sorted the same way the vulkan cache sorts, so the same layouts are shared
+		DescriptorLayoutDesc layout_desc = desc;
+		std::sort(layout_desc.bindings.begin(), layout_desc.bindings.end(),
+			[](const DescriptorBinding& a, const DescriptorBinding& b)
+			{
+				return a.binding < b.binding;
+			});
+
+		auto it = layout_cache_.find(layout_desc);
+		if (it != layout_cache_.end())
+			return (*it).second;
+
+		std::shared_ptr<NullDescriptorSetLayout> layout = std::make_shared<NullDescriptorSetLayout>();
+		layout->desc = layout_desc;
+		layout_cache_[layout_desc] = layout;
+		return layout;
+	}
+
+	// -------------------------------------------------------
+
+	DescriptorWriter& NullDescriptorWriter::WriteBuffer(uint32_t binding, rhi::RHIBuffer* buffer, DescriptorType type)
+	{
+		writes_.push_back({ binding, type, buffer, nullptr });
+		FrameCapture::OnDescriptorWrite(binding, type, buffer, nullptr);
+		return *this;
+	}
+
+	DescriptorWriter& NullDescriptorWriter::WriteImage(uint32_t binding, rhi::RHITexture* image, DescriptorType type)
+	{
+		writes_.push_back({ binding, type, nullptr, image });
+		FrameCapture::OnDescriptorWrite(binding, type, nullptr, image);
+		return *this;
+	}
+
+	bool NullDescriptorWriter::Build(DescriptorSet* set, DescriptorSetLayout* layout)
+	{
+		if (!alloc_->Allocate(set, layout))
+			return false;
+
+		OverWrite(set);
+
+		return true;
+	}
+
+	void NullDescriptorWriter::OverWrite(DescriptorSet* set)
+	{
+		NullRHI* rhi = alloc_->GetRHI();
+		NullDescriptorSet* null_set = static_cast<NullDescriptorSet*>(set);
+		if (rhi->IsValidating() && rhi->Validate(null_set->IsAllocated(), "write to a descriptor set that isn't allocated"))
+		{
+			const auto& bindings = null_set->layout->desc.bindings;
+			for (const Write& write : writes_)
+			{
+				auto binding = std::find_if(bindings.begin(), bindings.end(), [&write](const DescriptorBinding& other) {
+					return other.binding == write.binding; });
+				if (!rhi->Validate(binding != bindings.end(), "write to a binding the layout doesn't have"))
+					continue;
+				rhi->Validate(binding->descriptor_type == write.type, "write doesn't match the descriptor type of the binding");
+				if (write.buffer)
+					rhi->Validate(static_cast<NullBuffer*>(write.buffer)->is_alive, "descriptor written with a freed buffer");
+				else
+					rhi->Validate(write.image && static_cast<NullTexture*>(write.image)->is_alive, "descriptor written with a null or freed image");
+			}
+		}
+		RHIStats::Count(RHICounter::DESCRIPTOR_WRITES, writes_.size());
+		FrameCapture::OnWriteDescriptorSet(*set);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "Runtime/Function/RHI/Descriptor.h"
+
+namespace rhi {
+	class NullRHI;
+
+	struct NullDescriptorSetLayout : public DescriptorSetLayout
+	{
+		DescriptorLayoutDesc desc;
+	};
+
+	struct NullDescriptorSet : public DescriptorSet
+	{
+		NullDescriptorSetLayout* layout = nullptr;
+		// the set is allocated as long as the pools it came from haven't been reset since,
+		// shared so sets and their allocator can go away in any order
+		std::shared_ptr<uint64_t> pool_generation;
+		uint64_t generation = 0;
+
+		inline bool IsAllocated() const { return pool_generation && *pool_generation == generation; };
+	};
+
+	class NullDescriptorAllocator : public DescriptorAllocator
+	{
+	public:
+		NullDescriptorAllocator(NullRHI* in_rhi)
+			:rhi_(in_rhi), pool_generation_(std::make_shared<uint64_t>(0)) {};
+		virtual ~NullDescriptorAllocator() = default;
+		virtual void ResetPools() override;
+		virtual bool Allocate(DescriptorSet* set, DescriptorSetLayout* layout) override;
+
+		virtual void Shutdown() override { ResetPools(); };
+
+		inline NullRHI* GetRHI() { return rhi_; };
+	private:
+		NullRHI* rhi_;
+		std::shared_ptr<uint64_t> pool_generation_;
+	};
+
+	class NullDescriptorSetLayoutCache : public DescriptorSetLayoutCache
+	{
+	public:
+		virtual ~NullDescriptorSetLayoutCache() = default;
+		virtual void Shutdown() override { layout_cache_.clear(); };
+		virtual DescriptorSetLayoutRef CreateDescriptorLayout(const DescriptorLayoutDesc& desc) override;
+	};
+
+	class NullDescriptorWriter : public DescriptorWriter
+	{
+		friend class DescriptorWriter;
+	public:
+		NullDescriptorWriter(NullDescriptorAllocator* allocator)
+			:alloc_(allocator)
+		{
+			writes_.reserve(10);
+		};
+
+		virtual DescriptorWriter& WriteBuffer(uint32_t binding, rhi::RHIBuffer* buffer, DescriptorType type) override;
+		virtual DescriptorWriter& WriteImage(uint32_t binding, rhi::RHITexture* image, DescriptorType type) override;
+
+		virtual bool Build(DescriptorSet* set, DescriptorSetLayout* layout) override;
+		virtual void OverWrite(DescriptorSet* set) override;
+	private:
+		struct Write
+		{
+			uint32_t binding;
+			DescriptorType type;
+			RHIBuffer* buffer;
+			RHITexture* image;
+		};
+		std::vector<Write> writes_;
+
+		NullDescriptorAllocator* alloc_;
+	};
+}
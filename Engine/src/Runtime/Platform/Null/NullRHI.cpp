@@ -0,0 +1,434 @@
+#include "mlepch.h"
+#include "NullRHI.h"
+#include "NullCommandBuffer.h"
+#include "NullDescriptor.h"
+#include "NullRenderPass.h"
+#include "Runtime/Core/Base/Application.h"
+#include "Runtime/Function/RHI/RHIStats.h"
+#include "Runtime/Function/RHI/FrameCapture.h"
+
+#include <imgui.h>
+#include "backends/imgui_impl_glfw.h"
+
+namespace rhi {
+	void NullBuffer::SetData(const void* data, uint64_t size, uint64_t offset)
+	{
+		if (!rhi->Validate(is_alive, "SetData on a freed buffer"))
+			return;
+		if (mapped_data.empty())
+		{
+			MLE_CORE_ERROR("Buffer isn't mapped, can't set data directly. Please use a staging buffer to upload data");
+			return;
+		}
+		if (!rhi->Validate(offset + size <= mapped_data.size(), "SetData writes past the end of the buffer"))
+			return;
+		memcpy(mapped_data.data() + offset, data, size);
+		FrameCapture::OnBufferData(*this, data, size, offset);
+	}
+
+	// ---------------------------------------------------
+
+	void NullRHI::Init()
+	{
+		const engine::ApplicationSpecification& spec = engine::Application::GetApp().GetSpecification();
+		viewport_width_ = spec.width;
+		viewport_height_ = spec.height;
+		MLE_CORE_INFO("Null RHI initialized, validation is {0}", is_validating_ ? "on" : "off");
+	}
+
+	void NullRHI::Shutdown()
+	{
+		if (ImGui::GetCurrentContext())
+		{
+			if (has_imgui_platform_)
+				ImGui_ImplGlfw_Shutdown();
+			ImGui::DestroyContext();
+		}
+
+		if (is_validating_)
+		{
+			Validate(buffer_pool_.GetLiveCount() == 0, "buffers leaked");
+			Validate(texture_pool_.GetLiveCount() == 0, "textures leaked");
+			Validate(pipeline_pool_.GetLiveCount() == 0, "pipelines leaked");
+			Validate(live_semaphores_ == 0, "semaphores leaked");
+			Validate(live_fences_ == 0, "fences leaked");
+			Validate(live_query_pools_ == 0, "query pools leaked");
+			MLE_CORE_INFO("[null] {0} validation error(s)", validation_error_count_);
+		}
+		MLE_CORE_INFO("Null RHI has been shut down");
+	}
+
+	void NullRHI::RHITick(float delta_time)
+	{
+		MLE_PROFILE_FUNCTION();
+		// nothing is allocated from a heap, so report what was asked for as usage against an unlimited budget
+		RHIHeapBudget heap{};
+		for (uint8_t category = 0; category < static_cast<uint8_t>(MemoryCategory::COUNT); ++category)
+		{
+			RHIMemoryCategoryStats stats = RHIStats::GetInstance().GetMemoryCategory(static_cast<MemoryCategory>(category));
+			heap.usage += stats.bytes;
+			heap.allocation_count += static_cast<uint32_t>(stats.allocation_count);
+		}
+		heap.allocation_bytes = heap.usage;
+		heap.block_bytes = heap.usage;
+		heap.device_local = true;
+		RHIStats::GetInstance().SetHeapBudgets({ heap });
+	}
+
+	bool NullRHI::Validate(bool condition, const char* message, const char* detail)
+	{
+		if (condition || !is_validating_)
+			return condition;
+		++validation_error_count_;
+		if (detail)
+			MLE_CORE_ERROR("[null] {0}: {1}", message, detail);
+		else
+			MLE_CORE_ERROR("[null] {0}", message);
+		return false;
+	}
+
+	void NullRHI::AcquireNextImage(Semaphore* semaphore)
+	{
+		MLE_PROFILE_FUNCTION();
+		NullSemaphore* null_semaphore = static_cast<NullSemaphore*>(semaphore);
+		Validate(!null_semaphore->is_signaled, "AcquireNextImage signals a semaphore that is already signaled");
+		null_semaphore->is_signaled = true;
+	}
+
+	void NullRHI::Submit(const QueueSubmitDesc& desc)
+	{
+		assert(desc.cmds_count > 0 && "command buffer count must be greater than 0");
+		assert(desc.encoders);
+		if (is_validating_)
+		{
+			for (uint32_t i = 0; i < desc.cmds_count; ++i)
+			{
+				NullEncoderBase* encoder = static_cast<NullEncoderBase*>(desc.encoders[i]->GetHandle());
+				Validate(!encoder->is_recording_, "submitted an encoder that is still recording");
+			}
+		}
+		// the work is done as soon as it is submitted
+		for (uint32_t i = 0; i < desc.wait_semaphore_count; ++i)
+		{
+			NullSemaphore* semaphore = static_cast<NullSemaphore*>(desc.wait_semaphore[i]);
+			Validate(semaphore->is_signaled, "submit waits on a semaphore nothing signals");
+			semaphore->is_signaled = false;
+		}
+		for (uint32_t i = 0; i < desc.signal_semaphore_count; ++i)
+		{
+			NullSemaphore* semaphore = static_cast<NullSemaphore*>(desc.signal_semaphore[i]);
+			Validate(!semaphore->is_signaled, "submit signals a semaphore that is already signaled");
+			semaphore->is_signaled = true;
+		}
+		if (desc.signal_fence)
+		{
+			NullFence* fence = static_cast<NullFence*>(desc.signal_fence);
+			Validate(!fence->is_signaled, "submit signals a fence that hasn't been reset");
+			fence->is_signaled = true;
+		}
+		RHIStats::Count(RHICounter::QUEUE_SUBMITS);
+	}
+
+	void NullRHI::GfxQueueSubmit(const QueueSubmitDesc& desc)
+	{
+		MLE_PROFILE_FUNCTION();
+		Submit(desc);
+	}
+
+	void NullRHI::ComputeQueueSubmit(const QueueSubmitDesc& desc)
+	{
+
+	}
+
+	void NullRHI::TransferQueueSubmit(const QueueSubmitDesc& desc)
+	{
+		MLE_PROFILE_FUNCTION();
+		Submit(desc);
+	}
+
+	void NullRHI::Present(Semaphore** semaphores, uint32_t semaphore_count)
+	{
+		MLE_PROFILE_FUNCTION();
+		for (uint32_t i = 0; i < semaphore_count; ++i)
+		{
+			NullSemaphore* semaphore = static_cast<NullSemaphore*>(semaphores[i]);
+			Validate(semaphore->is_signaled, "Present waits on a semaphore nothing signals");
+			semaphore->is_signaled = false;
+		}
+	}
+
+	DescriptorSetPtr NullRHI::RHICreateDescriptorSet()
+	{
+		auto set = std::make_unique<NullDescriptorSet>();
+		FrameCapture::OnCreateDescriptorSet(*set);
+		return set;
+	}
+
+	DescriptorSetLayoutCachePtr NullRHI::CreateDescriptorSetLayoutCache()
+	{
+		return std::make_unique<NullDescriptorSetLayoutCache>();
+	}
+
+	DescriptorAllocatorPtr NullRHI::CreateDescriptorAllocator()
+	{
+		return std::make_unique<NullDescriptorAllocator>(this);
+	}
+
+	CommandBuffer* NullRHI::RHICreateCommandBuffer()
+	{
+		return new NullCommandBuffer(this);
+	}
+
+	std::unique_ptr<SecondaryCommandBuffer> NullRHI::RHICreateSecondaryCommandBuffer()
+	{
+		return std::make_unique<NullSecondaryCommandBuffer>(this);
+	}
+
+	std::unique_ptr<RenderPass> NullRHI::RHICreateRenderPass(const RenderPass::Descriptor& desc)
+	{
+		auto pass = std::make_unique<NullRenderPass>(*this, desc);
+		FrameCapture::OnCreateRenderPass(*pass, desc);
+		return pass;
+	}
+
+	std::unique_ptr<RenderTarget> NullRHI::RHICreateRenderTarget(const RenderTarget::Descriptor& desc)
+	{
+		auto render_target = std::make_unique<NullRenderTarget>(*this, desc);
+		FrameCapture::OnCreateRenderTarget(*render_target, desc);
+		return render_target;
+	}
+
+	Semaphore* NullRHI::RHICreateSemaphore()
+	{
+		++live_semaphores_;
+		return new NullSemaphore{};
+	}
+
+	Fence* NullRHI::RHICreateFence()
+	{
+		++live_fences_;
+		return new NullFence{};
+	}
+
+	void NullRHI::RHIDestroySemaphore(Semaphore* semaphore)
+	{
+		--live_semaphores_;
+		delete static_cast<NullSemaphore*>(semaphore);
+	}
+
+	void NullRHI::RHIDestroyFence(Fence* fence)
+	{
+		--live_fences_;
+		delete static_cast<NullFence*>(fence);
+	}
+
+	void NullRHI::RHIWaitForFences(Fence** fence, uint32_t fence_count)
+	{
+		MLE_PROFILE_FUNCTION();
+		for (uint32_t i = 0; i < fence_count; ++i)
+		{
+			NullFence* null_fence = static_cast<NullFence*>(fence[i]);
+			// a driver would block forever
+			Validate(null_fence->is_signaled, "waiting on a fence nothing signals");
+			null_fence->is_signaled = false;
+		}
+	}
+
+	bool NullRHI::RHIIsFenceReady(Fence* fence)
+	{
+		return static_cast<NullFence*>(fence)->is_signaled;
+	}
+
+	QueryPool* NullRHI::RHICreateTimestampQueryPool(uint32_t query_count)
+	{
+		NullQueryPool* pool = new NullQueryPool{};
+		pool->is_written.resize(query_count, false);
+		++live_query_pools_;
+		return pool;
+	}
+
+	void NullRHI::RHIDestroyQueryPool(QueryPool* pool)
+	{
+		--live_query_pools_;
+		delete static_cast<NullQueryPool*>(pool);
+	}
+
+	bool NullRHI::RHIGetQueryResults(QueryPool* pool, uint32_t first_query, uint32_t query_count, uint64_t* results)
+	{
+		NullQueryPool* null_pool = static_cast<NullQueryPool*>(pool);
+		if (!Validate(first_query + query_count <= null_pool->is_written.size(), "RHIGetQueryResults is out of range"))
+			return false;
+		for (uint32_t i = 0; i < query_count; ++i)
+		{
+			if (!null_pool->is_written[first_query + i])
+				return false;
+			results[i] = 0;
+		}
+		return true;
+	}
+
+	// ---------------------------------Resource Creation and deconstruction-----------------------------------
+	BufferRef NullRHI::RHICreateBuffer(const RHIBuffer::Descriptor& desc)
+	{
+		NullBuffer* buffer = buffer_pool_.Allocate();
+		buffer->rhi = this;
+
+		// same layout as the vulkan buffers, with the usual 256 bytes uniform offset alignment
+		constexpr uint32_t min_ubo_alignment = 256;
+		buffer->alignment = desc.element_stride;
+		if (desc.element_count > 1)
+			buffer->alignment = (buffer->alignment + min_ubo_alignment - 1) & ~(min_ubo_alignment - 1);
+		buffer->size = static_cast<uint64_t>(desc.element_count) * buffer->alignment;
+		buffer->usage = desc.usage;
+		buffer->category = desc.category;
+		buffer->allocation_size = buffer->size;
+		buffer->is_alive = true;
+		if (desc.mapped_at_creation)
+			buffer->mapped_data.resize(buffer->size);
+
+		RHIStats::TrackAllocation(buffer->category, buffer->allocation_size);
+		RHIStats::Count(RHICounter::BUFFER_CREATIONS);
+		FrameCapture::OnCreateBuffer(*buffer, desc);
+		return BufferRef(buffer, &buffer_pool_);
+	}
+
+	void NullRHI::RHIFreeBuffer(RHIBuffer& buffer)
+	{
+		NullBuffer* null_buffer = static_cast<NullBuffer*>(&buffer);
+		// the vulkan backend reports it and ignores the second free as well
+		if (!Validate(buffer_pool_.IsAlive(null_buffer->handle), "buffer freed twice"))
+			return;
+		null_buffer->is_alive = false;
+		null_buffer->mapped_data.clear();
+		null_buffer->mapped_data.shrink_to_fit();
+		RHIStats::TrackFree(null_buffer->category, null_buffer->allocation_size);
+		FrameCapture::OnFreeBuffer(buffer);
+		buffer_pool_.Release(*null_buffer);
+		RHIStats::Count(RHICounter::BUFFER_FREES);
+	}
+
+	uint64_t NullRHI::GetTextureSize(const NullTexture& texture)
+	{
+		uint64_t bytes_per_pixel = 4;
+		if (texture.format == PixelFormat::RGBA32F)
+			bytes_per_pixel = 16;
+		return static_cast<uint64_t>(texture.width) * texture.height * std::max(texture.depth, 1u) * texture.layers_count * bytes_per_pixel;
+	}
+
+	TextureRef NullRHI::RHICreateTexture(const RHITexture::Descriptor& desc)
+	{
+		NullTexture* texture = texture_pool_.Allocate();
+		texture->width = desc.width;
+		texture->height = desc.height;
+		texture->depth = desc.depth;
+		texture->miplevels = desc.miplevels;
+		texture->format = desc.format;
+		texture->usage = desc.usage;
+		texture->layers_count = desc.array_layers;
+		texture->category = desc.category;
+		Validate(desc.width > 0 && desc.height > 0, "texture created with a zero extent");
+
+		texture->allocation_size = GetTextureSize(*texture);
+		texture->is_alive = true;
+		RHIStats::TrackAllocation(texture->category, texture->allocation_size);
+		RHIStats::Count(RHICounter::TEXTURE_CREATIONS);
+		FrameCapture::OnCreateTexture(*texture, desc);
+		return TextureRef(texture, &texture_pool_);
+	}
+
+	TextureRef NullRHI::ResizeTexture(RHITexture& texture, uint32_t width, uint32_t height)
+	{
+		if (texture.width == width && texture.height == height)
+			return nullptr;
+		NullTexture* null_texture = static_cast<NullTexture*>(&texture);
+		if (!Validate(texture_pool_.IsAlive(null_texture->handle) && null_texture->is_alive, "resizing a freed texture"))
+			return nullptr;
+
+		// counted as a free plus a resize, the texture keeps its slot and there is no old memory the GPU could still use
+		RHIStats::TrackFree(null_texture->category, null_texture->allocation_size);
+		RHIStats::Count(RHICounter::TEXTURE_FREES);
+		texture.width = width;
+		texture.height = height;
+		null_texture->allocation_size = GetTextureSize(*null_texture);
+		RHIStats::TrackAllocation(null_texture->category, null_texture->allocation_size);
+		RHIStats::Count(RHICounter::TEXTURE_RESIZES);
+		FrameCapture::OnResizeTexture(texture, width, height);
+		return nullptr;
+	}
+
+	void NullRHI::RHIFreeTexture(RHITexture& texture)
+	{
+		NullTexture* null_texture = static_cast<NullTexture*>(&texture);
+		if (!Validate(texture_pool_.IsAlive(null_texture->handle), "texture freed twice"))
+			return;
+		null_texture->is_alive = false;
+		RHIStats::TrackFree(null_texture->category, null_texture->allocation_size);
+		RHIStats::Count(RHICounter::TEXTURE_FREES);
+		FrameCapture::OnFreeTexture(texture);
+		texture_pool_.Release(*null_texture);
+	}
+
+	ShaderModule* NullRHI::RHICreateShaderModule(const char* path)
+	{
+		NullShaderModule* shader = new NullShaderModule();
+		shader->path = path;
+		FrameCapture::OnCreateShaderModule(*shader, path);
+		return shader;
+	}
+
+	ShaderModule* NullRHI::RHICreateShaderModuleFromCode(const void* code, size_t size)
+	{
+		NullShaderModule* shader = new NullShaderModule();
+		Validate(code != nullptr || size == 0, "shader module created from null code");
+		shader->path = "<code>";
+		FrameCapture::OnCreateShaderModule(*shader, code, size);
+		return shader;
+	}
+
+	// like the vulkan backend, only what the module holds is freed, the object belongs to the caller
+	void NullRHI::RHIFreeShaderModule(ShaderModule& shader)
+	{
+		static_cast<NullShaderModule*>(&shader)->path.clear();
+	}
+
+	PipelineLayout* NullRHI::RHICreatePipelineLayout(const PipelineLayout::Descriptor& desc)
+	{
+		NullPipelineLayout* layout = new NullPipelineLayout();
+		layout->set_layout_count = desc.set_layout_count;
+		for (uint32_t i = 0; i < desc.set_layout_count; ++i)
+		{
+			Validate(desc.layouts[i] != nullptr, "pipeline layout created with a null descriptor set layout");
+		}
+		FrameCapture::OnCreatePipelineLayout(*layout, desc);
+		return layout;
+	}
+
+	void NullRHI::RHIFreePipelineLayout(PipelineLayout& layout)
+	{
+		static_cast<NullPipelineLayout*>(&layout)->set_layout_count = 0;
+	}
+
+	PipelineRef NullRHI::RHICreatePipeline(const RHIPipeline::Descriptor& desc)
+	{
+		NullPipeline* pipeline = pipeline_pool_.Allocate();
+		pipeline->layout = desc.layout;
+		pipeline->render_pass = desc.render_pass;
+		pipeline->subpass = desc.subpass;
+		Validate(desc.render_pass != nullptr && desc.layout != nullptr, "pipeline created without a render pass or layout");
+		Validate(desc.vert_shader != nullptr && desc.frag_shader != nullptr, "pipeline created without shaders");
+		if (desc.render_pass)
+			Validate(desc.subpass < static_cast<NullRenderPass*>(desc.render_pass)->GetSubpassCount(), "pipeline created for a subpass its render pass doesn't have");
+		RHIStats::Count(RHICounter::PIPELINE_CREATIONS);
+		FrameCapture::OnCreatePipeline(*pipeline, desc);
+		return PipelineRef(pipeline, &pipeline_pool_);
+	}
+
+	void NullRHI::RHIFreePipeline(RHIPipeline& pipeline)
+	{
+		NullPipeline* null_pipeline = static_cast<NullPipeline*>(&pipeline);
+		if (!Validate(pipeline_pool_.IsAlive(null_pipeline->handle), "pipeline freed twice"))
+			return;
+		FrameCapture::OnFreePipeline(pipeline);
+		pipeline_pool_.Release(*null_pipeline);
+	}
+}
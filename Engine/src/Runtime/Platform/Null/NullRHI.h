@@ -0,0 +1,120 @@
+#pragma once
+#include "Runtime/Function/RHI/RHI.h"
+#include "NullResource.h"
+
+namespace rhi {
+    struct NullSemaphore :public Semaphore {
+        bool is_signaled = false;
+    };
+    struct NullFence :public Fence {
+        // created signaled, like the vulkan ones
+        bool is_signaled = true;
+    };
+    struct NullQueryPool :public QueryPool {
+        std::vector<bool> is_written;
+    };
+
+    /// <summary>
+    /// A backend that talks to no driver at all. Every call is cheap bookkeeping, submitted work completes immediately
+    /// and RHIStats counts the same things the vulkan backend counts, so what is left in a profile is the engine's own cost.
+    /// With validation on, misuse a driver would have caught (recording outside of a pass, freed resources, fences waited
+    /// on that are never signaled, leaks at shutdown...) is logged and counted instead.
+    /// </summary>
+    class NullRHI : public RHI
+    {
+    public:
+        virtual void Init() override;
+        virtual void Shutdown() override;
+
+        virtual void RHITick(float delta_time) override;
+        virtual void RHIBlockUntilGPUIdle() override {};
+        virtual void RHIDefragment() override {};
+
+        virtual void* GetNativeInstance() override { return nullptr; };
+        virtual void* GetNativeDevice() override { return nullptr; };
+        virtual void* GetNativePhysicalDevice() override { return nullptr; };
+        virtual void* GetNativeGraphicsQueue() override { return nullptr; };
+        virtual void* GetNativeComputeQueue() override { return nullptr; };
+
+        virtual void AcquireNextImage(Semaphore* semaphore) override;
+        virtual void* GetNativeSwapchainImageView() override { return nullptr; };
+        virtual uint32_t GetViewportWidth() override { return viewport_width_; };
+        virtual uint32_t GetViewportHeight() override { return viewport_height_; };
+
+        virtual uint32_t GetGfxQueueFamily() override { return 0; };
+
+        virtual void GfxQueueSubmit(const QueueSubmitDesc& desc) override;
+        virtual void ComputeQueueSubmit(const QueueSubmitDesc& desc) override;
+        virtual void TransferQueueSubmit(const QueueSubmitDesc& desc) override;
+
+        virtual void Present(Semaphore** semaphores, uint32_t semaphore_count) override;
+
+        [[nodiscard]] virtual DescriptorSetPtr RHICreateDescriptorSet() override;
+        [[nodiscard]] virtual DescriptorSetLayoutCachePtr CreateDescriptorSetLayoutCache() override;
+        [[nodiscard]] virtual DescriptorAllocatorPtr CreateDescriptorAllocator() override;
+
+        virtual CommandBuffer* RHICreateCommandBuffer() override;
+        [[nodiscard]] virtual std::unique_ptr<SecondaryCommandBuffer> RHICreateSecondaryCommandBuffer() override;
+        virtual std::unique_ptr<RenderPass>   RHICreateRenderPass(const RenderPass::Descriptor& desc) override;
+        virtual std::unique_ptr<RenderTarget> RHICreateRenderTarget(const RenderTarget::Descriptor& desc) override;
+
+        [[nodiscard]] virtual ShaderModule* RHICreateShaderModule(const char* path) override;
+        [[nodiscard]] virtual ShaderModule* RHICreateShaderModuleFromCode(const void* code, size_t size) override;
+        virtual void RHIFreeShaderModule(ShaderModule& shader) override;
+        [[nodiscard]] virtual PipelineLayout* RHICreatePipelineLayout(const PipelineLayout::Descriptor& desc) override;
+        virtual void RHIFreePipelineLayout(PipelineLayout& layout) override;
+        [[nodiscard]] virtual PipelineRef RHICreatePipeline(const RHIPipeline::Descriptor& desc) override;
+        virtual void RHIFreePipeline(RHIPipeline& pipeline) override;
+        [[nodiscard]] virtual BufferRef RHICreateBuffer(const RHIBuffer::Descriptor& desc) override;
+        virtual void RHIFreeBuffer(RHIBuffer& buffer) override;
+        [[nodiscard]] virtual TextureRef RHICreateTexture(const RHITexture::Descriptor& desc) override;
+        [[nodiscard]] virtual TextureRef ResizeTexture(RHITexture& texture, uint32_t width, uint32_t height) override;
+        virtual void RHIFreeTexture(RHITexture& texture) override;
+
+        virtual Semaphore* RHICreateSemaphore() override;
+        virtual Fence* RHICreateFence() override;
+        virtual void RHIDestroySemaphore(Semaphore* semaphore) override;
+        virtual void RHIDestroyFence(Fence* fence) override;
+        virtual void RHIWaitForFences(Fence** fence, uint32_t fence_count) override;
+        virtual bool RHIIsFenceReady(Fence* fence) override;
+
+        [[nodiscard]] virtual QueryPool* RHICreateTimestampQueryPool(uint32_t query_count) override;
+        virtual void RHIDestroyQueryPool(QueryPool* pool) override;
+        virtual bool RHIGetQueryResults(QueryPool* pool, uint32_t first_query, uint32_t query_count, uint64_t* results) override;
+        // Nothing is timed, which also keeps the GPUProfiler off
+        virtual float GetTimestampPeriod() override { return 0.0f; };
+
+        // On by default in debug builds
+        inline void SetValidation(bool enable) { is_validating_ = enable; };
+        inline bool IsValidating() const { return is_validating_; };
+        // Logs and counts a usage error if validation is on and the condition doesn't hold, returns the condition
+        bool Validate(bool condition, const char* message, const char* detail = nullptr);
+        inline uint64_t GetValidationErrorCount() const { return validation_error_count_; };
+    private:
+        void Submit(const QueueSubmitDesc& desc);
+
+        static uint64_t GetTextureSize(const NullTexture& texture);
+
+        uint32_t viewport_width_ = 0;
+        uint32_t viewport_height_ = 0;
+
+        bool has_imgui_platform_ = false;
+
+#ifdef MLE_DEBUG
+        bool is_validating_ = true;
+#else
+        bool is_validating_ = false;
+#endif // MLE_DEBUG
+        uint64_t validation_error_count_ = 0;
+
+        // what is still alive at shutdown leaked
+        ResourcePool<NullTexture>   texture_pool_;
+        ResourcePool<NullBuffer>    buffer_pool_;
+        ResourcePool<NullPipeline>  pipeline_pool_;
+        int64_t live_semaphores_ = 0;
+        int64_t live_fences_ = 0;
+        int64_t live_query_pools_ = 0;
+
+        friend class NullRenderPass;
+    };
+}
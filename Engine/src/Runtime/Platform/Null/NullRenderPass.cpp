@@ -0,0 +1,86 @@
+#include "mlepch.h"
+#include "NullRHI.h"
+#include "NullRenderPass.h"
+#include "NullResource.h"
+#include "Runtime/Core/Base/Application.h"
+
+#include <imgui.h>
+#include "backends/imgui_impl_glfw.h"
+#include <GLFW/glfw3.h>
+
+namespace rhi {
+	NullRenderTarget::NullRenderTarget(rhi::NullRHI& in_rhi, const RenderTarget::Descriptor& desc)
+		:RenderTarget(desc.width, desc.height, desc.clear_value)
+	{
+		in_rhi.Validate(desc.pass != nullptr, "render target created without a render pass");
+		if (!desc.pass)
+			return;
+		NullRenderPass* pass = static_cast<NullRenderPass*>(desc.pass);
+		uint32_t attachment_count = static_cast<uint32_t>(desc.attachments.size());
+		if (desc.pass->is_for_present_)
+		{
+			// the back buffer is the last attachment
+			++attachment_count;
+			width_ = in_rhi.GetViewportWidth();
+			height_ = in_rhi.GetViewportHeight();
+		}
+		in_rhi.Validate(attachment_count == pass->GetAttachmentCount(), "render target doesn't have as many attachments as its render pass");
+		for (auto attachment : desc.attachments)
+		{
+			NullTexture* null_texture = static_cast<NullTexture*>(attachment);
+			in_rhi.Validate(null_texture && null_texture->is_alive, "render target attachment is null or has been freed");
+		}
+	}
+
+	NullRenderPass::NullRenderPass(rhi::NullRHI& in_rhi, const RenderPass::Descriptor& desc)
+		:RenderPass(desc.is_for_present), rhi_(in_rhi)
+	{
+		// a render pass without subpasses still has the implicit one
+		subpass_count_ = std::max<uint32_t>(1, static_cast<uint32_t>(desc.subpasses.size()));
+		attachment_count_ = static_cast<uint32_t>(desc.attachments.size()) + (desc.is_for_present ? 1 : 0);
+
+		for (const auto& subpass : desc.subpasses)
+		{
+			for (uint32_t attachment : subpass.color_attachments)
+				rhi_.Validate(attachment < attachment_count_, "subpass references a color attachment the pass doesn't have");
+			for (uint32_t attachment : subpass.input_attachments)
+				rhi_.Validate(attachment < attachment_count_, "subpass references an input attachment the pass doesn't have");
+		}
+
+		if (desc.is_for_present)
+			InitImGui();
+	}
+
+	NullRenderPass::~NullRenderPass()
+	{
+		pipelines_.clear();
+	}
+
+	void NullRenderPass::InitImGui()
+	{
+		// Setup Dear ImGui context
+		IMGUI_CHECKVERSION();
+		ImGui::CreateContext();
+		ImGuiIO& io = ImGui::GetIO(); (void)io;
+		io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;       // Enable Keyboard Controls
+		io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;           // Enable Docking
+		// no platform windows, nothing could render them
+		io.BackendRendererName = "imgui_impl_null";
+
+		ImGui::StyleColorsDark();
+
+		// Setup Platform backend, there is none when running headless
+		engine::Application& app = engine::Application::GetApp();
+		if (!app.IsHeadless())
+		{
+			GLFWwindow* window = static_cast<GLFWwindow*>(app.GetWindow().GetNativeWindow());
+			ImGui_ImplGlfw_InitForOther(window, true);
+			rhi_.has_imgui_platform_ = true;
+		}
+
+		// Nothing uploads the font atlas, but ImGui needs it built
+		unsigned char* pixels;
+		int width, height;
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+	}
+}
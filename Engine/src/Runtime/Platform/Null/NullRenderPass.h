@@ -0,0 +1,33 @@
+#pragma once
+#include "Runtime/Function/RHI/RenderPass.h"
+namespace rhi {
+	class NullRHI;
+
+	class NullRenderTarget :public RenderTarget
+	{
+	public:
+		NullRenderTarget(rhi::NullRHI& in_rhi, const RenderTarget::Descriptor& desc);
+		virtual ~NullRenderTarget() = default;
+		virtual void* GetHandle() override { return this; };
+	};
+
+	class NullRenderPass : public RenderPass
+	{
+	public:
+		NullRenderPass(rhi::NullRHI& in_rhi, const RenderPass::Descriptor& desc);
+		virtual ~NullRenderPass();
+
+		virtual void* GetHandle() override { return this; };
+
+		inline uint32_t GetSubpassCount() const { return subpass_count_; };
+		inline uint32_t GetAttachmentCount() const { return attachment_count_; };
+	private:
+		// The present pass owns the ImGui context, like the vulkan one
+		void InitImGui();
+
+		uint32_t subpass_count_ = 0;
+		uint32_t attachment_count_ = 0;
+
+		rhi::NullRHI& rhi_;
+	};
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Runtime/Function/RHI/RHIResource.h"
+
+namespace rhi {
+	class NullRHI;
+
+	struct NullTexture : public RHITexture
+	{
+		uint64_t allocation_size = 0;
+		bool is_alive = false;
+	};
+
+	// ---------------------------------------------------
+
+	struct NullBuffer : public RHIBuffer
+	{
+		NullRHI* rhi = nullptr;
+		uint64_t allocation_size = 0;
+		bool is_alive = false;
+
+		// mapped buffers keep their data in host memory, so uploads still cost a memcpy
+		std::vector<uint8_t> mapped_data;
+
+		virtual void SetData(const void* data, uint64_t size, uint64_t offset = 0) override;
+	};
+
+	// ---------------------------------------------------
+
+	struct NullShaderModule : public ShaderModule
+	{
+		std::string path;
+	};
+
+	struct NullPipelineLayout : public PipelineLayout
+	{
+		uint32_t set_layout_count = 0;
+	};
+
+	struct NullPipeline : public RHIPipeline
+	{
+		RenderPass* render_pass = nullptr;
+		uint32_t subpass = 0;
+	};
+}
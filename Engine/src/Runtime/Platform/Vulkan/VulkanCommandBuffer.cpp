@@ -1,19 +1,23 @@
 #include "mlepch.h"
 #include "VulkanCommandBuffer.h"
 #include "VulkanDevice.h"
+#include "VulkanRHI.h"
 #include "Runtime/Function/RHI/RenderPass.h"
 #include "VulkanResource.h"
 #include "VulkanDescriptor.h"
+#include "VulkanUtils.h"
+#include "Runtime/Function/RHI/RHIStats.h"
+#include "Runtime/Function/RHI/FrameCapture.h"
 
 #include <imgui.h>
 #include "backends/imgui_impl_vulkan.h"
 namespace rhi {
-	void VulkanEncoderBase::InternalBegin()
+	void VulkanEncoderBase::InternalBegin(const VkCommandBufferInheritanceInfo* inheritance)
 	{
 		VkCommandBufferBeginInfo begin_info{};
 		begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		begin_info.flags = 0; // Optional
-		begin_info.pInheritanceInfo = nullptr; // Optional
+		begin_info.flags = inheritance ? VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT : 0;
+		begin_info.pInheritanceInfo = inheritance;
 
 		if (vkBeginCommandBuffer(command_buffer_, &begin_info) != VK_SUCCESS)
 		{
@@ -26,8 +30,9 @@ namespace rhi {
 		vkEndCommandBuffer(command_buffer_);
 	}
 
-	void VulkanEncoderBase::AllocateCommandBuffer(VulkanDevice* device, uint32_t family_index)
+	void VulkanEncoderBase::AllocateCommandBuffer(VulkanDevice* device, uint32_t family_index, VkCommandBufferLevel level)
 	{
+		device_ = device;
 		VkCommandPoolCreateInfo poolInfo = {};
 		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 		poolInfo.queueFamilyIndex = family_index;
@@ -41,7 +46,7 @@ namespace rhi {
 
 		VkCommandBufferAllocateInfo alloc_info{};
 		alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		alloc_info.level = level;
 		alloc_info.commandPool = command_pool_;
 		alloc_info.commandBufferCount = 1;
 
@@ -51,7 +56,7 @@ namespace rhi {
 		};
 	}
 	//------------------------------------Gfx Encoder------------------------------------
-	void VulkanGraphicsEncoder::BeginRenderPass(RenderPass& pass, RenderTarget& render_target)
+	void VulkanGraphicsEncoder::BeginRenderPass(RenderPass& pass, RenderTarget& render_target, SubpassContents contents)
 	{
 		VkClearValue clear_color{};
 		clear_color.color.float32[0] = render_target.GetClearColor().r * render_target.GetClearColor().a;
@@ -68,13 +73,16 @@ namespace rhi {
 		// temp
 		info.clearValueCount = 2;
 		info.pClearValues = &clear_color;
-		vkCmdBeginRenderPass(command_buffer_, &info, VK_SUBPASS_CONTENTS_INLINE);
+		vkCmdBeginRenderPass(command_buffer_, &info,
+			contents == SubpassContents::SECONDARY_COMMAND_BUFFERS ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+		RHIStats::Count(RHICounter::RENDER_PASS_BEGINS);
 	}
 
 	void VulkanGraphicsEncoder::BindGfxPipeline(RHIPipeline* pipeline)
 	{
 		VulkanPipeline* vk_pipeline = static_cast<VulkanPipeline*>(pipeline);
 		vkCmdBindPipeline(command_buffer_, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_pipeline->pipeline);
+		RHIStats::Count(RHICounter::PIPELINE_BINDS);
 	}
 
 	void VulkanGraphicsEncoder::BindVertexBuffers(uint32_t first_binding, uint32_t binding_count, rhi::RHIBuffer** buffer, uint64_t* offsets)
@@ -88,12 +96,14 @@ namespace rhi {
 			offsets_vk[i] = offsets ? offsets[i] : 0;
 		}
 		vkCmdBindVertexBuffers(command_buffer_, first_binding, binding_count, vbs_vk, offsets_vk);
+		RHIStats::Count(RHICounter::VERTEX_BUFFER_BINDS, binding_count);
 	}
 
 	void VulkanGraphicsEncoder::BindIndexBuffer(rhi::RHIBuffer* index_buffer, uint64_t offset)
 	{
 		VulkanBuffer* vk_buffer = (VulkanBuffer*)index_buffer;
 		vkCmdBindIndexBuffer(command_buffer_, vk_buffer->buffer, offset, VK_INDEX_TYPE_UINT16);
+		RHIStats::Count(RHICounter::INDEX_BUFFER_BINDS);
 	}
 
 	void VulkanGraphicsEncoder::BindDescriptorSets(PipelineLayout* layout, uint32_t first_set, uint32_t sets_count, DescriptorSet** sets, uint32_t dynameic_offset_count, const uint32_t* dynamic_offsets)
@@ -101,49 +111,88 @@ namespace rhi {
 		VulkanPipelineLayout* vk_layout = static_cast<VulkanPipelineLayout*>(layout);
 		VulkanDescriptorSet** vk_sets = (VulkanDescriptorSet**)sets;
 		VkDescriptorSet sets_vk[64];
+		VulkanDescriptorTracker& tracker = device_->GetDescriptorTracker();
 		for (uint32_t i = 0; i < sets_count; ++i)
 		{
 			sets_vk[i] = vk_sets[i]->descriptor_set;
+			tracker.OnBind(sets_vk[i]);
+			if (is_secondary_)
+				bound_sets_.push_back(sets_vk[i]);
 		}
 		vkCmdBindDescriptorSets(command_buffer_, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_layout->pipeline_layout, first_set, sets_count, sets_vk, dynameic_offset_count, dynamic_offsets);
+		RHIStats::Count(RHICounter::DESCRIPTOR_SET_BINDS, sets_count);
 	}
 
-	void VulkanGraphicsEncoder::SetViewport(float x, float y, float width, float height, float min_depth, float max_depth)
+	void VulkanGraphicsEncoder::ExecuteSecondary(SecondaryCommandBuffer& secondary)
 	{
-		VkViewport viewport{};
-		viewport.x = x;
-		viewport.y = y;
-		viewport.width = width;
-		viewport.height = height;
-		viewport.minDepth = min_depth;
-		viewport.maxDepth = max_depth;
-		vkCmdSetViewport(command_buffer_, 0, 1, &viewport);
-	}
-
-	void VulkanGraphicsEncoder::SetScissor(int32_t offset_x, int32_t offset_y, uint32_t width, uint32_t height)
-	{
-		VkRect2D scissor{ {offset_x, offset_y}, {width, height} };
-		vkCmdSetScissor(command_buffer_, 0, 1, &scissor);
+		VulkanSecondaryCommandBuffer& vk_secondary = static_cast<VulkanSecondaryCommandBuffer&>(secondary);
+		// the sets are in use by this submission too
+		VulkanDescriptorTracker& tracker = device_->GetDescriptorTracker();
+		for (VkDescriptorSet set : vk_secondary.GetBoundSets())
+		{
+			tracker.OnBind(set);
+		}
+		VkCommandBuffer handle = vk_secondary.GetHandle();
+		vkCmdExecuteCommands(command_buffer_, 1, &handle);
 	}
 
-	void VulkanGraphicsEncoder::Draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance)
+	void VulkanGraphicsEncoder::BufferBarrier(const BufferBarrierDesc& desc)
 	{
-		vkCmdDraw(command_buffer_, vertex_count, instance_count, first_vertex, first_instance);
+		BufferBarriers(&desc, 1);
 	}
 
-	void VulkanGraphicsEncoder::DrawIndexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t offset, uint32_t first_instance)
+	void VulkanGraphicsEncoder::BufferBarriers(const BufferBarrierDesc* descs, uint32_t count)
 	{
-		vkCmdDrawIndexed(command_buffer_, index_count, instance_count, first_index, offset, first_instance);
+		// one vkCmdPipelineBarrier per batch, with the union of the stages
+		static constexpr uint32_t MAX_BATCH = 32;
+		for (uint32_t first = 0; first < count; first += MAX_BATCH)
+		{
+			const uint32_t batch_count = std::min(count - first, MAX_BATCH);
+			VkBufferMemoryBarrier barriers[MAX_BATCH];
+			VkPipelineStageFlags src_stages = 0;
+			VkPipelineStageFlags dst_stages = 0;
+			for (uint32_t i = 0; i < batch_count; ++i)
+			{
+				const BufferBarrierDesc& desc = descs[first + i];
+				VulkanBuffer* vk_buffer = static_cast<VulkanBuffer*>(desc.buffer);
+
+				VkBufferMemoryBarrier& barrier = barriers[i];
+				barrier = {};
+				barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				// a read after read only needs the execution dependency
+				barrier.srcAccessMask = desc.src_write ? VulkanUtils::BufferUsageToVkAccess(desc.src_usage, true) : 0;
+				barrier.dstAccessMask = VulkanUtils::BufferUsageToVkAccess(desc.dst_usage, desc.dst_write);
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.buffer = vk_buffer->buffer;
+				barrier.offset = 0;
+				barrier.size = VK_WHOLE_SIZE;
+
+				src_stages |= VulkanUtils::BufferUsageToVkPipelineStage(desc.src_usage);
+				dst_stages |= VulkanUtils::BufferUsageToVkPipelineStage(desc.dst_usage);
+			}
+
+			vkCmdPipelineBarrier(command_buffer_,
+				src_stages,
+				dst_stages,
+				0,
+				0, nullptr,
+				batch_count, barriers,
+				0, nullptr);
+			RHIStats::Count(RHICounter::BARRIERS);
+		}
 	}
 
-	void VulkanGraphicsEncoder::NextSubpass()
+	void VulkanGraphicsEncoder::ResetQueryPool(QueryPool* pool, uint32_t first_query, uint32_t query_count)
 	{
-		vkCmdNextSubpass(command_buffer_, VK_SUBPASS_CONTENTS_INLINE);
+		VulkanQueryPool* vk_pool = static_cast<VulkanQueryPool*>(pool);
+		vkCmdResetQueryPool(command_buffer_, vk_pool->pool, first_query, query_count);
 	}
 
-	void VulkanGraphicsEncoder::EndRenderPass()
+	void VulkanGraphicsEncoder::WriteTimestamp(QueryPool* pool, uint32_t query)
 	{
-		vkCmdEndRenderPass(command_buffer_);
+		VulkanQueryPool* vk_pool = static_cast<VulkanQueryPool*>(pool);
+		vkCmdWriteTimestamp(command_buffer_, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vk_pool->pool, query);
 	}
 
 	//------------------------------------Transfer Encoder------------------------------------
@@ -161,6 +210,7 @@ namespace rhi {
 		copyRegion.dstOffset = desc.src_offset;
 		copyRegion.size = desc.size;
 		vkCmdCopyBuffer(command_buffer_,  src->buffer, dst->buffer, 1, &copyRegion);
+		FrameCapture::OnCopyBufferToBuffer(desc);
 	}
 
 	void VulkanTransferEncoder::CopyBufferToImage(RHIBuffer* buffer,
@@ -187,6 +237,7 @@ namespace rhi {
 		region.imageExtent = { width, height, 1 };
 
 		vkCmdCopyBufferToImage(command_buffer_, buffer_vk->buffer, image_vk->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+		FrameCapture::OnCopyBufferToImage(*buffer, *image, width, height, layer_count);
 	}
 
 	//------------------------------------Cmd Buffer----------------------------------------
@@ -233,4 +284,51 @@ namespace rhi {
 		gfx_encoder_.End();
 		transfer_encoder_.End();
 	}
+
+	//------------------------------------Secondary Cmd Buffer------------------------------
+	VulkanSecondaryCommandBuffer::VulkanSecondaryCommandBuffer(VulkanDevice* in_device)
+		:device_(in_device)
+	{
+		gfx_encoder_.AllocateCommandBuffer(device_, device_->GetGfxQueue()->GetFamilyIndex(), VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+		gfx_encoder_.is_secondary_ = true;
+	}
+
+	VulkanSecondaryCommandBuffer::~VulkanSecondaryCommandBuffer()
+	{
+		vkDestroyCommandPool(device_->GetDeviceHandle(), gfx_encoder_.command_pool_, nullptr);
+	}
+
+	void VulkanSecondaryCommandBuffer::Begin(RenderPass& pass, uint32_t subpass)
+	{
+		vkResetCommandPool(device_->GetDeviceHandle(), gfx_encoder_.command_pool_, 0);
+		gfx_encoder_.bound_sets_.clear();
+		recorded_write_serial_ = device_->GetDescriptorTracker().GetWriteSerial();
+		is_recorded_ = false;
+
+		VkCommandBufferInheritanceInfo inheritance{};
+		inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritance.renderPass = (VkRenderPass)pass.GetHandle();
+		inheritance.subpass = subpass;
+		inheritance.framebuffer = VK_NULL_HANDLE;
+		gfx_encoder_.InternalBegin(&inheritance);
+	}
+
+	void VulkanSecondaryCommandBuffer::End()
+	{
+		gfx_encoder_.InternalEnd();
+		is_recorded_ = true;
+	}
+
+	bool VulkanSecondaryCommandBuffer::IsValid()
+	{
+		if (!is_recorded_)
+			return false;
+		const VulkanDescriptorTracker& tracker = device_->GetDescriptorTracker();
+		for (VkDescriptorSet set : gfx_encoder_.bound_sets_)
+		{
+			if (tracker.GetLastWrite(set) > recorded_write_serial_)
+				return false;
+		}
+		return true;
+	}
 }
\ No newline at end of file
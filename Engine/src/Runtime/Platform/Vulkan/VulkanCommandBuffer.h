@@ -2,53 +2,89 @@
 #include <vulkan/vulkan.h>
 #include "Runtime/Function/RHI/CommandBuffer.h"
 #include "VulkanResource.h"
+#include "Runtime/Function/RHI/RHIStats.h"
 
 namespace rhi {
 	class VulkanDevice;
 	class VulkanEncoderBase
 	{
 		friend class VulkanCommandBuffer;
+		friend class VulkanSecondaryCommandBuffer;
 		friend class VulkanQueue;
 	public:
 		virtual ~VulkanEncoderBase() = default;
-		void InternalBegin();
+		// secondary command buffers continue the render pass they inherit
+		void InternalBegin(const VkCommandBufferInheritanceInfo* inheritance = nullptr);
 		void InternalEnd();
-		void AllocateCommandBuffer(VulkanDevice* device, uint32_t family_index);
+		void AllocateCommandBuffer(VulkanDevice* device, uint32_t family_index, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 	protected:
+		VulkanDevice* device_ = nullptr;
 		VkCommandPool command_pool_ = VK_NULL_HANDLE;
 		VkCommandBuffer command_buffer_ = VK_NULL_HANDLE;
 	};
 
-	class VulkanGraphicsEncoder : public RHIGraphicsEncoder, public VulkanEncoderBase
+	class VulkanGraphicsEncoder final : public RHIGraphicsEncoder, public VulkanEncoderBase
 	{
+		friend class VulkanSecondaryCommandBuffer;
 	public:
 		virtual ~VulkanGraphicsEncoder() = default;
 
 		virtual void Begin() override { InternalBegin(); }
-		virtual void BeginRenderPass(RenderPass& pass, RenderTarget& render_target) override;
+		virtual void BeginRenderPass(RenderPass& pass, RenderTarget& render_target, SubpassContents contents) override;
 		virtual void BindGfxPipeline(RHIPipeline* pipeline) override;
 		virtual void BindVertexBuffers(uint32_t first_binding, uint32_t binding_count, RHIBuffer** buffer, uint64_t* offsets) override;
 		virtual void BindIndexBuffer(RHIBuffer* index_buffer, uint64_t offset) override;
 		virtual void BindDescriptorSets(PipelineLayout* layout, uint32_t first_set, uint32_t sets_count, DescriptorSet** sets, uint32_t dynameic_offset_count, const uint32_t* dynamic_offsets) override;
 		
-		virtual void SetViewport(float x, float y, float width, float height, float min_depth, float max_depth) override;
-		virtual void SetScissor(int32_t offset_x, int32_t offset_y, uint32_t width, uint32_t height) override;
+		// the per draw commands are defined here so they inline when the backend is bound at compile time
+		virtual void SetViewport(float x, float y, float width, float height, float min_depth, float max_depth) override
+		{
+			VkViewport viewport{ x, y, width, height, min_depth, max_depth };
+			vkCmdSetViewport(command_buffer_, 0, 1, &viewport);
+		};
+		virtual void SetScissor(int32_t offset_x, int32_t offset_y, uint32_t width, uint32_t height) override
+		{
+			VkRect2D scissor{ {offset_x, offset_y}, {width, height} };
+			vkCmdSetScissor(command_buffer_, 0, 1, &scissor);
+		};
 
-		virtual void Draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance) override;
-		virtual void DrawIndexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t offset, uint32_t first_instance) override;
+		virtual void Draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance) override
+		{
+			vkCmdDraw(command_buffer_, vertex_count, instance_count, first_vertex, first_instance);
+			RHIStats::Count(RHICounter::DRAW_CALLS);
+			RHIStats::Count(RHICounter::DRAWN_VERTICES, static_cast<uint64_t>(vertex_count) * instance_count);
+		};
+		virtual void DrawIndexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t offset, uint32_t first_instance) override
+		{
+			vkCmdDrawIndexed(command_buffer_, index_count, instance_count, first_index, offset, first_instance);
+			RHIStats::Count(RHICounter::DRAW_CALLS);
+			RHIStats::Count(RHICounter::DRAWN_VERTICES, static_cast<uint64_t>(index_count) * instance_count);
+		};
 
-		virtual void NextSubpass() override;
+		virtual void NextSubpass() override { vkCmdNextSubpass(command_buffer_, VK_SUBPASS_CONTENTS_INLINE); };
 
-		virtual void EndRenderPass() override;
+		virtual void ExecuteSecondary(SecondaryCommandBuffer& secondary) override;
+
+		virtual void BufferBarrier(const BufferBarrierDesc& desc) override;
+		virtual void BufferBarriers(const BufferBarrierDesc* descs, uint32_t count) override;
+
+		virtual void ResetQueryPool(QueryPool* pool, uint32_t first_query, uint32_t query_count) override;
+		virtual void WriteTimestamp(QueryPool* pool, uint32_t query) override;
+
+		virtual void EndRenderPass() override { vkCmdEndRenderPass(command_buffer_); };
 
 		virtual void ImGui_RenderDrawData(ImDrawData* draw_data) override;
 
 		virtual void End() override { InternalEnd(); };
 
 		virtual void* GetHandle() override { return (void*)command_buffer_; };
+	private:
+		// the encoder of a secondary command buffer keeps the sets it binds, executing it binds them again
+		bool is_secondary_ = false;
+		std::vector<VkDescriptorSet> bound_sets_;
 	};
 
-	class VulkanTransferEncoder :public RHITransferEncoder, public VulkanEncoderBase
+	class VulkanTransferEncoder final :public RHITransferEncoder, public VulkanEncoderBase
 	{
 	public:
 		virtual ~VulkanTransferEncoder() = default;
@@ -64,7 +100,7 @@ namespace rhi {
 		virtual void* GetHandle() override { return (void*)command_buffer_; };
 	};
 
-	class VulkanCommandBuffer : public CommandBuffer
+	class VulkanCommandBuffer final : public CommandBuffer
 	{
 		
 	public:
@@ -73,9 +109,10 @@ namespace rhi {
 		virtual void AllocateCommandBuffers() override;
 		virtual void Begin() override;
 		virtual void End() override;
-		inline virtual RHIGraphicsEncoder& GetGfxEncoder()	override { return gfx_encoder_; };
+		// covariant, so callers holding a VulkanCommandBuffer reach the encoder without a virtual call
+		inline virtual VulkanGraphicsEncoder& GetGfxEncoder()	override { return gfx_encoder_; };
 		inline virtual void* GetNativeGfxHandle()			override { return (void*)gfx_encoder_.command_buffer_; };
-		virtual RHITransferEncoder& GetTransferEncoder()	override { return transfer_encoder_; };
+		inline virtual VulkanTransferEncoder& GetTransferEncoder()	override { return transfer_encoder_; };
 		virtual void* GetNativeTransferHandle()				override { return (void*)transfer_encoder_.command_buffer_; };
 	private:
 		VulkanDevice* device_;
@@ -84,5 +121,33 @@ namespace rhi {
 		VulkanTransferEncoder transfer_encoder_;
 
 	};
+
+	/// <summary>
+	/// A secondary command buffer with a pool of its own, owned by one frame in flight at a time, so it is only
+	/// recorded again once that frame's fence has signaled. The framebuffer isn't inherited, the commands work with
+	/// every render target of the render pass
+	/// </summary>
+	class VulkanSecondaryCommandBuffer final : public SecondaryCommandBuffer
+	{
+	public:
+		VulkanSecondaryCommandBuffer(VulkanDevice* in_device);
+		virtual ~VulkanSecondaryCommandBuffer();
+		virtual void Begin(RenderPass& pass, uint32_t subpass) override;
+		virtual void End() override;
+		// covariant, like VulkanCommandBuffer::GetGfxEncoder
+		inline virtual VulkanGraphicsEncoder& GetGfxEncoder() override { return gfx_encoder_; };
+		// Writing a set makes the command buffers that bound it invalid
+		virtual bool IsValid() override;
+
+		inline VkCommandBuffer GetHandle() const { return gfx_encoder_.command_buffer_; };
+		inline const std::vector<VkDescriptorSet>& GetBoundSets() const { return gfx_encoder_.bound_sets_; };
+	private:
+		VulkanDevice* device_;
+
+		VulkanGraphicsEncoder gfx_encoder_;
+		// the descriptor writes counted by the tracker when the recording began
+		uint64_t recorded_write_serial_ = 0;
+		bool is_recorded_ = false;
+	};
 }
 
@@ -0,0 +1,381 @@
+#include "mlepch.h"
+#include "VulkanDefragmenter.h"
+#include "VulkanDevice.h"
+#include "VulkanRHI.h"
+#include "VulkanResource.h"
+#include "VulkanUtils.h"
+#include "Runtime/Function/RHI/RHIStats.h"
+
+namespace rhi {
+	void VulkanDefragmenter::Init(VulkanRHI* rhi, VulkanDevice* device, VmaAllocator allocator)
+	{
+		rhi_ = rhi;
+		device_ = device;
+		allocator_ = allocator;
+
+		// the copies go behind the frames on the graphics queue, so the barriers order them without waiting
+		VkCommandPoolCreateInfo pool_info{};
+		pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		pool_info.queueFamilyIndex = device_->GetGfxQueue()->GetFamilyIndex();
+		pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		if (vkCreateCommandPool(device_->GetDeviceHandle(), &pool_info, nullptr, &command_pool_) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create defragmentation command pool!");
+		}
+
+		VkCommandBufferAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		alloc_info.commandPool = command_pool_;
+		alloc_info.commandBufferCount = 1;
+		vkAllocateCommandBuffers(device_->GetDeviceHandle(), &alloc_info, &command_buffer_);
+
+		VkFenceCreateInfo fence_info{};
+		fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+		if (vkCreateFence(device_->GetDeviceHandle(), &fence_info, nullptr, &fence_) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create defragmentation fence!");
+		}
+	}
+
+	void VulkanDefragmenter::Shutdown()
+	{
+		// the RHI has waited for the GPU already
+		if (is_pass_pending_)
+			EndPass(true);
+		if (IsRunning())
+			Finish();
+		vkDestroyFence(device_->GetDeviceHandle(), fence_, nullptr);
+		fence_ = VK_NULL_HANDLE;
+		// the command buffer goes with its pool
+		vkDestroyCommandPool(device_->GetDeviceHandle(), command_pool_, nullptr);
+		command_pool_ = VK_NULL_HANDLE;
+		buffers_.clear();
+		textures_.clear();
+	}
+
+	void VulkanDefragmenter::RegisterBuffer(VulkanBuffer* buffer)
+	{
+		buffers_[buffer->buffer_allocation] = buffer;
+	}
+
+	void VulkanDefragmenter::RegisterTexture(VulkanTexture* texture)
+	{
+		textures_[texture->image_allocation] = texture;
+	}
+
+	void VulkanDefragmenter::Unregister(VmaAllocation allocation)
+	{
+		// the allocation only points at its new place once the pass has ended
+		if (is_pass_pending_ && IsMoving(allocation))
+		{
+			WaitForPass();
+			EndPass(true);
+		}
+		buffers_.erase(allocation);
+		textures_.erase(allocation);
+	}
+
+	void VulkanDefragmenter::Begin()
+	{
+		if (IsRunning())
+			return;
+
+		VmaDefragmentationInfo info{};
+		info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+		info.maxBytesPerPass = MAX_BYTES_PER_PASS;
+		info.maxAllocationsPerPass = MAX_MOVES_PER_PASS;
+		if (vmaBeginDefragmentation(allocator_, &info, &context_) != VK_SUCCESS)
+		{
+			MLE_CORE_ERROR("[vulkan] failed to begin defragmentation");
+			context_ = VK_NULL_HANDLE;
+			return;
+		}
+
+		RHIDefragmentationStats stats = RHIStats::GetInstance().GetDefragmentation();
+		stats.is_running = true;
+		RHIStats::GetInstance().SetDefragmentation(stats);
+	}
+
+	void VulkanDefragmenter::Tick()
+	{
+		if (!IsRunning())
+			return;
+		MLE_PROFILE_FUNCTION();
+
+		if (!is_pass_pending_)
+		{
+			BeginPass();
+			return;
+		}
+		if (EndPass(false) || ++pending_ticks_ < MAX_PENDING_TICKS)
+			return;
+		WaitForPass();
+		EndPass(false);
+	}
+
+	void VulkanDefragmenter::BeginPass()
+	{
+		if (vmaBeginDefragmentationPass(allocator_, context_, &pass_) == VK_SUCCESS)
+		{
+			Finish();
+			return;
+		}
+
+		VkDevice device = device_->GetDeviceHandle();
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		if (pass_.moveCount > 0)
+		{
+			vkResetCommandPool(device, command_pool_, 0);
+			VkCommandBufferBeginInfo begin_info{};
+			begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vkBeginCommandBuffer(command_buffer_, &begin_info);
+
+			// the frames submitted before may still write the buffers
+			barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(command_buffer_, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, 1, &barrier, 0, nullptr, 0, nullptr);
+		}
+
+		for (uint32_t i = 0; i < pass_.moveCount; ++i)
+		{
+			VmaDefragmentationMove& move = pass_.pMoves[i];
+			bool is_recorded = false;
+			auto buffer = buffers_.find(move.srcAllocation);
+			auto texture = textures_.find(move.srcAllocation);
+			if (buffer != buffers_.end())
+				is_recorded = RecordBufferMove(buffer->second, move.dstTmpAllocation);
+			// ImGui keeps its own descriptor set for the texture, which we can't rewrite
+			else if (texture != textures_.end() && texture->second->texture_id == nullptr)
+				is_recorded = RecordTextureMove(texture->second, move.dstTmpAllocation);
+
+			if (!is_recorded)
+				move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+		}
+
+		if (buffer_moves_.empty() && texture_moves_.empty())
+		{
+			if (pass_.moveCount > 0)
+				vkEndCommandBuffer(command_buffer_);
+			// every move was ignored, there is nothing to copy or to wait for
+			if (vmaEndDefragmentationPass(allocator_, context_, &pass_) == VK_SUCCESS)
+				Finish();
+			return;
+		}
+
+		// the frames submitted next read the new buffers
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		vkCmdPipelineBarrier(command_buffer_, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+		vkEndCommandBuffer(command_buffer_);
+
+		vkResetFences(device, 1, &fence_);
+		VkSubmitInfo submit_info{};
+		submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submit_info.commandBufferCount = 1;
+		submit_info.pCommandBuffers = &command_buffer_;
+		vkQueueSubmit(device_->GetGfxQueue()->GetQueueHandle(), 1, &submit_info, fence_);
+		RHIStats::Count(RHICounter::QUEUE_SUBMITS);
+
+		// swapped in right away, only the frames submitted so far and the stale descriptor sets use the old ones
+		last_old_use_ = rhi_->GetLastSubmission();
+		VulkanDescriptorTracker& tracker = device_->GetDescriptorTracker();
+		for (auto const& move : buffer_moves_)
+		{
+			move.buffer->buffer = move.new_buffer;
+			move.buffer->buffer_info.buffer = move.new_buffer;
+			tracker.MarkStale(&move.buffer->buffer_info);
+		}
+		for (auto const& move : texture_moves_)
+		{
+			VulkanTexture* texture = move.texture;
+			texture->image = move.new_image;
+			texture->CreateImageView(device);
+			texture->texture_info.imageView = texture->image_view;
+			tracker.MarkStale(&texture->texture_info);
+		}
+		is_pass_pending_ = true;
+		pending_ticks_ = 0;
+	}
+
+	bool VulkanDefragmenter::EndPass(bool is_gpu_idle)
+	{
+		VkDevice device = device_->GetDeviceHandle();
+		if (!is_gpu_idle && (vkGetFenceStatus(device, fence_) != VK_SUCCESS || !rhi_->IsSubmissionDone(last_old_use_)))
+			return false;
+		auto is_done = [this](const VulkanSubmissionMark& mark) { return rhi_->IsSubmissionDone(mark); };
+		if (!device_->GetDescriptorTracker().RewriteStale(device, is_done, is_gpu_idle))
+			return false;
+
+		for (auto const& move : buffer_moves_)
+		{
+			vkDestroyBuffer(device, move.old_buffer, nullptr);
+		}
+		for (auto const& move : texture_moves_)
+		{
+			vkDestroyImageView(device, move.old_image_view, nullptr);
+			vkDestroyImage(device, move.old_image, nullptr);
+		}
+		buffer_moves_.clear();
+		texture_moves_.clear();
+		is_pass_pending_ = false;
+
+		// the allocations now live where they were moved to
+		if (vmaEndDefragmentationPass(allocator_, context_, &pass_) == VK_SUCCESS)
+			Finish();
+		return true;
+	}
+
+	void VulkanDefragmenter::WaitForPass()
+	{
+		VkDevice device = device_->GetDeviceHandle();
+		vkWaitForFences(device, 1, &fence_, VK_TRUE, UINT64_MAX);
+		// a fence covers the submissions before its own on the queue
+		const VulkanSubmissionMark last_submission = rhi_->GetLastSubmission();
+		if (!rhi_->IsSubmissionDone(last_submission))
+			vkWaitForFences(device, 1, &last_submission.fence->fence, VK_TRUE, UINT64_MAX);
+	}
+
+	bool VulkanDefragmenter::IsMoving(VmaAllocation allocation) const
+	{
+		auto buffer = std::find_if(buffer_moves_.begin(), buffer_moves_.end(), [allocation](const BufferMove& move) {
+			return move.buffer->buffer_allocation == allocation; });
+		auto texture = std::find_if(texture_moves_.begin(), texture_moves_.end(), [allocation](const TextureMove& move) {
+			return move.texture->image_allocation == allocation; });
+		return buffer != buffer_moves_.end() || texture != texture_moves_.end();
+	}
+
+	void VulkanDefragmenter::Finish()
+	{
+		VmaDefragmentationStats vma_stats{};
+		vmaEndDefragmentation(allocator_, context_, &vma_stats);
+		context_ = VK_NULL_HANDLE;
+
+		RHIDefragmentationStats stats;
+		stats.bytes_moved = vma_stats.bytesMoved;
+		stats.bytes_freed = vma_stats.bytesFreed;
+		stats.allocations_moved = vma_stats.allocationsMoved;
+		stats.blocks_freed = vma_stats.deviceMemoryBlocksFreed;
+		RHIStats::GetInstance().SetDefragmentation(stats);
+
+		MLE_CORE_INFO("[vulkan] defragmentation moved {0} allocations ({1} KiB), reclaimed {2} KiB in {3} blocks",
+			stats.allocations_moved, stats.bytes_moved >> 10, stats.bytes_freed >> 10, stats.blocks_freed);
+	}
+
+	bool VulkanDefragmenter::RecordBufferMove(VulkanBuffer* buffer, VmaAllocation dst_allocation)
+	{
+		VkBufferCreateInfo buffer_info{};
+		buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		buffer_info.size = buffer->size;
+		buffer_info.usage = buffer->vk_usage;
+		buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VkBuffer new_buffer = VK_NULL_HANDLE;
+		if (vkCreateBuffer(device_->GetDeviceHandle(), &buffer_info, nullptr, &new_buffer) != VK_SUCCESS)
+			return false;
+		if (vmaBindBufferMemory(allocator_, dst_allocation, new_buffer) != VK_SUCCESS)
+		{
+			vkDestroyBuffer(device_->GetDeviceHandle(), new_buffer, nullptr);
+			return false;
+		}
+
+		VkBufferCopy region{};
+		region.size = buffer->size;
+		vkCmdCopyBuffer(command_buffer_, buffer->buffer, new_buffer, 1, &region);
+
+		buffer_moves_.push_back({ buffer, new_buffer, buffer->buffer });
+		return true;
+	}
+
+	bool VulkanDefragmenter::RecordTextureMove(VulkanTexture* texture, VmaAllocation dst_allocation)
+	{
+		const uint32_t depth = std::max(texture->depth, 1u);
+
+		// same as VulkanUtils::VMACreateImage
+		VkImageCreateInfo image_info{};
+		image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		image_info.imageType = VK_IMAGE_TYPE_2D;
+		image_info.extent = { texture->width, texture->height, depth };
+		image_info.mipLevels = texture->miplevels;
+		image_info.arrayLayers = texture->layers_count;
+		image_info.format = texture->vk_format;
+		image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		image_info.usage = texture->vk_usage;
+		image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+		image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VkImage new_image = VK_NULL_HANDLE;
+		if (vkCreateImage(device_->GetDeviceHandle(), &image_info, nullptr, &new_image) != VK_SUCCESS)
+			return false;
+		if (vmaBindImageMemory(allocator_, dst_allocation, new_image) != VK_SUCCESS)
+		{
+			vkDestroyImage(device_->GetDeviceHandle(), new_image, nullptr);
+			return false;
+		}
+
+		const VkImageLayout layout = texture->texture_info.imageLayout;
+		const VkImageAspectFlags aspect = texture->GetAspect();
+		VkImageSubresourceRange range{};
+		range.aspectMask = aspect;
+		range.levelCount = texture->miplevels;
+		range.layerCount = texture->layers_count;
+
+		VkImageMemoryBarrier barriers[2]{};
+		barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[0].subresourceRange = range;
+		barriers[1] = barriers[0];
+
+		// after the frames submitted before are done with it
+		barriers[0].image = texture->image;
+		barriers[0].oldLayout = layout;
+		barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[0].srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+		barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		barriers[1].image = new_image;
+		barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		vkCmdPipelineBarrier(command_buffer_, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, 2, barriers);
+
+		std::vector<VkImageCopy> regions(texture->miplevels);
+		for (uint32_t mip = 0; mip < texture->miplevels; ++mip)
+		{
+			VkImageCopy& region = regions[mip];
+			region.srcSubresource.aspectMask = aspect;
+			region.srcSubresource.mipLevel = mip;
+			region.srcSubresource.layerCount = texture->layers_count;
+			region.dstSubresource = region.srcSubresource;
+			region.extent = { std::max(texture->width >> mip, 1u), std::max(texture->height >> mip, 1u), std::max(depth >> mip, 1u) };
+		}
+		vkCmdCopyImage(command_buffer_,
+			texture->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			new_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			static_cast<uint32_t>(regions.size()), regions.data());
+
+		// both back to the layout the descriptors expect, the stale sets keep reading the old image for a while
+		barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[0].newLayout = layout;
+		barriers[0].srcAccessMask = 0;
+		barriers[0].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barriers[1].newLayout = layout;
+		barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barriers[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		vkCmdPipelineBarrier(command_buffer_, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+			0, 0, nullptr, 0, nullptr, 2, barriers);
+
+		texture_moves_.push_back({ texture, new_image, texture->image, texture->image_view });
+		return true;
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "vk_mem_alloc.h"
+#include "VulkanViewport.h"
+
+namespace rhi {
+	class VulkanRHI;
+	class VulkanDevice;
+	struct VulkanBuffer;
+	struct VulkanTexture;
+
+	/// <summary>
+	/// Incremental defragmentation on top of VMA's defragmentation API.
+	/// A pass moves at most MAX_MOVES_PER_PASS allocations: moved buffers and images are recreated in their new place,
+	/// copied on the graphics queue behind the frames submitted so far and swapped in for the frames submitted next.
+	/// The descriptor sets referencing them are rewritten once the frames that bound them are done, and the pass ends
+	/// when nothing uses the old buffers and images anymore, nothing waits for the GPU in between.
+	/// Only registered resources move, mapped buffers, attachments and textures shown by ImGui never do.
+	/// </summary>
+	class VulkanDefragmenter
+	{
+	public:
+		static constexpr uint32_t MAX_MOVES_PER_PASS = 16;
+		static constexpr VkDeviceSize MAX_BYTES_PER_PASS = 64ull << 20;
+		// a set bound by every frame is never free when the next one starts, after this many ticks the pass waits for them
+		static constexpr uint32_t MAX_PENDING_TICKS = 16;
+
+		void Init(VulkanRHI* rhi, VulkanDevice* device, VmaAllocator allocator);
+		void Shutdown();
+
+		void RegisterBuffer(VulkanBuffer* buffer);
+		void RegisterTexture(VulkanTexture* texture);
+		// A resource freed in the middle of its move ends the pass first
+		void Unregister(VmaAllocation allocation);
+
+		void Begin();
+		// Starts a pass if a defragmentation is in progress, or ends the one in flight once the GPU is done with it
+		void Tick();
+		inline bool IsRunning() const { return context_ != VK_NULL_HANDLE; };
+	private:
+		void Finish();
+
+		void BeginPass();
+		// Returns false while the old buffers and images may still be used, unless the GPU is known to be idle
+		bool EndPass(bool is_gpu_idle);
+		// Waits for the copies and the frames submitted so far
+		void WaitForPass();
+		bool IsMoving(VmaAllocation allocation) const;
+
+		bool RecordBufferMove(VulkanBuffer* buffer, VmaAllocation dst_allocation);
+		bool RecordTextureMove(VulkanTexture* texture, VmaAllocation dst_allocation);
+
+		VulkanRHI* rhi_ = nullptr;
+		VulkanDevice* device_ = nullptr;
+		VmaAllocator allocator_ = VK_NULL_HANDLE;
+		VmaDefragmentationContext context_ = VK_NULL_HANDLE;
+
+		VkCommandPool command_pool_ = VK_NULL_HANDLE;
+		VkCommandBuffer command_buffer_ = VK_NULL_HANDLE;
+		// signaled once the copies of the pass are done
+		VkFence fence_ = VK_NULL_HANDLE;
+
+		VmaDefragmentationPassMoveInfo pass_{};
+		bool is_pass_pending_ = false;
+		uint32_t pending_ticks_ = 0;
+		// the frames submitted before the swap use the old buffers and images
+		VulkanSubmissionMark last_old_use_{};
+
+		std::unordered_map<VmaAllocation, VulkanBuffer*> buffers_;
+		std::unordered_map<VmaAllocation, VulkanTexture*> textures_;
+
+		// recreated in the current pass, the old objects are destroyed when the pass ends
+		struct BufferMove
+		{
+			VulkanBuffer* buffer;
+			VkBuffer new_buffer;
+			VkBuffer old_buffer;
+		};
+		struct TextureMove
+		{
+			VulkanTexture* texture;
+			VkImage new_image;
+			VkImage old_image;
+			VkImageView old_image_view;
+		};
+		std::vector<BufferMove> buffer_moves_;
+		std::vector<TextureMove> texture_moves_;
+	};
+}
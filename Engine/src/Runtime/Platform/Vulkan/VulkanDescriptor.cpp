@@ -3,6 +3,8 @@
 #include "VulkanDevice.h"
 #include "VulkanResource.h"
 #include "VulkanUtils.h"
+#include "Runtime/Function/RHI/RHIStats.h"
+#include "Runtime/Function/RHI/FrameCapture.h"
 
 namespace utils {
 	VkDescriptorPool VkCreatePool(VkDevice device, 
@@ -73,6 +75,7 @@ namespace rhi {
 		free_pools_.clear();
 
 		std::for_each(used_pools_.begin(), used_pools_.end(), [=](VkDescriptorPool pool) {
+			device_->GetDescriptorTracker().OnPoolReset(pool);
 			vkDestroyDescriptorPool(device_->GetDeviceHandle(), pool, nullptr);
 			});
 		used_pools_.clear();
@@ -83,6 +86,7 @@ namespace rhi {
 		//reset all used pools and add them to the free pools
 		for (auto p : used_pools_) {
 			vkResetDescriptorPool(device_->GetDeviceHandle(), p, 0);
+			device_->GetDescriptorTracker().OnPoolReset(p);
 			free_pools_.push_back(p);
 		}
 
@@ -120,6 +124,8 @@ namespace rhi {
 		switch (result) {
 		case VK_SUCCESS:
 			//all good, return
+			device_->GetDescriptorTracker().OnAllocate(set_vk->descriptor_set, current_pool_);
+			FrameCapture::OnAllocateDescriptorSet(*set, *layout);
 			return true;
 		case VK_ERROR_FRAGMENTED_POOL:
 		case VK_ERROR_OUT_OF_POOL_MEMORY:
@@ -141,6 +147,8 @@ namespace rhi {
 
 			//if it still fails then we have big issues
 			if (result == VK_SUCCESS) {
+				device_->GetDescriptorTracker().OnAllocate(set_vk->descriptor_set, current_pool_);
+				FrameCapture::OnAllocateDescriptorSet(*set, *layout);
 				return true;
 			}
 		}
@@ -246,6 +254,7 @@ namespace rhi {
 		newWrite.descriptorType = VulkanUtils::MLEFormatToVkFormat(type);
 		newWrite.pBufferInfo = &vk_buffer->buffer_info;
 		newWrite.dstBinding = binding;
+		FrameCapture::OnDescriptorWrite(binding, type, buffer, nullptr);
 		
 		return *this;
 	}
@@ -262,6 +271,7 @@ namespace rhi {
 		newWrite.descriptorType = VulkanUtils::MLEFormatToVkFormat(type);
 		newWrite.pImageInfo = &vk_image->texture_info;
 		newWrite.dstBinding = binding;
+		FrameCapture::OnDescriptorWrite(binding, type, nullptr, image);
 
 		return *this;
 
@@ -286,5 +296,140 @@ namespace rhi {
 		}
 
 		vkUpdateDescriptorSets(alloc_->device_->GetDeviceHandle(), writes_.size(), writes_.data(), 0, nullptr);
+		RHIStats::Count(RHICounter::DESCRIPTOR_WRITES, writes_.size());
+		alloc_->device_->GetDescriptorTracker().OnWrite(vk_set->descriptor_set, writes_);
+		FrameCapture::OnWriteDescriptorSet(*set);
+	}
+
+	// -------------------------------------------------------
+
+	void VulkanDescriptorTracker::OnAllocate(VkDescriptorSet set, VkDescriptorPool pool)
+	{
+		pool_sets_[pool].push_back(set);
+		// the handle may be the one of a set freed before
+		OnSetWritten(set);
+	}
+
+	void VulkanDescriptorTracker::OnPoolReset(VkDescriptorPool pool)
+	{
+		auto it = pool_sets_.find(pool);
+		if (it == pool_sets_.end())
+			return;
+		for (VkDescriptorSet set : it->second)
+		{
+			auto writes = set_writes_.find(set);
+			if (writes == set_writes_.end())
+				continue;
+			for (auto const& write : writes->second)
+			{
+				auto sets = info_sets_.find(GetInfo(write));
+				if (sets != info_sets_.end())
+					sets->second.erase(set);
+			}
+			set_writes_.erase(writes);
+		}
+		for (VkDescriptorSet set : it->second)
+		{
+			recording_sets_.erase(set);
+			set_last_use_.erase(set);
+			stale_sets_.erase(set);
+			set_last_write_.erase(set);
+		}
+		pool_sets_.erase(it);
+	}
+
+	void VulkanDescriptorTracker::OnWrite(VkDescriptorSet set, const std::vector<VkWriteDescriptorSet>& writes)
+	{
+		auto& tracked = set_writes_[set];
+		for (auto const& write : writes)
+		{
+			// a binding written again replaces what it referenced before
+			auto same_binding = std::find_if(tracked.begin(), tracked.end(), [&write](const VkWriteDescriptorSet& other) {
+				return other.dstBinding == write.dstBinding; });
+			if (same_binding != tracked.end())
+				*same_binding = write;
+			else
+				tracked.push_back(write);
+			info_sets_[GetInfo(write)].insert(set);
+		}
+		OnSetWritten(set);
+	}
+
+	void VulkanDescriptorTracker::OnBind(VkDescriptorSet set)
+	{
+		recording_sets_.insert(set);
+	}
+
+	void VulkanDescriptorTracker::OnSubmit(const VulkanSubmissionMark& mark)
+	{
+		for (VkDescriptorSet set : recording_sets_)
+		{
+			set_last_use_[set] = mark;
+		}
+		recording_sets_.clear();
+	}
+
+	void VulkanDescriptorTracker::MarkStale(const void* info)
+	{
+		auto sets = info_sets_.find(info);
+		if (sets == info_sets_.end())
+			return;
+		stale_sets_.insert(sets->second.begin(), sets->second.end());
+	}
+
+	bool VulkanDescriptorTracker::RewriteStale(VkDevice device, const std::function<bool(const VulkanSubmissionMark&)>& is_done, bool is_gpu_idle)
+	{
+		std::vector<VkWriteDescriptorSet> writes;
+		for (auto it = stale_sets_.begin(); it != stale_sets_.end();)
+		{
+			if (!is_gpu_idle)
+			{
+				auto last_use = set_last_use_.find(*it);
+				if (recording_sets_.count(*it) || (last_use != set_last_use_.end() && !is_done(last_use->second)))
+				{
+					++it;
+					continue;
+				}
+			}
+			// the writes point at the infos, which hold the moved resources already
+			auto set_writes = set_writes_.find(*it);
+			if (set_writes != set_writes_.end())
+				writes.insert(writes.end(), set_writes->second.begin(), set_writes->second.end());
+			OnSetWritten(*it);
+			it = stale_sets_.erase(it);
+		}
+		if (!writes.empty())
+		{
+			vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+			RHIStats::Count(RHICounter::DESCRIPTOR_WRITES, writes.size());
+		}
+		return stale_sets_.empty();
+	}
+
+	void VulkanDescriptorTracker::Forget(const void* info)
+	{
+		auto sets = info_sets_.find(info);
+		if (sets == info_sets_.end())
+			return;
+		for (VkDescriptorSet set : sets->second)
+		{
+			auto& writes = set_writes_[set];
+			writes.erase(std::remove_if(writes.begin(), writes.end(), [info](const VkWriteDescriptorSet& write) {
+				return GetInfo(write) == info; }), writes.end());
+			// what the set references is about to be destroyed
+			OnSetWritten(set);
+		}
+		info_sets_.erase(sets);
+	}
+
+	uint64_t VulkanDescriptorTracker::GetLastWrite(VkDescriptorSet set) const
+	{
+		auto it = set_last_write_.find(set);
+		return it != set_last_write_.end() ? it->second : UINT64_MAX;
+	}
+
+	const void* VulkanDescriptorTracker::GetInfo(const VkWriteDescriptorSet& write)
+	{
+		return write.pBufferInfo ? static_cast<const void*>(write.pBufferInfo) : static_cast<const void*>(write.pImageInfo);
 	}
 }
\ No newline at end of file
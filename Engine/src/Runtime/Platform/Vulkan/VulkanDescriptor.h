@@ -1,6 +1,7 @@
 #pragma once
 #include <vulkan/vulkan.h>
 #include "Runtime/Function/RHI/Descriptor.h"
+#include "VulkanViewport.h"
 
 namespace rhi {
 	class VulkanDevice;
@@ -15,6 +16,53 @@ namespace rhi {
 		VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
 	};
 
+	/// <summary>
+	/// Remembers what every descriptor set allocated by a VulkanDescriptorAllocator was written with.
+	/// Writes point at the buffer_info/texture_info of the resource, so when the defragmenter moves a resource
+	/// it updates the info and rewrites the sets that reference it.
+	/// A set can't be written while a command buffer that bound it is pending, so the binds are tracked too
+	/// and a stale set is only rewritten once the submissions that used it are done.
+	/// Writing a set also makes the recorded command buffers that bound it invalid, so every write gets a serial
+	/// the secondary command buffers check before they are executed again.
+	/// </summary>
+	class VulkanDescriptorTracker
+	{
+	public:
+		void OnAllocate(VkDescriptorSet set, VkDescriptorPool pool);
+		void OnPoolReset(VkDescriptorPool pool);
+		void OnWrite(VkDescriptorSet set, const std::vector<VkWriteDescriptorSet>& writes);
+		void OnBind(VkDescriptorSet set);
+		// The sets bound since the last graphics submission with a fence are in use until mark is done
+		void OnSubmit(const VulkanSubmissionMark& mark);
+
+		// info is the buffer_info or texture_info of a resource, the sets referencing it are rewritten by RewriteStale
+		void MarkStale(const void* info);
+		// Rewrites the stale sets no submission uses anymore, all of them if the GPU is known to be idle.
+		// Returns whether every stale set has been rewritten
+		bool RewriteStale(VkDevice device, const std::function<bool(const VulkanSubmissionMark&)>& is_done, bool is_gpu_idle);
+		void Forget(const void* info);
+
+		inline uint64_t GetWriteSerial() const { return write_serial_; };
+		// The serial of the last write of the set, the highest one if the set has been freed since
+		uint64_t GetLastWrite(VkDescriptorSet set) const;
+	private:
+		void OnSetWritten(VkDescriptorSet set) { set_last_write_[set] = ++write_serial_; };
+
+		static const void* GetInfo(const VkWriteDescriptorSet& write);
+
+		std::unordered_map<VkDescriptorSet, std::vector<VkWriteDescriptorSet>> set_writes_;
+		std::unordered_map<const void*, std::unordered_set<VkDescriptorSet>> info_sets_;
+		std::unordered_map<VkDescriptorPool, std::vector<VkDescriptorSet>> pool_sets_;
+
+		// bound by the command buffers being recorded
+		std::unordered_set<VkDescriptorSet> recording_sets_;
+		std::unordered_map<VkDescriptorSet, VulkanSubmissionMark> set_last_use_;
+		std::unordered_set<VkDescriptorSet> stale_sets_;
+
+		uint64_t write_serial_ = 0;
+		std::unordered_map<VkDescriptorSet, uint64_t> set_last_write_;
+	};
+
 	class VulkanDescriptorAllocator : public DescriptorAllocator
 	{
 		friend class VulkanDescriptorWriter;
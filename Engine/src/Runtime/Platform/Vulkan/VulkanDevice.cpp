@@ -1,6 +1,7 @@
 #include "mlepch.h"
 #include "VulkanDevice.h"
 #include "VulkanUtils.h"
+#include "VulkanRHI.h"
 #include "Runtime/Core/Base/Log.h"
 
 #define ARRAY_SIZE( ARRAY ) (sizeof (ARRAY) / sizeof (ARRAY[0]))
@@ -48,10 +49,27 @@ namespace rhi {
 		device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 
 		// extensions related
-		int device_extension_count = 1;
-		const char* device_extensions[] = { "VK_KHR_swapchain"};
-		device_create_info.enabledExtensionCount = device_extension_count;
-		device_create_info.ppEnabledExtensionNames = device_extensions;
+		std::vector<const char*> device_extensions;
+		if (!rhi_->IsHeadless())
+			device_extensions.push_back("VK_KHR_swapchain");
+
+		uint32_t available_extension_count = 0;
+		vkEnumerateDeviceExtensionProperties(gpu_, nullptr, &available_extension_count, nullptr);
+		std::vector<VkExtensionProperties> available_extensions(available_extension_count);
+		vkEnumerateDeviceExtensionProperties(gpu_, nullptr, &available_extension_count, available_extensions.data());
+		for (auto const& extension : available_extensions)
+		{
+			if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+			{
+				device_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+				has_memory_budget_ = true;
+			}
+		}
+		if (!has_memory_budget_)
+			MLE_CORE_WARN("VK_EXT_memory_budget is not supported, memory budgets are estimated");
+
+		device_create_info.enabledExtensionCount = static_cast<uint32_t>(device_extensions.size());
+		device_create_info.ppEnabledExtensionNames = device_extensions.data();
 
 		// validation layer
 		device_create_info.enabledLayerCount = 0;
@@ -1,6 +1,7 @@
 #pragma once
 #include <vulkan/vulkan.h>
 #include "VulkanQueue.h"
+#include "VulkanDescriptor.h"
 
 namespace rhi {
 	class VulkanDevice
@@ -36,9 +37,12 @@ namespace rhi {
 		inline VulkanQueue*		GetPresentQueue()	{ return present_queue_; };
 		inline VkCommandPool	GetCommandPool()	{ return command_pool_; };
 		inline VkDescriptorPool	GetDescriptorPool()	{ return descriptor_pool_; }
+		inline VulkanDescriptorTracker& GetDescriptorTracker() { return descriptor_tracker_; };
 
 		inline const VkPhysicalDeviceFeatures& GetPhysicalFeatures() { return features_; };
 		inline const VkPhysicalDeviceProperties& GetDeviceProperties() { return gpu_properties_; };
+		// VK_EXT_memory_budget is enabled, heap budgets come from the driver
+		inline bool HasMemoryBudget() const { return has_memory_budget_; };
 
 		void SetupPresentQueue(VkSurfaceKHR in_surface);
 
@@ -47,6 +51,7 @@ namespace rhi {
 		VkPhysicalDevice gpu_;
 		VkPhysicalDeviceProperties gpu_properties_{};
 		VkPhysicalDeviceFeatures features_{};
+		bool has_memory_budget_ = false;
 		// Logical Device
 		VkDevice         device_;
 
@@ -54,6 +59,7 @@ namespace rhi {
 
 		VkCommandPool    command_pool_;
 		VkDescriptorPool descriptor_pool_;
+		VulkanDescriptorTracker descriptor_tracker_;
 
 		// Queue
 		VulkanQueue* graphics_queue_;
@@ -5,6 +5,8 @@
 #include "VulkanResource.h"
 #include "VulkanCommandBuffer.h"
 #include "VulkanDescriptor.h"
+#include "Runtime/Function/RHI/RHIStats.h"
+#include "Runtime/Function/RHI/FrameCapture.h"
 
 #include <vector>
 #include <GLFW/glfw3.h>
@@ -47,6 +49,10 @@ namespace utils {
 		{
 			usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
 		}
+		if (EnumHasFlag(type, ResourceTypes::RESOURCE_TYPE_INDIRECT_BUFFER))
+		{
+			usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+		}
 		return usage;
 	}
 
@@ -76,8 +82,11 @@ namespace rhi {
 
 	void VulkanRHI::Init()
 	{
+		engine::Application& app = engine::Application::GetApp();
+		is_headless_ = app.IsHeadless();
+
 		// Setup Vulkan
-		if (!glfwVulkanSupported())
+		if (!is_headless_ && !glfwVulkanSupported())
 		{
 			MLE_CORE_ERROR("GLFW: Vulkan not supported!\n");
 			return;
@@ -90,9 +99,13 @@ namespace rhi {
 		}
 		CreateVulkanMemoryAllocator();
 
-		engine::Application& app = engine::Application::GetApp();
-		GLFWwindow* window = static_cast<GLFWwindow*>(app.GetWindow().GetNativeWindow());
-		viewport_ = new VulkanViewport(this, device_, &app.GetWindow());
+		if (is_headless_)
+		{
+			const engine::ApplicationSpecification& spec = app.GetSpecification();
+			viewport_ = new VulkanViewport(this, device_, spec.width, spec.height);
+		}
+		else
+			viewport_ = new VulkanViewport(this, device_, &app.GetWindow());
 
 		depth_format_ = VulkanUtils::FindDepthFormat(device_->GetPhysicalHandle());
 	}
@@ -103,9 +116,14 @@ namespace rhi {
 		RHIBlockUntilGPUIdle();
 
 		ImGui_ImplVulkan_Shutdown();
-		ImGui_ImplGlfw_Shutdown();
+		if (!is_headless_)
+			ImGui_ImplGlfw_Shutdown();
 		ImGui::DestroyContext();
 
+		defragmenter_.Shutdown();
+		if (texture_pool_.GetLiveCount() || buffer_pool_.GetLiveCount() || pipeline_pool_.GetLiveCount())
+			MLE_CORE_WARN("[vulkan] {0} textures, {1} buffers and {2} pipelines were never freed",
+				texture_pool_.GetLiveCount(), buffer_pool_.GetLiveCount(), pipeline_pool_.GetLiveCount());
 		vmaDestroyAllocator(allocator_);
 
 		viewport_->Destroy();
@@ -124,17 +142,38 @@ namespace rhi {
 
 	void VulkanRHI::GetExtensionsAndLayers()
 	{
-		uint32_t extensions_count = 0;
-		const char** extensions = glfwGetRequiredInstanceExtensions(&extensions_count);
-		for (uint32_t i = 0; i < extensions_count; ++i)
+		// no surface without a window
+		if (!is_headless_)
 		{
-			instance_extensions_.emplace_back(extensions[i]);
+			uint32_t extensions_count = 0;
+			const char** extensions = glfwGetRequiredInstanceExtensions(&extensions_count);
+			for (uint32_t i = 0; i < extensions_count; ++i)
+			{
+				instance_extensions_.emplace_back(extensions[i]);
+			}
 		}
 #ifdef MLE_DEBUG
 		instance_extensions_.emplace_back("VK_EXT_debug_report");
 #endif // MLE_DEBUG
 
-		instance_layers_.emplace_back("VK_LAYER_KHRONOS_validation");
+		// build machines usually don't have the SDK installed
+		uint32_t layer_count = 0;
+		vkEnumerateInstanceLayerProperties(&layer_count, nullptr);
+		std::vector<VkLayerProperties> layers(layer_count);
+		vkEnumerateInstanceLayerProperties(&layer_count, layers.data());
+		bool has_validation = false;
+		for (const VkLayerProperties& layer : layers)
+		{
+			if (!strcmp(layer.layerName, "VK_LAYER_KHRONOS_validation"))
+			{
+				has_validation = true;
+				break;
+			}
+		}
+		if (has_validation)
+			instance_layers_.emplace_back("VK_LAYER_KHRONOS_validation");
+		else
+			MLE_CORE_WARN("VK_LAYER_KHRONOS_validation is not available, running without validation");
 	}
 
     void VulkanRHI::CreateInstance()
@@ -253,6 +292,7 @@ namespace rhi {
 		//std::vector<DeviceInfo> integrated_devices;
 
 		MLE_CORE_INFO("Found {0} device(s)", gpu_count);
+		VulkanDevice* fallback_device = nullptr;
 		//enumerate all physical device
 		for(int i = 0; i < (int)gpu_count; i++)
 		{
@@ -271,10 +311,24 @@ namespace rhi {
 
 				integrated_devices.emplace_back(new_device, i);
 			}*/
+			// integrated or cpu devices are only used when nothing better is there, e.g. lavapipe on a server
+			if (!fallback_device)
+			{
+				fallback_device = new_device;
+				continue;
+			}
 			delete new_device;
 		}
 		free(gpus);
 
+		if (device_)
+			delete fallback_device;
+		else if (fallback_device)
+		{
+			MLE_CORE_WARN("No discrete device found, falling back to {0}", fallback_device->GetDeviceProperties().deviceName);
+			device_ = fallback_device;
+		}
+
 		//Pick the first discrete device
 		//device_ = discrete_devices[0].device;
 
@@ -295,6 +349,8 @@ namespace rhi {
 		allocatorCreateInfo.device = device_->GetDeviceHandle();
 		allocatorCreateInfo.instance = instance_;
 		allocatorCreateInfo.pVulkanFunctions = &vulkanFunctions;
+		if (device_->HasMemoryBudget())
+			allocatorCreateInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
 
 		if (vmaCreateAllocator(&allocatorCreateInfo, &allocator_) != VK_SUCCESS)
 		{
@@ -302,16 +358,83 @@ namespace rhi {
 			throw std::runtime_error("Failed to create VMA allocator");
 		}
 		MLE_CORE_INFO("VMA allocator created");
+
+		defragmenter_.Init(this, device_, allocator_);
 	}
 
 	void VulkanRHI::RHITick(float delta_time)
 	{
+		MLE_PROFILE_FUNCTION();
+		vmaSetCurrentFrameIndex(allocator_, ++frame_index_);
+
+		const VkPhysicalDeviceMemoryProperties* memory_props = nullptr;
+		vmaGetMemoryProperties(allocator_, &memory_props);
+		VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+		vmaGetHeapBudgets(allocator_, budgets);
+
+		std::vector<RHIHeapBudget> heaps(memory_props->memoryHeapCount);
+		bool is_near_budget = false;
+		uint64_t block_bytes = 0;
+		uint64_t allocation_bytes = 0;
+		for (uint32_t heap_index = 0; heap_index < memory_props->memoryHeapCount; ++heap_index)
+		{
+			RHIHeapBudget& heap = heaps[heap_index];
+			heap.usage = budgets[heap_index].usage;
+			heap.budget = budgets[heap_index].budget;
+			heap.block_bytes = budgets[heap_index].statistics.blockBytes;
+			heap.allocation_bytes = budgets[heap_index].statistics.allocationBytes;
+			heap.allocation_count = budgets[heap_index].statistics.allocationCount;
+			heap.device_local = memory_props->memoryHeaps[heap_index].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+			block_bytes += heap.block_bytes;
+			allocation_bytes += heap.allocation_bytes;
+
+			if (heap.budget > 0 && heap.usage >= static_cast<uint64_t>(heap.budget * RHIStats::BUDGET_WARNING_RATIO))
+			{
+				is_near_budget = true;
+				// once per second is plenty, the renderer evicts what it can in the meantime
+				if (budget_warning_cooldown_ <= 0.0f)
+					MLE_CORE_WARN("[vulkan] heap {0} is at {1} of {2} MiB", heap_index, heap.usage >> 20, heap.budget >> 20);
+			}
+		}
+		if (is_near_budget && budget_warning_cooldown_ <= 0.0f)
+			budget_warning_cooldown_ = 1.0f;
+		budget_warning_cooldown_ = std::max(budget_warning_cooldown_ - delta_time, 0.0f);
+
+		RHIStats::GetInstance().SetHeapBudgets(std::move(heaps));
 
+		// long sessions leave many half empty blocks behind, compact them every now and then
+		auto_defragment_cooldown_ = std::max(auto_defragment_cooldown_ - delta_time, 0.0f);
+		const uint64_t unused_bytes = block_bytes - allocation_bytes;
+		if (!defragmenter_.IsRunning() && auto_defragment_cooldown_ <= 0.0f &&
+			unused_bytes >= AUTO_DEFRAGMENT_UNUSED_BYTES && unused_bytes * 4 >= block_bytes)
+		{
+			RHIDefragment();
+		}
+		defragmenter_.Tick();
+	}
+
+	void VulkanRHI::RHIDefragment()
+	{
+		defragmenter_.Begin();
+		auto_defragment_cooldown_ = AUTO_DEFRAGMENT_INTERVAL;
 	}
 
 	void VulkanRHI::RHIBlockUntilGPUIdle()
 	{
 		vkDeviceWaitIdle(device_->GetDeviceHandle());
+		// nothing can be in use anymore
+		if (viewport_)
+			viewport_->ReleaseRetiredSwapChains(true);
+	}
+
+	bool VulkanRHI::IsSubmissionDone(const VulkanSubmissionMark& mark)
+	{
+		if (!mark.fence)
+			return true;
+		// the fence has been waited for before it could be submitted again
+		if (mark.fence->submission_serial != mark.serial)
+			return true;
+		return vkGetFenceStatus(device_->GetDeviceHandle(), mark.fence->fence) == VK_SUCCESS;
 	}
 
 	void* VulkanRHI::GetNativeInstance()
@@ -341,6 +464,7 @@ namespace rhi {
 
 	void VulkanRHI::AcquireNextImage(Semaphore* semaphore)
 	{
+		MLE_PROFILE_FUNCTION();
 		VulkanSemaphore* image_acquired_semaphore = (VulkanSemaphore*)semaphore;
 		viewport_->AcquireNextImage(image_acquired_semaphore->semaphore);
 	}
@@ -348,7 +472,7 @@ namespace rhi {
 	void* VulkanRHI::GetNativeSwapchainImageView()
 	{
 		uint32_t index = viewport_->GetAccquiredIndex();
-		return (void*)viewport_->GetSwapChain()->GetSwapchianImageView(index);
+		return (void*)viewport_->GetImageView(index);
 	}
 
 	uint32_t VulkanRHI::GetViewportWidth()
@@ -366,9 +490,34 @@ namespace rhi {
 		return device_->GetGfxQueue()->GetFamilyIndex();
 	}
 
+	void VulkanRHI::OnViewportResize(uint32_t width, uint32_t height)
+	{
+		if (viewport_ && !is_headless_)
+			viewport_->RequestSwapChainRecreate();
+	}
+
+	void VulkanRHI::SetPresentMode(PresentMode mode)
+	{
+		if (mode == present_mode_)
+			return;
+		RHI::SetPresentMode(mode);
+		// before Init the first swapchain picks it up, headless viewports have none
+		if (viewport_ && !is_headless_)
+			viewport_->RequestSwapChainRecreate();
+	}
+
 	void VulkanRHI::GfxQueueSubmit(const QueueSubmitDesc& desc)
 	{
+		MLE_PROFILE_FUNCTION();
 		device_->GetGfxQueue()->Submit(desc);
+		RHIStats::Count(RHICounter::QUEUE_SUBMITS);
+		if (desc.signal_fence)
+		{
+			VulkanFence* fence_vk = static_cast<VulkanFence*>(desc.signal_fence);
+			fence_vk->submission_serial = ++submission_serial_;
+			last_submission_ = { fence_vk, fence_vk->submission_serial };
+			device_->GetDescriptorTracker().OnSubmit(last_submission_);
+		}
 	}
 
 	void VulkanRHI::ComputeQueueSubmit(const QueueSubmitDesc& desc)
@@ -378,17 +527,22 @@ namespace rhi {
 
 	void VulkanRHI::TransferQueueSubmit(const QueueSubmitDesc& desc)
 	{
+		MLE_PROFILE_FUNCTION();
 		device_->GetTransferQueue()->Submit(desc);
+		RHIStats::Count(RHICounter::QUEUE_SUBMITS);
 	}
 
 	void VulkanRHI::Present(Semaphore** semaphores, uint32_t semaphore_count)
 	{
+		MLE_PROFILE_FUNCTION();
 		viewport_->Present(semaphores, semaphore_count);
 	}
 
 	DescriptorSetPtr VulkanRHI::RHICreateDescriptorSet()
 	{
-		return std::make_unique<VulkanDescriptorSet>();
+		auto set = std::make_unique<VulkanDescriptorSet>();
+		FrameCapture::OnCreateDescriptorSet(*set);
+		return set;
 	}
 
 	DescriptorSetLayoutCachePtr VulkanRHI::CreateDescriptorSetLayoutCache()
@@ -405,14 +559,23 @@ namespace rhi {
 		return new VulkanCommandBuffer(device_);
 	}
 
+	std::unique_ptr<SecondaryCommandBuffer> VulkanRHI::RHICreateSecondaryCommandBuffer()
+	{
+		return std::make_unique<VulkanSecondaryCommandBuffer>(device_);
+	}
+
 	std::unique_ptr<RenderPass> VulkanRHI::RHICreateRenderPass(const RenderPass::Descriptor& desc)
 	{
-		return std::make_unique<VulkanRenderPass>(*this, desc);
+		auto pass = std::make_unique<VulkanRenderPass>(*this, desc);
+		FrameCapture::OnCreateRenderPass(*pass, desc);
+		return pass;
 	}
 
 	std::unique_ptr<RenderTarget> VulkanRHI::RHICreateRenderTarget(const RenderTarget::Descriptor& desc)
 	{
-		return std::make_unique<VulkanRenderTarget>(*this, desc);
+		auto render_target = std::make_unique<VulkanRenderTarget>(*this, desc);
+		FrameCapture::OnCreateRenderTarget(*render_target, desc);
+		return render_target;
 	}
 
 	Semaphore* VulkanRHI::RHICreateSemaphore()
@@ -452,12 +615,15 @@ namespace rhi {
 	void VulkanRHI::RHIDestroyFence(Fence* fence)
 	{
 		VulkanFence* fence_vk = (VulkanFence*)fence;
+		if (last_submission_.fence == fence_vk)
+			last_submission_ = {};
 		vkDestroyFence(device_->GetDeviceHandle(), fence_vk->fence, nullptr);
 		delete fence;
 	}
 
 	void VulkanRHI::RHIWaitForFences(Fence** fence, uint32_t fence_count)
 	{
+		MLE_PROFILE_FUNCTION();
 		VkFence* fences = new VkFence[fence_count];
 		for (uint32_t i = 0; i < fence_count; ++i)
 		{
@@ -483,10 +649,59 @@ namespace rhi {
 		return false;
 	}
 
+	QueryPool* VulkanRHI::RHICreateTimestampQueryPool(uint32_t query_count)
+	{
+		VulkanQueryPool* pool_vk = new VulkanQueryPool{};
+		VkQueryPoolCreateInfo pool_info{};
+		pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		pool_info.queryCount = query_count;
+		if (vkCreateQueryPool(device_->GetDeviceHandle(), &pool_info, nullptr, &pool_vk->pool) != VK_SUCCESS)
+		{
+			MLE_CORE_ERROR("Failed to create vulkan query pool");
+			throw std::runtime_error("Failed to create vulkan query pool");
+		}
+		return pool_vk;
+	}
+
+	void VulkanRHI::RHIDestroyQueryPool(QueryPool* pool)
+	{
+		VulkanQueryPool* pool_vk = (VulkanQueryPool*)pool;
+		vkDestroyQueryPool(device_->GetDeviceHandle(), pool_vk->pool, nullptr);
+		delete pool;
+	}
+
+	bool VulkanRHI::RHIGetQueryResults(QueryPool* pool, uint32_t first_query, uint32_t query_count, uint64_t* results)
+	{
+		VulkanQueryPool* pool_vk = static_cast<VulkanQueryPool*>(pool);
+		// no VK_QUERY_RESULT_WAIT_BIT, unavailable results come back as VK_NOT_READY
+		VkResult result = vkGetQueryPoolResults(device_->GetDeviceHandle(), pool_vk->pool, first_query, query_count,
+			sizeof(uint64_t) * query_count, results, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		switch (result)
+		{
+		case VK_SUCCESS: return true;
+		case VK_NOT_READY: return false;
+		case VK_ERROR_DEVICE_LOST: MLE_CORE_ERROR("[vulkan] The device has been lost"); throw std::runtime_error("[vulkan] The device has been lost");
+		}
+		return false;
+	}
+
+	float VulkanRHI::GetTimestampPeriod()
+	{
+		uint32_t family_count = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(device_->GetPhysicalHandle(), &family_count, nullptr);
+		std::vector<VkQueueFamilyProperties> families(family_count);
+		vkGetPhysicalDeviceQueueFamilyProperties(device_->GetPhysicalHandle(), &family_count, families.data());
+
+		if (families[GetGfxQueueFamily()].timestampValidBits == 0)
+			return 0.0f;
+		return device_->GetDeviceProperties().limits.timestampPeriod;
+	}
+
 	// ---------------------------------Resource Creation and deconstruction-----------------------------------
 	BufferRef VulkanRHI::RHICreateBuffer(const RHIBuffer::Descriptor& desc)
 	{
-		auto buffer = std::make_shared<VulkanBuffer>();
+		VulkanBuffer* buffer = buffer_pool_.Allocate();
 
 		// -------------Configure buffer size-------------
 		// Calculate required alignment based on minimum device offset alignment
@@ -503,8 +718,9 @@ namespace rhi {
 		VkBufferUsageFlags usage = utils::ResolveBufferUsage(desc.usage);
 
 		// if this buffer needs staging buffer to upload data or it needs to read data from the gpu 
+		// the defragmenter copies it to move it
 		if (desc.memory_usage == MemoryUsage::MEMORY_USAGE_GPU_ONLY)
-			usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
 		// -------------Resolve VMA Create Info, and fix some usage stuff-------------
 		VmaAllocationCreateInfo vma_create_info{};
@@ -539,18 +755,41 @@ namespace rhi {
 		buffer->buffer_info.offset = 0;
 		buffer->buffer_info.range = buffer->size;
 
+		buffer->category = desc.category;
+		buffer->vk_usage = usage;
+		TrackAllocation(buffer->buffer_allocation, buffer->category, buffer->allocation_size);
+		// mapped buffers would have to be moved by the cpu
+		if (desc.memory_usage == MemoryUsage::MEMORY_USAGE_GPU_ONLY && !desc.mapped_at_creation)
+			defragmenter_.RegisterBuffer(buffer);
+
 #ifdef MLE_DEBUG
 		MLE_CORE_INFO("[vulkan] Buffer created");
 #endif // MLE_DEBUG
-		return buffer;
+		RHIStats::Count(RHICounter::BUFFER_CREATIONS);
+		FrameCapture::OnCreateBuffer(*buffer, desc);
+		return BufferRef(buffer, &buffer_pool_);
 	}
 
 	void VulkanRHI::RHIFreeBuffer(RHIBuffer& buffer)
 	{
 		VulkanBuffer* vk_buffer = static_cast<VulkanBuffer*>(&buffer);
+		if (!buffer_pool_.IsAlive(vk_buffer->handle))
+		{
+			MLE_CORE_ERROR("[vulkan] Freeing a buffer that has already been freed");
+			return;
+		}
 		if (vk_buffer->buffer != VK_NULL_HANDLE)
+		{
+			defragmenter_.Unregister(vk_buffer->buffer_allocation);
+			device_->GetDescriptorTracker().Forget(&vk_buffer->buffer_info);
 			vmaDestroyBuffer(allocator_, vk_buffer->buffer, vk_buffer->buffer_allocation);
+			RHIStats::TrackFree(vk_buffer->category, vk_buffer->allocation_size);
+			vk_buffer->buffer = VK_NULL_HANDLE;
+		}
+		FrameCapture::OnFreeBuffer(buffer);
+		buffer_pool_.Release(*vk_buffer);
 		MLE_CORE_INFO("[vulkan] Buffer freed");
+		RHIStats::Count(RHICounter::BUFFER_FREES);
 	}
 
 	void VulkanRHI::AllocateTextureMemory(VulkanTexture* texture)
@@ -592,24 +831,17 @@ namespace rhi {
 			texture->layers_count,
 			texture->miplevels,
 			texture->image_allocation);
+		texture->vk_format = vk_format;
+		texture->vk_usage = vk_usage;
+		TrackAllocation(texture->image_allocation, texture->category, texture->allocation_size);
+		// attachments are referenced by framebuffers, which aren't tracked
+		const TextureUsage attachment_usage = TextureUsage::COLOR_ATTACHMENT | TextureUsage::DEPTH_ATTACHMENT |
+			TextureUsage::STENCIL_ATTACHMENT | TextureUsage::TRANSIENT_ATTACHMENT;
+		if (!EnumHasFlag(texture->usage, attachment_usage) && EnumHasFlag(texture->usage, TextureUsage::UPLOADABLE))
+			defragmenter_.RegisterTexture(texture);
 
 		// Create Image View
-		VkImageViewCreateInfo image_view_create_info{};
-		image_view_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		image_view_create_info.image = texture->image;
-		image_view_create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-		image_view_create_info.format = vk_format;
-		image_view_create_info.subresourceRange.aspectMask = texture->format == PixelFormat::DEPTH ? VK_IMAGE_ASPECT_DEPTH_BIT
-			: VK_IMAGE_ASPECT_COLOR_BIT;
-		image_view_create_info.subresourceRange.baseMipLevel = 0;
-		image_view_create_info.subresourceRange.levelCount = texture->miplevels;
-		image_view_create_info.subresourceRange.baseArrayLayer = 0;
-		image_view_create_info.subresourceRange.layerCount = 1;
-
-		if (vkCreateImageView(device_->GetDeviceHandle(), &image_view_create_info, nullptr, &texture->image_view) != VK_SUCCESS)
-		{
-			throw std::runtime_error("failed to create image view!");
-		}
+		texture->CreateImageView(device_->GetDeviceHandle());
 
 		VulkanUtils::CreateLinearSampler(device_->GetDeviceHandle(), device_->GetPhysicalHandle(), texture->sampler);
 
@@ -620,9 +852,19 @@ namespace rhi {
 		texture->texture_id = nullptr;
 	}
 
+	void VulkanRHI::TrackAllocation(VmaAllocation allocation, MemoryCategory category, VkDeviceSize& allocation_size)
+	{
+		VmaAllocationInfo alloc_info{};
+		vmaGetAllocationInfo(allocator_, allocation, &alloc_info);
+		allocation_size = alloc_info.size;
+		// shows up in VMA's json dumps and in validation messages
+		vmaSetAllocationName(allocator_, allocation, ToString(category));
+		RHIStats::TrackAllocation(category, allocation_size);
+	}
+
 	TextureRef VulkanRHI::RHICreateTexture(const RHITexture::Descriptor& desc)
 	{
-		auto texture = std::make_shared<VulkanTexture>();
+		VulkanTexture* texture = texture_pool_.Allocate();
 		texture->width = desc.width;
 		texture->height = desc.height;
 		texture->depth = desc.depth;
@@ -630,47 +872,81 @@ namespace rhi {
 		texture->format = desc.format;
 		texture->usage = desc.usage;
 		texture->layers_count = desc.array_layers;
+		texture->category = desc.category;
 		
-		AllocateTextureMemory(texture.get());
+		AllocateTextureMemory(texture);
+		RHIStats::Count(RHICounter::TEXTURE_CREATIONS);
+		FrameCapture::OnCreateTexture(*texture, desc);
 
-		return texture;
+		return TextureRef(texture, &texture_pool_);
 	}
 
-	void VulkanRHI::ResizeTexture(RHITexture& texture, uint32_t width, uint32_t height)
+	TextureRef VulkanRHI::ResizeTexture(RHITexture& texture, uint32_t width, uint32_t height)
 	{
 		if (texture.width == width && texture.height == height)
-			return;
-		texture.width = width;
-		texture.height = height;
+			return nullptr;
 
-		RHIFreeTexture(texture);
+		// the frames in flight may still use the old image, it moves to a slot of its own that goes through the frame dumps,
+		// the texture keeps its slot so every handle to it stays valid
 		VulkanTexture* vk_texture = static_cast<VulkanTexture*>(&texture);
+		defragmenter_.Unregister(vk_texture->image_allocation);
+		device_->GetDescriptorTracker().Forget(&vk_texture->texture_info);
+		VulkanTexture* old_memory = texture_pool_.Allocate();
+		const PoolHandle old_memory_handle = old_memory->handle;
+		*old_memory = *vk_texture;
+		old_memory->handle = old_memory_handle;
+		old_memory->texture_id = nullptr;
+
+		texture.width = width;
+		texture.height = height;
 		AllocateTextureMemory(vk_texture);
+		RHIStats::Count(RHICounter::TEXTURE_RESIZES);
+		FrameCapture::OnResizeTexture(texture, width, height);
+		return TextureRef(old_memory, &texture_pool_);
 	}
 
 	void VulkanRHI::RHIFreeTexture(RHITexture& texture)
 	{
-		RHIBlockUntilGPUIdle();
 		VulkanTexture* vk_texture = static_cast<VulkanTexture*>(&texture);
-		if (vk_texture->image)
+		if (!texture_pool_.IsAlive(vk_texture->handle))
 		{
+			MLE_CORE_ERROR("[vulkan] Freeing a texture that has already been freed");
+			return;
+		}
+		FreeTextureMemory(vk_texture);
+		FrameCapture::OnFreeTexture(texture);
+		texture_pool_.Release(*vk_texture);
+	}
 
+	void VulkanRHI::FreeTextureMemory(VulkanTexture* vk_texture)
+	{
+		if (vk_texture->image)
+		{
+			defragmenter_.Unregister(vk_texture->image_allocation);
+			device_->GetDescriptorTracker().Forget(&vk_texture->texture_info);
 			vkDestroySampler(device_->GetDeviceHandle(), vk_texture->sampler, nullptr);
 			vkDestroyImageView(device_->GetDeviceHandle(), vk_texture->image_view, nullptr);
 			vmaDestroyImage(allocator_, vk_texture->image, vk_texture->image_allocation);
+			RHIStats::TrackFree(vk_texture->category, vk_texture->allocation_size);
 			vk_texture->image = VK_NULL_HANDLE;
+			RHIStats::Count(RHICounter::TEXTURE_FREES);
 		}
 	}
 
 	ShaderModule* VulkanRHI::RHICreateShaderModule(const char* path)
 	{
 		auto code = utils::ReadFile(path);
+		return RHICreateShaderModuleFromCode(code.data(), code.size());
+	}
+
+	ShaderModule* VulkanRHI::RHICreateShaderModuleFromCode(const void* code, size_t size)
+	{
 		VulkanShaderModule* vk_shader = new VulkanShaderModule();
 
 		VkShaderModuleCreateInfo shader_module_create_info{};
 		shader_module_create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		shader_module_create_info.codeSize = code.size();
-		shader_module_create_info.pCode = reinterpret_cast<const uint32_t*>(code.data());
+		shader_module_create_info.codeSize = size;
+		shader_module_create_info.pCode = reinterpret_cast<const uint32_t*>(code);
 
 		VkResult result;
 		result = vkCreateShaderModule(device_->GetDeviceHandle(), &shader_module_create_info, nullptr, &vk_shader->shader_module);
@@ -678,6 +954,7 @@ namespace rhi {
 		{
 			MLE_CORE_ERROR("Failed to create ShaderModule");
 		}
+		FrameCapture::OnCreateShaderModule(*vk_shader, code, size);
 
 		return vk_shader;
 	}
@@ -706,6 +983,7 @@ namespace rhi {
 		if (vkCreatePipelineLayout(device_->GetDeviceHandle(), &pipelineLayoutInfo, nullptr, &pipeline_layout->pipeline_layout) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create pipeline layout!");
 		}
+		FrameCapture::OnCreatePipelineLayout(*pipeline_layout, desc);
 
 		return pipeline_layout;
 	}
@@ -719,7 +997,7 @@ namespace rhi {
 	PipelineRef VulkanRHI::RHICreatePipeline(const RHIPipeline::Descriptor& desc)
 	{
 		assert(desc.layout != nullptr && "Cannot create graphics pipeline: no pipeline layout provided in desc");
-		auto new_pipeline = std::make_shared<VulkanPipeline>();
+		VulkanPipeline* new_pipeline = pipeline_pool_.Allocate();
 
 		VulkanPipelineLayout* vk_layout = (VulkanPipelineLayout*)desc.layout;
 		VulkanShaderModule* vk_vert = (VulkanShaderModule*)desc.vert_shader;
@@ -887,13 +1165,22 @@ namespace rhi {
 			throw std::runtime_error("failed to create graphics pipeline");
 		}
 
-		return new_pipeline;
+		RHIStats::Count(RHICounter::PIPELINE_CREATIONS);
+		FrameCapture::OnCreatePipeline(*new_pipeline, desc);
+		return PipelineRef(new_pipeline, &pipeline_pool_);
 	}
 
 	void VulkanRHI::RHIFreePipeline(RHIPipeline& pipeline)
 	{
 		VulkanPipeline* vk_pipeline = (VulkanPipeline*)&pipeline;
+		if (!pipeline_pool_.IsAlive(vk_pipeline->handle))
+		{
+			MLE_CORE_ERROR("[vulkan] Freeing a pipeline that has already been freed");
+			return;
+		}
 
 		vkDestroyPipeline(device_->GetDeviceHandle(), vk_pipeline->pipeline, nullptr);
+		FrameCapture::OnFreePipeline(pipeline);
+		pipeline_pool_.Release(*vk_pipeline);
 	}
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "VulkanViewport.h"
 #include "VulkanDevice.h"
 #include "VulkanResource.h"
+#include "VulkanDefragmenter.h"
 #include "Runtime/Core/Base/Singleton.h"
 
 #include "vk_mem_alloc.h"
@@ -15,9 +16,14 @@ namespace rhi {
     };
     struct VulkanFence :public Fence {
         VkFence fence = VK_NULL_HANDLE;
+        // of the last graphics submission that signals it
+        uint64_t submission_serial = 0;
+    };
+    struct VulkanQueryPool :public QueryPool {
+        VkQueryPool pool = VK_NULL_HANDLE;
     };
 
-    class VulkanRHI : public RHI
+    class VulkanRHI final : public RHI
     {
         friend class VulkanRenderer;
     public:
@@ -34,8 +40,10 @@ namespace rhi {
         virtual void* GetNativeSwapchainImageView() override;
         virtual uint32_t GetViewportWidth() override;
         virtual uint32_t GetViewportHeight() override;
+        virtual void OnViewportResize(uint32_t width, uint32_t height) override;
+        virtual void SetPresentMode(PresentMode mode) override;
 
-        VkFormat GetSwapchainImageFormat() { return viewport_->GetSwapChain()->GetImageFormat(); };
+        VkFormat GetSwapchainImageFormat() { return viewport_->GetImageFormat(); };
 
         virtual uint32_t GetGfxQueueFamily() override;
 
@@ -50,10 +58,12 @@ namespace rhi {
         [[nodiscard]] virtual DescriptorAllocatorPtr CreateDescriptorAllocator() override;
 
         virtual CommandBuffer* RHICreateCommandBuffer() override;
+        [[nodiscard]] virtual std::unique_ptr<SecondaryCommandBuffer> RHICreateSecondaryCommandBuffer() override;
         virtual std::unique_ptr<RenderPass>   RHICreateRenderPass(const RenderPass::Descriptor& desc) override;
         virtual std::unique_ptr<RenderTarget> RHICreateRenderTarget(const RenderTarget::Descriptor& desc) override;
         
         [[nodiscard]] virtual ShaderModule* RHICreateShaderModule(const char* path) override;
+        [[nodiscard]] virtual ShaderModule* RHICreateShaderModuleFromCode(const void* code, size_t size) override;
         virtual void RHIFreeShaderModule(ShaderModule& shader) override;
         [[nodiscard]] virtual PipelineLayout* RHICreatePipelineLayout(const PipelineLayout::Descriptor& desc) override;
         virtual void RHIFreePipelineLayout(PipelineLayout& layout) override;
@@ -62,7 +72,7 @@ namespace rhi {
         [[nodiscard]] virtual BufferRef RHICreateBuffer(const RHIBuffer::Descriptor& desc) override;
         virtual void RHIFreeBuffer(RHIBuffer& buffer) override;
         [[nodiscard]] virtual TextureRef RHICreateTexture(const RHITexture::Descriptor& desc) override;
-        virtual void ResizeTexture(RHITexture& texture, uint32_t width, uint32_t height) override;
+        [[nodiscard]] virtual TextureRef ResizeTexture(RHITexture& texture, uint32_t width, uint32_t height) override;
         virtual void RHIFreeTexture(RHITexture& texture) override;
 
         virtual Semaphore* RHICreateSemaphore() override;
@@ -72,7 +82,13 @@ namespace rhi {
         virtual void RHIWaitForFences(Fence** fence, uint32_t fence_count) override;
         virtual bool RHIIsFenceReady(Fence* fence) override;
 
+        [[nodiscard]] virtual QueryPool* RHICreateTimestampQueryPool(uint32_t query_count) override;
+        virtual void RHIDestroyQueryPool(QueryPool* pool) override;
+        virtual bool RHIGetQueryResults(QueryPool* pool, uint32_t first_query, uint32_t query_count, uint64_t* results) override;
+        virtual float GetTimestampPeriod() override;
+
         void RHITick(float delta_time) override;
+        void RHIDefragment() override;
         void RHIBlockUntilGPUIdle() override;
 
         void GetExtensionsAndLayers();
@@ -81,7 +97,13 @@ namespace rhi {
         inline VulkanDevice* GetDevice() { return device_; };
         inline VulkanViewport* GetViewport() { return viewport_; };
 
+        // Objects that the GPU may still use are retired with the current mark and destroyed once IsSubmissionDone is true
+        inline VulkanSubmissionMark GetLastSubmission() const { return last_submission_; };
+        bool IsSubmissionDone(const VulkanSubmissionMark& mark);
+
         inline VkFormat GetDepthFormat() { return depth_format_; };
+        // no window, no surface and no swapchain
+        inline bool IsHeadless() const { return is_headless_; };
 
         VmaAllocator allocator_;
     private:
@@ -93,6 +115,10 @@ namespace rhi {
         void CreateVulkanMemoryAllocator();
 
         void AllocateTextureMemory(VulkanTexture* texture);
+        // Destroys the image but keeps the pool slot, resizing reuses it
+        void FreeTextureMemory(VulkanTexture* texture);
+        // Names the allocation after its category and adds it to the RHIStats
+        void TrackAllocation(VmaAllocation allocation, MemoryCategory category, VkDeviceSize& allocation_size);
     protected:
         VkInstance instance_ = VK_NULL_HANDLE;
         std::vector<const char*> instance_extensions_;
@@ -103,5 +129,23 @@ namespace rhi {
         VulkanViewport* viewport_ = nullptr;
 
         VkFormat depth_format_;
+
+        bool is_headless_ = false;
+
+        uint32_t frame_index_ = 0;
+        float budget_warning_cooldown_ = 0.0f;
+
+        uint64_t submission_serial_ = 0;
+        VulkanSubmissionMark last_submission_{};
+
+        // start a defragmentation by itself when this much of the memory blocks is unused, at most once per interval
+        static constexpr uint64_t AUTO_DEFRAGMENT_UNUSED_BYTES = 64ull << 20;
+        static constexpr float AUTO_DEFRAGMENT_INTERVAL = 30.0f;
+        VulkanDefragmenter defragmenter_;
+        float auto_defragment_cooldown_ = 0.0f;
+
+        ResourcePool<VulkanTexture>     texture_pool_;
+        ResourcePool<VulkanBuffer>      buffer_pool_;
+        ResourcePool<VulkanPipeline>    pipeline_pool_;
     };
 }
\ No newline at end of file
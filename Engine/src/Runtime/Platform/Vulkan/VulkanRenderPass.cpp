@@ -129,7 +129,8 @@ namespace rhi {
 			attachment_description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 			attachment_description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 			attachment_description.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			attachment_description.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+			// headless frames end up in an offscreen image that can only be copied out
+			attachment_description.finalLayout = rhi_.IsHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 		}
 
 		// subpass description
@@ -186,6 +187,31 @@ namespace rhi {
 			}
 		}
 
+		// write after read, the fragment shaders of earlier frames may still sample the image, an execution dependency is enough
+		for (uint32_t index = 0; index < desc.attachments.size(); index++)
+		{
+			const auto& attachment = desc.attachments[index];
+			if (!attachment.is_read_by_earlier_frames)
+				continue;
+			for (uint32_t subpass = 0; subpass < desc.subpasses.size(); subpass++)
+			{
+				const auto& color_attachments = desc.subpasses[subpass].color_attachments;
+				const bool is_written = attachment.is_depth ? desc.subpasses[subpass].use_depth_stencil :
+					std::find(color_attachments.begin(), color_attachments.end(), index) != color_attachments.end();
+				if (!is_written)
+					continue;
+
+				auto& current = dependencies.emplace_back();
+				current.srcSubpass = VK_SUBPASS_EXTERNAL;
+				current.dstSubpass = subpass;
+				current.srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+				current.srcAccessMask = 0;
+				current.dstStageMask = attachment.is_depth ? VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+				current.dstAccessMask = attachment.is_depth ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+				break;
+			}
+		}
+
 		if (desc.is_for_present)
 		{
 			VkAttachmentReference* colorAttachmentRef = new VkAttachmentReference{};
@@ -234,7 +260,8 @@ namespace rhi {
 			io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;       // Enable Keyboard Controls
 			//io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
 			io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;           // Enable Docking
-			io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;         // Enable Multi-Viewport / Platform Windows
+			if (!rhi_.IsHeadless())
+				io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;     // Enable Multi-Viewport / Platform Windows
 			//io.ConfigViewportsNoAutoMerge = true;
 			//io.ConfigViewportsNoTaskBarIcon = true;
 
@@ -252,8 +279,11 @@ namespace rhi {
 
 			// Setup Platform/Renderer backends
 			engine::Application& app = engine::Application::GetApp();
-			GLFWwindow* window = static_cast<GLFWwindow*>(app.GetWindow().GetNativeWindow());
-			ImGui_ImplGlfw_InitForVulkan(window, true);
+			if (!rhi_.IsHeadless())
+			{
+				GLFWwindow* window = static_cast<GLFWwindow*>(app.GetWindow().GetNativeWindow());
+				ImGui_ImplGlfw_InitForVulkan(window, true);
+			}
 			ImGui_ImplVulkan_InitInfo init_info = {};
 			init_info.Instance = rhi_.GetVkInstance();
 			init_info.PhysicalDevice = rhi_.GetDevice()->GetPhysicalHandle();
@@ -264,7 +294,7 @@ namespace rhi {
 			init_info.DescriptorPool = rhi_.GetDevice()->GetDescriptorPool();
 			init_info.Subpass = subpasses.size() - 1;
 			init_info.MinImageCount = 2;
-			init_info.ImageCount = rhi_.GetViewport()->GetSwapChain()->GetSwapchainImageCount();
+			init_info.ImageCount = rhi_.GetViewport()->GetImageCount();
 			init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
 			init_info.Allocator = nullptr;
 			init_info.CheckVkResultFn = check_vk_result;
@@ -2,6 +2,7 @@
 #include "VulkanResource.h"
 #include "VulkanRHI.h"
 #include "VulkanUtils.h"
+#include "Runtime/Function/RHI/FrameCapture.h"
 
 #include "imgui.h"
 #include "backends/imgui_impl_vulkan.h"
@@ -59,6 +60,16 @@ namespace rhi {
     //    vkFreeMemory(rhi_.GetDevice()->GetDeviceHandle(), staging_buffer_memory, nullptr);
     //}
 
+    VkImageAspectFlags VulkanTexture::GetAspect() const
+    {
+        return format == PixelFormat::DEPTH ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+
+    void VulkanTexture::CreateImageView(VkDevice device)
+    {
+        image_view = VulkanUtils::CreateImageView(device, image, vk_format, GetAspect(), VK_IMAGE_VIEW_TYPE_2D, 1, miplevels);
+    }
+
     void VulkanTexture::RegisterForImGui()
     {
         if(!texture_id)
@@ -77,5 +88,6 @@ namespace rhi {
         char* offset_mapped = (char*)alloc_info.pMappedData;
         offset_mapped += offset;
         memcpy((void*)offset_mapped, data, size);
+        FrameCapture::OnBufferData(*this, data, size, offset);
     }
 }
\ No newline at end of file
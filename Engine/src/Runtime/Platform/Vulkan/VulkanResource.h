@@ -18,6 +18,12 @@ namespace rhi {
 		VkDescriptorImageInfo texture_info;
 
 		VmaAllocation image_allocation;
+		VkDeviceSize allocation_size = 0;
+
+		// Depth textures are viewed, transitioned and copied through their depth aspect
+		VkImageAspectFlags GetAspect() const;
+		// The view of every mip of the first layer, what the descriptors and framebuffers use
+		void CreateImageView(VkDevice device);
 
 		virtual void RegisterForImGui() override;
 	};
@@ -27,8 +33,10 @@ namespace rhi {
 	struct VulkanBuffer : public RHIBuffer
 	{
 		VkBuffer buffer = VK_NULL_HANDLE;
+		VkBufferUsageFlags vk_usage = 0;
 		VmaAllocation buffer_allocation = VK_NULL_HANDLE;
 		VmaAllocationInfo alloc_info;
+		VkDeviceSize allocation_size = 0;
 
 		VkDescriptorBufferInfo buffer_info;
 
@@ -105,7 +105,7 @@ namespace rhi {
 		}
 
 		VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(formats);
-		VkPresentModeKHR presentMode = ChooseSwapPresentMode(present_modes);
+		VkPresentModeKHR presentMode = ChooseSwapPresentMode(present_modes, recreate_info->present_mode);
 		VkExtent2D extent = ChooseSwapExtent(capabilities, recreate_info->width, recreate_info->height);
 
 		uint32_t imageCount = capabilities.minImageCount + 1;
@@ -211,25 +211,29 @@ namespace rhi {
 		return available_formats[0];
 	}
 
-	VkPresentModeKHR VulkanSwapChain::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& available_present_modes)
+	VkPresentModeKHR VulkanSwapChain::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& available_present_modes, PresentMode requested_mode)
 	{
+		VkPresentModeKHR requested = VK_PRESENT_MODE_FIFO_KHR;
+		switch (requested_mode)
+		{
+		case PresentMode::MAILBOX:		requested = VK_PRESENT_MODE_MAILBOX_KHR; break;
+		case PresentMode::IMMEDIATE:	requested = VK_PRESENT_MODE_IMMEDIATE_KHR; break;
+		default: break;
+		}
+
 		for (const auto& available_present_mode : available_present_modes)
 		{
-			if (available_present_mode == VK_PRESENT_MODE_MAILBOX_KHR)
+			if (available_present_mode == requested)
 			{
-				MLE_CORE_INFO("Present mode: Mailbox");
+				MLE_CORE_INFO("Present mode: {0}", ToString(requested_mode));
 				return available_present_mode;
 			}
 		}
 
-		// for (const auto &availablePresentMode : availablePresentModes) {
-		//   if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-		//     std::cout << "Present mode: Immediate" << std::endl;
-		//     return availablePresentMode;
-		//   }
-		// }
-
-		MLE_CORE_INFO("Present mode: FIFO");
+		// the only mode every surface has to support
+		if (requested != VK_PRESENT_MODE_FIFO_KHR)
+			MLE_CORE_WARN("Present mode {0} is not supported, falling back to fifo", ToString(requested_mode));
+		MLE_CORE_INFO("Present mode: fifo");
 		return VK_PRESENT_MODE_FIFO_KHR;
 	}
 
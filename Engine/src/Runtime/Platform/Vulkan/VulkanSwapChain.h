@@ -6,6 +6,7 @@ namespace rhi {
 	class VulgkanCommandBuffer;
 	class VulkanRenderPass;
 	struct Semaphore;
+	enum class PresentMode : uint8_t;
 
 	struct VulkanSwapChainRecreateInfo
 	{
@@ -13,6 +14,7 @@ namespace rhi {
 		VkSurfaceKHR surface;
 		uint32_t width;
 		uint32_t height;
+		PresentMode present_mode;
 	};
 
 	class VulkanSwapChain
@@ -63,7 +65,7 @@ namespace rhi {
 		// Helper functions
 
 		VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& available_formats);
-		VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& available_present_modes);
+		VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& available_present_modes, PresentMode requested_mode);
 		VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, uint32_t width, uint32_t height);
 
 		VulkanDevice& device_;
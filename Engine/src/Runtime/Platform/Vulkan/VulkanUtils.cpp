@@ -426,4 +426,32 @@ namespace rhi {
         default:return (VkImageLayout)0;
         }
     }
-}
\ No newline at end of file
+
+    VkPipelineStageFlags VulkanUtils::BufferUsageToVkPipelineStage(BufferUsage usage)
+    {
+        VkPipelineStageFlags stage = 0;
+        if (EnumHasFlag(usage, BufferUsage::UNIFORM | BufferUsage::STORAGE))
+            stage |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        if (EnumHasFlag(usage, BufferUsage::INDIRECT))
+            stage |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+        if (EnumHasFlag(usage, BufferUsage::VERTEX | BufferUsage::INDEX))
+            stage |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+        return stage ? stage : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    }
+
+    VkAccessFlags VulkanUtils::BufferUsageToVkAccess(BufferUsage usage, bool is_write)
+    {
+        VkAccessFlags access = 0;
+        if (EnumHasFlag(usage, BufferUsage::UNIFORM))
+            access |= VK_ACCESS_UNIFORM_READ_BIT;
+        if (EnumHasFlag(usage, BufferUsage::STORAGE))
+            access |= is_write ? VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+        if (EnumHasFlag(usage, BufferUsage::INDIRECT))
+            access |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        if (EnumHasFlag(usage, BufferUsage::VERTEX))
+            access |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+        if (EnumHasFlag(usage, BufferUsage::INDEX))
+            access |= VK_ACCESS_INDEX_READ_BIT;
+        return access;
+    }
+}
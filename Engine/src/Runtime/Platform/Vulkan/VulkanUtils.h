@@ -87,6 +87,9 @@ namespace rhi {
 		static VkShaderStageFlags MLEFormatToVkFormat(const ShaderStage& in_stage);
 
 		static VkImageLayout ImageLayoutToVkImageLayout(rhi::ImageLayout in_layout);
+
+		static VkPipelineStageFlags BufferUsageToVkPipelineStage(BufferUsage usage);
+		static VkAccessFlags BufferUsageToVkAccess(BufferUsage usage, bool is_write);
 	};
 }
 
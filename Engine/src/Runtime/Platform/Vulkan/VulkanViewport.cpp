@@ -2,6 +2,7 @@
 #include "VulkanViewport.h"
 #include "VulkanDevice.h"
 #include "VulkanRHI.h"
+#include "VulkanUtils.h"
 #include "Runtime/Core/Window.h"
 #include "Runtime/Core/Base/Log.h"
 #include <GLFW/glfw3.h>
@@ -17,10 +18,23 @@ namespace rhi {
 		acquired_image_index_(-1)
 	{
 		CreateWindowSurface();
-		VulkanSwapChainRecreateInfo recreate_info = { VK_NULL_HANDLE, surface_, window_handle_->GetWidth(),window_handle_->GetHeight() };
+		VulkanSwapChainRecreateInfo recreate_info = { VK_NULL_HANDLE, surface_, window_handle_->GetWidth(),window_handle_->GetHeight(), rhi_->GetPresentMode() };
 		CreateSwapChain(&recreate_info);
 	}
 	
+	VulkanViewport::VulkanViewport(VulkanRHI* in_rhi, VulkanDevice* in_device, uint32_t width, uint32_t height)
+		:rhi_(in_rhi),
+		swap_chain_(nullptr),
+		device_(in_device),
+		window_handle_(nullptr),
+		surface_(VK_NULL_HANDLE),
+		acquired_image_index_(0),
+		offscreen_width_(width),
+		offscreen_height_(height)
+	{
+		CreateOffscreenImages();
+	}
+
 	VulkanViewport::~VulkanViewport()
 	{
 		swap_chain_ = nullptr;
@@ -29,10 +43,45 @@ namespace rhi {
 
 	void VulkanViewport::Destroy()
 	{
+		if (IsHeadless())
+		{
+			for (uint32_t index = 0; index < offscreen_images_.size(); ++index)
+			{
+				vkDestroyImageView(device_->GetDeviceHandle(), offscreen_image_views_[index], nullptr);
+				vmaDestroyImage(rhi_->allocator_, offscreen_images_[index], offscreen_allocations_[index]);
+			}
+			offscreen_image_views_.clear();
+			offscreen_images_.clear();
+			offscreen_allocations_.clear();
+			return;
+		}
+		ReleaseRetiredSwapChains(true);
 		swap_chain_->Destroy();
 		vkDestroySurfaceKHR(rhi_->GetVkInstance(), surface_, nullptr);
 	}
 
+	void VulkanViewport::CreateOffscreenImages()
+	{
+		offscreen_images_.resize(OFFSCREEN_IMAGE_COUNT);
+		offscreen_allocations_.resize(OFFSCREEN_IMAGE_COUNT);
+		offscreen_image_views_.resize(OFFSCREEN_IMAGE_COUNT);
+		for (uint32_t index = 0; index < OFFSCREEN_IMAGE_COUNT; ++index)
+		{
+			// transfer src so frames can be read back
+			VulkanUtils::VMACreateImage(rhi_->allocator_, offscreen_width_, offscreen_height_, 1,
+				OFFSCREEN_FORMAT,
+				VK_IMAGE_TILING_OPTIMAL,
+				VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+				offscreen_images_[index],
+				1,
+				1,
+				offscreen_allocations_[index]);
+			offscreen_image_views_[index] = VulkanUtils::CreateImageView(device_->GetDeviceHandle(), offscreen_images_[index],
+				OFFSCREEN_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_2D, 1, 1);
+		}
+		MLE_CORE_INFO("[vulkan] headless viewport {0}x{1} created", offscreen_width_, offscreen_height_);
+	}
+
 	void VulkanViewport::CreateWindowSurface()
 	{
 		GLFWwindow* window = static_cast<GLFWwindow*>(window_handle_->GetNativeWindow());
@@ -52,8 +101,8 @@ namespace rhi {
 			glfwGetFramebufferSize(window, &width, &height);
 			glfwWaitEvents();
 		}
-		vkDeviceWaitIdle(device_->GetDeviceHandle());
-		VulkanSwapChainRecreateInfo recreate_info = {swap_chain_->GetSwapchainHandle(), surface_, width, height};
+		resized_ = false;
+		VulkanSwapChainRecreateInfo recreate_info = {swap_chain_->GetSwapchainHandle(), surface_, width, height, rhi_->GetPresentMode()};
 		CreateSwapChain(&recreate_info);
 	}
 
@@ -71,11 +120,23 @@ namespace rhi {
 				MLE_CORE_ERROR("Swap chain image(or depth) format has changed!");
 				throw std::runtime_error("Swap chain image(or depth) format has changed!");
 			}
-			old_swap_chain->Destroy();
-			delete old_swap_chain;
+			// the frames submitted so far may still render to or present its images
+			retired_swap_chains_.push_back({ old_swap_chain, rhi_->GetLastSubmission() });
 		}
 	}
 
+	void VulkanViewport::ReleaseRetiredSwapChains(bool is_gpu_idle)
+	{
+		auto it = std::remove_if(retired_swap_chains_.begin(), retired_swap_chains_.end(), [this, is_gpu_idle](RetiredSwapChain& retired) {
+			if (!is_gpu_idle && !rhi_->IsSubmissionDone(retired.last_use))
+				return false;
+			retired.swap_chain->Destroy();
+			delete retired.swap_chain;
+			return true;
+			});
+		retired_swap_chains_.erase(it, retired_swap_chains_.end());
+	}
+
 	void VulkanViewport::CleanupSwapChain()
 	{
 		rhi_->RHIBlockUntilGPUIdle();
@@ -84,11 +145,29 @@ namespace rhi {
 
 	void VulkanViewport::Present(Semaphore** semaphores, uint32_t semaphore_count)
 	{
+		if (IsHeadless())
+		{
+			// nothing to present, but the semaphores still have to be waited on before they are signaled again
+			std::vector<VkSemaphore> wait_semaphores(semaphore_count);
+			std::vector<VkPipelineStageFlags> wait_stages(semaphore_count, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			for (uint32_t index = 0; index < semaphore_count; ++index)
+			{
+				wait_semaphores[index] = static_cast<VulkanSemaphore*>(semaphores[index])->semaphore;
+			}
+			VkSubmitInfo submit_info{};
+			submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submit_info.waitSemaphoreCount = semaphore_count;
+			submit_info.pWaitSemaphores = wait_semaphores.data();
+			submit_info.pWaitDstStageMask = wait_stages.data();
+			vkQueueSubmit(device_->GetGfxQueue()->GetQueueHandle(), 1, &submit_info, VK_NULL_HANDLE);
+			return;
+		}
+
 		auto result = swap_chain_->Present(semaphores, semaphore_count, &acquired_image_index_);
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || resized_) 
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
 		{
-			resized_ = false;
-			RecreateSwapChain();
+			// recreated before the next acquire
+			resized_ = true;
 		}
 		else if (result != VK_SUCCESS)
 		{
@@ -99,11 +178,28 @@ namespace rhi {
 
 	void VulkanViewport::AcquireNextImage(VkSemaphore& image_available_semaphore)
 	{
+		if (IsHeadless())
+		{
+			// last used OFFSCREEN_IMAGE_COUNT frames ago, at least as far back as the frame whose fence the renderer just waited for
+			acquired_image_index_ = (acquired_image_index_ + 1) % OFFSCREEN_IMAGE_COUNT;
+			VkSubmitInfo submit_info{};
+			submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submit_info.signalSemaphoreCount = 1;
+			submit_info.pSignalSemaphores = &image_available_semaphore;
+			vkQueueSubmit(device_->GetGfxQueue()->GetQueueHandle(), 1, &submit_info, VK_NULL_HANDLE);
+			return;
+		}
+
+		ReleaseRetiredSwapChains(false);
+		if (resized_)
+			RecreateSwapChain();
+
 		auto result = swap_chain_->AcquireNextImage(&acquired_image_index_, image_available_semaphore);
 		if (result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
+			// the semaphore wasn't signaled, the frame still needs an image
 			RecreateSwapChain();
-			return;
+			result = swap_chain_->AcquireNextImage(&acquired_image_index_, image_available_semaphore);
 		}
 
 		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
@@ -115,11 +211,30 @@ namespace rhi {
 
 	uint32_t VulkanViewport::GetViewportWidth()
 	{
+		if (IsHeadless())
+			return offscreen_width_;
 		return window_handle_->GetWidth();
 	}
 
 	uint32_t VulkanViewport::GetViewportHeight()
 	{
+		if (IsHeadless())
+			return offscreen_height_;
 		return window_handle_->GetHeight();
 	}
+
+	VkFormat VulkanViewport::GetImageFormat()
+	{
+		return IsHeadless() ? OFFSCREEN_FORMAT : swap_chain_->GetImageFormat();
+	}
+
+	VkImageView VulkanViewport::GetImageView(uint32_t index)
+	{
+		return IsHeadless() ? offscreen_image_views_[index] : swap_chain_->GetSwapchianImageView(index);
+	}
+
+	uint32_t VulkanViewport::GetImageCount()
+	{
+		return IsHeadless() ? OFFSCREEN_IMAGE_COUNT : static_cast<uint32_t>(swap_chain_->GetSwapchainImageCount());
+	}
 }
\ No newline at end of file
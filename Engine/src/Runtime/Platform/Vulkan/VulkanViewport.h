@@ -1,6 +1,8 @@
 #pragma once
 #include <vulkan/vulkan.h>
 #include "VulkanSwapChain.h"
+#include "vk_mem_alloc.h"
+#include "Runtime/Function/Renderer/FrameResource.h"
 namespace engine{
 	class Window;
 }
@@ -9,11 +11,21 @@ namespace rhi {
 	class VulkanDevice;
 	class VulkanCommandBuffer;
 	class VulkanRHI;
+	struct VulkanFence;
+
+	// A graphics submission that signals a fence, what it and the submissions before it use is free once it is done
+	struct VulkanSubmissionMark
+	{
+		VulkanFence* fence = nullptr;
+		uint64_t serial = 0;
+	};
 
 	class VulkanViewport
 	{
 	public:
 		VulkanViewport(VulkanRHI* in_rhi, VulkanDevice* in_device, engine::Window* in_window);
+		// Headless, renders into offscreen images instead of a swapchain
+		VulkanViewport(VulkanRHI* in_rhi, VulkanDevice* in_device, uint32_t width, uint32_t height);
 		~VulkanViewport();
 
 		void Destroy();
@@ -22,10 +34,21 @@ namespace rhi {
 		uint32_t GetViewportWidth(); 
 		uint32_t GetViewportHeight();
 
+		inline bool IsHeadless() const { return window_handle_ == nullptr; };
+		// The swapchain images or the offscreen ones
+		VkFormat	GetImageFormat();
+		VkImageView	GetImageView(uint32_t index);
+		uint32_t	GetImageCount();
+
 		void CreateWindowSurface();
 		void CreateSwapChain(VulkanSwapChainRecreateInfo* recreate_info);
 		void CleanupSwapChain();
+		// The old swapchain is passed to the new one and retired, nothing waits for the GPU
 		void RecreateSwapChain();
+		// Recreated before the next image is acquired, e.g. for a new size or present mode
+		inline void RequestSwapChainRecreate() { resized_ = true; };
+		// Destroys the retired swapchains the GPU is done with, all of them if the GPU is known to be idle
+		void ReleaseRetiredSwapChains(bool is_gpu_idle);
 
 		void Present(Semaphore** semaphores, uint32_t semaphore_count);
 
@@ -42,5 +65,24 @@ namespace rhi {
 		uint32_t acquired_image_index_;
 
 		bool resized_ = false;
+
+		// replaced swapchains, their images and views may still be used by the frames in flight
+		struct RetiredSwapChain
+		{
+			VulkanSwapChain* swap_chain;
+			VulkanSubmissionMark last_use;
+		};
+		std::vector<RetiredSwapChain> retired_swap_chains_;
+
+		void CreateOffscreenImages();
+
+		// one per frame that can be in flight, so an image comes around again only after its frame's fence was waited for
+		static constexpr uint32_t OFFSCREEN_IMAGE_COUNT = renderer::FrameResourceMngr::MAX_FRAMES_IN_FLIGHT;
+		static constexpr VkFormat OFFSCREEN_FORMAT = VK_FORMAT_B8G8R8A8_UNORM;
+		uint32_t offscreen_width_ = 0;
+		uint32_t offscreen_height_ = 0;
+		std::vector<VkImage>		offscreen_images_;
+		std::vector<VmaAllocation>	offscreen_allocations_;
+		std::vector<VkImageView>	offscreen_image_views_;
 	};
 }
@@ -20,6 +20,7 @@
 #include <set>
 
 #include "Runtime/Core/Base/Log.h"
+#include "Runtime/Core/Debug/Instrumentor.h"
 
 #ifdef MLE_PLATFORM_WINDOWS
 	#include <Windows.h>
@@ -0,0 +1,55 @@
+project "Replay"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++17"
+   targetdir "bin/%{cfg.buildcfg}"
+   staticruntime "off"
+
+   files { "src/**.h", "src/**.cpp" }
+
+   -- captures are usually written next to the editor
+   debugdir "../Editor"
+
+   includedirs
+   {
+      "../vendor/imgui",
+      "../vendor/GLFW/include",
+      "../vendor/ImGuizmo",
+
+      "../Engine/src",
+
+      "%{IncludeDir.VulkanSDK}",
+      "%{IncludeDir.glm}",
+      "%{IncludeDir.spdlog}",
+      "%{IncludeDir.entt}"
+   }
+
+    links
+    {
+        "Runtime"
+    }
+
+   targetdir ("../bin/" .. outputdir .. "/%{prj.name}")
+   objdir ("../bin-int/" .. outputdir .. "/%{prj.name}")
+
+   filter "system:windows"
+      systemversion "latest"
+      defines { "MLE_PLATFORM_WINDOWS" }
+
+   filter "configurations:Debug"
+      defines { "MLE_DEBUG", "MLE_PROFILE" }
+      runtime "Debug"
+      symbols "On"
+
+   filter "configurations:Release"
+      defines { "MLE_RELEASE", "MLE_PROFILE" }
+      runtime "Release"
+      optimize "On"
+      symbols "On"
+
+   filter "configurations:Dist"
+      kind "WindowedApp"
+      defines { "MLE_DIST" }
+      runtime "Release"
+      optimize "On"
+      symbols "Off"
\ No newline at end of file
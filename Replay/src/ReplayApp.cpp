@@ -0,0 +1,62 @@
+#include "mlepch.h"
+#include <Runtime/Core/Base/Application.h>
+#include <Runtime/Core/Base/EntryPoint.h>
+#include <Runtime/Function/RHI/RHI.h>
+
+#include "ReplayLayer.h"
+
+engine::Application* engine::CreateApplication(int argc, char** argv)
+{
+	engine::ApplicationSpecification spec;
+	spec.name = "Replay";
+	spec.width = 1280;
+	spec.height = 720;
+	spec.headless = true;
+
+	replay::ReplaySettings& settings = replay::ReplayLayer::settings;
+
+	// <capture file> --rhi null|vulkan --loop <count> --out <frame stats file>
+#ifdef MLE_RHI_STATIC_VULKAN
+	settings.backend = "vulkan-static";
+#endif // MLE_RHI_STATIC_VULKAN
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool has_value = i + 1 < argc;
+		if (strcmp(argv[i], "--rhi") == 0 && has_value)
+		{
+#ifdef MLE_RHI_STATIC_VULKAN
+			// the build is bound to vulkan, --rhi is ignored
+			++i;
+#else
+			settings.backend = argv[++i];
+			if (settings.backend == "null")
+				rhi::RHI::SetAPI(rhi::RHI::GfxAPI::Null);
+			else
+			{
+				settings.backend = "vulkan";
+				rhi::RHI::SetAPI(rhi::RHI::GfxAPI::Vulkan);
+			}
+#endif // MLE_RHI_STATIC_VULKAN
+		}
+		else if (strcmp(argv[i], "--loop") == 0 && has_value)
+			settings.loop_count = std::max(static_cast<uint32_t>(std::stoul(argv[++i])), 1u);
+		else if (strcmp(argv[i], "--out") == 0 && has_value)
+			spec.frame_stats_file = argv[++i];
+		else if (argv[i][0] != '-')
+			settings.capture_file = argv[i];
+	}
+	if (settings.capture_file.empty())
+		MLE_CORE_ERROR("[Replay] usage: Replay <capture file> [--rhi null|vulkan] [--loop <count>] [--out <frame stats file>]");
+
+	// rendered at the captured size, the render targets in the capture have it baked in
+	rhi::CaptureHeader header{};
+	if (renderer::CaptureReplayer::ReadHeader(settings.capture_file, header) && header.viewport_width > 0 && header.viewport_height > 0)
+	{
+		spec.width = header.viewport_width;
+		spec.height = header.viewport_height;
+	}
+
+	engine::Application* app = new engine::Application(spec);
+	app->PushLayer<replay::ReplayLayer>();
+	return app;
+}
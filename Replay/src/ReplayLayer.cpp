@@ -0,0 +1,75 @@
+#include "mlepch.h"
+#include "ReplayLayer.h"
+#include "Runtime/Core/Base/Application.h"
+#include "Runtime/Function/Renderer/Renderer.h"
+
+#include <imgui.h>
+
+namespace replay {
+	ReplaySettings ReplayLayer::settings{};
+
+	void ReplayLayer::OnAttach()
+	{
+		if (!replayer_.Load(settings.capture_file) || !replayer_.Setup())
+		{
+			Fail();
+			return;
+		}
+		MLE_INFO("[Replay] replaying {0} frames {1} times on {2}", replayer_.GetFrameCount(), settings.loop_count, settings.backend);
+		is_running_ = true;
+	}
+
+	void ReplayLayer::OnDetach()
+	{
+		replayer_.Release();
+	}
+
+	void ReplayLayer::OnUIRender()
+	{
+		// nothing draws UI, the frame that Renderer::Begin started is closed right away
+		ImGui::EndFrame();
+		if (!is_running_)
+			return;
+
+		renderer::FrameResource& frame = renderer::Renderer::GetInstance().GetCurrentFrame();
+		if (!replayer_.ReplayFrame(frame))
+		{
+			Fail();
+			return;
+		}
+
+		if (replayer_.GetReplayedFrameCount() < replayer_.GetFrameCount())
+			return;
+		if (++loop_index_ < settings.loop_count)
+			replayer_.Rewind();
+		else
+			Finish();
+	}
+
+	void ReplayLayer::Finish()
+	{
+		is_running_ = false;
+		const uint32_t frame_count = replayer_.GetFrameCount() * settings.loop_count;
+		engine::FrameStats& frame_stats = engine::Application::GetApp().GetFrameStats();
+		for (uint8_t metric = 0; metric < static_cast<uint8_t>(engine::FrameMetric::COUNT); ++metric)
+		{
+			const engine::FrameMetricStats stats = frame_stats.Compute(static_cast<engine::FrameMetric>(metric), frame_count);
+			MLE_INFO("[Replay] {0}: avg {1:.3f} ms, p50 {2:.3f} ms, p99 {3:.3f} ms, max {4:.3f} ms", ToString(static_cast<engine::FrameMetric>(metric)),
+				stats.average, stats.p50, stats.p99, stats.max);
+		}
+		// the profiler lags a few frames, its rolling averages cover the most recent ones
+		for (const renderer::GPUScopeTiming& timing : renderer::Renderer::GetInstance().GetGPUProfiler().GetTimings())
+		{
+			MLE_INFO("[Replay] GPU {0}: avg {1:.3f} ms, min {2:.3f} ms, max {3:.3f} ms", timing.name, timing.average, timing.min, timing.max);
+		}
+		engine::Application::GetApp().Close();
+	}
+
+	void ReplayLayer::Fail()
+	{
+		is_running_ = false;
+		MLE_ERROR("[Replay] failed to replay {0}", settings.capture_file);
+		engine::Application::GetApp().SetExitCode(1);
+		engine::Application::GetApp().Close();
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "Runtime/Core/Base/Layer.h"
+#include "Runtime/Function/Renderer/CaptureReplayer.h"
+
+namespace replay {
+	struct ReplaySettings
+	{
+		std::string capture_file;
+		// the captured frames are replayed this many times
+		uint32_t loop_count = 1;
+		std::string backend = "vulkan";
+	};
+
+	/// <summary>
+	/// Replays a capture in place of the render graph, one captured frame per application frame,
+	/// then logs the CPU and GPU timings and closes the application. The exit code is 1 if the capture couldn't be replayed.
+	/// </summary>
+	class ReplayLayer : public engine::Layer
+	{
+	public:
+		static ReplaySettings settings;
+
+		virtual void OnAttach() override;
+		virtual void OnDetach() override;
+		virtual void OnUIRender() override;
+	private:
+		void Finish();
+		void Fail();
+
+		renderer::CaptureReplayer replayer_;
+		uint32_t loop_index_ = 0;
+		bool is_running_ = false;
+	};
+}
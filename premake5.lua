@@ -1,10 +1,29 @@
 -- premake5.lua
+newoption
+{
+   trigger = "rhi",
+   value = "API",
+   description = "Graphics backend, picked at runtime or bound at compile time",
+   allowed =
+   {
+      { "dynamic", "Picked at runtime through the RHI interface, the Null RHI is available" },
+      { "vulkan", "Vulkan only, encoder and resource calls are devirtualized" }
+   },
+   default = "dynamic"
+}
+
 workspace "MyLittleEngine"
    architecture "x64"
    configurations { "Debug", "Release", "Dist" }
    startproject "Editor"
 
+   filter "options:rhi=vulkan"
+      defines { "MLE_RHI_STATIC_VULKAN" }
+   filter {}
+
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 
 include "Dependencies.lua"
-include "Editor"
\ No newline at end of file
+include "Editor"
+include "Benchmark"
+include "Replay"
\ No newline at end of file